@@ -0,0 +1,124 @@
+// bin/bilevel_bench.dart
+// ignore_for_file: curly_braces_in_flow_control_structures
+
+import 'dart:io';
+import 'package:pdf_tools/src/gsx_bridge/gsx_bridge.dart';
+
+// dart run bin/bilevel_bench.dart --in "C:\MyDartProjects\pdf_tools\pdfs\input\14_34074_Vol 5.pdf" --dpi 300
+//
+// Compara CCITT G4 e JBIG2 (região genérica) no motor P&B nativo: mesmas páginas
+// binarizadas, codificadas nos dois formatos; mostra tamanho e vazão de codificação.
+
+void printUsage([String? err]) {
+  if (err != null) stderr.writeln('Erro: $err\n');
+  stdout.writeln('''
+Uso:
+  dart run bin/bilevel_bench.dart --in <arquivo.pdf> [opções]
+
+Opções:
+  --dpi <n>            Resolução do raster (padrão 300)
+  --range <A-B>        Intervalo de páginas (padrão: todas)
+  --method <sauvola|otsu>   Limiar adaptativo (padrão sauvola)
+  --workers <n>        Instâncias do Ghostscript (padrão: nº de CPUs)
+  --pages              Lista o resultado de cada página
+  --help               Mostra esta ajuda
+''');
+}
+
+String _kb(num bytes) => '${(bytes / 1024).toStringAsFixed(1)} KB';
+
+Future<int> main(List<String> argv) async {
+  if (argv.isEmpty || argv.contains('--help')) {
+    printUsage();
+    return 0;
+  }
+
+  String? inPath;
+  int dpi = 300;
+  int first = 0, last = 0;
+  int method = GsxBinMethod.sauvola;
+  int workers = 0;
+  bool perPage = false;
+
+  for (int i = 0; i < argv.length; i++) {
+    final a = argv[i];
+    String? next() {
+      if (i + 1 >= argv.length) {
+        printUsage('faltando valor para $a');
+        return null;
+      }
+      return argv[++i];
+    }
+
+    switch (a) {
+      case '--in':
+        inPath = next();
+        if (inPath == null) return 64;
+        break;
+      case '--dpi':
+        final v = next();
+        if (v == null) return 64;
+        dpi = int.tryParse(v) ?? dpi;
+        break;
+      case '--range':
+        final v = next();
+        if (v == null) return 64;
+        final parts = v.split('-');
+        first = int.tryParse(parts[0]) ?? 0;
+        last = parts.length > 1 ? (int.tryParse(parts[1]) ?? 0) : first;
+        break;
+      case '--method':
+        final v = next();
+        if (v == null) return 64;
+        method = v.toLowerCase() == 'otsu' ? GsxBinMethod.otsu : GsxBinMethod.sauvola;
+        break;
+      case '--workers':
+        final v = next();
+        if (v == null) return 64;
+        workers = int.tryParse(v) ?? 0;
+        break;
+      case '--pages':
+        perPage = true;
+        break;
+      default:
+        printUsage('opção desconhecida: $a');
+        return 64;
+    }
+  }
+  if (inPath == null || !File(inPath).existsSync()) {
+    printUsage('arquivo de entrada não encontrado');
+    return 1;
+  }
+
+  final bridge = GsxBridge.open();
+  final sw = Stopwatch()..start();
+  final r = await bridge.bilevelBench(
+    inputPath: inPath,
+    firstPage: first,
+    lastPage: last,
+    dpi: dpi,
+    method: method,
+    workers: workers,
+    onProgress: (done, total, line) => stdout.write('\r$line / $total   '),
+  );
+  stdout.writeln();
+
+  final g4 = r['g4'] as Map<String, dynamic>;
+  final jb = r['jbig2'] as Map<String, dynamic>;
+  stdout.writeln('${r['pages']} páginas a ${r['dpi']} dpi, ${r['workers']} workers, '
+      '${((r['pixels'] as num) / 1e6).toStringAsFixed(1)} Mpx, ${sw.elapsedMilliseconds} ms');
+  stdout.writeln('  G4   : ${_kb(g4['bytes'] as num).padLeft(12)}   '
+      '${g4['encode_ms']} ms   ${g4['mpx_per_s']} Mpx/s');
+  stdout.writeln('  JBIG2: ${_kb(jb['bytes'] as num).padLeft(12)}   '
+      '${jb['encode_ms']} ms   ${jb['mpx_per_s']} Mpx/s');
+  stdout.writeln('  JBIG2/G4 = ${r['jbig2_vs_g4']}');
+
+  if (perPage) {
+    for (final p in (r['per_page'] as List).cast<Map<String, dynamic>>()) {
+      stdout.writeln('  pág ${p['page'].toString().padLeft(4)}: '
+          'G4 ${_kb(p['g4'] as num).padLeft(10)} (${p['g4_ms']} ms)  '
+          'JBIG2 ${_kb(p['jbig2'] as num).padLeft(10)} (${p['jbig2_ms']} ms)');
+    }
+  }
+  return 0;
+}
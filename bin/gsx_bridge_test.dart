@@ -19,8 +19,8 @@ Uso:
 Opções:
   --dpi <n>            DPI alvo p/ imagens (padrão 150)
   --q <1-100>          Qualidade JPEG (padrão 65)
-  --preset <nome>      default|screen|ebook|printer|prepress
-  --mode <color|gray|bilevel>   (padrão color)
+  --preset <nome>      default|screen|ebook|printer|prepress|images (só imagens, nativo)
+  --mode <color|gray|bilevel|mrc>   (padrão color)
   --async              Usa API assíncrona para arquivo único
   --args               Somente imprime os args que seriam usados (não executa)
   --help               Mostra esta ajuda
@@ -39,6 +39,8 @@ int _parseMode(String s) {
     case 'mono':
     case 'bw':
       return GsxColorMode.bilevel;
+    case 'mrc':
+      return GsxColorMode.mrc;
     default:
       return GsxColorMode.color;
   }
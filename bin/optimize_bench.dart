@@ -0,0 +1,109 @@
+// bin/optimize_bench.dart
+// ignore_for_file: curly_braces_in_flow_control_structures
+
+import 'dart:io';
+import 'package:path/path.dart' as p;
+import 'package:pdf_tools/src/gsx_bridge/gsx_bridge.dart';
+
+// dart run bin/optimize_bench.dart --in saida_pdfwrite.pdf
+//
+// Pós-passo nativo (gsx_optimize_pdf) em cada nível da zlib: bytes economizados,
+// tempo de CPU da compressão e bytes economizados por segundo de CPU.
+
+void printUsage([String? err]) {
+  if (err != null) stderr.writeln('Erro: $err\n');
+  stdout.writeln('''
+Uso:
+  dart run bin/optimize_bench.dart --in <arquivo.pdf> [opções]
+
+Opções:
+  --levels <lista>     Níveis separados por vírgula; 0 = esforço máximo (padrão 1,6,9,0)
+  --workers <n>        Threads de compressão (0 = nº de CPUs)
+  --classic-xref       Sem object streams / xref stream (só recompressão)
+  --keep <arquivo>     Guarda a saída do último nível
+  --help               Mostra esta ajuda
+''');
+}
+
+Future<int> main(List<String> argv) async {
+  if (argv.contains('--help')) {
+    printUsage();
+    return 0;
+  }
+
+  String? input;
+  String? keep;
+  var levels = [1, 6, 9, 0];
+  int workers = 0;
+  bool classic = false;
+
+  for (int i = 0; i < argv.length; i++) {
+    final a = argv[i];
+    if (a == '--classic-xref') {
+      classic = true;
+      continue;
+    }
+    if (!['--in', '--levels', '--workers', '--keep'].contains(a)) {
+      printUsage('opção desconhecida: $a');
+      return 64;
+    }
+    if (i + 1 >= argv.length) {
+      printUsage('faltando valor para $a');
+      return 64;
+    }
+    final v = argv[++i];
+    switch (a) {
+      case '--in':
+        input = v;
+        break;
+      case '--levels':
+        levels = v.split(',').map((s) => int.tryParse(s.trim()) ?? -1).toList();
+        break;
+      case '--workers':
+        workers = int.tryParse(v) ?? workers;
+        break;
+      case '--keep':
+        keep = v;
+        break;
+    }
+  }
+  if (input == null) {
+    printUsage('--in é obrigatório');
+    return 64;
+  }
+  if (levels.any((l) => l < 0 || l > 9)) {
+    printUsage('níveis válidos: 0..9');
+    return 64;
+  }
+
+  final bridge = GsxBridge.open();
+  final tmp = await Directory.systemTemp.createTemp('gsx_opt_');
+  try {
+    stdout.writeln('${'nível'.padRight(8)}${'saída'.padLeft(12)}${'economia'.padLeft(12)}'
+        '${'CPU ms'.padLeft(10)}${'parede ms'.padLeft(11)}${'KB/s CPU'.padLeft(11)}');
+    for (var k = 0; k < levels.length; k++) {
+      final out = (keep != null && k == levels.length - 1)
+          ? keep
+          : p.join(tmp.path, 'nivel_${levels[k]}.pdf');
+      final st = await bridge.optimizePdf(
+          inputPath: input,
+          outputPath: out,
+          level: levels[k],
+          workers: workers,
+          classicXref: classic);
+      final name = levels[k] == 0 ? 'máx' : '${levels[k]}';
+      final pct = st.bytesIn > 0 ? 100.0 * st.bytesSaved / st.bytesIn : 0.0;
+      stdout.writeln('${name.padRight(8)}${'${st.bytesOut}'.padLeft(12)}'
+          '${'${pct.toStringAsFixed(1)}%'.padLeft(12)}'
+          '${'${st.cpu.inMilliseconds}'.padLeft(10)}'
+          '${'${st.elapsed.inMilliseconds}'.padLeft(11)}'
+          '${(st.bytesSavedPerCpuSecond / 1024).toStringAsFixed(0).padLeft(11)}');
+    }
+  } on GsxException catch (e) {
+    stderr.writeln('Falha: $e');
+    return 1;
+  } finally {
+    await tmp.delete(recursive: true);
+  }
+  return 0;
+}
@@ -0,0 +1,147 @@
+// bin/replay.dart
+// ignore_for_file: curly_braces_in_flow_control_structures
+
+import 'dart:convert';
+import 'dart:io';
+import 'package:pdf_tools/src/gsx_bridge/gsx_bridge.dart';
+
+// dart run bin/replay.dart --capture carga.jsonl --speed 2 --inputs /srv/pdfs
+//
+// Repete contra esta build a carga gravada com gsx_capture_start (no servidor,
+// GSX_CAPTURE_FILE) e mostra latência e vazão ao lado das gravadas. Com --baseline,
+// compara com o relatório (--report) de outra build e sai com 1 se o p99 piorar além
+// de --max-regress.
+
+void printUsage([String? err]) {
+  if (err != null) stderr.writeln('Erro: $err\n');
+  stdout.writeln('''
+Uso:
+  dart run bin/replay.dart --capture <carga.jsonl> [opções]
+
+Opções:
+  --speed <x>          1 = ritmo gravado, 2 = duas vezes mais rápido, 0 = sem esperar (padrão 1)
+  --concurrency <n>    Jobs simultâneos (padrão 8)
+  --limit <n>          Só os primeiros N jobs
+  --inputs <pasta>     Onde achar as entradas pelo conteúdo se o caminho gravado mudou
+  --work-dir <pasta>   Saídas descartáveis (padrão: pasta temporária)
+  --report <arquivo>   Grava o relatório (JSON)
+  --baseline <arq>     Relatório de outra build para comparar
+  --max-regress <pct>  Piora tolerada do p99 e da vazão frente ao baseline (padrão 10)
+  --help               Mostra esta ajuda
+''');
+}
+
+Future<int> main(List<String> argv) async {
+  if (argv.contains('--help')) {
+    printUsage();
+    return 0;
+  }
+
+  final opts = <String, String>{};
+  const known = [
+    '--capture',
+    '--speed',
+    '--concurrency',
+    '--limit',
+    '--inputs',
+    '--work-dir',
+    '--report',
+    '--baseline',
+    '--max-regress',
+  ];
+  for (int i = 0; i < argv.length; i++) {
+    final a = argv[i];
+    if (!known.contains(a)) {
+      printUsage('opção desconhecida: $a');
+      return 64;
+    }
+    if (i + 1 >= argv.length) {
+      printUsage('faltando valor para $a');
+      return 64;
+    }
+    opts[a] = argv[++i];
+  }
+  final capture = opts['--capture'];
+  if (capture == null) {
+    printUsage('--capture é obrigatório');
+    return 64;
+  }
+  final speed = double.tryParse(opts['--speed'] ?? '1');
+  final concurrency = int.tryParse(opts['--concurrency'] ?? '8');
+  final limit = int.tryParse(opts['--limit'] ?? '0');
+  final maxRegress = double.tryParse(opts['--max-regress'] ?? '10');
+  if (speed == null || speed < 0 || concurrency == null || limit == null || maxRegress == null) {
+    printUsage('valor numérico inválido');
+    return 64;
+  }
+
+  final bridge = GsxBridge.open();
+  final cancel = GsxCancelToken();
+  final sub = ProcessSignal.sigint.watch().listen((_) => cancel.cancel());
+  try {
+    final report = await bridge.replay(
+      capture,
+      speed: speed,
+      concurrency: concurrency,
+      limit: limit,
+      inputsDir: opts['--inputs'],
+      workDir: opts['--work-dir'],
+      onProgress: (done, total, line) => stdout.writeln('[$done/$total] $line'),
+      cancel: cancel,
+    );
+    final json = _reportJson(report);
+    final reportPath = opts['--report'];
+    if (reportPath != null) {
+      await File(reportPath).writeAsString(const JsonEncoder.withIndent('  ').convert(json));
+      stdout.writeln('Relatório gravado em $reportPath');
+    }
+    stdout.writeln(report);
+
+    var ok = report.missing == 0 && report.outcomeMismatch == 0;
+    final baselinePath = opts['--baseline'];
+    if (baselinePath != null) {
+      final base = jsonDecode(await File(baselinePath).readAsString()) as Map<String, dynamic>;
+      final baseP99 = ((base['latency_ms'] as Map)['p99'] as num).toDouble();
+      final baseTput = (base['jobs_per_s'] as num).toDouble();
+      final dP99 = baseP99 > 0 ? (report.latency.p99 - baseP99) * 100 / baseP99 : 0.0;
+      final dTput = baseTput > 0 ? (report.jobsPerSecond - baseTput) * 100 / baseTput : 0.0;
+      stdout.writeln('Frente ao baseline: p99 ${baseP99.toStringAsFixed(0)} → '
+          '${report.latency.p99.toStringAsFixed(0)} ms (${_pct(dP99)}), vazão '
+          '${baseTput.toStringAsFixed(2)} → ${report.jobsPerSecond.toStringAsFixed(2)} jobs/s (${_pct(dTput)})');
+      if (dP99 > maxRegress || -dTput > maxRegress) {
+        stdout.writeln('Regressão acima de ${maxRegress.toStringAsFixed(0)}%.');
+        ok = false;
+      }
+    }
+    // o valor de main não vira código de saída: exitCode para o CI enxergar a falha
+    exitCode = ok ? 0 : 1;
+    return exitCode;
+  } on GsxException catch (e) {
+    stderr.writeln('Falha: $e');
+    exitCode = 1;
+    return exitCode;
+  } finally {
+    await sub.cancel();
+    cancel.dispose();
+  }
+}
+
+String _pct(double v) => '${v >= 0 ? '+' : ''}${v.toStringAsFixed(1)}%';
+
+Map<String, dynamic> _dist(GsxLatency l) =>
+    {'p50': l.p50, 'p90': l.p90, 'p99': l.p99, 'max': l.max, 'mean': l.mean};
+
+Map<String, dynamic> _reportJson(GsxReplayReport r) => {
+      'records': r.records,
+      'replayed': r.replayed,
+      'missing': r.missing,
+      'failed': r.failed,
+      'outcome_mismatch': r.outcomeMismatch,
+      'speed': r.speed,
+      'concurrency': r.concurrency,
+      'wall_ms': r.wallMs,
+      'jobs_per_s': r.jobsPerSecond,
+      'latency_ms': _dist(r.latency),
+      'service_ms': _dist(r.service),
+      'captured_ms': _dist(r.captured),
+    };
@@ -15,6 +15,7 @@ import 'package:shelf_router/shelf_router.dart';
 import 'package:uuid/uuid.dart';
 
 import 'package:pdf_tools/src/ghostscript/ghostscript.dart' as gs_api;
+import 'package:pdf_tools/src/gsx_bridge/gsx_bridge.dart' as gsx_api;
 import 'package:pdf_tools/src/mupdf/mupdf.dart' as mupdf_api;
 import 'package:pdf_tools/src/qpdf/qpdf.dart' as qpdf_api;
 
@@ -120,6 +121,9 @@ Future<_JobRes> _compressIsolate(_Job job) async {
 Future<void> main(List<String> args) async {
   final ip = InternetAddress.anyIPv4;
   final port = int.parse(Platform.environment['PORT'] ?? '8080');
+  _loadTuneProfile();
+  _enableTrace();
+  _startCapture();
   final router = Router()
     ..get('/health', _health)
     ..get('/', (req) => Response.found('/ui'))
@@ -134,7 +138,8 @@ Future<void> main(List<String> args) async {
         'activeJobs': _jobs.length,
       });
       return Response.ok(s, headers: {'content-type': 'application/json'});
-    });
+    })
+    ..get('/metrics', _metrics);
 
   final handler = Pipeline()
       .addMiddleware(_logRequestsWithoutBody())
@@ -206,19 +211,607 @@ Future<int> _getPageCount(String path) async {
   }
 }
 
-Future<void> _mergePdfs(List<String> inputPaths, String outputPath) async {
+/// Inspeção nativa (gsx_probe): header, xref e contagem de páginas em
+/// microssegundos. null se a biblioteca nativa não estiver disponível.
+gsx_api.GsxProbe? _probePdf(String path, String reqId) {
+  try {
+    final probe = gsx_api.GsxBridge.open().probe(path);
+    print('[$reqId] $probe');
+    return probe;
+  } catch (e) {
+    print('[$reqId] gsx_probe indisponível ($e).');
+    return null;
+  }
+}
+
+/// Atribuição de bytes (gsx_analyze) em isolate: resumo por categoria e dpi
+/// efetivo das imagens, para o cliente ver onde está o peso do arquivo. Só roda
+/// com o campo analyze=1 (ou true): percorre o arquivo inteiro e o resultado não
+/// muda a compressão. null se a biblioteca nativa não estiver disponível ou o
+/// PDF não for legível.
+Future<Map<String, dynamic>?> _analyzePdf(String path, String reqId) async {
+  try {
+    final a = await Isolate.run(() => gsx_api.GsxBridge.open().analyze(path));
+    final images = (a['images'] as List).cast<Map<String, dynamic>>();
+    final summary = <String, dynamic>{
+      'categories': a['categories'],
+      'images': images.length,
+      'maxImageDpi': a['max_image_dpi'],
+      'inlineImages': (a['inline_images'] as Map)['count'],
+    };
+    print('[$reqId] Análise: $summary');
+    return summary;
+  } catch (e) {
+    print('[$reqId] gsx_analyze indisponível ($e).');
+    return null;
+  }
+}
+
+/// Modos raster nativos: 'bilevel' (gsx_bilevel_pdf: raster em cinza, limiar
+/// adaptativo e páginas JBIG2) e 'mrc' (gsx_mrc_pdf: máscara de texto 1-bpp, cor do
+/// texto e fundo JPEG). false se a biblioteca nativa não estiver disponível (o
+/// chamador cai no pdfwrite).
+Future<bool> _compressNative(String mode, Map<String, String> fields,
+    String inputPath, String outputPath, int first, int last, _Prog prog,
+    String reqId) async {
+  final gsx_api.GsxBridge gsx;
+  try {
+    gsx = gsx_api.GsxBridge.open();
+  } catch (e) {
+    print('[$reqId] gsx_bridge indisponível ($e); $mode via pdfwrite.');
+    return false;
+  }
+  // 'dpi' é a resolução das imagens em tons; traço 1-bpp precisa do dobro
+  final imageDpi = int.tryParse(fields['dpi'] ?? '150') ?? 150;
+  final dpi = (imageDpi * 2).clamp(150, 600);
+  final workers = Platform.numberOfProcessors.clamp(1, MAX_ISOLATES_PER_PDF);
+  final isolateId = '$reqId-$mode';
+  prog.emit({
+    'stage': 'start',
+    'isolateId': isolateId,
+    'totalPagesInJob': last - first + 1,
+    'firstPage': first,
+  });
+  void onProgress(int done, int total, String line) =>
+      prog.emit({'stage': 'page', 'page': done, 'isolateId': isolateId});
+  try {
+    final int pages;
+    if (mode == 'mrc') {
+      pages = await gsx.mrcPdf(
+        inputPath: inputPath,
+        outputPath: outputPath,
+        firstPage: first,
+        lastPage: last,
+        dpi: dpi,
+        bgDpi: min(imageDpi, dpi),
+        jpegQuality: int.tryParse(fields['jpegQuality'] ?? '65') ?? 65,
+        workers: workers,
+        onProgress: onProgress,
+      );
+    } else {
+      pages = await gsx.bilevelPdf(
+        inputPath: inputPath,
+        outputPath: outputPath,
+        firstPage: first,
+        lastPage: last,
+        dpi: dpi,
+        workers: workers,
+        codec: gsx_api.GsxBinCodec.jbig2,
+        onProgress: onProgress,
+      );
+    }
+    print('[$reqId] $mode nativo: $pages páginas a ${dpi}dpi.');
+    return true;
+  } on ArgumentError catch (e) {
+    // lib antiga, sem gsx_bilevel_pdf / gsx_mrc_pdf
+    print('[$reqId] $mode nativo indisponível ($e); usando pdfwrite.');
+    return false;
+  }
+}
+
+/// memfd (Linux, com a lib nativa) para o upload/saída; null → arquivo temporário.
+int? _memfd(String name, String reqId) {
+  if (!Platform.isLinux) return null;
+  try {
+    return gsx_api.GsxBridge.open().memfdCreate(name);
+  } catch (e) {
+    print('[$reqId] memfd indisponível ($e); usando arquivos temporários.');
+    return null;
+  }
+}
+
+void _closeFd(int fd) {
+  try {
+    gsx_api.GsxBridge.open().closeFd(fd);
+  } catch (_) {}
+}
+
+/// Compressão de descritor para descritor (gsx_compress_fd_sync): o upload em
+/// memfd vai direto ao Ghostscript e a saída fica em [outFd], de onde a resposta é
+/// lida. false se a função nativa não estiver disponível ou falhar (o chamador
+/// segue com o isolate e arquivos).
+Future<bool> _compressFd(Map<String, String> fields, int inFd, int outFd,
+    int first, int last, _Prog prog, String reqId) async {
+  final mode = switch ((fields['mode'] ?? 'color').toLowerCase()) {
+    'gray' => 1,
+    _ => 0,
+  };
+  final isolateId = '$reqId-fd';
+  prog.emit({
+    'stage': 'start',
+    'isolateId': isolateId,
+    'totalPagesInJob': last - first + 1,
+    'firstPage': first,
+  });
+  try {
+    final n = await gsx_api.GsxBridge.open().compressFd(
+      inputFd: inFd,
+      outputFd: outFd,
+      dpi: int.tryParse(fields['dpi'] ?? '150') ?? 150,
+      jpegQuality: int.tryParse(fields['jpegQuality'] ?? '65') ?? 65,
+      preset: (fields['quality'] ?? 'default').toLowerCase(),
+      colorMode: mode,
+      firstPage: first,
+      lastPage: last,
+      onProgress: (done, total, line) {
+        if (line.contains('xref table was repaired')) {
+          prog.emit({'stage': 'repaired'});
+        }
+        if (done > 0) {
+          prog.emit({'stage': 'page', 'page': done, 'isolateId': isolateId});
+        }
+      },
+    );
+    print('[$reqId] Compressão por descritores: $n bytes.');
+    return true;
+  } catch (e) {
+    print('[$reqId] gsx_compress_fd_sync falhou ($e); usando isolate.');
+    return false;
+  }
+}
+
+/// Engine 'images' (gsx_recompress_images): só as imagens são reduzidas e
+/// recodificadas em JPEG; fontes, conteúdo e estrutura são copiados byte a byte.
+/// Vale para o documento inteiro. false se a biblioteca nativa não estiver
+/// disponível (o chamador cai no pdfwrite).
+Future<bool> _compressImagesOnly(Map<String, String> fields, String inputPath,
+    String outputPath, _Prog prog, String reqId) async {
+  final gsx_api.GsxBridge gsx;
+  try {
+    gsx = gsx_api.GsxBridge.open();
+  } catch (e) {
+    print('[$reqId] gsx_bridge indisponível ($e); imagens via pdfwrite.');
+    return false;
+  }
+  final isolateId = '$reqId-images';
+  try {
+    final st = await gsx.recompressImages(
+      inputPath: inputPath,
+      outputPath: outputPath,
+      dpi: int.tryParse(fields['dpi'] ?? '150') ?? 150,
+      jpegQuality: int.tryParse(fields['jpegQuality'] ?? '65') ?? 65,
+      gray: (fields['mode'] ?? '').toLowerCase() == 'gray',
+      workers: Platform.numberOfProcessors.clamp(1, MAX_ISOLATES_PER_PDF),
+      onProgress: (done, total, line) {
+        if (done == 1) {
+          prog.emit({
+            'stage': 'start',
+            'isolateId': isolateId,
+            'totalPagesInJob': total,
+            'firstPage': 1,
+          });
+        }
+        prog.emit({'stage': 'page', 'page': done, 'isolateId': isolateId});
+      },
+    );
+    print('[$reqId] Só imagens: $st');
+    return true;
+  } on ArgumentError catch (e) {
+    // lib antiga, sem gsx_recompress_images
+    print('[$reqId] gsx_recompress_images indisponível ($e); usando pdfwrite.');
+    return false;
+  }
+}
+
+/// Modo 'auto': pré-passada em baixa resolução (gsx_classify_pages) sobre o
+/// intervalo; sem nenhuma página colorida o documento vai em tons de cinza.
+/// Sem a biblioteca nativa (ou se a pré-passada falhar) fica em 'color'.
+Future<String> _autoColorMode(
+    String path, int first, int last, _Prog prog, String reqId) async {
+  try {
+    final sw = Stopwatch()..start();
+    final pages = await gsx_api.GsxBridge.open().classifyPages(
+      inputPath: path,
+      firstPage: first,
+      lastPage: last,
+      workers: Platform.numberOfProcessors.clamp(1, MAX_ISOLATES_PER_PDF),
+    );
+    int count(int kind) => pages.where((p) => p.kind == kind).length;
+    final blank = [for (final p in pages) if (p.isBlank) p.page];
+    final mode = gsx_api.GsxPageClass.suggestedColorMode(pages) ==
+            gsx_api.GsxColorMode.gray
+        ? 'gray'
+        : 'color';
+    prog.emit({
+      'stage': 'classified',
+      'blank': blank,
+      'bilevel': count(gsx_api.GsxPageKind.bilevel),
+      'gray': count(gsx_api.GsxPageKind.gray),
+      'color': count(gsx_api.GsxPageKind.color),
+      'mode': mode,
+      'elapsedMs': sw.elapsedMilliseconds,
+    });
+    print('[$reqId] Pré-passada: ${pages.length} páginas em '
+        '${sw.elapsedMilliseconds}ms, em branco=$blank, modo=$mode');
+    return mode;
+  } catch (e) {
+    print('[$reqId] gsx_classify_pages indisponível ($e); modo colorido.');
+    return 'color';
+  }
+}
+
+/// Divide [first, last] em até [chunks] intervalos equilibrando o custo estimado
+/// de cada página (gsx_plan_chunks). Se a biblioteca nativa falhar, volta à
+/// divisão por contagem de páginas.
+List<(int, int)> _planChunks(String path, int first, int last, int chunks) {
+  try {
+    final plan = gsx_api.GsxBridge.open().planChunks(
+        inputPath: path, firstPage: first, lastPage: last, maxChunks: chunks);
+    if (plan.isNotEmpty) {
+      return [for (final c in plan) (c.firstPage, c.lastPage)];
+    }
+  } catch (e) {
+    print('gsx_plan_chunks indisponível ($e); dividindo por páginas.');
+  }
+  final pagesPerChunk = ((last - first + 1) / chunks).ceil();
+  return [
+    for (var i = 0; i < chunks; i++)
+      if (first + i * pagesPerChunk <= last)
+        (
+          first + i * pagesPerChunk,
+          i == chunks - 1
+              ? last
+              : min(last, first + (i + 1) * pagesPerChunk - 1)
+        ),
+  ];
+}
+
+/// Antes de dividir em isolates: com a xref danificada, cada instância do Ghostscript
+/// repetiria a varredura de reparo do arquivo inteiro; gsx_normalize_pdf a faz uma vez
+/// e grava uma cópia sã (em isolate: a varredura lê o arquivo inteiro). Devolve o
+/// caminho que os lotes devem ler (o original se a xref está boa ou a biblioteca
+/// nativa não estiver disponível).
+Future<String> _normalizeOnce(String inputPath, String workDir,
+    List<String> tempFiles, _Prog prog, String reqId) async {
+  final outPath = p.join(workDir, '${_uuid.v4()}-normalized.pdf');
+  try {
+    final st = await Isolate.run(() => gsx_api.GsxBridge.open()
+        .normalizePdf(inputPath: inputPath, outputPath: outPath));
+    if (!st.written) return inputPath;
+    print('[$reqId] xref reparada uma vez antes dos lotes: $st');
+    prog.emit({'stage': 'repaired'});
+    tempFiles.add(outPath);
+    return outPath;
+  } catch (e) {
+    print('[$reqId] gsx_normalize_pdf indisponível ($e); lotes com o original.');
+    return inputPath;
+  }
+}
+
+/// Perfil de gsx_tune_calibrate (bin/tune_calibrate.dart), de GSX_TUNE_PROFILE ou da
+/// pasta temporária do servidor. Ativo, ele decide quando dividir e em quantos lotes.
+void _loadTuneProfile() {
+  final path = Platform.environment['GSX_TUNE_PROFILE'] ??
+      p.join(Directory.systemTemp.path, 'pdf-compressor-server',
+          'tune_profile.json');
+  if (!File(path).existsSync()) return;
+  try {
+    final gsx = gsx_api.GsxBridge.open();
+    final profile = gsx.loadTuneProfile(path);
+    gsx.setTuneProfile(profile);
+    print('Perfil de lotes carregado de $path: $profile');
+  } catch (e) {
+    print('Perfil de lotes ignorado ($e); usando MIN_PAGES_FOR_SPLIT.');
+  }
+}
+
+/// GSX_TRACE_DIR: spans nativos de cada requisição em <dir>/<reqId>.json, para abrir
+/// no Perfetto. A janela é o tempo da requisição: jobs de requisições simultâneas
+/// aparecem também, cada um na sua linha (pid = job).
+final String? _traceDir = Platform.environment['GSX_TRACE_DIR'];
+
+void _enableTrace() {
+  final dir = _traceDir;
+  if (dir == null || dir.isEmpty) return;
+  try {
+    Directory(dir).createSync(recursive: true);
+    gsx_api.GsxBridge.open().traceEnable(true);
+    print('Rastreamento nativo ligado: $dir');
+  } catch (e) {
+    print('Rastreamento nativo indisponível ($e).');
+  }
+}
+
+/// GSX_CAPTURE_FILE: grava a carga real (uma linha por compressão nativa) para
+/// repetir contra outra build com bin/replay.dart.
+void _startCapture() {
+  final path = Platform.environment['GSX_CAPTURE_FILE'];
+  if (path == null || path.isEmpty) return;
+  try {
+    gsx_api.GsxBridge.open().captureStart(path);
+    print('Captura de carga ligada: $path');
+  } catch (e) {
+    print('Captura de carga indisponível ($e).');
+  }
+}
+
+int? _traceStart() {
+  final dir = _traceDir;
+  if (dir == null || dir.isEmpty) return null;
+  try {
+    return gsx_api.GsxBridge.open().traceNowUs;
+  } catch (_) {
+    return null;
+  }
+}
+
+void _traceRequest(String reqId, int? since) {
+  if (since == null) return;
+  final path = p.join(_traceDir!, '$reqId.json');
+  try {
+    final n = gsx_api.GsxBridge.open().traceDump(path, sinceUs: since);
+    print('[$reqId] trace: $n spans em $path');
+  } catch (e) {
+    print('[$reqId] trace não gravado ($e).');
+  }
+}
+
+/// Métricas no formato texto do Prometheus: os contadores da lib nativa (o mesmo
+/// processo, todos os isolates) mais a fila e os jobs do servidor.
+Response _metrics(Request _) {
+  final sb = StringBuffer();
+  try {
+    sb.write(gsx_api.GsxBridge.open().metricsSnapshot());
+  } catch (e) {
+    sb.writeln('# lib nativa indisponível: $e');
+  }
+  sb
+    ..writeln('# HELP pdf_server_queue_in_use Arquivos ocupando a fila de processamento.')
+    ..writeln('# TYPE pdf_server_queue_in_use gauge')
+    ..writeln('pdf_server_queue_in_use $_filesInQueue')
+    ..writeln('# HELP pdf_server_queue_max Capacidade da fila de processamento.')
+    ..writeln('# TYPE pdf_server_queue_max gauge')
+    ..writeln('pdf_server_queue_max $_filesMaxQueue')
+    ..writeln('# HELP pdf_server_jobs_active Requisições de compressão acompanhadas.')
+    ..writeln('# TYPE pdf_server_jobs_active gauge')
+    ..writeln('pdf_server_jobs_active ${_jobs.length}');
+  return Response.ok(sb.toString(),
+      headers: {'content-type': 'text/plain; version=0.0.4; charset=utf-8'});
+}
+
+/// Dividir compensa? Com perfil ativo, o modelo de custo calibrado responde pelo peso
+/// das páginas; sem ele (ou sem a lib nativa), vale MIN_PAGES_FOR_SPLIT.
+bool _shouldSplit(
+    String inputPath, int first, int last, int pages, String reqId) {
+  try {
+    final plan = gsx_api.GsxBridge.open().tunePlan(
+        inputPath: inputPath,
+        firstPage: first,
+        lastPage: last,
+        maxWorkers: Platform.numberOfProcessors.clamp(2, MAX_ISOLATES_PER_PDF));
+    if (plan != null) {
+      print('[$reqId] plano do perfil para $pages páginas: $plan');
+      return plan.split;
+    }
+  } catch (_) {}
+  return pages >= MIN_PAGES_FOR_SPLIT;
+}
+
+/// Compressão do intervalo via gsx_compress_parallel_sync: lotes pequenos numa
+/// fila compartilhada, com os lotes retardatários redivididos entre os workers
+/// ociosos. Retorna as partes em ordem de página, ou null se a biblioteca nativa
+/// não estiver disponível (o chamador usa o fan-out de isolates).
+Future<List<String>?> _compressParallel(
+    Map<String, String> fields,
+    String inputPath,
+    int first,
+    int last,
+    String workDir,
+    _Prog prog,
+    String reqId) async {
+  final gsx_api.GsxBridge gsx;
+  try {
+    gsx = gsx_api.GsxBridge.open();
+  } catch (e) {
+    print('[$reqId] gsx_bridge indisponível ($e); usando isolates.');
+    return null;
+  }
+  final mode = switch ((fields['mode'] ?? 'color').toLowerCase()) {
+    'gray' => 1,
+    'bilevel' => 2,
+    'mrc' => 3,
+    _ => 0,
+  };
+  final quality = (fields['quality'] ?? 'default').toLowerCase();
+  final isolateId = '$reqId-parallel';
+
+  // o progresso nativo já vem agregado: um único "isolate" cobrindo o intervalo
+  prog.emit({
+    'stage': 'start',
+    'isolateId': isolateId,
+    'totalPagesInJob': last - first + 1,
+    'firstPage': 1,
+  });
+  var lastDone = 0;
+  try {
+    return await gsx.compressParallel(
+      inputPath: inputPath,
+      dpi: int.tryParse(fields['dpi'] ?? '150') ?? 150,
+      jpegQuality: int.tryParse(fields['jpegQuality'] ?? '65') ?? 65,
+      preset: quality,
+      colorMode: mode,
+      firstPage: first,
+      lastPage: last,
+      workers: Platform.numberOfProcessors.clamp(2, MAX_ISOLATES_PER_PDF),
+      workDir: workDir,
+      onProgress: (done, total, line) {
+        if (line.contains('xref table was repaired')) {
+          prog.emit({'stage': 'repaired'});
+        }
+        if (done > lastDone) {
+          lastDone = done;
+          prog.emit({'stage': 'page', 'page': done, 'isolateId': isolateId});
+        }
+      },
+    );
+  } on ArgumentError catch (e) {
+    // lib antiga, sem gsx_compress_parallel_sync
+    print('[$reqId] gsx_compress_parallel_sync indisponível ($e); usando isolates.');
+    return null;
+  }
+}
+
+/// Requisição inteira no pipeline nativo (gsx_pipeline_run): lotes em paralelo,
+/// partes em memória (memfd) e mesclagem deduplicada, já linearizada se
+/// [linearize], gravada direto em [outputPath]. false se a biblioteca nativa não
+/// estiver disponível ou o pipeline falhar (o chamador segue com partes em disco).
+Future<bool> _compressPipeline(
+    Map<String, String> fields,
+    String inputPath,
+    String outputPath,
+    int first,
+    int last,
+    String workDir,
+    bool linearize,
+    _Prog prog,
+    String reqId) async {
+  final gsx_api.GsxBridge gsx;
+  try {
+    gsx = gsx_api.GsxBridge.open();
+  } catch (e) {
+    print('[$reqId] gsx_bridge indisponível ($e); pipeline em arquivos.');
+    return false;
+  }
+  final mode = switch ((fields['mode'] ?? 'color').toLowerCase()) {
+    'gray' => 1,
+    'bilevel' => 2,
+    'mrc' => 3,
+    _ => 0,
+  };
+  final isolateId = '$reqId-pipeline';
+  prog.emit({
+    'stage': 'start',
+    'isolateId': isolateId,
+    'totalPagesInJob': last - first + 1,
+    'firstPage': 1,
+  });
+  var lastDone = 0;
+  try {
+    final report = await gsx.runPipeline(
+      inputPath: inputPath,
+      outputPath: outputPath,
+      dpi: int.tryParse(fields['dpi'] ?? '150') ?? 150,
+      jpegQuality: int.tryParse(fields['jpegQuality'] ?? '65') ?? 65,
+      preset: (fields['quality'] ?? 'default').toLowerCase(),
+      colorMode: mode,
+      firstPage: first,
+      lastPage: last,
+      workers: Platform.numberOfProcessors.clamp(2, MAX_ISOLATES_PER_PDF),
+      linearize: linearize,
+      workDir: workDir,
+      onProgress: (done, total, line) {
+        if (line.contains('xref table was repaired')) {
+          prog.emit({'stage': 'repaired'});
+        }
+        if (line == 'pipeline: merge' || line == 'pipeline: merge+linearize') {
+          prog.emit({'stage': 'merging'});
+        }
+        if (done > lastDone) {
+          lastDone = done;
+          prog.emit({'stage': 'page', 'page': done, 'isolateId': isolateId});
+        }
+      },
+    );
+    print('[$reqId] Pipeline nativo: $report');
+    return true;
+  } catch (e) {
+    print('[$reqId] gsx_pipeline_run falhou ($e); pipeline em arquivos.');
+    try {
+      await File(outputPath).delete();
+    } catch (_) {}
+    return false;
+  }
+}
+
+/// Pós-passo nativo (gsx_optimize_pdf): recomprime os streams Flate e empacota os
+/// objetos em object streams. true se a saída ficou menor (o chamador passa a usá-la);
+/// false se a biblioteca nativa não estiver disponível ou não houve ganho.
+Future<bool> _optimizePdf(String inputPath, String outputPath, String reqId) async {
+  try {
+    final st = await gsx_api.GsxBridge.open()
+        .optimizePdf(inputPath: inputPath, outputPath: outputPath);
+    final kbPerCpuS = st.bytesSavedPerCpuSecond / 1024;
+    print('[$reqId] Otimização: $st (${kbPerCpuS.toStringAsFixed(0)} KB/s de CPU)');
+    if (st.bytesOut < st.bytesIn) return true;
+  } catch (e) {
+    print('[$reqId] gsx_optimize_pdf indisponível ($e).');
+  }
+  try {
+    await File(outputPath).delete();
+  } catch (_) {}
+  return false;
+}
+
+/// Mescla [inputPaths] em [outputPath]. Com [linearize], tenta gravar já linearizado
+/// na mesma escrita; devolve true se a saída saiu linearizada.
+Future<bool> _mergePdfs(List<String> inputPaths, String outputPath,
+    {bool linearize = false}) async {
+  // concatenação nativa (cópia de bytes, sem modelo de objetos); qpdf só como reserva
+  try {
+    // dedup: cada parte do pdfwrite traz sua própria cópia de fontes/ICC/imagens
+    final st = gsx_api.GsxBridge.open().mergePdfs(
+        inputPaths: inputPaths,
+        outputPath: outputPath,
+        dedup: true,
+        linearize: linearize);
+    print('Mesclagem nativa${linearize ? ' (linearizada)' : ''}: $st');
+    return linearize;
+  } catch (e) {
+    print('gsx_merge_pdfs falhou ($e); mesclando com QPDF.');
+  }
   final qpdf = qpdf_api.Qpdf.open();
   final args = ['--empty', '--pages', ...inputPaths, '--'];
   final rc = qpdf.run(args, outputPath: outputPath);
   if (rc != 0) {
     throw qpdf_api.QpdfException(rc, "Falha ao mesclar PDFs");
   }
+  return false;
+}
+
+/// Lineariza [inputPath] em [outputPath]: nativo (gsx_linearize_pdf), sem recarregar
+/// o arquivo no qpdf; qpdf --linearize só se a biblioteca nativa falhar.
+Future<void> _linearizePdf(
+    String inputPath, String outputPath, String reqId) async {
+  try {
+    final st = gsx_api.GsxBridge.open()
+        .linearizePdf(inputPath: inputPath, outputPath: outputPath);
+    print('[$reqId] Linearização nativa: $st');
+    return;
+  } catch (e) {
+    print('[$reqId] gsx_linearize_pdf falhou ($e); linearizando com QPDF.');
+  }
+  final rc = qpdf_api.Qpdf.open()
+      .run(['--linearize', inputPath], outputPath: outputPath);
+  if (rc != 0) {
+    throw qpdf_api.QpdfException(rc, 'Falha ao linearizar (QPDF)');
+  }
 }
 
 // SUBSTITUA A SUA FUNÇÃO _compress POR ESTA
 Future<Response> _compress(Request req) async {
   final reqStart = DateTime.now();
   final reqId = _uuid.v4().substring(0, 8);
+  final traceSince = _traceStart();
   print('[$reqId] /compress recebido');
 
   final ct = req.headers[HttpHeaders.contentTypeHeader];
@@ -238,6 +831,14 @@ Future<Response> _compress(Request req) async {
   final jobId = req.url.queryParameters['jobId'] ?? _uuid.v4();
   final prog = _ensureJob(jobId);
   print('[$reqId] Job ID: $jobId');
+  // descritores em memória (upload e saída), fechados na limpeza
+  final fds = <int>[];
+  void closeFds() {
+    for (final fd in fds) {
+      _closeFd(fd);
+    }
+    fds.clear();
+  }
 
   try {
     final partsStream =
@@ -249,8 +850,12 @@ Future<Response> _compress(Request req) async {
       final filename = disp.parameters['filename'];
       if (filename != null && name == 'file') {
         originalName = filename;
-        final tmpPath = p.join(tmpRoot.path, '${_uuid.v4()}-upload.pdf');
-        uploaded = File(tmpPath);
+        // upload num memfd quando possível: o Ghostscript o lê sem arquivo temporário
+        final fd = _memfd('upload', reqId);
+        if (fd != null) fds.add(fd);
+        uploaded = File(fd != null
+            ? gsx_api.GsxBridge.fdPath(fd)
+            : p.join(tmpRoot.path, '${_uuid.v4()}-upload.pdf'));
         await part.pipe(uploaded.openWrite());
         final size = await uploaded.length();
         print('[$reqId] Upload concluído: $originalName ($size bytes)');
@@ -263,6 +868,7 @@ Future<Response> _compress(Request req) async {
     }
   } catch (e) {
     print('[$reqId] Erro no upload: $e');
+    closeFds();
     return Response.internalServerError(body: "Erro no upload: $e");
   }
 
@@ -270,28 +876,44 @@ Future<Response> _compress(Request req) async {
     return Response(400, body: 'campo "file" não encontrado');
   }
 
+  // Assinatura + estrutura pelo probe nativo (mmap da xref, sem MuPDF);
+  // sem a lib nativa, volta à leitura do cabeçalho + MuPDF.
+  final probe = _probePdf(uploaded.path, reqId);
+  if (probe != null && !probe.isPdf) {
+    closeFds();
+    return Response(400, body: 'Arquivo não parece ser um PDF válido.');
+  }
+
   // MUDANÇA: Validação de assinatura PDF mais robusta
-  try {
-    final raf = await uploaded.open();
-    // Lê um pouco mais para encontrar o header, ignorando possíveis bytes no início (BOM)
-    final bytes = await raf.read(1024);
-    await raf.close();
-    final txt = utf8.decode(bytes, allowMalformed: true);
-    if (!txt.contains('%PDF-')) {
-      return Response(400, body: 'Arquivo não parece ser um PDF válido.');
+  if (probe == null) {
+    try {
+      final raf = await uploaded.open();
+      // Lê um pouco mais para encontrar o header, ignorando possíveis bytes no início (BOM)
+      final bytes = await raf.read(1024);
+      await raf.close();
+      final txt = utf8.decode(bytes, allowMalformed: true);
+      if (!txt.contains('%PDF-')) {
+        closeFds();
+        return Response(400, body: 'Arquivo não parece ser um PDF válido.');
+      }
+    } catch (e) {
+      closeFds();
+      return Response(500, body: 'Erro ao ler arquivo para validação: $e');
     }
-  } catch (e) {
-    return Response(500, body: 'Erro ao ler arquivo para validação: $e');
   }
 
   return _fileQueueSemaphore.withPermit<Response>(() async {
-    final List<String> tempFiles = [uploaded!.path];
+    final uploadFd = fds.isEmpty ? null : fds.first;
+    final List<String> tempFiles = [if (uploadFd == null) uploaded!.path];
     StreamSubscription? sub;
     ReceivePort? progressPort;
 
     try {
       print('[$reqId] Iniciando processamento do arquivo: ${uploaded.path}');
-      final totalPagesInFile = await _getPageCount(uploaded.path);
+      // estrutura que o leitor nativo não leu: o MuPDF ainda pode reparar
+      final totalPagesInFile = (probe != null && probe.pageCount > 0)
+          ? probe.pageCount
+          : await _getPageCount(uploaded.path);
       if (totalPagesInFile <= 0) {
         throw Exception("PDF inválido ou sem páginas.");
       }
@@ -322,6 +944,20 @@ Future<Response> _compress(Request req) async {
         'inSize': inSize
       });
 
+      final wantsAnalysis =
+          const {'1', 'true'}.contains((fields['analyze'] ?? '').toLowerCase());
+      if (wantsAnalysis) {
+        final analysis = await _analyzePdf(uploaded.path, reqId);
+        if (analysis != null) {
+          prog.emit({'stage': 'analysis', ...analysis});
+        }
+      }
+
+      if ((fields['mode'] ?? '').toLowerCase() == 'auto') {
+        fields['mode'] = await _autoColorMode(uploaded.path,
+            firstPageToProcess, lastPageToProcess, prog, reqId);
+      }
+
       String finalCompressedPath;
       final engine = (fields['engine'] ?? 'gs').toLowerCase();
       print('[$reqId] Usando engine: $engine');
@@ -363,62 +999,118 @@ Future<Response> _compress(Request req) async {
         finalCompressedPath = linPath;
         prog.emit({'stage': 'done'});
       } else {
-        // engine == 'gs' (lógica original)
+        // engine == 'gs' (lógica original) ou 'images' (documento inteiro, nativo)
+        final wantsLinearize =
+            (fields['linearize'] ?? '').toLowerCase() == 'true';
+        final wantsOptimize =
+            (fields['optimize'] ?? '').toLowerCase() == 'true';
+        var linearized = false;
         progressPort = ReceivePort();
         sub = progressPort.listen((msg) {
           if (msg is Map) prog.emit(msg.cast<String, Object?>());
         });
 
-        if (totalPagesToProcess < MIN_PAGES_FOR_SPLIT) {
+        final imagesOut = p.join(tmpRoot.path, '${_uuid.v4()}-images.pdf');
+        final pipelineOut =
+            p.join(tmpRoot.path, '${_uuid.v4()}-pipeline.pdf');
+        if (engine == 'images' &&
+            userFirstPage == null &&
+            userLastPage == null &&
+            await _compressImagesOnly(
+                fields, uploaded.path, imagesOut, prog, reqId)) {
+          tempFiles.add(imagesOut);
+          finalCompressedPath = imagesOut;
+        } else if (!_shouldSplit(uploaded.path, firstPageToProcess,
+            lastPageToProcess, totalPagesToProcess, reqId)) {
           print(
               '[$reqId] PDF/Intervalo pequeno ($totalPagesToProcess páginas), processando em um único isolate.');
           final outPath = p.join(tmpRoot.path, '${_uuid.v4()}-compressed.pdf');
-          tempFiles.add(outPath);
-          final job = _createJob(
-              fields, uploaded.path, outPath, totalPagesToProcess,
-              firstPage: firstPageToProcess,
-              lastPage: lastPageToProcess,
-              sendPort: progressPort.sendPort,
-              isolateId: '$reqId-main');
-          final result = await _runIsolate(job);
-          if ((result['rc'] as int) < 0) throw Exception(result['error']);
-          finalCompressedPath = result['finalPath'] as String;
-        } else {
-          final cpus =
-              Platform.numberOfProcessors.clamp(2, MAX_ISOLATES_PER_PDF);
-          final chunks = min(cpus, (totalPagesToProcess / 2).ceil());
-          final pagesPerChunk = (totalPagesToProcess / chunks).ceil();
-          print(
-              '[$reqId] PDF/Intervalo grande ($totalPagesToProcess páginas), dividindo em $chunks isolates.');
-
-          final futures = <Future<_JobRes>>[];
-          final outParts = <String>[];
-
-          for (var i = 0; i < chunks; i++) {
-            final start = firstPageToProcess + i * pagesPerChunk;
-            final end = (i == chunks - 1)
-                ? lastPageToProcess
-                : min(lastPageToProcess, start + pagesPerChunk - 1);
-            if (start > end) break;
-
-            final partPath =
-                p.join(tmpRoot.path, '${_uuid.v4()}-part${i + 1}.pdf');
-            outParts.add(partPath);
-            tempFiles.add(partPath);
-
+          final mode = (fields['mode'] ?? '').toLowerCase();
+          final outFd = (mode == 'bilevel' || mode == 'mrc' || uploadFd == null)
+              ? null
+              : _memfd('output', reqId);
+          if (outFd != null) fds.add(outFd);
+          if ((mode == 'bilevel' || mode == 'mrc') &&
+              await _compressNative(mode, fields, uploaded.path, outPath,
+                  firstPageToProcess, lastPageToProcess, prog, reqId)) {
+            tempFiles.add(outPath);
+            finalCompressedPath = outPath;
+          } else if (outFd != null &&
+              await _compressFd(fields, uploadFd!, outFd, firstPageToProcess,
+                  lastPageToProcess, prog, reqId)) {
+            // memfd → memfd: a resposta sai do descritor, sem temporário
+            finalCompressedPath = gsx_api.GsxBridge.fdPath(outFd);
+          } else {
+            tempFiles.add(outPath);
             final job = _createJob(
-                fields, uploaded.path, partPath, totalPagesToProcess,
-                firstPage: start,
-                lastPage: end,
+                fields, uploaded.path, outPath, totalPagesToProcess,
+                firstPage: firstPageToProcess,
+                lastPage: lastPageToProcess,
                 sendPort: progressPort.sendPort,
-                isolateId: '$reqId-iso${i + 1}');
-            futures.add(_runIsolate(job));
+                isolateId: '$reqId-main');
+            final result = await _runIsolate(job);
+            if ((result['rc'] as int) < 0) throw Exception(result['error']);
+            finalCompressedPath = result['finalPath'] as String;
           }
+        } else if (await _compressPipeline(
+            fields,
+            uploaded.path,
+            pipelineOut,
+            firstPageToProcess,
+            lastPageToProcess,
+            tmpRoot.path,
+            wantsLinearize && !wantsOptimize,
+            prog,
+            reqId)) {
+          // partes em memória e saída final numa escrita (já linearizada, se pedido)
+          tempFiles.add(pipelineOut);
+          finalCompressedPath = pipelineOut;
+          linearized = wantsLinearize && !wantsOptimize;
+        } else {
+          // fila de lotes no gsx_bridge (com redivisão de retardatários);
+          // sem a lib nativa, cai no fan-out de isolates por chunk fixo.
+          final outParts = await _compressParallel(fields, uploaded.path,
+                  firstPageToProcess, lastPageToProcess, tmpRoot.path, prog,
+                  reqId) ??
+              <String>[];
+          tempFiles.addAll(outParts);
+
+          if (outParts.isEmpty) {
+            final cpus =
+                Platform.numberOfProcessors.clamp(2, MAX_ISOLATES_PER_PDF);
+            final chunks = min(cpus, (totalPagesToProcess / 2).ceil());
+            // xref danificada: reparada uma vez aqui, não em cada isolate
+            final chunkInput = await _normalizeOnce(
+                uploaded.path, tmpRoot.path, tempFiles, prog, reqId);
+            final plan = _planChunks(
+                chunkInput, firstPageToProcess, lastPageToProcess, chunks);
+            print(
+                '[$reqId] PDF/Intervalo grande ($totalPagesToProcess páginas), dividindo em ${plan.length} isolates: $plan');
+
+            final futures = <Future<_JobRes>>[];
+
+            for (var i = 0; i < plan.length; i++) {
+              final (start, end) = plan[i];
+
+              final partPath =
+                  p.join(tmpRoot.path, '${_uuid.v4()}-part${i + 1}.pdf');
+              outParts.add(partPath);
+              tempFiles.add(partPath);
+
+              final job = _createJob(
+                  fields, chunkInput, partPath, totalPagesToProcess,
+                  firstPage: start,
+                  lastPage: end,
+                  sendPort: progressPort.sendPort,
+                  isolateId: '$reqId-iso${i + 1}');
+              futures.add(_runIsolate(job));
+            }
 
-          final results = await Future.wait(futures);
-          for (final r in results) {
-            if ((r['rc'] as int) < 0) {
-              throw Exception(r['error'] ?? 'Erro em um dos isolates.');
+            final results = await Future.wait(futures);
+            for (final r in results) {
+              if ((r['rc'] as int) < 0) {
+                throw Exception(r['error'] ?? 'Erro em um dos isolates.');
+              }
             }
           }
 
@@ -426,22 +1118,27 @@ Future<Response> _compress(Request req) async {
           prog.emit({'stage': 'merging'});
           final mergedPath = p.join(tmpRoot.path, '${_uuid.v4()}-merged.pdf');
           tempFiles.add(mergedPath);
-          await _mergePdfs(outParts, mergedPath);
+          // sem o pós-passo de otimização, mescla e linearização saem numa escrita só
+          linearized = await _mergePdfs(outParts, mergedPath,
+              linearize: wantsLinearize && !wantsOptimize);
           finalCompressedPath = mergedPath;
           print('[$reqId] Mesclagem concluída para: $mergedPath');
         }
 
-        final wantsLinearize =
-            (fields['linearize'] ?? '').toLowerCase() == 'true';
-        if (wantsLinearize) {
-          print('[$reqId] Linearizando o PDF final com QPDF.');
+        if (wantsOptimize) {
+          prog.emit({'stage': 'optimizing'});
+          final optPath = p.join(tmpRoot.path, '${_uuid.v4()}-optimized.pdf');
+          if (await _optimizePdf(finalCompressedPath, optPath, reqId)) {
+            tempFiles.add(optPath);
+            finalCompressedPath = optPath;
+          }
+        }
+
+        if (wantsLinearize && !linearized) {
+          print('[$reqId] Linearizando o PDF final.');
           prog.emit({'stage': 'linearizing'});
           final linPath = p.join(tmpRoot.path, '${_uuid.v4()}-linearized.pdf');
-          final rc = qpdf_api.Qpdf.open()
-              .run(['--linearize', finalCompressedPath], outputPath: linPath);
-          if (rc != 0) {
-            throw qpdf_api.QpdfException(rc, 'Falha ao linearizar (QPDF)');
-          }
+          await _linearizePdf(finalCompressedPath, linPath, reqId);
           tempFiles.add(linPath);
           finalCompressedPath = linPath;
         }
@@ -487,6 +1184,7 @@ Future<Response> _compress(Request req) async {
             print('[$reqId] Erro ao deletar arquivo temporário $path: $e');
           }
         }
+        closeFds();
         prog.close();
         _jobs.remove(jobId);
         print('[$reqId] Limpeza concluída.');
@@ -508,12 +1206,14 @@ Future<Response> _compress(Request req) async {
               '[$reqId] Erro (no bloco catch) ao deletar arquivo temporário $path: $e');
         });
       }
+      closeFds();
       prog.close();
       _jobs.remove(jobId);
       return Response.internalServerError(body: 'Falha ao comprimir PDF: $e');
     } finally {
       await sub?.cancel();
       progressPort?.close();
+      _traceRequest(reqId, traceSince);
     }
   });
 }
@@ -740,9 +1440,10 @@ Response _ui(Request _) {
           <select name="engine" id="engine">
             <option value="gs" selected>Ghostscript (melhor redução)</option>
             <option value="qpdf">QPDF (rápido; só lineariza)</option>
+            <option value="images">Só imagens (nativo; mantém fontes e texto)</option>
           </select>
           <div class="muted" style="margin-top:6px">
-            <small>• <b>Ghostscript</b>: reduz tamanho (downsample/qualidade).<br> • <b>QPDF</b>: não reduz, apenas <i>lineariza</i> (otimiza para web).</small>
+            <small>• <b>Ghostscript</b>: reduz tamanho (downsample/qualidade).<br> • <b>QPDF</b>: não reduz, apenas <i>lineariza</i> (otimiza para web).<br> • <b>Só imagens</b>: reduz só as imagens (DPI/JPEG) e copia o resto sem reprocessar.</small>
           </div>
         </div>
       </div>
@@ -768,14 +1469,17 @@ Response _ui(Request _) {
           <fieldset>
             <legend>Modo de cor</legend>
             <div class="inline">
-              <label class="inline"><input type="radio" name="mode" value="color" checked> Colorido</label> <label class="inline"><input type="radio" name="mode" value="gray"> Tons de cinza</label> <label class="inline"><input type="radio" name="mode" value="bilevel"> Preto e branco</label>
+              <label class="inline"><input type="radio" name="mode" value="auto"> Automático</label> <label class="inline"><input type="radio" name="mode" value="color" checked> Colorido</label> <label class="inline"><input type="radio" name="mode" value="gray"> Tons de cinza</label> <label class="inline"><input type="radio" name="mode" value="bilevel"> Preto e branco</label> <label class="inline"><input type="radio" name="mode" value="mrc"> Digitalização colorida (MRC)</label>
             </div>
             <div class="muted" style="margin-top:6px"><small>“Tons de cinza” ou “Preto e branco” pode reduzir drasticamente o tamanho de documentos escaneados.</small></div>
           </fieldset>
           <fieldset>
             <legend>Otimização web</legend>
             <label class="inline">
-              <input type="checkbox" id="linearize" name="linearize" value="true"> Linearizar após compressão (QPDF)
+              <input type="checkbox" id="linearize" name="linearize" value="true"> Linearizar após compressão (nativo)
+            </label>
+            <label class="inline">
+              <input type="checkbox" id="optimize" name="optimize" value="true"> Recomprimir streams e empacotar objetos (nativo)
             </label>
             <div class="muted" id="linNote" style="margin-top:6px"></div>
           </fieldset>
@@ -891,7 +1595,8 @@ Response _ui(Request _) {
           }
           if (data.stage === 'repaired') $('msg').textContent = 'PDF reparado pelo engine.';
           if (data.stage === 'linearizing') $('msg').textContent = 'Otimizando para web (QPDF)...';
-          if (data.stage === 'merging') $('msg').textContent = 'Mesclando partes (QPDF)…';
+          if (data.stage === 'merging') $('msg').textContent = 'Mesclando partes…';
+          if (data.stage === 'optimizing') $('msg').textContent = 'Recomprimindo streams…';
 
           if (data.stage === 'start') {
               jobProgress[jobId][data.isolateId] = { pagesDone: 0, totalInJob: data.totalPagesInJob, firstPage: data.firstPage };
@@ -0,0 +1,158 @@
+// bin/soak.dart
+// ignore_for_file: curly_braces_in_flow_control_structures
+
+import 'dart:convert';
+import 'dart:io';
+import 'package:pdf_tools/src/gsx_bridge/gsx_bridge.dart';
+
+// dart run bin/soak.dart --in a.pdf --in b.pdf --seconds 3600 --report soak.json
+//
+// Teste de resistência da lib nativa (gsx_soak_run): jobs misturados em paralelo por
+// horas, com RSS, descritores, threads e temporários amostrados. Sai com 1 se algum
+// recurso cresce sem parar ou se um job válido falhou.
+
+void printUsage([String? err]) {
+  if (err != null) stderr.writeln('Erro: $err\n');
+  stdout.writeln('''
+Uso:
+  dart run bin/soak.dart --in <arquivo.pdf> [--in <outro.pdf> ...] [opções]
+
+Opções:
+  --seconds <n>        Duração (padrão 300)
+  --workers <n>        Laços simultâneos (padrão 4)
+  --sample-ms <n>      Intervalo entre amostras (padrão 2000)
+  --warmup <pct>       % inicial das amostras fora da análise (padrão 20)
+  --dpi <n>            Resolução das compressões (padrão 150)
+  --quality <n>        Qualidade JPEG (padrão 65)
+  --preset <nome>      Preset do pdfwrite (ex.: ebook)
+  --mode <modo>        color | gray | bilevel | mrc (padrão color)
+  --max-pages <n>      Páginas por job (padrão 4)
+  --seed <n>           Repete um sorteio anterior (0 = relógio)
+  --work-dir <pasta>   Saídas e partes (padrão: pasta temporária)
+  --report <arquivo>   Grava o relatório completo (JSON, com as amostras)
+  --help               Mostra esta ajuda
+''');
+}
+
+Future<int> main(List<String> argv) async {
+  if (argv.contains('--help')) {
+    printUsage();
+    return 0;
+  }
+
+  final corpus = <String>[];
+  final ints = <String, int>{
+    '--seconds': 300,
+    '--workers': 4,
+    '--sample-ms': 2000,
+    '--warmup': 20,
+    '--dpi': 150,
+    '--quality': 65,
+    '--max-pages': 4,
+    '--seed': 0,
+  };
+  String? preset;
+  int mode = GsxColorMode.color;
+  String? workDir;
+  String? reportPath;
+  const modes = {
+    'color': GsxColorMode.color,
+    'gray': GsxColorMode.gray,
+    'bilevel': GsxColorMode.bilevel,
+    'mrc': GsxColorMode.mrc,
+  };
+
+  for (int i = 0; i < argv.length; i++) {
+    final a = argv[i];
+    if (!ints.containsKey(a) && !['--in', '--preset', '--mode', '--work-dir', '--report'].contains(a)) {
+      printUsage('opção desconhecida: $a');
+      return 64;
+    }
+    if (i + 1 >= argv.length) {
+      printUsage('faltando valor para $a');
+      return 64;
+    }
+    final v = argv[++i];
+    switch (a) {
+      case '--in':
+        corpus.add(v);
+        break;
+      case '--preset':
+        preset = v;
+        break;
+      case '--mode':
+        if (!modes.containsKey(v)) {
+          printUsage('modo inválido: $v');
+          return 64;
+        }
+        mode = modes[v]!;
+        break;
+      case '--work-dir':
+        workDir = v;
+        break;
+      case '--report':
+        reportPath = v;
+        break;
+      default:
+        final n = int.tryParse(v);
+        if (n == null) {
+          printUsage('valor inválido para $a: $v');
+          return 64;
+        }
+        ints[a] = n;
+    }
+  }
+  if (corpus.isEmpty) {
+    printUsage('--in é obrigatório');
+    return 64;
+  }
+
+  final bridge = GsxBridge.open();
+  final cancel = GsxCancelToken();
+  // Ctrl+C encerra o teste com as amostras colhidas até ali
+  final sub = ProcessSignal.sigint.watch().listen((_) => cancel.cancel());
+  try {
+    final report = await bridge.soak(
+      corpus: corpus,
+      seconds: ints['--seconds']!,
+      workers: ints['--workers']!,
+      sampleMs: ints['--sample-ms']!,
+      warmupPct: ints['--warmup']!,
+      dpi: ints['--dpi']!,
+      jpegQuality: ints['--quality']!,
+      preset: preset,
+      colorMode: mode,
+      maxPages: ints['--max-pages']!,
+      seed: ints['--seed']!,
+      workDir: workDir,
+      onProgress: (done, total, line) => stdout.writeln(line),
+      cancel: cancel,
+    );
+    if (reportPath != null) {
+      await File(reportPath).writeAsString(const JsonEncoder.withIndent('  ').convert({
+        'seconds': report.seconds,
+        'workers': report.workers,
+        'seed': report.seed,
+        'jobs': report.jobs,
+        'unexpected': report.unexpected,
+        'unexpected_msgs': report.unexpectedMessages,
+        'growing': report.growing,
+        'conclusive': report.conclusive,
+        'samples': report.samples,
+      }));
+      stdout.writeln('Relatório gravado em $reportPath');
+    }
+    stdout.writeln(report);
+    for (final m in report.unexpectedMessages) stdout.writeln('  inesperado: $m');
+    // o valor de main não vira código de saída: exitCode para o CI enxergar a falha
+    exitCode = report.passed ? 0 : 1;
+    return exitCode;
+  } on GsxException catch (e) {
+    stderr.writeln('Falha: $e');
+    exitCode = 1;
+    return exitCode;
+  } finally {
+    await sub.cancel();
+    cancel.dispose();
+  }
+}
@@ -0,0 +1,115 @@
+// bin/thumbs_bench.dart
+// ignore_for_file: curly_braces_in_flow_control_structures
+
+import 'dart:io';
+import 'package:pdf_tools/src/gsx_bridge/gsx_bridge.dart';
+
+// dart run bin/thumbs_bench.dart --in a.pdf --cache /tmp/thumbs --level 1
+//
+// Miniaturas nativas (gsx_thumbs_*): pede as primeiras páginas como visíveis, o resto
+// em segundo plano, e mede o tempo até a primeira miniatura e até todas. Rodar de
+// novo mostra o cache em disco (indexado pelo conteúdo do PDF).
+
+void printUsage([String? err]) {
+  if (err != null) stderr.writeln('Erro: $err\n');
+  stdout.writeln('''
+Uso:
+  dart run bin/thumbs_bench.dart --in <arquivo.pdf> --cache <pasta> [opções]
+
+Opções:
+  --level <0..3>       Zoom: 24, 48, 96 ou 192 dpi (padrão 1)
+  --visible <n>        Páginas "na tela" pedidas primeiro (padrão 6)
+  --workers <n>        Threads de renderização (0 = nº de CPUs)
+  --gray               Miniaturas em cinza
+  --help               Mostra esta ajuda
+''');
+}
+
+Future<int> main(List<String> argv) async {
+  if (argv.contains('--help')) {
+    printUsage();
+    return 0;
+  }
+
+  String? input;
+  String? cache;
+  int level = 1;
+  int visible = 6;
+  int workers = 0;
+  bool gray = false;
+
+  for (int i = 0; i < argv.length; i++) {
+    final a = argv[i];
+    String next() {
+      if (i + 1 >= argv.length) throw ArgumentError('faltando valor para $a');
+      return argv[++i];
+    }
+
+    try {
+      switch (a) {
+        case '--in':
+          input = next();
+          break;
+        case '--cache':
+          cache = next();
+          break;
+        case '--level':
+          level = int.tryParse(next()) ?? level;
+          break;
+        case '--visible':
+          visible = int.tryParse(next()) ?? visible;
+          break;
+        case '--workers':
+          workers = int.tryParse(next()) ?? workers;
+          break;
+        case '--gray':
+          gray = true;
+          break;
+        default:
+          printUsage('opção desconhecida: $a');
+          return 64;
+      }
+    } on ArgumentError catch (e) {
+      printUsage(e.message as String);
+      return 64;
+    }
+  }
+  if (input == null || cache == null) {
+    printUsage('--in e --cache são obrigatórios');
+    return 64;
+  }
+  if (level < 0 || level >= gsxThumbLevels) {
+    printUsage('--level fora de 0..${gsxThumbLevels - 1}');
+    return 64;
+  }
+
+  final bridge = GsxBridge.open();
+  final pages = bridge.probe(input).pageCount;
+  if (pages <= 0) {
+    stderr.writeln('PDF ilegível: $input');
+    return 1;
+  }
+  final thumbs = bridge.openThumbnails(cache, workers: workers, gray: gray);
+  try {
+    final sw = Stopwatch()..start();
+    final shown = visible.clamp(1, pages);
+    thumbs.request(input, 1, shown, level: level, visible: true);
+    if (shown < pages) thumbs.request(input, shown + 1, pages, level: level);
+
+    final first = await thumbs.get(input, 1, level: level);
+    final tFirst = sw.elapsedMilliseconds;
+    // em ordem: cada get só espera o que os workers já estão fazendo
+    for (var p = 2; p <= shown; p++) await thumbs.get(input, p, level: level);
+    final tVisible = sw.elapsedMilliseconds;
+    for (var p = shown + 1; p <= pages; p++) await thumbs.get(input, p, level: level);
+    final tAll = sw.elapsedMilliseconds;
+
+    stdout.writeln('1ª miniatura: $tFirst ms ($first)');
+    stdout.writeln('$shown visíveis: $tVisible ms');
+    stdout.writeln('$pages páginas: $tAll ms');
+    stdout.writeln(thumbs.stats());
+  } finally {
+    thumbs.close();
+  }
+  return 0;
+}
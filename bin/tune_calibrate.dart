@@ -0,0 +1,136 @@
+// bin/tune_calibrate.dart
+// ignore_for_file: curly_braces_in_flow_control_structures
+
+import 'dart:io';
+import 'package:path/path.dart' as p;
+import 'package:pdf_tools/src/gsx_bridge/gsx_bridge.dart';
+
+// dart run bin/tune_calibrate.dart --in a.pdf --in b.pdf --dpi 150
+//
+// Calibra nesta máquina o modelo de custo da compressão em lotes (gsx_tune_calibrate)
+// e grava o perfil que o servidor carrega na inicialização para decidir quando dividir
+// e em quantos lotes.
+
+void printUsage([String? err]) {
+  if (err != null) stderr.writeln('Erro: $err\n');
+  stdout.writeln('''
+Uso:
+  dart run bin/tune_calibrate.dart --in <arquivo.pdf> [--in <outro.pdf> ...] [opções]
+
+Opções:
+  --dpi <n>            Resolução da compressão calibrada (padrão 150)
+  --quality <n>        Qualidade JPEG (padrão 65)
+  --preset <nome>      Preset do pdfwrite (ex.: ebook)
+  --mode <modo>        color | gray | bilevel | mrc (padrão color)
+  --max-pages <n>      Maior lote medido por documento (0 = 16)
+  --max-seconds <n>    Orçamento da calibração (0 = 60)
+  --out <arquivo>      Onde gravar o perfil (padrão: o que o servidor lê)
+  --plan <arquivo.pdf> Mostra o plano do perfil novo para este PDF
+  --help               Mostra esta ajuda
+''');
+}
+
+Future<int> main(List<String> argv) async {
+  if (argv.contains('--help')) {
+    printUsage();
+    return 0;
+  }
+
+  final corpus = <String>[];
+  int dpi = 150;
+  int quality = 65;
+  String? preset;
+  int mode = GsxColorMode.color;
+  int maxPages = 0;
+  int maxSeconds = 0;
+  String? out;
+  String? planFor;
+  const modes = {
+    'color': GsxColorMode.color,
+    'gray': GsxColorMode.gray,
+    'bilevel': GsxColorMode.bilevel,
+    'mrc': GsxColorMode.mrc,
+  };
+
+  for (int i = 0; i < argv.length; i++) {
+    final a = argv[i];
+    if (![
+      '--in', '--dpi', '--quality', '--preset', '--mode', '--max-pages', '--max-seconds', '--out',
+      '--plan'
+    ].contains(a)) {
+      printUsage('opção desconhecida: $a');
+      return 64;
+    }
+    if (i + 1 >= argv.length) {
+      printUsage('faltando valor para $a');
+      return 64;
+    }
+    final v = argv[++i];
+    switch (a) {
+      case '--in':
+        corpus.add(v);
+        break;
+      case '--dpi':
+        dpi = int.tryParse(v) ?? dpi;
+        break;
+      case '--quality':
+        quality = int.tryParse(v) ?? quality;
+        break;
+      case '--preset':
+        preset = v;
+        break;
+      case '--mode':
+        if (!modes.containsKey(v)) {
+          printUsage('modo inválido: $v');
+          return 64;
+        }
+        mode = modes[v]!;
+        break;
+      case '--max-pages':
+        maxPages = int.tryParse(v) ?? maxPages;
+        break;
+      case '--max-seconds':
+        maxSeconds = int.tryParse(v) ?? maxSeconds;
+        break;
+      case '--out':
+        out = v;
+        break;
+      case '--plan':
+        planFor = v;
+        break;
+    }
+  }
+  if (corpus.isEmpty) {
+    printUsage('--in é obrigatório');
+    return 64;
+  }
+  out ??= Platform.environment['GSX_TUNE_PROFILE'] ??
+      p.join(Directory.systemTemp.path, 'pdf-compressor-server', 'tune_profile.json');
+
+  final bridge = GsxBridge.open();
+  try {
+    final profile = await bridge.calibrate(
+      corpus: corpus,
+      dpi: dpi,
+      jpegQuality: quality,
+      preset: preset,
+      colorMode: mode,
+      maxPages: maxPages,
+      maxSeconds: maxSeconds,
+      onProgress: (done, total, line) => stdout.writeln(line),
+    );
+    stdout.writeln(profile);
+    await Directory(p.dirname(out)).create(recursive: true);
+    bridge.saveTuneProfile(out, profile);
+    stdout.writeln('Perfil gravado em $out');
+
+    if (planFor != null) {
+      bridge.setTuneProfile(profile);
+      stdout.writeln('$planFor: ${bridge.tunePlan(inputPath: planFor)}');
+    }
+  } on GsxException catch (e) {
+    stderr.writeln('Falha: $e');
+    return 1;
+  }
+  return 0;
+}
@@ -155,7 +155,37 @@ Future<Map<String, Object?>> _compressIsolate(Map<String, Object?> job) async {
   }
 }
 
+/// Divide [first, last] em até [chunks] intervalos equilibrando o custo estimado
+/// de cada página (gsx_plan_chunks); sem a DLL, divide por contagem de páginas.
+List<(int, int)> _planChunks(String path, int first, int last, int chunks) {
+  try {
+    final plan = gsx_api.GsxBridge.open().planChunks(
+        inputPath: path, firstPage: first, lastPage: last, maxChunks: chunks);
+    if (plan.isNotEmpty) {
+      return [for (final c in plan) (c.firstPage, c.lastPage)];
+    }
+  } catch (_) {}
+  final pagesPerChunk = ((last - first + 1) / chunks).ceil();
+  return [
+    for (var i = 0; i < chunks; i++)
+      if (first + i * pagesPerChunk <= last)
+        (
+          first + i * pagesPerChunk,
+          i == chunks - 1
+              ? last
+              : min(last, first + (i + 1) * pagesPerChunk - 1)
+        ),
+  ];
+}
+
 Future<int> getPageCountAsync(String path) async {
+  // probe nativo (só xref + raiz da árvore de páginas); MuPDF fica para os
+  // arquivos que o leitor nativo não consegue ler
+  try {
+    final n = gsx_api.GsxBridge.open().probe(path).pageCount;
+    if (n > 0) return n;
+  } catch (_) {}
+
   final receivePort = ReceivePort();
   await Isolate.spawn(
     (Map<String, Object> msg) async {
@@ -340,18 +370,15 @@ Future<String> compressPdfFile({
     } else {
       final chunks =
           maxIsolatesPerPdf.clamp(1, (totalPagesToProcess / 2).ceil());
-      final pagesPerChunk = (totalPagesToProcess / chunks).ceil();
-      onProgress("Dividindo em $chunks partes...", null);
+      final plan = _planChunks(
+          inputPath, firstPageToProcess, lastPageToProcess, chunks);
+      onProgress("Dividindo em ${plan.length} partes...", null);
 
       final outParts = <String>[];
-      for (var i = 0; i < chunks; i++) {
+      for (var i = 0; i < plan.length; i++) {
         if (isCancelRequested?.call() == true) throw Exception('cancelled');
 
-        final start = firstPageToProcess + i * pagesPerChunk;
-        final end = (i == chunks - 1)
-            ? lastPageToProcess
-            : min(lastPageToProcess, start + pagesPerChunk - 1);
-        if (start > end) break;
+        final (start, end) = plan[i];
 
         final partPath = p.join(tmpRoot.path, '${_uuid.v4()}-part${i + 1}.pdf');
         tempFiles.add(partPath);
@@ -583,10 +610,18 @@ void _mergeIsolateEntry(Map<String, Object?> m) async {
 
   try {
     progress?.send({'stage': 'merge-start'});
-    final qpdf = qpdf_api.Qpdf.open();
-    final args = ['--empty', '--pages', ...inputs, '--'];
-    final rc = qpdf.run(args, outputPath: out);
-    if (rc != 0) throw qpdf_api.QpdfException(rc, "Falha ao mesclar PDFs");
+    var rc = 0;
+    try {
+      // concatenação nativa; qpdf só se a lib não tiver gsx_merge_pdfs
+      gsx_api.GsxBridge.open()
+          .mergePdfs(inputPaths: inputs, outputPath: out, dedup: true);
+    } catch (e) {
+      progress?.send({'stage': 'merge-fallback', 'error': e.toString()});
+      final qpdf = qpdf_api.Qpdf.open();
+      final args = ['--empty', '--pages', ...inputs, '--'];
+      rc = qpdf.run(args, outputPath: out);
+      if (rc != 0) throw qpdf_api.QpdfException(rc, "Falha ao mesclar PDFs");
+    }
     progress?.send({'stage': 'merge-done'});
     result.send({'rc': rc});
   } catch (e, st) {
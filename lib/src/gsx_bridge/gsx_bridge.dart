@@ -3,10 +3,13 @@
 
 import 'dart:convert';
 import 'dart:ffi';
+import 'dart:isolate';
 import 'dart:typed_data';
 import 'package:ffi/ffi.dart';
 
 import 'gsx_bridge_bindings.dart';
+export 'gsx_bridge_bindings.dart'
+    show GsxBinCodec, GsxBinMethod, GsxColorMode, GsxPageKind, GsxPreset, GsxRenderColor, gsxThumbLevels;
 
 /// ---------------- Signatures nativas (espelham o header C) ----------------
 
@@ -51,6 +54,519 @@ class GsxCancelToken {
   void dispose() => calloc.free(_flag);
 }
 
+/// ---------------- Inspeção ----------------
+
+/// Resultado de gsx_probe (estrutura do PDF lida sem Ghostscript/MuPDF).
+class GsxProbe {
+  /// -1 se a árvore de páginas não pôde ser lida.
+  final int pageCount;
+
+  /// 17 == "%PDF-1.7"; 0 = sem header (não é PDF).
+  final int version;
+  final bool encrypted;
+  final bool linearized;
+
+  /// 0 = ok, 1 = xref reconstruída por varredura, 2 = ilegível.
+  final int xrefHealth;
+  final bool hasXrefStream;
+  final int xrefSections;
+  final int objectCount;
+  final int fileSize;
+  final int headerOffset;
+  final int elapsedUs;
+
+  GsxProbe._(GsxProbeNative n)
+      : pageCount = n.page_count,
+        version = n.version,
+        encrypted = n.encrypted != 0,
+        linearized = n.linearized != 0,
+        xrefHealth = n.xref_health,
+        hasXrefStream = n.has_xref_stream != 0,
+        xrefSections = n.xref_sections,
+        objectCount = n.object_count,
+        fileSize = n.file_size,
+        headerOffset = n.header_offset,
+        elapsedUs = n.elapsed_us;
+
+  bool get isPdf => version > 0;
+  String get versionString => '${version ~/ 10}.${version % 10}';
+
+  @override
+  String toString() =>
+      'GsxProbe(pages=$pageCount, v=$versionString, encrypted=$encrypted, '
+      'linearized=$linearized, xref=$xrefHealth, objects=$objectCount, ${elapsedUs}us)';
+}
+
+/// Resultado de gsx_normalize_pdf.
+class GsxNormalizeStats {
+  /// true se a cópia normalizada foi gravada (a xref da entrada estava danificada).
+  final bool written;
+
+  /// Da entrada: 0 = ok, 1 = xref reconstruída por varredura.
+  final int xrefHealth;
+
+  /// Entradas da xref que não apontavam para o objeto certo.
+  final int badOffsets;
+  final int objects;
+  final int dropped;
+  final int bytesOut;
+  final Duration elapsed;
+
+  GsxNormalizeStats._(this.written, GsxNormalizeStatsNative n)
+      : xrefHealth = n.xref_health,
+        badOffsets = n.bad_offsets,
+        objects = n.objects,
+        dropped = n.dropped,
+        bytesOut = n.bytes_out,
+        elapsed = Duration(microseconds: n.elapsed_us);
+
+  @override
+  String toString() =>
+      'GsxNormalizeStats(written=$written, xref=$xrefHealth, badOffsets=$badOffsets, '
+      'objects=$objects, dropped=$dropped, out=$bytesOut, ${elapsed.inMilliseconds}ms)';
+}
+
+/// Classe de uma página na pré-passada de gsx_classify_pages.
+class GsxPageClass {
+  final int page;
+
+  /// GsxPageKind.*
+  final int kind;
+
+  /// Boa parte da página é meio-tom (foto/digitalização).
+  final bool imageHeavy;
+
+  /// Frações de pixels: mais escuros que o papel / cromáticos / meio-tom.
+  final double ink;
+  final double color;
+  final double midtone;
+
+  GsxPageClass._(GsxPageClassNative n)
+      : page = n.page,
+        kind = n.kind,
+        imageHeavy = n.image_heavy != 0,
+        ink = n.ink,
+        color = n.color,
+        midtone = n.midtone;
+
+  bool get isBlank => kind == GsxPageKind.blank;
+
+  /// Modo de cor que cobre todas as páginas: cinza se nenhuma tem cor.
+  static int suggestedColorMode(Iterable<GsxPageClass> pages) =>
+      pages.any((p) => p.kind == GsxPageKind.color)
+          ? GsxColorMode.color
+          : GsxColorMode.gray;
+
+  @override
+  String toString() => 'GsxPageClass(p$page, kind=$kind, ink=${ink.toStringAsFixed(4)}, '
+      'color=${color.toStringAsFixed(4)}, mid=${midtone.toStringAsFixed(4)})';
+}
+
+/// ---------------- Planejamento ----------------
+
+/// Intervalo de páginas (1-based, inclusivo) devolvido por gsx_plan_chunks.
+class GsxChunk {
+  final int firstPage;
+  final int lastPage;
+
+  /// Custo estimado (bytes de conteúdo + imagens + custo fixo por página).
+  final int weight;
+  const GsxChunk(this.firstPage, this.lastPage, this.weight);
+
+  int get pageCount => lastPage - firstPage + 1;
+
+  @override
+  String toString() => 'GsxChunk($firstPage-$lastPage, weight=$weight)';
+}
+
+/// ---------------- Mesclagem ----------------
+
+/// Resultado de gsx_merge_pdfs / gsx_dedup_pdf.
+class GsxMergeStats {
+  final int pages;
+  final int objectsIn;
+  final int objectsOut;
+
+  /// Bytes de stream não gravados por serem duplicados.
+  final int streamBytesSaved;
+  final int bytesOut;
+
+  GsxMergeStats._(GsxMergeStatsNative n)
+      : pages = n.pages,
+        objectsIn = n.objects_in,
+        objectsOut = n.objects_out,
+        streamBytesSaved = n.stream_bytes_saved,
+        bytesOut = n.bytes_out;
+
+  @override
+  String toString() =>
+      'GsxMergeStats(pages=$pages, objects=$objectsIn->$objectsOut, saved=$streamBytesSaved, out=$bytesOut)';
+}
+
+/// Resultado de gsx_linearize_pdf.
+class GsxLinearizeStats {
+  final int pages;
+  final int objects;
+  final int firstPageObjects;
+  final int sharedObjects;
+
+  /// Bytes até o fim da 1ª página (/E): o que o leitor baixa antes de exibi-la.
+  final int firstPageEnd;
+  final int hintBytes;
+  final int bytesOut;
+
+  GsxLinearizeStats._(GsxLinearizeStatsNative n)
+      : pages = n.pages,
+        objects = n.objects,
+        firstPageObjects = n.first_page_objects,
+        sharedObjects = n.shared_objects,
+        firstPageEnd = n.first_page_end,
+        hintBytes = n.hint_bytes,
+        bytesOut = n.bytes_out;
+
+  @override
+  String toString() =>
+      'GsxLinearizeStats(pages=$pages, objects=$objects, firstPage=$firstPageObjects, '
+      'shared=$sharedObjects, E=$firstPageEnd, hint=$hintBytes, out=$bytesOut)';
+}
+
+/// Resultado de gsx_optimize_pdf.
+class GsxOptimizeStats {
+  final int objects;
+  final int objectsPacked;
+  final int objectStreams;
+  final int streams;
+  final int streamsRecompressed;
+  final int streamsDeflated;
+  final int streamBytesIn;
+  final int streamBytesOut;
+  final int bytesIn;
+  final int bytesOut;
+
+  /// Tempo de CPU somado das threads de compressão.
+  final Duration cpu;
+  final Duration elapsed;
+
+  GsxOptimizeStats._(GsxOptimizeStatsNative n)
+      : objects = n.objects,
+        objectsPacked = n.objects_packed,
+        objectStreams = n.object_streams,
+        streams = n.streams,
+        streamsRecompressed = n.streams_recompressed,
+        streamsDeflated = n.streams_deflated,
+        streamBytesIn = n.stream_bytes_in,
+        streamBytesOut = n.stream_bytes_out,
+        bytesIn = n.bytes_in,
+        bytesOut = n.bytes_out,
+        cpu = Duration(microseconds: n.cpu_us),
+        elapsed = Duration(microseconds: n.elapsed_us);
+
+  int get bytesSaved => bytesIn - bytesOut;
+
+  /// Bytes economizados por segundo de CPU gasto na compressão.
+  double get bytesSavedPerCpuSecond =>
+      cpu.inMicroseconds > 0 ? bytesSaved * 1e6 / cpu.inMicroseconds : 0;
+
+  @override
+  String toString() =>
+      'GsxOptimizeStats(objects=$objects, packed=$objectsPacked in $objectStreams, '
+      'streams=$streamsRecompressed+$streamsDeflated/$streams, '
+      'stream bytes=$streamBytesIn->$streamBytesOut, file=$bytesIn->$bytesOut, '
+      'cpu=${cpu.inMilliseconds}ms)';
+}
+
+/// Modelo de custo da divisão em lotes medido por gsx_tune_calibrate.
+class GsxTuneProfile {
+  /// Custo fixo de cada lote (inicialização do Ghostscript, fontes, abertura).
+  final double chunkFixedMs;
+  final double pageMs;
+  final double msPerMb;
+  final double mergeFixedMs;
+  final double mergePartMs;
+  final double mergeMsPerMb;
+
+  /// Bytes das partes / peso das páginas.
+  final double outRatio;
+
+  /// Rendimento de cada instância com [effWorkers] simultâneas (0..1).
+  final double parallelEff;
+  final int effWorkers;
+  final int cpus;
+  final int samples;
+
+  const GsxTuneProfile({
+    required this.chunkFixedMs,
+    required this.pageMs,
+    required this.msPerMb,
+    required this.mergeFixedMs,
+    required this.mergePartMs,
+    required this.mergeMsPerMb,
+    required this.outRatio,
+    required this.parallelEff,
+    required this.effWorkers,
+    required this.cpus,
+    this.samples = 0,
+  });
+
+  GsxTuneProfile._(GsxTuneProfileNative n)
+      : chunkFixedMs = n.chunk_fixed_ms,
+        pageMs = n.page_ms,
+        msPerMb = n.ms_per_mb,
+        mergeFixedMs = n.merge_fixed_ms,
+        mergePartMs = n.merge_part_ms,
+        mergeMsPerMb = n.merge_ms_per_mb,
+        outRatio = n.out_ratio,
+        parallelEff = n.parallel_eff,
+        effWorkers = n.eff_workers,
+        cpus = n.cpus,
+        samples = n.samples;
+
+  void _fill(GsxTuneProfileNative n) {
+    n
+      ..chunk_fixed_ms = chunkFixedMs
+      ..page_ms = pageMs
+      ..ms_per_mb = msPerMb
+      ..merge_fixed_ms = mergeFixedMs
+      ..merge_part_ms = mergePartMs
+      ..merge_ms_per_mb = mergeMsPerMb
+      ..out_ratio = outRatio
+      ..parallel_eff = parallelEff
+      ..eff_workers = effWorkers
+      ..cpus = cpus
+      ..samples = samples;
+  }
+
+  @override
+  String toString() =>
+      'GsxTuneProfile(lote=${chunkFixedMs.toStringAsFixed(0)}ms+${pageMs.toStringAsFixed(1)}ms/pág'
+      '+${msPerMb.toStringAsFixed(1)}ms/MB, mescla=${mergeFixedMs.toStringAsFixed(0)}ms'
+      '+${mergePartMs.toStringAsFixed(1)}ms/parte+${mergeMsPerMb.toStringAsFixed(1)}ms/MB, '
+      'eff=${parallelEff.toStringAsFixed(2)}@$effWorkers, cpus=$cpus, samples=$samples)';
+}
+
+/// Escolha de gsx_tune_plan: [chunks] = 1 quando dividir não compensa.
+class GsxTunePlan {
+  final int chunks;
+  final int workers;
+  final Duration estimated;
+  final Duration estimatedSingle;
+
+  GsxTunePlan._(GsxTunePlanNative n)
+      : chunks = n.chunks,
+        workers = n.workers,
+        estimated = Duration(microseconds: (n.est_ms * 1000).round()),
+        estimatedSingle = Duration(microseconds: (n.est_single_ms * 1000).round());
+
+  bool get split => chunks > 1;
+
+  @override
+  String toString() =>
+      'GsxTunePlan(chunks=$chunks, workers=$workers, est=${estimated.inMilliseconds}ms, '
+      'single=${estimatedSingle.inMilliseconds}ms)';
+}
+
+/// Relatório de gsx_pipeline_run.
+class GsxPipelineReport {
+  final int pages;
+  final int parts;
+  final int partsInMemory;
+
+  /// "memfd" (todas as partes em memória), "mixed" ou "file".
+  final String handoff;
+  final int partBytes;
+  final int bytesIn;
+  final int bytesOut;
+  final int objects;
+
+  /// true se a xref estava danificada e os lotes leram a cópia normalizada.
+  final bool normalized;
+  final bool linearized;
+  final Duration total;
+
+  /// Tempo por etapa, na ordem: probe, normalize, chunk, compress, merge, dedup e
+  /// linearize (ou write). Com uma parte só não há merge nem dedup.
+  final Map<String, Duration> stages;
+
+  GsxPipelineReport._(Map<String, dynamic> j)
+      : pages = j['pages'] as int,
+        parts = j['parts'] as int,
+        partsInMemory = j['parts_in_memory'] as int,
+        handoff = j['handoff'] as String,
+        partBytes = j['part_bytes'] as int,
+        bytesIn = j['bytes_in'] as int,
+        bytesOut = j['bytes_out'] as int,
+        objects = j['objects'] as int,
+        normalized = j['normalized'] as bool? ?? false,
+        linearized = j['linearized'] as bool,
+        total = _ms(j['total_ms']),
+        stages = {
+          for (final s in (j['stages'] as List).cast<Map<String, dynamic>>())
+            s['stage'] as String: _ms(s['ms']),
+        };
+
+  static Duration _ms(Object? v) => Duration(microseconds: ((v as num) * 1000).round());
+
+  @override
+  String toString() =>
+      'GsxPipelineReport(pages=$pages, parts=$parts/$handoff, out=$bytesOut, '
+      'total=${total.inMilliseconds}ms, ' +
+      stages.entries.map((e) => '${e.key}=${e.value.inMilliseconds}ms').join(' ') +
+      ')';
+}
+
+/// ---------------- Teste de resistência ----------------
+
+/// Resultado de [GsxBridge.soak]. [growing] lista os recursos cujo piso (mínimo de
+/// cada quarto das amostras) só subiu e passou da tolerância: rss_kb, fds, threads,
+/// tmp_files ou tmp_bytes.
+class GsxSoakReport {
+  final int seconds;
+  final int workers;
+  final int seed;
+  final Map<String, int> jobs;
+  final int unexpected;
+  final List<String> unexpectedMessages;
+  final List<String> growing;
+
+  /// false se houve poucas amostras para analisar (nada medido).
+  final bool conclusive;
+
+  /// Amostras cruas: {t_ms, rss_kb, fds, threads, tmp_files, tmp_bytes, jobs}.
+  final List<Map<String, dynamic>> samples;
+
+  GsxSoakReport._(Map<String, dynamic> j)
+      : seconds = j['seconds'] as int,
+        workers = j['workers'] as int,
+        seed = j['seed'] as int,
+        jobs = (j['jobs'] as Map<String, dynamic>).map((k, v) => MapEntry(k, v as int)),
+        unexpected = j['unexpected'] as int,
+        unexpectedMessages = (j['unexpected_msgs'] as List).cast<String>(),
+        growing = (j['growing'] as List).cast<String>(),
+        conclusive = j['conclusive'] as bool,
+        samples = (j['samples'] as List).cast<Map<String, dynamic>>();
+
+  bool get passed => growing.isEmpty && unexpected == 0 && conclusive;
+
+  @override
+  String toString() =>
+      'GsxSoakReport(${passed ? 'ok' : 'FALHOU'}, ${seconds}s, $workers laços, seed=$seed, '
+      'jobs=$jobs, inesperados=$unexpected, crescendo=$growing)';
+}
+
+/// ---------------- Captura e replay de carga ----------------
+
+/// Percentis (ms) de um conjunto de jobs.
+class GsxLatency {
+  final double p50, p90, p99, max, mean;
+
+  GsxLatency._(Map<String, dynamic> j)
+      : p50 = (j['p50'] as num).toDouble(),
+        p90 = (j['p90'] as num).toDouble(),
+        p99 = (j['p99'] as num).toDouble(),
+        max = (j['max'] as num).toDouble(),
+        mean = (j['mean'] as num).toDouble();
+
+  @override
+  String toString() => 'p50=${p50.toStringAsFixed(0)} p90=${p90.toStringAsFixed(0)} '
+      'p99=${p99.toStringAsFixed(0)} máx=${max.toStringAsFixed(0)} ms';
+}
+
+/// Resultado de [GsxBridge.replay]. [latency] conta da chegada prevista (inclui a
+/// espera por um worker), [service] só a execução e [captured] é a duração gravada
+/// dos mesmos jobs — compare [latency].p99 e [jobsPerSecond] entre builds.
+class GsxReplayReport {
+  final int records;
+  final int replayed;
+  final int missing;
+  final int failed;
+
+  /// Jobs que passaram a falhar ou deixaram de falhar em relação à captura.
+  final int outcomeMismatch;
+  final double speed;
+  final int concurrency;
+  final int wallMs;
+  final double jobsPerSecond;
+  final GsxLatency latency;
+  final GsxLatency service;
+  final GsxLatency captured;
+
+  GsxReplayReport._(Map<String, dynamic> j)
+      : records = j['records'] as int,
+        replayed = j['replayed'] as int,
+        missing = j['missing'] as int,
+        failed = j['failed'] as int,
+        outcomeMismatch = j['outcome_mismatch'] as int,
+        speed = (j['speed'] as num).toDouble(),
+        concurrency = j['concurrency'] as int,
+        wallMs = (j['wall_ms'] as num).toInt(),
+        jobsPerSecond = (j['jobs_per_s'] as num).toDouble(),
+        latency = GsxLatency._(j['latency_ms'] as Map<String, dynamic>),
+        service = GsxLatency._(j['service_ms'] as Map<String, dynamic>),
+        captured = GsxLatency._(j['captured_ms'] as Map<String, dynamic>);
+
+  @override
+  String toString() =>
+      'GsxReplayReport($replayed/$records jobs, ${speed == 0 ? 'sem espera' : '${speed}x'}, '
+      '${jobsPerSecond.toStringAsFixed(2)} jobs/s, latência $latency, gravado $captured, '
+      'falhas=$failed, sem entrada=$missing, desfechos diferentes=$outcomeMismatch)';
+}
+
+/// ---------------- Renderização para a memória ----------------
+
+/// Página renderizada por gsx_render_pages (linhas com [stride] bytes, sem padding).
+class GsxRaster {
+  final int page;
+  final int width;
+  final int height;
+  final int stride;
+
+  /// GsxRenderColor.*
+  final int color;
+  final int bitsPerPixel;
+  final Uint8List data;
+
+  GsxRaster._(GsxRasterNative n)
+      : page = n.page,
+        width = n.width,
+        height = n.height,
+        stride = n.stride,
+        color = n.color,
+        bitsPerPixel = n.bits_per_pixel,
+        data = Uint8List.fromList(n.data.asTypedList(n.stride * n.height));
+
+  @override
+  String toString() => 'GsxRaster(page=$page, ${width}x$height, ${bitsPerPixel}bpp)';
+}
+
+/// ---------------- Recompressão de imagens ----------------
+
+/// Resultado de gsx_recompress_images.
+class GsxRecompressStats {
+  final int images;
+  final int recompressed;
+  final int downsampled;
+
+  /// Bytes dos streams de imagem substituídos, antes e depois.
+  final int imageBytesIn;
+  final int imageBytesOut;
+  final int bytesIn;
+  final int bytesOut;
+
+  GsxRecompressStats._(GsxRecompressStatsNative n)
+      : images = n.images,
+        recompressed = n.recompressed,
+        downsampled = n.downsampled,
+        imageBytesIn = n.image_bytes_in,
+        imageBytesOut = n.image_bytes_out,
+        bytesIn = n.bytes_in,
+        bytesOut = n.bytes_out;
+
+  @override
+  String toString() =>
+      'GsxRecompressStats(images=$recompressed/$images, downsampled=$downsampled, '
+      'image bytes=$imageBytesIn->$imageBytesOut, file=$bytesIn->$bytesOut)';
+}
+
 /// ---------------- Shared callback registry ----------------
 /// Usa NativeCallable.listener para permitir chamadas de qualquer thread.
 /// Mantemos callables singletons, criados sob demanda.
@@ -184,6 +700,81 @@ class GsxJob {
   }
 }
 
+/// ---------------- Miniaturas ----------------
+
+/// Serviço de miniaturas PNG (gsx_thumbs_*): workers nativos renderizam lotes de
+/// páginas e gravam em [cacheDir], indexado pelo hash do conteúdo do PDF, então
+/// reabrir o mesmo arquivo (mesmo com outro nome) não renderiza de novo.
+/// [level] 0..3 = 24, 48, 96 e 192 dpi.
+class GsxThumbnails {
+  final GsxBridge _gsx;
+  Pointer<Void> _svc;
+
+  GsxThumbnails._(this._gsx, this._svc);
+
+  /// Caminho do PNG da página; renderiza como visível (com prefetch das vizinhas)
+  /// se ainda não estiver no cache. A espera roda num isolate auxiliar.
+  Future<String> get(String inputPath, int page, {int level = 1}) async {
+    if (_svc == nullptr) throw GsxException(-2001, 'gsx_thumbs_get');
+    final inP = inputPath.toNativeUtf8();
+    final out = calloc<Pointer<Utf8>>();
+    try {
+      final fnAddr = _gsx._b.api.gsx_thumbs_get_ptr.address;
+      final a = [_svc.address, inP.address, out.address];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxThumbsGetNative>>.fromAddress(fnAddr)
+            .asFunction<GsxThumbsGetDart>();
+        return fn(Pointer.fromAddress(a[0]), Pointer.fromAddress(a[1]), page, level,
+            Pointer.fromAddress(a[2]));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_thumbs_get');
+      final path = out.value.toDartString();
+      _gsx._b.api.gsx_free(out.value.cast());
+      return path;
+    } finally {
+      calloc.free(inP);
+      calloc.free(out);
+    }
+  }
+
+  /// Enfileira [firstPage]..[lastPage] sem esperar: [visible] = páginas na tela
+  /// (antes de tudo, com prefetch das vizinhas); senão, segundo plano.
+  /// Retorna quantas ainda não estavam prontas.
+  int request(String inputPath, int firstPage, int lastPage,
+      {int level = 1, bool visible = false}) {
+    if (_svc == nullptr) throw GsxException(-2001, 'gsx_thumbs_request');
+    final inP = inputPath.toNativeUtf8();
+    try {
+      final rc = _gsx._b.api
+          .gsx_thumbs_request(_svc, inP, firstPage, lastPage, level, visible ? 1 : 0);
+      if (rc < 0) throw GsxException(rc, 'gsx_thumbs_request');
+      return rc;
+    } finally {
+      calloc.free(inP);
+    }
+  }
+
+  Map<String, dynamic> stats() {
+    final out = calloc<Pointer<Utf8>>();
+    try {
+      final rc = _gsx._b.api.gsx_thumbs_stats(_svc, out);
+      if (rc < 0) throw GsxException(rc, 'gsx_thumbs_stats');
+      final map = jsonDecode(out.value.toDartString()) as Map<String, dynamic>;
+      _gsx._b.api.gsx_free(out.value.cast());
+      return map;
+    } finally {
+      calloc.free(out);
+    }
+  }
+
+  /// Cancela a fila e espera os workers (chamadas [get] pendentes falham).
+  void close() {
+    if (_svc == nullptr) return;
+    _gsx._b.api.gsx_thumbs_close(_svc);
+    _svc = nullptr;
+  }
+}
+
 /// ---------------- High-level API ----------------
 
 class GsxBridge {
@@ -384,6 +975,72 @@ class GsxBridge {
     }
   }
 
+  /// Compressão entre descritores já abertos (gsx_compress_fd_sync): no Linux um
+  /// memfd/arquivo regular é entregue ao Ghostscript sem cópia; pipes e sockets
+  /// passam por um temporário. A saída fica com o offset em 0; retorna o tamanho
+  /// gravado. Os descritores continuam do chamador. Roda num isolate auxiliar.
+  Future<int> compressFd({
+    required int inputFd,
+    required int outputFd,
+    int dpi = 150,
+    int jpegQuality = 65,
+    String? preset,
+    int colorMode = GsxColorMode.color,
+    int firstPage = 0,
+    int lastPage = 0,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final preP = (preset ?? '').toNativeUtf8();
+    final outLen = calloc<Uint64>();
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+    try {
+      final fnAddr = _b.api.gsx_compress_fd_sync_ptr.address;
+      final a = [
+        preP.address,
+        outLen.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxCompressFdNative>>.fromAddress(fnAddr)
+            .asFunction<GsxCompressFdDart>();
+        return fn(inputFd, outputFd, dpi, jpegQuality, Pointer.fromAddress(a[0]), colorMode,
+            firstPage, lastPage, Pointer.fromAddress(a[1]), Pointer.fromAddress(a[2]),
+            Pointer.fromAddress(a[3]), Pointer.fromAddress(a[4]));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_compress_fd_sync');
+      return outLen.value;
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(preP);
+      calloc.free(outLen);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Arquivo anônimo em memória (memfd no Linux; senão temporário já apagado).
+  /// No Linux é acessível por caminho como `/proc/self/fd/<fd>` ([fdPath]).
+  /// Feche com [closeFd].
+  int memfdCreate([String? name]) {
+    final nameP = (name ?? '').toNativeUtf8();
+    try {
+      final fd = _b.api.gsx_memfd_create(nameP);
+      if (fd < 0) throw GsxException(fd, 'gsx_memfd_create');
+      return fd;
+    } finally {
+      calloc.free(nameP);
+    }
+  }
+
+  void closeFd(int fd) => _b.api.gsx_fd_close(fd);
+
+  /// Caminho de um descritor do próprio processo (Linux).
+  static String fdPath(int fd) => '/proc/self/fd/$fd';
+
   /// comprimime um PDF em um thread nativo
   GsxJob compressFileNativeAsync({
     required String inputPath,
@@ -437,6 +1094,1208 @@ class GsxBridge {
     }
   }
 
+  /// Inspeciona a estrutura do PDF (header, xref, raiz da árvore de páginas) sem
+  /// abrir Ghostscript/MuPDF. Estrutura ilegível não lança: volta com
+  /// pageCount = -1 (e version = 0 se nem o header %PDF- existe).
+  GsxProbe probe(String inputPath) {
+    final inP = inputPath.toNativeUtf8();
+    final out = calloc<GsxProbeNative>();
+    try {
+      final rc = _b.api.gsx_probe(inP, out);
+      // -2008 = GSX_E_PDF_PARSE: o struct ainda traz header/tamanho
+      if (rc < 0 && rc != -2008) throw GsxException(rc, 'gsx_probe');
+      return GsxProbe._(out.ref);
+    } finally {
+      calloc.free(inP);
+      calloc.free(out);
+    }
+  }
+
+  /// Com a xref de [inputPath] danificada, grava em [outputPath] uma cópia com a
+  /// tabela reconstruída pela varredura nativa (gsx_normalize_pdf), para que o
+  /// Ghostscript não repita o reparo em cada lote. Entrada sã: nada é gravado
+  /// ([GsxNormalizeStats.written] = false), a menos que [force].
+  GsxNormalizeStats normalizePdf({
+    required String inputPath,
+    required String outputPath,
+    bool force = false,
+  }) {
+    final inP = inputPath.toNativeUtf8();
+    final outP = outputPath.toNativeUtf8();
+    final st = calloc<GsxNormalizeStatsNative>();
+    try {
+      final rc = _b.api.gsx_normalize_pdf(
+          inP, outP, force ? GsxNormalizeFlags.force : 0, st);
+      if (rc < 0) throw GsxException(rc, 'gsx_normalize_pdf');
+      return GsxNormalizeStats._(rc == 1, st.ref);
+    } finally {
+      calloc.free(inP);
+      calloc.free(outP);
+      calloc.free(st);
+    }
+  }
+
+  /// Atribuição de bytes do PDF (gsx_analyze): mapa decodificado do JSON com
+  /// 'categories', 'per_page', 'document_level', 'images' (dpi efetivo por imagem),
+  /// 'max_image_dpi' e 'inline_images'. Lança [GsxException] se o PDF não é legível
+  /// ou está criptografado.
+  Map<String, dynamic> analyze(String inputPath) {
+    final inP = inputPath.toNativeUtf8();
+    final jsonOut = calloc<Pointer<Utf8>>();
+    try {
+      final rc = _b.api.gsx_analyze(inP, jsonOut);
+      if (rc < 0) throw GsxException(rc, 'gsx_analyze');
+      final js = jsonOut.value;
+      final map = jsonDecode(js.toDartString()) as Map<String, dynamic>;
+      _b.api.gsx_free(js.cast());
+      return map;
+    } finally {
+      calloc.free(inP);
+      calloc.free(jsonOut);
+    }
+  }
+
+  /// Divide [firstPage, lastPage] em até [maxChunks] intervalos contíguos
+  /// equilibrando o custo estimado de cada página (lido da xref, sem Ghostscript).
+  /// firstPage/lastPage = 0 → documento inteiro.
+  List<GsxChunk> planChunks({
+    required String inputPath,
+    int firstPage = 0,
+    int lastPage = 0,
+    required int maxChunks,
+  }) {
+    if (maxChunks <= 0) return const [];
+    final inP = inputPath.toNativeUtf8();
+    final out = calloc<GsxChunkNative>(maxChunks);
+    try {
+      final n = _b.api.gsx_plan_chunks(inP, firstPage, lastPage, maxChunks, out);
+      if (n < 0) throw GsxException(n, 'gsx_plan_chunks');
+      return [
+        for (var i = 0; i < n; i++)
+          GsxChunk(out[i].first_page, out[i].last_page, out[i].weight),
+      ];
+    } finally {
+      calloc.free(inP);
+      calloc.free(out);
+    }
+  }
+
+  /// Pré-passada em baixa resolução ([dpi], 0 = 24): classifica cada página como
+  /// em branco, P&B, cinza ou colorida (gsx_classify_pages). As faixas de páginas
+  /// rodam em paralelo em [workers] instâncias do Ghostscript, num isolate auxiliar.
+  /// firstPage/lastPage = 0 → documento inteiro.
+  Future<List<GsxPageClass>> classifyPages({
+    required String inputPath,
+    int firstPage = 0,
+    int lastPage = 0,
+    int dpi = 0,
+    int workers = 0,
+    GsxCancelToken? cancel,
+  }) async {
+    var last = lastPage;
+    if (last <= 0) {
+      last = probe(inputPath).pageCount;
+      if (last <= 0) throw GsxException(-2008, 'gsx_classify_pages');
+    }
+    final first = firstPage > 0 ? firstPage : 1;
+    if (first > last) return const [];
+
+    final cap = last - first + 1;
+    final inP = inputPath.toNativeUtf8();
+    final out = calloc<GsxPageClassNative>(cap);
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    try {
+      final fnAddr = _b.api.gsx_classify_pages_ptr.address;
+      final a = [inP.address, first, last, dpi, workers, out.address, token.ptr.address];
+      final n = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxClassifyPagesNative>>.fromAddress(fnAddr)
+            .asFunction<GsxClassifyPagesDart>();
+        return fn(Pointer.fromAddress(a[0]), a[1], a[2], a[3], a[4],
+            Pointer.fromAddress(a[5]), Pointer.fromAddress(a[6]));
+      });
+      if (n < 0) throw GsxException(n, 'gsx_classify_pages');
+      return [for (var i = 0; i < n; i++) GsxPageClass._(out[i])];
+    } finally {
+      calloc.free(inP);
+      calloc.free(out);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Renderiza as páginas na memória com o device display (gsx_render_pages), sem
+  /// arquivos temporários. [bandHeight] > 0 renderiza em faixas (menos memória por
+  /// worker); o coletor nativo remonta as páginas. [workers] instâncias dividem as
+  /// páginas pelo peso; [renderThreads] usa -dNumRenderingThreads em cada uma.
+  /// Roda num isolate auxiliar; a lista vem em ordem de página.
+  Future<List<GsxRaster>> renderPages({
+    required String inputPath,
+    int firstPage = 0,
+    int lastPage = 0,
+    int dpi = 72,
+    int color = GsxRenderColor.rgb,
+    int bandHeight = 0,
+    int renderThreads = 0,
+    int workers = 1,
+    int alphaBits = 0,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final inP = inputPath.toNativeUtf8();
+    final opts = calloc<GsxRenderOptsNative>();
+    opts.ref
+      ..dpi = dpi
+      ..color = color
+      ..band_height = bandHeight
+      ..render_threads = renderThreads
+      ..workers = workers
+      ..alpha_bits = alphaBits;
+    final list = _b.api.gsx_raster_list_new();
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+    try {
+      if (list == nullptr) throw GsxException(-2099, 'gsx_raster_list_new');
+      final fnAddr = _b.api.gsx_render_pages_ptr.address;
+      final a = [
+        inP.address,
+        opts.address,
+        _b.api.gsx_raster_list_collect_ptr.address,
+        list.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxRenderPagesNative>>.fromAddress(fnAddr)
+            .asFunction<GsxRenderPagesDart>();
+        return fn(Pointer.fromAddress(a[0]), firstPage, lastPage,
+            Pointer.fromAddress(a[1]), Pointer.fromAddress(a[2]),
+            Pointer.fromAddress(a[3]), Pointer.fromAddress(a[4]),
+            Pointer.fromAddress(a[5]), Pointer.fromAddress(a[6]));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_render_pages');
+      final n = _b.api.gsx_raster_list_count(list);
+      return [for (var i = 0; i < n; i++) GsxRaster._(_b.api.gsx_raster_list_get(list, i).ref)];
+    } finally {
+      _CallbackRegistry.unregister(id);
+      if (list != nullptr) _b.api.gsx_raster_list_free(list);
+      calloc.free(inP);
+      calloc.free(opts);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Libera os bitmaps reaproveitados entre chamadas de [renderPages].
+  void renderPoolTrim() => _b.api.gsx_render_pool_trim();
+
+  /// Pós-passo estrutural (gsx_optimize_pdf): recomprime os streams Flate em paralelo,
+  /// empacota os objetos em object streams com xref stream e descarta o inalcançável.
+  /// [level] 0 = esforço máximo; [classicXref] mantém a xref clássica. Roda num isolate
+  /// auxiliar.
+  Future<GsxOptimizeStats> optimizePdf({
+    required String inputPath,
+    required String outputPath,
+    int level = 0,
+    int workers = 0,
+    bool classicXref = false,
+    bool skipUnfiltered = false,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final inP = inputPath.toNativeUtf8();
+    final outP = outputPath.toNativeUtf8();
+    final opts = calloc<GsxOptimizeOptsNative>();
+    opts.ref
+      ..level = level
+      ..workers = workers
+      ..classic_xref = classicXref ? 1 : 0
+      ..skip_unfiltered = skipUnfiltered ? 1 : 0;
+    final st = calloc<GsxOptimizeStatsNative>();
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+    try {
+      final fnAddr = _b.api.gsx_optimize_pdf_ptr.address;
+      final a = [
+        inP.address,
+        outP.address,
+        opts.address,
+        st.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxOptimizePdfNative>>.fromAddress(fnAddr)
+            .asFunction<GsxOptimizePdfDart>();
+        return fn(Pointer.fromAddress(a[0]), Pointer.fromAddress(a[1]),
+            Pointer.fromAddress(a[2]), Pointer.fromAddress(a[3]),
+            Pointer.fromAddress(a[4]), Pointer.fromAddress(a[5]),
+            Pointer.fromAddress(a[6]));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_optimize_pdf');
+      return GsxOptimizeStats._(st.ref);
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(inP);
+      calloc.free(outP);
+      calloc.free(opts);
+      calloc.free(st);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Abre o serviço de miniaturas com cache em [cacheDir] (criada se preciso).
+  /// [workers] 0 = nº de CPUs; [prefetch] 0 = 4 vizinhas de cada lado, <0 = nenhuma.
+  GsxThumbnails openThumbnails(String cacheDir,
+      {int workers = 0, int prefetch = 0, int batchPages = 0, bool gray = false}) {
+    final dirP = cacheDir.toNativeUtf8();
+    final opts = calloc<GsxThumbsOptsNative>();
+    opts.ref
+      ..workers = workers
+      ..prefetch = prefetch
+      ..batch_pages = batchPages
+      ..gray = gray ? 1 : 0;
+    try {
+      final svc = _b.api.gsx_thumbs_open(dirP, opts);
+      if (svc == nullptr) throw GsxException(-2003, 'gsx_thumbs_open');
+      return GsxThumbnails._(this, svc);
+    } finally {
+      calloc.free(dirP);
+      calloc.free(opts);
+    }
+  }
+
+  /// P&B nativo (gsx_bilevel_pdf): renderiza em cinza a [dpi], binariza com limiar
+  /// adaptativo ([method] = GsxBinMethod.*) e grava cada página como imagem 1-bpp
+  /// ([codec] = GsxBinCodec.g4 ou .jbig2, este ~2× menor em texto). O texto vira
+  /// imagem. Roda num isolate auxiliar; retorna as páginas gravadas.
+  Future<int> bilevelPdf({
+    required String inputPath,
+    required String outputPath,
+    int firstPage = 0,
+    int lastPage = 0,
+    int dpi = 300,
+    int method = GsxBinMethod.sauvola,
+    int window = 0,
+    double k = 0,
+    int despeckle = 0,
+    int workers = 0,
+    int codec = GsxBinCodec.g4,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final inP = inputPath.toNativeUtf8();
+    final outP = outputPath.toNativeUtf8();
+    final opts = calloc<GsxBilevelOptsNative>();
+    opts.ref
+      ..dpi = dpi
+      ..method = method
+      ..window = window
+      ..k = k
+      ..despeckle = despeckle
+      ..workers = workers
+      ..codec = codec;
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+    try {
+      final fnAddr = _b.api.gsx_bilevel_pdf_ptr.address;
+      final a = [
+        inP.address,
+        outP.address,
+        firstPage,
+        lastPage,
+        opts.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxBilevelPdfNative>>.fromAddress(fnAddr)
+            .asFunction<GsxBilevelPdfDart>();
+        return fn(Pointer.fromAddress(a[0]), Pointer.fromAddress(a[1]), a[2], a[3],
+            Pointer.fromAddress(a[4]), Pointer.fromAddress(a[5]),
+            Pointer.fromAddress(a[6]), Pointer.fromAddress(a[7]));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_bilevel_pdf');
+      return rc;
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(inP);
+      calloc.free(outP);
+      calloc.free(opts);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// MRC (gsx_mrc_pdf): renderiza em RGB a [dpi] e grava cada página em camadas —
+  /// máscara de texto 1-bpp ([codec]), cor do texto em grade grossa e fundo JPEG a
+  /// [bgDpi] com [jpegQuality]. Para digitalizações coloridas. Roda num isolate
+  /// auxiliar; retorna as páginas gravadas.
+  Future<int> mrcPdf({
+    required String inputPath,
+    required String outputPath,
+    int firstPage = 0,
+    int lastPage = 0,
+    int dpi = 300,
+    int bgDpi = 0,
+    int jpegQuality = 0,
+    int codec = GsxBinCodec.jbig2,
+    int workers = 0,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final inP = inputPath.toNativeUtf8();
+    final outP = outputPath.toNativeUtf8();
+    final opts = calloc<GsxMrcOptsNative>();
+    opts.ref
+      ..dpi = dpi
+      ..bg_dpi = bgDpi
+      ..jpeg_quality = jpegQuality
+      ..codec = codec
+      ..workers = workers;
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+    try {
+      final fnAddr = _b.api.gsx_mrc_pdf_ptr.address;
+      final a = [
+        inP.address,
+        outP.address,
+        firstPage,
+        lastPage,
+        opts.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxMrcPdfNative>>.fromAddress(fnAddr)
+            .asFunction<GsxMrcPdfDart>();
+        return fn(Pointer.fromAddress(a[0]), Pointer.fromAddress(a[1]), a[2], a[3],
+            Pointer.fromAddress(a[4]), Pointer.fromAddress(a[5]),
+            Pointer.fromAddress(a[6]), Pointer.fromAddress(a[7]));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_mrc_pdf');
+      return rc;
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(inP);
+      calloc.free(outP);
+      calloc.free(opts);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Recompressão só das imagens (gsx_recompress_images), sem pdfwrite: imagens
+  /// acima de 1.5× [dpi] são reduzidas e recodificadas em JPEG com [jpegQuality]
+  /// (ou cinza com [gray]); o resto do arquivo é copiado byte a byte. Roda num
+  /// isolate auxiliar; o progresso vem por imagem.
+  Future<GsxRecompressStats> recompressImages({
+    required String inputPath,
+    required String outputPath,
+    int dpi = 150,
+    int jpegQuality = 0,
+    bool gray = false,
+    int workers = 0,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final inP = inputPath.toNativeUtf8();
+    final outP = outputPath.toNativeUtf8();
+    final opts = calloc<GsxRecompressOptsNative>();
+    opts.ref
+      ..dpi = dpi
+      ..jpeg_quality = jpegQuality
+      ..gray = gray ? 1 : 0
+      ..workers = workers;
+    final st = calloc<GsxRecompressStatsNative>();
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+    try {
+      final fnAddr = _b.api.gsx_recompress_images_ptr.address;
+      final a = [
+        inP.address,
+        outP.address,
+        opts.address,
+        st.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxRecompressImagesNative>>.fromAddress(fnAddr)
+            .asFunction<GsxRecompressImagesDart>();
+        return fn(Pointer.fromAddress(a[0]), Pointer.fromAddress(a[1]),
+            Pointer.fromAddress(a[2]), Pointer.fromAddress(a[3]),
+            Pointer.fromAddress(a[4]), Pointer.fromAddress(a[5]),
+            Pointer.fromAddress(a[6]));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_recompress_images');
+      return GsxRecompressStats._(st.ref);
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(inP);
+      calloc.free(outP);
+      calloc.free(opts);
+      calloc.free(st);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Benchmark G4 × JBIG2 (gsx_bilevel_bench): mesmo pipeline do [bilevelPdf], sem
+  /// gravar; cada página é codificada nos dois formatos. Devolve o JSON decodificado
+  /// com 'g4' e 'jbig2' ({bytes, encode_ms, mpx_per_s}), 'jbig2_vs_g4' e 'per_page'.
+  Future<Map<String, dynamic>> bilevelBench({
+    required String inputPath,
+    int firstPage = 0,
+    int lastPage = 0,
+    int dpi = 300,
+    int method = GsxBinMethod.sauvola,
+    int workers = 0,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final inP = inputPath.toNativeUtf8();
+    final opts = calloc<GsxBilevelOptsNative>();
+    opts.ref
+      ..dpi = dpi
+      ..method = method
+      ..workers = workers;
+    final jsonOut = calloc<Pointer<Utf8>>();
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+    try {
+      final fnAddr = _b.api.gsx_bilevel_bench_ptr.address;
+      final a = [
+        inP.address,
+        firstPage,
+        lastPage,
+        opts.address,
+        jsonOut.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxBilevelBenchNative>>.fromAddress(fnAddr)
+            .asFunction<GsxBilevelBenchDart>();
+        return fn(Pointer.fromAddress(a[0]), a[1], a[2], Pointer.fromAddress(a[3]),
+            Pointer.fromAddress(a[4]), Pointer.fromAddress(a[5]),
+            Pointer.fromAddress(a[6]), Pointer.fromAddress(a[7]));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_bilevel_bench');
+      final js = jsonOut.value;
+      final map = jsonDecode(js.toDartString()) as Map<String, dynamic>;
+      _b.api.gsx_free(js.cast());
+      return map;
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(inP);
+      calloc.free(opts);
+      calloc.free(jsonOut);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Nível SIMD dos kernels de raster em uso: 'scalar', 'sse4.2' ou 'avx2'
+  /// (GSX_SIMD no ambiente força um nível).
+  String get simdLevel => _b.api.gsx_simd_level().toDartString();
+
+  /// Confere bit a bit cada variante SIMD dos kernels contra a escalar
+  /// (gsx_kernels_selftest): mapa com 'active', 'levels', 'cases', 'failures' e
+  /// 'mismatches'. 'failures' == 0 → todas idênticas.
+  Map<String, dynamic> kernelsSelftest() {
+    final jsonOut = calloc<Pointer<Utf8>>();
+    try {
+      final rc = _b.api.gsx_kernels_selftest(jsonOut);
+      if (rc < 0) throw GsxException(rc, 'gsx_kernels_selftest');
+      final js = jsonOut.value;
+      final map = jsonDecode(js.toDartString()) as Map<String, dynamic>;
+      _b.api.gsx_free(js.cast());
+      return map;
+    } finally {
+      calloc.free(jsonOut);
+    }
+  }
+
+  /// Microbenchmark dos kernels em cada nível disponível sobre ~[megapixels] Mpx
+  /// (gsx_kernels_bench): 'kernels' = [{kernel, mpx_per_s: {nível: valor}}].
+  /// Roda num isolate auxiliar.
+  Future<Map<String, dynamic>> kernelsBench({int megapixels = 16}) async {
+    final jsonOut = calloc<Pointer<Utf8>>();
+    try {
+      final fnAddr = _b.api.gsx_kernels_bench_ptr.address;
+      final outAddr = jsonOut.address;
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<Int32 Function(Int32, Pointer<Pointer<Utf8>>)>>.fromAddress(fnAddr)
+            .asFunction<int Function(int, Pointer<Pointer<Utf8>>)>();
+        return fn(megapixels, Pointer.fromAddress(outAddr));
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_kernels_bench');
+      final js = jsonOut.value;
+      final map = jsonDecode(js.toDartString()) as Map<String, dynamic>;
+      _b.api.gsx_free(js.cast());
+      return map;
+    } finally {
+      calloc.free(jsonOut);
+    }
+  }
+
+  /// Teste de resistência (gsx_soak_run): [workers] laços rodam por [seconds] uma
+  /// mistura de compressões síncronas, assíncronas, canceladas, com falha, pipeline e
+  /// montagem de argumentos sobre [corpus], enquanto o processo é amostrado a cada
+  /// [sampleMs] (RSS, descritores, threads e temporários). Roda num isolate auxiliar;
+  /// [onProgress] recebe uma linha por amostra.
+  Future<GsxSoakReport> soak({
+    required List<String> corpus,
+    int seconds = 300,
+    int workers = 4,
+    int sampleMs = 2000,
+    int warmupPct = 20,
+    int dpi = 150,
+    int jpegQuality = 65,
+    String? preset,
+    int colorMode = GsxColorMode.color,
+    int maxPages = 4,
+    int seed = 0,
+    String? workDir,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final arr = calloc<Pointer<Utf8>>(corpus.length);
+    final preP = (preset ?? '').toNativeUtf8();
+    final dirP = workDir == null ? nullptr : workDir.toNativeUtf8();
+    final opts = calloc<GsxSoakOptsNative>();
+    final jsonOut = calloc<Pointer<Utf8>>();
+    for (var i = 0; i < corpus.length; i++) {
+      arr[i] = corpus[i].toNativeUtf8();
+    }
+    opts.ref
+      ..seconds = seconds
+      ..workers = workers
+      ..sample_ms = sampleMs
+      ..warmup_pct = warmupPct
+      ..dpi = dpi
+      ..jpeg_quality = jpegQuality
+      ..preset = preP
+      ..mode = colorMode
+      ..max_pages = maxPages
+      ..seed = seed
+      ..work_dir = dirP;
+
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+
+    try {
+      final a = [
+        _b.api.gsx_soak_run_ptr.address,
+        arr.address,
+        corpus.length,
+        opts.address,
+        jsonOut.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxSoakRunNative>>.fromAddress(a[0]).asFunction<GsxSoakRunDart>();
+        return fn(
+          Pointer.fromAddress(a[1]),
+          a[2],
+          Pointer.fromAddress(a[3]),
+          Pointer.fromAddress(a[4]),
+          Pointer.fromAddress(a[5]),
+          Pointer.fromAddress(a[6]),
+          Pointer.fromAddress(a[7]),
+        );
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_soak_run');
+      final js = jsonOut.value;
+      final report = GsxSoakReport._(jsonDecode(js.toDartString()) as Map<String, dynamic>);
+      _b.api.gsx_free(js.cast());
+      return report;
+    } finally {
+      _CallbackRegistry.unregister(id);
+      for (var i = 0; i < corpus.length; i++) {
+        calloc.free(arr[i]);
+      }
+      calloc.free(arr);
+      calloc.free(preP);
+      if (dirP != nullptr) calloc.free(dirP);
+      calloc.free(opts);
+      calloc.free(jsonOut);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Grava em [path] (JSON por linha) cada compressão de topo deste processo:
+  /// parâmetros, tamanho e hash da entrada, chegada, resultado e duração — a carga
+  /// real para [replay] contra outra build. Global ao processo; substitui uma captura
+  /// anterior. Hashear a entrada custa uma leitura extra do arquivo por job.
+  void captureStart(String path) {
+    final pathP = path.toNativeUtf8();
+    try {
+      final rc = _b.api.gsx_capture_start(pathP);
+      if (rc < 0) throw GsxException(rc, 'gsx_capture_start');
+    } finally {
+      calloc.free(pathP);
+    }
+  }
+
+  void captureStop() => _b.api.gsx_capture_stop();
+
+  bool get captureActive => _b.api.gsx_capture_active() != 0;
+
+  /// Reemite a carga gravada por [captureStart] (gsx_replay_run): chegadas divididas
+  /// por [speed] (1 = ritmo original, 0 = sem esperar) em [concurrency] workers.
+  /// Entradas que mudaram de lugar são achadas em [inputsDir] pelo conteúdo. Roda num
+  /// isolate auxiliar; [onProgress] recebe uma linha por job.
+  Future<GsxReplayReport> replay(
+    String capturePath, {
+    double speed = 1,
+    int concurrency = 8,
+    int limit = 0,
+    String? inputsDir,
+    String? workDir,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final pathP = capturePath.toNativeUtf8();
+    final inP = inputsDir == null ? nullptr : inputsDir.toNativeUtf8();
+    final dirP = workDir == null ? nullptr : workDir.toNativeUtf8();
+    final opts = calloc<GsxReplayOptsNative>();
+    final jsonOut = calloc<Pointer<Utf8>>();
+    opts.ref
+      ..speed = speed
+      ..concurrency = concurrency
+      ..limit = limit
+      ..inputs_dir = inP
+      ..work_dir = dirP;
+
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+
+    try {
+      final a = [
+        _b.api.gsx_replay_run_ptr.address,
+        pathP.address,
+        opts.address,
+        jsonOut.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ];
+      final rc = await Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxReplayRunNative>>.fromAddress(a[0]).asFunction<GsxReplayRunDart>();
+        return fn(
+          Pointer.fromAddress(a[1]),
+          Pointer.fromAddress(a[2]),
+          Pointer.fromAddress(a[3]),
+          Pointer.fromAddress(a[4]),
+          Pointer.fromAddress(a[5]),
+          Pointer.fromAddress(a[6]),
+        );
+      });
+      if (rc < 0) throw GsxException(rc, 'gsx_replay_run');
+      final js = jsonOut.value;
+      final report = GsxReplayReport._(jsonDecode(js.toDartString()) as Map<String, dynamic>);
+      _b.api.gsx_free(js.cast());
+      return report;
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(pathP);
+      if (inP != nullptr) calloc.free(inP);
+      if (dirP != nullptr) calloc.free(dirP);
+      calloc.free(opts);
+      calloc.free(jsonOut);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Spans das etapas nativas (fila, instância do Ghostscript, inicialização,
+  /// páginas, flush, mesclagem, linearização) no formato Chrome trace — abre em
+  /// ui.perfetto.dev. Global ao processo; desligado por padrão. Com [dumpDir], cada
+  /// chamada nativa de topo grava o próprio gsx_trace_<job>.json ao terminar.
+  void traceEnable(bool on, {String? dumpDir}) {
+    final dirP = dumpDir == null ? nullptr : dumpDir.toNativeUtf8();
+    try {
+      _b.api.gsx_trace_set_dump_dir(dirP);
+      _b.api.gsx_trace_enable(on ? 1 : 0);
+    } finally {
+      if (dirP != nullptr) calloc.free(dirP);
+    }
+  }
+
+  bool get traceEnabled => _b.api.gsx_trace_enabled() != 0;
+
+  /// Relógio dos spans (µs): marque o início de uma requisição e passe a
+  /// [traceDump] como sinceUs para recortar só a janela dela.
+  int get traceNowUs => _b.api.gsx_trace_now_us();
+
+  /// Grava em [path] os spans do [job] (0 = todos) que terminaram a partir de
+  /// [sinceUs]. Retorna quantos eventos foram gravados.
+  int traceDump(String path, {int job = 0, int sinceUs = 0}) {
+    final pathP = path.toNativeUtf8();
+    try {
+      final rc = _b.api.gsx_trace_dump(pathP, job, sinceUs);
+      if (rc < 0) throw GsxException(rc, 'gsx_trace_dump');
+      return rc;
+    } finally {
+      calloc.free(pathP);
+    }
+  }
+
+  String traceJson({int job = 0, int sinceUs = 0}) {
+    final js = _b.api.gsx_trace_json(job, sinceUs);
+    if (js == nullptr) throw GsxException(-2099, 'gsx_trace_json');
+    try {
+      return js.toDartString();
+    } finally {
+      _b.api.gsx_free(js.cast());
+    }
+  }
+
+  void traceClear() => _b.api.gsx_trace_clear();
+
+  /// Contadores nativos no formato texto do Prometheus (gsx_metrics_snapshot):
+  /// chamadas por resultado e código de erro, histograma de latência, bytes,
+  /// páginas, instâncias do Ghostscript, cache de miniaturas e profundidade da fila.
+  String metricsSnapshot() {
+    final txt = _b.api.gsx_metrics_snapshot();
+    if (txt == nullptr) throw GsxException(-2099, 'gsx_metrics_snapshot');
+    try {
+      return txt.toDartString();
+    } finally {
+      _b.api.gsx_free(txt.cast());
+    }
+  }
+
+  /// Compressão paralela: lotes pequenos numa fila compartilhada entre [workers]
+  /// instâncias do Ghostscript; lotes retardatários são redivididos entre os
+  /// workers ociosos (gsx_compress_parallel_sync). Com um perfil ativo
+  /// ([setTuneProfile]) e [batchesPerWorker] = 0, o número de lotes e de workers
+  /// (até [workers]) sai do modelo de custo calibrado.
+  /// A chamada nativa roda num isolate auxiliar, então [onProgress] e [cancel]
+  /// funcionam enquanto o job anda. Retorna os caminhos das partes em ordem de
+  /// página; mesclar e apagar as partes fica com o chamador.
+  Future<List<String>> compressParallel({
+    required String inputPath,
+    int dpi = 150,
+    int jpegQuality = 65,
+    String? preset,
+    int colorMode = GsxColorMode.color,
+    int firstPage = 0,
+    int lastPage = 0,
+    int workers = 0,
+    int batchesPerWorker = 0,
+    int stragglerPct = 0,
+    int stragglerMinMs = 0,
+    String? workDir,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final inP = inputPath.toNativeUtf8();
+    final preP = (preset ?? '').toNativeUtf8();
+    final dirP = workDir == null ? nullptr : workDir.toNativeUtf8();
+    final opts = calloc<GsxParallelOptsNative>();
+    opts.ref
+      ..workers = workers
+      ..batches_per_worker = batchesPerWorker
+      ..straggler_pct = stragglerPct
+      ..straggler_min_ms = stragglerMinMs
+      ..work_dir = dirP;
+    final jsonOut = calloc<Pointer<Utf8>>();
+
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+
+    try {
+      final rc = await _runParallelInIsolate([
+        _b.api.gsx_compress_parallel_sync_ptr.address,
+        inP.address,
+        dpi,
+        jpegQuality,
+        preP.address,
+        colorMode,
+        firstPage,
+        lastPage,
+        opts.address,
+        jsonOut.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ]);
+      if (rc < 0) throw GsxException(rc, 'gsx_compress_parallel_sync');
+
+      final js = jsonOut.value;
+      final parts = (jsonDecode(js.toDartString()) as List).cast<String>();
+      _b.api.gsx_free(js.cast());
+      return parts;
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(inP);
+      calloc.free(preP);
+      if (dirP != nullptr) calloc.free(dirP);
+      calloc.free(opts);
+      calloc.free(jsonOut);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  /// Só endereços (int) atravessam o isolate; a memória nativa é a mesma.
+  static Future<int> _runParallelInIsolate(List<int> a) => Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxCompressParallelNative>>.fromAddress(a[0])
+            .asFunction<GsxCompressParallelDart>();
+        return fn(
+          Pointer.fromAddress(a[1]),
+          a[2],
+          a[3],
+          Pointer.fromAddress(a[4]),
+          a[5],
+          a[6],
+          a[7],
+          Pointer.fromAddress(a[8]),
+          Pointer.fromAddress(a[9]),
+          Pointer.fromAddress(a[10]),
+          Pointer.fromAddress(a[11]),
+          Pointer.fromAddress(a[12]),
+        );
+      });
+
+  /// Mede nesta máquina o custo de dividir em lotes (gsx_tune_calibrate): roda
+  /// [corpus] em lotes de 1..[maxPages] páginas com a compressão dada, mescla as
+  /// saídas e repete o maior lote em paralelo, até [maxSeconds]. O perfil devolvido
+  /// vale para esta máquina e estes parâmetros; ative-o com [setTuneProfile] e
+  /// guarde-o com [saveTuneProfile]. Roda num isolate auxiliar.
+  Future<GsxTuneProfile> calibrate({
+    required List<String> corpus,
+    int dpi = 150,
+    int jpegQuality = 65,
+    String? preset,
+    int colorMode = GsxColorMode.color,
+    int maxPages = 0,
+    int maxSeconds = 0,
+    String? workDir,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final arr = calloc<Pointer<Utf8>>(corpus.length);
+    final preP = (preset ?? '').toNativeUtf8();
+    final dirP = workDir == null ? nullptr : workDir.toNativeUtf8();
+    final opts = calloc<GsxTuneOptsNative>();
+    final out = calloc<GsxTuneProfileNative>();
+    for (var i = 0; i < corpus.length; i++) {
+      arr[i] = corpus[i].toNativeUtf8();
+    }
+    opts.ref
+      ..dpi = dpi
+      ..jpeg_quality = jpegQuality
+      ..preset = preP
+      ..mode = colorMode
+      ..max_pages = maxPages
+      ..max_seconds = maxSeconds
+      ..work_dir = dirP;
+
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+
+    try {
+      final rc = await _runCalibrateInIsolate([
+        _b.api.gsx_tune_calibrate_ptr.address,
+        arr.address,
+        corpus.length,
+        opts.address,
+        out.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ]);
+      if (rc < 0) throw GsxException(rc, 'gsx_tune_calibrate');
+      return GsxTuneProfile._(out.ref);
+    } finally {
+      _CallbackRegistry.unregister(id);
+      for (var i = 0; i < corpus.length; i++) {
+        calloc.free(arr[i]);
+      }
+      calloc.free(arr);
+      calloc.free(preP);
+      if (dirP != nullptr) calloc.free(dirP);
+      calloc.free(opts);
+      calloc.free(out);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  static Future<int> _runCalibrateInIsolate(List<int> a) => Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxTuneCalibrateNative>>.fromAddress(a[0])
+            .asFunction<GsxTuneCalibrateDart>();
+        return fn(
+          Pointer.fromAddress(a[1]),
+          a[2],
+          Pointer.fromAddress(a[3]),
+          Pointer.fromAddress(a[4]),
+          Pointer.fromAddress(a[5]),
+          Pointer.fromAddress(a[6]),
+          Pointer.fromAddress(a[7]),
+        );
+      });
+
+  void saveTuneProfile(String path, GsxTuneProfile profile) {
+    final pathP = path.toNativeUtf8();
+    final p = calloc<GsxTuneProfileNative>();
+    try {
+      profile._fill(p.ref);
+      final rc = _b.api.gsx_tune_save(pathP, p);
+      if (rc < 0) throw GsxException(rc, 'gsx_tune_save');
+    } finally {
+      calloc.free(pathP);
+      calloc.free(p);
+    }
+  }
+
+  GsxTuneProfile loadTuneProfile(String path) {
+    final pathP = path.toNativeUtf8();
+    final p = calloc<GsxTuneProfileNative>();
+    try {
+      final rc = _b.api.gsx_tune_load(pathP, p);
+      if (rc < 0) throw GsxException(rc, 'gsx_tune_load');
+      return GsxTuneProfile._(p.ref);
+    } finally {
+      calloc.free(pathP);
+      calloc.free(p);
+    }
+  }
+
+  /// Perfil usado por [compressParallel]/[runPipeline] para escolher lotes e workers
+  /// (global ao processo; null desativa).
+  void setTuneProfile(GsxTuneProfile? profile) {
+    if (profile == null) {
+      _b.api.gsx_tune_set_profile(nullptr);
+      return;
+    }
+    final p = calloc<GsxTuneProfileNative>();
+    try {
+      profile._fill(p.ref);
+      _b.api.gsx_tune_set_profile(p);
+    } finally {
+      calloc.free(p);
+    }
+  }
+
+  GsxTuneProfile? get tuneProfile {
+    final p = calloc<GsxTuneProfileNative>();
+    try {
+      return _b.api.gsx_tune_get_profile(p) == 1 ? GsxTuneProfile._(p.ref) : null;
+    } finally {
+      calloc.free(p);
+    }
+  }
+
+  /// Plano do perfil ativo para [firstPage, lastPage] de [inputPath] (pesos lidos
+  /// da xref, sem Ghostscript). null sem perfil ativo.
+  GsxTunePlan? tunePlan({
+    required String inputPath,
+    int firstPage = 0,
+    int lastPage = 0,
+    int maxWorkers = 0,
+  }) {
+    final inP = inputPath.toNativeUtf8();
+    final out = calloc<GsxTunePlanNative>();
+    try {
+      final rc = _b.api.gsx_tune_plan_file(inP, firstPage, lastPage, maxWorkers, out);
+      if (rc < 0) throw GsxException(rc, 'gsx_tune_plan_file');
+      return rc == 1 ? GsxTunePlan._(out.ref) : null;
+    } finally {
+      calloc.free(inP);
+      calloc.free(out);
+    }
+  }
+
+  /// Requisição inteira numa chamada nativa (gsx_pipeline_run): probe, lotes do
+  /// pdfwrite em paralelo, mesclagem com deduplicação e, se [linearize], saída
+  /// linearizada. As partes passam em memória (memfd, até [memBudgetMb]; 0 = 512,
+  /// negativo = nunca); o disco só é tocado para ler a entrada e gravar a saída.
+  /// Roda num isolate auxiliar, como [compressParallel].
+  Future<GsxPipelineReport> runPipeline({
+    required String inputPath,
+    required String outputPath,
+    int dpi = 150,
+    int jpegQuality = 65,
+    String? preset,
+    int colorMode = GsxColorMode.color,
+    int firstPage = 0,
+    int lastPage = 0,
+    int workers = 0,
+    bool dedup = true,
+    bool linearize = false,
+    int memBudgetMb = 0,
+    String? workDir,
+    ProgressCallback? onProgress,
+    GsxCancelToken? cancel,
+  }) async {
+    final inP = inputPath.toNativeUtf8();
+    final outP = outputPath.toNativeUtf8();
+    final preP = (preset ?? '').toNativeUtf8();
+    final dirP = workDir == null ? nullptr : workDir.toNativeUtf8();
+    final opts = calloc<GsxPipelineOptsNative>();
+    opts.ref
+      ..dpi = dpi
+      ..jpeg_quality = jpegQuality
+      ..preset = preP
+      ..mode = colorMode
+      ..first_page = firstPage
+      ..last_page = lastPage
+      ..workers = workers
+      ..skip_dedup = dedup ? 0 : 1
+      ..linearize = linearize ? 1 : 0
+      ..mem_budget_mb = memBudgetMb
+      ..work_dir = dirP;
+    final jsonOut = calloc<Pointer<Utf8>>();
+
+    final token = cancel ?? GsxCancelToken();
+    final createdToken = cancel == null;
+    final id = _CallbackRegistry.register(onProgress: onProgress);
+
+    try {
+      final rc = await _runPipelineInIsolate([
+        _b.api.gsx_pipeline_run_ptr.address,
+        inP.address,
+        outP.address,
+        opts.address,
+        jsonOut.address,
+        _CallbackRegistry._progressPtr().address,
+        id,
+        token.ptr.address,
+      ]);
+      if (rc < 0) throw GsxException(rc, 'gsx_pipeline_run');
+
+      final js = jsonOut.value;
+      final report = GsxPipelineReport._(jsonDecode(js.toDartString()) as Map<String, dynamic>);
+      _b.api.gsx_free(js.cast());
+      return report;
+    } finally {
+      _CallbackRegistry.unregister(id);
+      calloc.free(inP);
+      calloc.free(outP);
+      calloc.free(preP);
+      if (dirP != nullptr) calloc.free(dirP);
+      calloc.free(opts);
+      calloc.free(jsonOut);
+      if (createdToken) token.dispose();
+    }
+  }
+
+  static Future<int> _runPipelineInIsolate(List<int> a) => Isolate.run(() {
+        final fn = Pointer<NativeFunction<GsxPipelineRunNative>>.fromAddress(a[0])
+            .asFunction<GsxPipelineRunDart>();
+        return fn(
+          Pointer.fromAddress(a[1]),
+          Pointer.fromAddress(a[2]),
+          Pointer.fromAddress(a[3]),
+          Pointer.fromAddress(a[4]),
+          Pointer.fromAddress(a[5]),
+          Pointer.fromAddress(a[6]),
+          Pointer.fromAddress(a[7]),
+        );
+      });
+
+  /// Concatena [inputPaths] (nessa ordem) em [outputPath] sem qpdf: renumera os
+  /// objetos e copia os streams sem decodificar. Com [dedup], fontes/ICC/imagens
+  /// idênticas entre as partes são gravadas uma vez só; com [linearize], a saída já
+  /// sai linearizada (fast web view) na mesma escrita.
+  GsxMergeStats mergePdfs({
+    required List<String> inputPaths,
+    required String outputPath,
+    bool dedup = false,
+    bool linearize = false,
+  }) {
+    final arr = calloc<Pointer<Utf8>>(inputPaths.length);
+    final outP = outputPath.toNativeUtf8();
+    final st = calloc<GsxMergeStatsNative>();
+    try {
+      for (var i = 0; i < inputPaths.length; i++) {
+        arr[i] = inputPaths[i].toNativeUtf8();
+      }
+      final flags = (dedup ? GsxMergeFlags.dedup : 0) |
+          (linearize ? GsxMergeFlags.linearize : 0);
+      final rc = _b.api.gsx_merge_pdfs(arr, inputPaths.length, outP, flags, st);
+      if (rc < 0) throw GsxException(rc, 'gsx_merge_pdfs');
+      return GsxMergeStats._(st.ref);
+    } finally {
+      for (var i = 0; i < inputPaths.length; i++) {
+        if (arr[i] != nullptr) calloc.free(arr[i]);
+      }
+      calloc.free(arr);
+      calloc.free(outP);
+      calloc.free(st);
+    }
+  }
+
+  /// Regrava [inputPath] em [outputPath] fundindo objetos idênticos.
+  GsxMergeStats dedupPdf({
+    required String inputPath,
+    required String outputPath,
+  }) {
+    final inP = inputPath.toNativeUtf8();
+    final outP = outputPath.toNativeUtf8();
+    final st = calloc<GsxMergeStatsNative>();
+    try {
+      final rc = _b.api.gsx_dedup_pdf(inP, outP, st);
+      if (rc < 0) throw GsxException(rc, 'gsx_dedup_pdf');
+      return GsxMergeStats._(st.ref);
+    } finally {
+      calloc.free(inP);
+      calloc.free(outP);
+      calloc.free(st);
+    }
+  }
+
+  /// Confere a deduplicação em grafos sintéticos com resposta conhecida
+  /// (gsx_merge_selftest): mapa com 'cases', 'failures' e 'mismatches'.
+  /// 'failures' == 0 → ok.
+  Map<String, dynamic> mergeSelftest() {
+    final jsonOut = calloc<Pointer<Utf8>>();
+    try {
+      final rc = _b.api.gsx_merge_selftest(jsonOut);
+      if (rc < 0) throw GsxException(rc, 'gsx_merge_selftest');
+      final js = jsonOut.value;
+      final map = jsonDecode(js.toDartString()) as Map<String, dynamic>;
+      _b.api.gsx_free(js.cast());
+      return map;
+    } finally {
+      calloc.free(jsonOut);
+    }
+  }
+
+  /// Regrava [inputPath] linearizado em [outputPath] (fast web view) sem qpdf: hint
+  /// tables e 1ª página no início, streams copiados sem recodificar.
+  GsxLinearizeStats linearizePdf({
+    required String inputPath,
+    required String outputPath,
+  }) {
+    final inP = inputPath.toNativeUtf8();
+    final outP = outputPath.toNativeUtf8();
+    final st = calloc<GsxLinearizeStatsNative>();
+    try {
+      final rc = _b.api.gsx_linearize_pdf(inP, outP, st);
+      if (rc < 0) throw GsxException(rc, 'gsx_linearize_pdf');
+      return GsxLinearizeStats._(st.ref);
+    } finally {
+      calloc.free(inP);
+      calloc.free(outP);
+      calloc.free(st);
+    }
+  }
+
   int compressDirSync({
     required String inputDir,
     required String outputDir,
@@ -9,6 +9,7 @@ class GsxColorMode {
   static const int color = 0;
   static const int gray = 1;
   static const int bilevel = 2;
+  static const int mrc = 3;
 }
 
 /// C: typedef void (GSX_CALL *gsx_progress_cb)
@@ -28,6 +29,760 @@ typedef GsxFileCbNative = Void Function(
   Pointer<Void> user,
 );
 
+/// C: typedef struct gsx_probe_s { ... } (ver gsx_bridge.h)
+final class GsxProbeNative extends Struct {
+  @Int32()
+  external int page_count;
+  @Int32()
+  external int version;
+  @Int32()
+  external int encrypted;
+  @Int32()
+  external int linearized;
+  @Int32()
+  external int xref_health;
+  @Int32()
+  external int has_xref_stream;
+  @Int32()
+  external int xref_sections;
+  @Int32()
+  external int object_count;
+  @Uint64()
+  external int file_size;
+  @Uint64()
+  external int header_offset;
+  @Uint64()
+  external int elapsed_us;
+}
+
+/// C: typedef struct gsx_normalize_stats_s { int xref_health; int bad_offsets;
+///        int objects; int dropped; uint64_t bytes_out; uint64_t elapsed_us; }
+final class GsxNormalizeStatsNative extends Struct {
+  @Int32()
+  external int xref_health;
+  @Int32()
+  external int bad_offsets;
+  @Int32()
+  external int objects;
+  @Int32()
+  external int dropped;
+  @Uint64()
+  external int bytes_out;
+  @Uint64()
+  external int elapsed_us;
+}
+
+/// Flags de gsx_normalize_pdf
+class GsxNormalizeFlags {
+  static const int force = 1;
+}
+
+/// Classes de gsx_classify_pages (gsx_page_kind_t)
+class GsxPageKind {
+  static const int blank = 0;
+  static const int bilevel = 1;
+  static const int gray = 2;
+  static const int color = 3;
+}
+
+/// C: typedef struct gsx_page_class_s { int page; int kind; int image_heavy;
+///        float ink; float color; float midtone; }
+final class GsxPageClassNative extends Struct {
+  @Int32()
+  external int page;
+  @Int32()
+  external int kind;
+  @Int32()
+  external int image_heavy;
+  @Float()
+  external double ink;
+  @Float()
+  external double color;
+  @Float()
+  external double midtone;
+}
+
+/// Métodos de limiar de gsx_bilevel_pdf (gsx_bin_method_t)
+class GsxBinMethod {
+  static const int sauvola = 0;
+  static const int otsu = 1;
+}
+
+/// C: gsx_bin_codec_t
+class GsxBinCodec {
+  static const int g4 = 0;
+  static const int jbig2 = 1;
+}
+
+/// C: typedef struct gsx_bilevel_opts_s { int dpi; int method; int window; float k;
+///        int despeckle; int workers; int codec; }
+final class GsxBilevelOptsNative extends Struct {
+  @Int32()
+  external int dpi;
+  @Int32()
+  external int method;
+  @Int32()
+  external int window;
+  @Float()
+  external double k;
+  @Int32()
+  external int despeckle;
+  @Int32()
+  external int workers;
+  @Int32()
+  external int codec;
+}
+
+/// C: typedef struct gsx_mrc_opts_s { int dpi; int bg_dpi; int jpeg_quality; int codec;
+///        int workers; }
+final class GsxMrcOptsNative extends Struct {
+  @Int32()
+  external int dpi;
+  @Int32()
+  external int bg_dpi;
+  @Int32()
+  external int jpeg_quality;
+  @Int32()
+  external int codec;
+  @Int32()
+  external int workers;
+}
+
+/// Preset de gsx_compress_*: só as imagens, sem pdfwrite (GSX_PRESET_IMAGES)
+class GsxPreset {
+  static const String images = 'images';
+}
+
+/// C: typedef struct gsx_recompress_opts_s { int dpi; int jpeg_quality; int gray; int workers; }
+final class GsxRecompressOptsNative extends Struct {
+  @Int32()
+  external int dpi;
+  @Int32()
+  external int jpeg_quality;
+  @Int32()
+  external int gray;
+  @Int32()
+  external int workers;
+}
+
+/// C: typedef struct gsx_recompress_stats_s { int images; int recompressed; int downsampled;
+///        uint64_t image_bytes_in; uint64_t image_bytes_out; uint64_t bytes_in; uint64_t bytes_out; }
+final class GsxRecompressStatsNative extends Struct {
+  @Int32()
+  external int images;
+  @Int32()
+  external int recompressed;
+  @Int32()
+  external int downsampled;
+  @Uint64()
+  external int image_bytes_in;
+  @Uint64()
+  external int image_bytes_out;
+  @Uint64()
+  external int bytes_in;
+  @Uint64()
+  external int bytes_out;
+}
+
+/// Cores de gsx_render_pages (gsx_render_color_t)
+class GsxRenderColor {
+  static const int rgb = 0;
+  static const int gray = 1;
+
+  /// 1 bpp, bit mais significativo à esquerda, 1 = preto.
+  static const int mono = 2;
+}
+
+/// C: typedef struct gsx_render_opts_s { int dpi; int color; int band_height;
+///        int render_threads; int workers; int alpha_bits;
+///        gsx_render_alloc_cb alloc; gsx_render_free_cb free_mem; void* alloc_user; }
+final class GsxRenderOptsNative extends Struct {
+  @Int32()
+  external int dpi;
+  @Int32()
+  external int color;
+  @Int32()
+  external int band_height;
+  @Int32()
+  external int render_threads;
+  @Int32()
+  external int workers;
+  @Int32()
+  external int alpha_bits;
+  external Pointer<Void> alloc;
+  external Pointer<Void> free_mem;
+  external Pointer<Void> alloc_user;
+}
+
+/// C: typedef struct gsx_raster_s { int page; int width, height; int y, rows;
+///        int stride; int color; int bits_per_pixel; int worker; const uint8_t* data; }
+final class GsxRasterNative extends Struct {
+  @Int32()
+  external int page;
+  @Int32()
+  external int width;
+  @Int32()
+  external int height;
+  @Int32()
+  external int y;
+  @Int32()
+  external int rows;
+  @Int32()
+  external int stride;
+  @Int32()
+  external int color;
+  @Int32()
+  external int bits_per_pixel;
+  @Int32()
+  external int worker;
+  external Pointer<Uint8> data;
+}
+
+/// C: typedef struct gsx_thumbs_opts_s { int workers; int prefetch; int batch_pages; int gray; }
+final class GsxThumbsOptsNative extends Struct {
+  @Int32()
+  external int workers;
+  @Int32()
+  external int prefetch;
+  @Int32()
+  external int batch_pages;
+  @Int32()
+  external int gray;
+}
+
+/// Níveis fixos de zoom das miniaturas (GSX_THUMB_LEVELS): 24, 48, 96 e 192 dpi.
+const int gsxThumbLevels = 4;
+
+/// C: typedef struct gsx_optimize_opts_s { int level; int workers; int classic_xref;
+///        int skip_unfiltered; }
+final class GsxOptimizeOptsNative extends Struct {
+  @Int32()
+  external int level;
+  @Int32()
+  external int workers;
+  @Int32()
+  external int classic_xref;
+  @Int32()
+  external int skip_unfiltered;
+}
+
+/// C: typedef struct gsx_optimize_stats_s { int objects; int objects_packed;
+///        int object_streams; int streams; int streams_recompressed; int streams_deflated;
+///        uint64_t stream_bytes_in, stream_bytes_out; uint64_t bytes_in, bytes_out;
+///        uint64_t cpu_us; uint64_t elapsed_us; }
+final class GsxOptimizeStatsNative extends Struct {
+  @Int32()
+  external int objects;
+  @Int32()
+  external int objects_packed;
+  @Int32()
+  external int object_streams;
+  @Int32()
+  external int streams;
+  @Int32()
+  external int streams_recompressed;
+  @Int32()
+  external int streams_deflated;
+  @Uint64()
+  external int stream_bytes_in;
+  @Uint64()
+  external int stream_bytes_out;
+  @Uint64()
+  external int bytes_in;
+  @Uint64()
+  external int bytes_out;
+  @Uint64()
+  external int cpu_us;
+  @Uint64()
+  external int elapsed_us;
+}
+
+/// C: typedef struct gsx_chunk_s { int first_page; int last_page; uint64_t weight; }
+final class GsxChunkNative extends Struct {
+  @Int32()
+  external int first_page;
+  @Int32()
+  external int last_page;
+  @Uint64()
+  external int weight;
+}
+
+/// C: typedef struct gsx_parallel_opts_s { int workers; int batches_per_worker;
+///        int straggler_pct; int straggler_min_ms; const char* work_dir; }
+final class GsxParallelOptsNative extends Struct {
+  @Int32()
+  external int workers;
+  @Int32()
+  external int batches_per_worker;
+  @Int32()
+  external int straggler_pct;
+  @Int32()
+  external int straggler_min_ms;
+  external Pointer<Utf8> work_dir;
+}
+
+/// C: typedef struct gsx_tune_profile_s { double chunk_fixed_ms, page_ms, ms_per_mb,
+///        merge_fixed_ms, merge_part_ms, merge_ms_per_mb, out_ratio, parallel_eff;
+///        int eff_workers; int cpus; int samples; }
+final class GsxTuneProfileNative extends Struct {
+  @Double()
+  external double chunk_fixed_ms;
+  @Double()
+  external double page_ms;
+  @Double()
+  external double ms_per_mb;
+  @Double()
+  external double merge_fixed_ms;
+  @Double()
+  external double merge_part_ms;
+  @Double()
+  external double merge_ms_per_mb;
+  @Double()
+  external double out_ratio;
+  @Double()
+  external double parallel_eff;
+  @Int32()
+  external int eff_workers;
+  @Int32()
+  external int cpus;
+  @Int32()
+  external int samples;
+}
+
+/// C: typedef struct gsx_tune_opts_s { int dpi; int jpeg_quality; const char* preset;
+///        gsx_color_mode_t mode; int max_pages; int max_seconds; const char* work_dir; }
+final class GsxTuneOptsNative extends Struct {
+  @Int32()
+  external int dpi;
+  @Int32()
+  external int jpeg_quality;
+  external Pointer<Utf8> preset;
+  @Int32()
+  external int mode;
+  @Int32()
+  external int max_pages;
+  @Int32()
+  external int max_seconds;
+  external Pointer<Utf8> work_dir;
+}
+
+/// C: typedef struct gsx_tune_plan_s { int chunks; int workers; double est_ms;
+///        double est_single_ms; }
+final class GsxTunePlanNative extends Struct {
+  @Int32()
+  external int chunks;
+  @Int32()
+  external int workers;
+  @Double()
+  external double est_ms;
+  @Double()
+  external double est_single_ms;
+}
+
+/// C: typedef struct gsx_pipeline_opts_s { int dpi; int jpeg_quality; const char* preset;
+///        gsx_color_mode_t mode; int first_page; int last_page; int workers; int skip_dedup;
+///        int linearize; int mem_budget_mb; const char* work_dir; }
+final class GsxPipelineOptsNative extends Struct {
+  @Int32()
+  external int dpi;
+  @Int32()
+  external int jpeg_quality;
+  external Pointer<Utf8> preset;
+  @Int32()
+  external int mode;
+  @Int32()
+  external int first_page;
+  @Int32()
+  external int last_page;
+  @Int32()
+  external int workers;
+  @Int32()
+  external int skip_dedup;
+  @Int32()
+  external int linearize;
+  @Int32()
+  external int mem_budget_mb;
+  external Pointer<Utf8> work_dir;
+}
+
+/// C: typedef struct gsx_soak_opts_s { int seconds; int workers; int sample_ms;
+///        int warmup_pct; int dpi; int jpeg_quality; const char* preset;
+///        gsx_color_mode_t mode; int max_pages; unsigned seed; const char* work_dir; }
+final class GsxSoakOptsNative extends Struct {
+  @Int32()
+  external int seconds;
+  @Int32()
+  external int workers;
+  @Int32()
+  external int sample_ms;
+  @Int32()
+  external int warmup_pct;
+  @Int32()
+  external int dpi;
+  @Int32()
+  external int jpeg_quality;
+  external Pointer<Utf8> preset;
+  @Int32()
+  external int mode;
+  @Int32()
+  external int max_pages;
+  @Uint32()
+  external int seed;
+  external Pointer<Utf8> work_dir;
+}
+
+/// C: typedef struct gsx_replay_opts_s { double speed; int concurrency; int limit;
+///        const char* inputs_dir; const char* work_dir; }
+final class GsxReplayOptsNative extends Struct {
+  @Double()
+  external double speed;
+  @Int32()
+  external int concurrency;
+  @Int32()
+  external int limit;
+  external Pointer<Utf8> inputs_dir;
+  external Pointer<Utf8> work_dir;
+}
+
+/// Flags de gsx_merge_pdfs
+class GsxMergeFlags {
+  static const int dedup = 1;
+  static const int linearize = 2;
+}
+
+/// C: typedef struct gsx_merge_stats_s { int pages; int objects_in; int objects_out;
+///        uint64_t stream_bytes_saved; uint64_t bytes_out; }
+final class GsxMergeStatsNative extends Struct {
+  @Int32()
+  external int pages;
+  @Int32()
+  external int objects_in;
+  @Int32()
+  external int objects_out;
+  @Uint64()
+  external int stream_bytes_saved;
+  @Uint64()
+  external int bytes_out;
+}
+
+/// C: typedef struct gsx_linearize_stats_s { int pages; int objects;
+///        int first_page_objects; int shared_objects; uint64_t first_page_end;
+///        uint64_t hint_bytes; uint64_t bytes_out; }
+final class GsxLinearizeStatsNative extends Struct {
+  @Int32()
+  external int pages;
+  @Int32()
+  external int objects;
+  @Int32()
+  external int first_page_objects;
+  @Int32()
+  external int shared_objects;
+  @Uint64()
+  external int first_page_end;
+  @Uint64()
+  external int hint_bytes;
+  @Uint64()
+  external int bytes_out;
+}
+
+/// C: int gsx_compress_parallel_sync(in_path, dpi, jpeg_quality, preset, mode,
+///        first_page, last_page, opts, parts_json, on_progress, user, cancel_flag);
+typedef GsxCompressParallelNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Int32 dpi,
+  Int32 jpeg_quality,
+  Pointer<Utf8> preset,
+  Int32 mode,
+  Int32 first_page,
+  Int32 last_page,
+  Pointer<GsxParallelOptsNative> opts,
+  Pointer<Pointer<Utf8>> parts_json,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxCompressParallelDart = int Function(
+  Pointer<Utf8> inPath,
+  int dpi,
+  int jpegQuality,
+  Pointer<Utf8> presetOrNull,
+  int mode,
+  int firstPage,
+  int lastPage,
+  Pointer<GsxParallelOptsNative> optsOrNull,
+  Pointer<Pointer<Utf8>> partsJsonOut,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+/// C: int gsx_compress_fd_sync(in_fd, out_fd, dpi, jpeg_quality, preset, mode,
+///        first_page, last_page, out_len, on_progress, user, cancel_flag);
+typedef GsxCompressFdNative = Int32 Function(
+  Int32 in_fd,
+  Int32 out_fd,
+  Int32 dpi,
+  Int32 jpeg_quality,
+  Pointer<Utf8> preset,
+  Int32 mode,
+  Int32 first_page,
+  Int32 last_page,
+  Pointer<Uint64> out_len,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxCompressFdDart = int Function(
+  int inFd,
+  int outFd,
+  int dpi,
+  int jpegQuality,
+  Pointer<Utf8> presetOrNull,
+  int mode,
+  int firstPage,
+  int lastPage,
+  Pointer<Uint64> outLenOrNull,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+/// C: int gsx_tune_calibrate(corpus, count, opts, out, on_progress, user, cancel_flag);
+typedef GsxTuneCalibrateNative = Int32 Function(
+  Pointer<Pointer<Utf8>> corpus,
+  Int32 count,
+  Pointer<GsxTuneOptsNative> opts,
+  Pointer<GsxTuneProfileNative> out,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxTuneCalibrateDart = int Function(
+  Pointer<Pointer<Utf8>> corpus,
+  int count,
+  Pointer<GsxTuneOptsNative> optsOrNull,
+  Pointer<GsxTuneProfileNative> out,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+/// C: int gsx_pipeline_run(in_path, out_path, opts, report_json, on_progress, user, cancel_flag);
+typedef GsxPipelineRunNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Pointer<Utf8> out_path,
+  Pointer<GsxPipelineOptsNative> opts,
+  Pointer<Pointer<Utf8>> report_json,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxPipelineRunDart = int Function(
+  Pointer<Utf8> inPath,
+  Pointer<Utf8> outPath,
+  Pointer<GsxPipelineOptsNative> optsOrNull,
+  Pointer<Pointer<Utf8>> reportJsonOut,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+/// C: int gsx_soak_run(corpus, count, opts, report_json, on_progress, user, cancel_flag);
+typedef GsxSoakRunNative = Int32 Function(
+  Pointer<Pointer<Utf8>> corpus,
+  Int32 count,
+  Pointer<GsxSoakOptsNative> opts,
+  Pointer<Pointer<Utf8>> report_json,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxSoakRunDart = int Function(
+  Pointer<Pointer<Utf8>> corpus,
+  int count,
+  Pointer<GsxSoakOptsNative> optsOrNull,
+  Pointer<Pointer<Utf8>> reportJsonOut,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+/// C: int gsx_replay_run(capture_path, opts, report_json, on_progress, user, cancel_flag);
+typedef GsxReplayRunNative = Int32 Function(
+  Pointer<Utf8> capture_path,
+  Pointer<GsxReplayOptsNative> opts,
+  Pointer<Pointer<Utf8>> report_json,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxReplayRunDart = int Function(
+  Pointer<Utf8> capturePath,
+  Pointer<GsxReplayOptsNative> optsOrNull,
+  Pointer<Pointer<Utf8>> reportJsonOut,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+typedef GsxClassifyPagesNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Int32 first_page,
+  Int32 last_page,
+  Int32 dpi,
+  Int32 workers,
+  Pointer<GsxPageClassNative> out,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxClassifyPagesDart = int Function(
+  Pointer<Utf8> inPath,
+  int firstPage,
+  int lastPage,
+  int dpi,
+  int workers,
+  Pointer<GsxPageClassNative> out,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+typedef GsxBilevelPdfNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Pointer<Utf8> out_path,
+  Int32 first_page,
+  Int32 last_page,
+  Pointer<GsxBilevelOptsNative> opts,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxBilevelPdfDart = int Function(
+  Pointer<Utf8> inPath,
+  Pointer<Utf8> outPath,
+  int firstPage,
+  int lastPage,
+  Pointer<GsxBilevelOptsNative> optsOrNull,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+typedef GsxBilevelBenchNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Int32 first_page,
+  Int32 last_page,
+  Pointer<GsxBilevelOptsNative> opts,
+  Pointer<Pointer<Utf8>> json_out,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxBilevelBenchDart = int Function(
+  Pointer<Utf8> inPath,
+  int firstPage,
+  int lastPage,
+  Pointer<GsxBilevelOptsNative> optsOrNull,
+  Pointer<Pointer<Utf8>> jsonOut,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+typedef GsxMrcPdfNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Pointer<Utf8> out_path,
+  Int32 first_page,
+  Int32 last_page,
+  Pointer<GsxMrcOptsNative> opts,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxMrcPdfDart = int Function(
+  Pointer<Utf8> inPath,
+  Pointer<Utf8> outPath,
+  int firstPage,
+  int lastPage,
+  Pointer<GsxMrcOptsNative> optsOrNull,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+typedef GsxRecompressImagesNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Pointer<Utf8> out_path,
+  Pointer<GsxRecompressOptsNative> opts,
+  Pointer<GsxRecompressStatsNative> stats_out,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxRecompressImagesDart = int Function(
+  Pointer<Utf8> inPath,
+  Pointer<Utf8> outPath,
+  Pointer<GsxRecompressOptsNative> optsOrNull,
+  Pointer<GsxRecompressStatsNative> statsOrNull,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+typedef GsxRenderPagesNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Int32 first_page,
+  Int32 last_page,
+  Pointer<GsxRenderOptsNative> opts,
+  Pointer<Void> on_raster,
+  Pointer<Void> raster_user,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxRenderPagesDart = int Function(
+  Pointer<Utf8> inPath,
+  int firstPage,
+  int lastPage,
+  Pointer<GsxRenderOptsNative> optsOrNull,
+  Pointer<Void> onRaster,
+  Pointer<Void> rasterUser,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
+typedef GsxThumbsGetNative = Int32 Function(
+  Pointer<Void> svc,
+  Pointer<Utf8> in_path,
+  Int32 page,
+  Int32 level,
+  Pointer<Pointer<Utf8>> png_path_out,
+);
+typedef GsxThumbsGetDart = int Function(
+  Pointer<Void> svc,
+  Pointer<Utf8> inPath,
+  int page,
+  int level,
+  Pointer<Pointer<Utf8>> pngPathOut,
+);
+
+typedef GsxOptimizePdfNative = Int32 Function(
+  Pointer<Utf8> in_path,
+  Pointer<Utf8> out_path,
+  Pointer<GsxOptimizeOptsNative> opts,
+  Pointer<GsxOptimizeStatsNative> stats_out,
+  Pointer<NativeFunction<GsxProgressCbNative>> on_progress,
+  Pointer<Void> user,
+  Pointer<Int32> cancel_flag,
+);
+typedef GsxOptimizePdfDart = int Function(
+  Pointer<Utf8> inPath,
+  Pointer<Utf8> outPath,
+  Pointer<GsxOptimizeOptsNative> optsOrNull,
+  Pointer<GsxOptimizeStatsNative> statsOrNull,
+  Pointer<NativeFunction<GsxProgressCbNative>> onProgress,
+  Pointer<Void> user,
+  Pointer<Int32> cancelFlagOrNull,
+);
+
 class _Lib {
   final DynamicLibrary lib;
   _Lib(this.lib);
@@ -43,6 +798,35 @@ class _Lib {
         'gsx_destroy_context',
       );
 
+  // -------- Rastreamento (Chrome trace) --------
+  late final void Function(int on) gsx_trace_enable =
+      lib.lookupFunction<Void Function(Int32), void Function(int)>('gsx_trace_enable');
+
+  late final int Function() gsx_trace_enabled =
+      lib.lookupFunction<Int32 Function(), int Function()>('gsx_trace_enabled');
+
+  late final void Function(Pointer<Utf8> dirOrNull) gsx_trace_set_dump_dir =
+      lib.lookupFunction<Void Function(Pointer<Utf8>), void Function(Pointer<Utf8>)>(
+          'gsx_trace_set_dump_dir');
+
+  late final int Function() gsx_trace_now_us =
+      lib.lookupFunction<Uint64 Function(), int Function()>('gsx_trace_now_us');
+
+  late final int Function(Pointer<Utf8> path, int job, int sinceUs) gsx_trace_dump =
+      lib.lookupFunction<Int32 Function(Pointer<Utf8>, Uint64, Uint64),
+          int Function(Pointer<Utf8>, int, int)>('gsx_trace_dump');
+
+  late final Pointer<Utf8> Function(int job, int sinceUs) gsx_trace_json =
+      lib.lookupFunction<Pointer<Utf8> Function(Uint64, Uint64), Pointer<Utf8> Function(int, int)>(
+          'gsx_trace_json');
+
+  late final void Function() gsx_trace_clear =
+      lib.lookupFunction<Void Function(), void Function()>('gsx_trace_clear');
+
+  // -------- Métricas (Prometheus) --------
+  late final Pointer<Utf8> Function() gsx_metrics_snapshot =
+      lib.lookupFunction<Pointer<Utf8> Function(), Pointer<Utf8> Function()>('gsx_metrics_snapshot');
+
   // -------- Helpers de argv --------
   late final int Function(
     Pointer<Pointer<Utf8>> argvOut,
@@ -188,6 +972,19 @@ class _Lib {
         Pointer<Int32>,
       )>('gsx_compress_bytes_sync');
 
+  // -------- Descritores --------
+  /// Endereço cru da função: chamada a partir de outro isolate (ver GsxBridge.compressFd).
+  late final Pointer<NativeFunction<GsxCompressFdNative>> gsx_compress_fd_sync_ptr =
+      lib.lookup<NativeFunction<GsxCompressFdNative>>('gsx_compress_fd_sync');
+
+  late final int Function(Pointer<Utf8> nameOrNull) gsx_memfd_create =
+      lib.lookupFunction<Int32 Function(Pointer<Utf8>), int Function(Pointer<Utf8>)>(
+    'gsx_memfd_create',
+  );
+
+  late final int Function(int fd) gsx_fd_close =
+      lib.lookupFunction<Int32 Function(Int32), int Function(int)>('gsx_fd_close');
+
   // -------- Assíncrono (job) --------
   late final Pointer<Void> Function(
     Pointer<Utf8> inPath,
@@ -287,6 +1084,262 @@ class _Lib {
         Pointer<NativeFunction<GsxFileCbNative>>,
       )>('gsx_compress_dir_sync');
 
+  // -------- Inspeção rápida --------
+  late final int Function(Pointer<Utf8> inPath, Pointer<GsxProbeNative> out)
+      gsx_probe = lib.lookupFunction<
+          Int32 Function(Pointer<Utf8>, Pointer<GsxProbeNative>),
+          int Function(Pointer<Utf8>, Pointer<GsxProbeNative>)>('gsx_probe');
+
+  late final int Function(
+    Pointer<Utf8> inPath,
+    Pointer<Utf8> outPath,
+    int flags,
+    Pointer<GsxNormalizeStatsNative> statsOrNull,
+  ) gsx_normalize_pdf = lib.lookupFunction<
+      Int32 Function(Pointer<Utf8>, Pointer<Utf8>, Int32, Pointer<GsxNormalizeStatsNative>),
+      int Function(Pointer<Utf8>, Pointer<Utf8>, int,
+          Pointer<GsxNormalizeStatsNative>)>('gsx_normalize_pdf');
+
+  late final int Function(Pointer<Utf8> inPath, Pointer<Pointer<Utf8>> jsonOut)
+      gsx_analyze = lib.lookupFunction<
+          Int32 Function(Pointer<Utf8>, Pointer<Pointer<Utf8>>),
+          int Function(Pointer<Utf8>, Pointer<Pointer<Utf8>>)>('gsx_analyze');
+
+  // -------- Classificação de páginas --------
+  /// Só o endereço: a chamada roda em outro isolate (ver GsxBridge.classifyPages).
+  late final Pointer<NativeFunction<GsxClassifyPagesNative>>
+      gsx_classify_pages_ptr =
+      lib.lookup<NativeFunction<GsxClassifyPagesNative>>('gsx_classify_pages');
+
+  // -------- P&B nativo --------
+  /// Só o endereço: a chamada roda em outro isolate (ver GsxBridge.bilevelPdf).
+  late final Pointer<NativeFunction<GsxBilevelPdfNative>> gsx_bilevel_pdf_ptr =
+      lib.lookup<NativeFunction<GsxBilevelPdfNative>>('gsx_bilevel_pdf');
+  late final Pointer<NativeFunction<GsxBilevelBenchNative>> gsx_bilevel_bench_ptr =
+      lib.lookup<NativeFunction<GsxBilevelBenchNative>>('gsx_bilevel_bench');
+
+  // -------- MRC --------
+  late final Pointer<NativeFunction<GsxMrcPdfNative>> gsx_mrc_pdf_ptr =
+      lib.lookup<NativeFunction<GsxMrcPdfNative>>('gsx_mrc_pdf');
+
+  // -------- Recompressão só das imagens --------
+  late final Pointer<NativeFunction<GsxRecompressImagesNative>> gsx_recompress_images_ptr =
+      lib.lookup<NativeFunction<GsxRecompressImagesNative>>('gsx_recompress_images');
+
+  // -------- Renderização para a memória --------
+  /// Só o endereço: a chamada roda em outro isolate (ver GsxBridge.renderPages).
+  late final Pointer<NativeFunction<GsxRenderPagesNative>> gsx_render_pages_ptr =
+      lib.lookup<NativeFunction<GsxRenderPagesNative>>('gsx_render_pages');
+
+  /// Passado como on_raster: o callback roda nas threads dos workers, então o
+  /// coletor nativo junta as páginas e o Dart só lê a lista no fim.
+  late final Pointer<Void> gsx_raster_list_collect_ptr =
+      lib.lookup<Void>('gsx_raster_list_collect');
+
+  late final Pointer<Void> Function() gsx_raster_list_new = lib.lookupFunction<
+      Pointer<Void> Function(), Pointer<Void> Function()>('gsx_raster_list_new');
+
+  late final int Function(Pointer<Void>) gsx_raster_list_count =
+      lib.lookupFunction<Int32 Function(Pointer<Void>), int Function(Pointer<Void>)>(
+        'gsx_raster_list_count',
+      );
+
+  late final Pointer<GsxRasterNative> Function(Pointer<Void>, int) gsx_raster_list_get =
+      lib.lookupFunction<Pointer<GsxRasterNative> Function(Pointer<Void>, Int32),
+          Pointer<GsxRasterNative> Function(Pointer<Void>, int)>('gsx_raster_list_get');
+
+  late final void Function(Pointer<Void>) gsx_raster_list_free =
+      lib.lookupFunction<Void Function(Pointer<Void>), void Function(Pointer<Void>)>(
+        'gsx_raster_list_free',
+      );
+
+  late final void Function() gsx_render_pool_trim =
+      lib.lookupFunction<Void Function(), void Function()>('gsx_render_pool_trim');
+
+  // -------- Miniaturas --------
+  late final Pointer<Void> Function(Pointer<Utf8>, Pointer<GsxThumbsOptsNative>)
+      gsx_thumbs_open = lib.lookupFunction<
+          Pointer<Void> Function(Pointer<Utf8>, Pointer<GsxThumbsOptsNative>),
+          Pointer<Void> Function(
+              Pointer<Utf8>, Pointer<GsxThumbsOptsNative>)>('gsx_thumbs_open');
+
+  late final void Function(Pointer<Void>) gsx_thumbs_close =
+      lib.lookupFunction<Void Function(Pointer<Void>), void Function(Pointer<Void>)>(
+        'gsx_thumbs_close',
+      );
+
+  late final int Function(Pointer<Void>, Pointer<Utf8>, int, int, int, int)
+      gsx_thumbs_request = lib.lookupFunction<
+          Int32 Function(Pointer<Void>, Pointer<Utf8>, Int32, Int32, Int32, Int32),
+          int Function(Pointer<Void>, Pointer<Utf8>, int, int, int, int)>(
+        'gsx_thumbs_request',
+      );
+
+  /// Só o endereço: bloqueia até a página ficar pronta (ver GsxThumbnails.get).
+  late final Pointer<NativeFunction<GsxThumbsGetNative>> gsx_thumbs_get_ptr =
+      lib.lookup<NativeFunction<GsxThumbsGetNative>>('gsx_thumbs_get');
+
+  late final int Function(Pointer<Void>, Pointer<Pointer<Utf8>>) gsx_thumbs_stats =
+      lib.lookupFunction<Int32 Function(Pointer<Void>, Pointer<Pointer<Utf8>>),
+          int Function(Pointer<Void>, Pointer<Pointer<Utf8>>)>('gsx_thumbs_stats');
+
+  // -------- Planejamento de chunks --------
+  late final int Function(
+    Pointer<Utf8> inPath,
+    int firstPage,
+    int lastPage,
+    int maxChunks,
+    Pointer<GsxChunkNative> chunksOut,
+  ) gsx_plan_chunks = lib.lookupFunction<
+      Int32 Function(
+        Pointer<Utf8>,
+        Int32,
+        Int32,
+        Int32,
+        Pointer<GsxChunkNative>,
+      ),
+      int Function(
+        Pointer<Utf8>,
+        int,
+        int,
+        int,
+        Pointer<GsxChunkNative>,
+      )>('gsx_plan_chunks');
+
+  // -------- Compressão paralela --------
+  late final GsxCompressParallelDart gsx_compress_parallel_sync =
+      lib.lookupFunction<GsxCompressParallelNative, GsxCompressParallelDart>(
+    'gsx_compress_parallel_sync',
+  );
+
+  /// Endereço cru da função: chamada a partir de outro isolate (ver GsxBridge.compressParallel).
+  late final Pointer<NativeFunction<GsxCompressParallelNative>>
+      gsx_compress_parallel_sync_ptr =
+      lib.lookup<NativeFunction<GsxCompressParallelNative>>(
+    'gsx_compress_parallel_sync',
+  );
+
+  // -------- Auto-ajuste (modelo de custo da divisão em lotes) --------
+  /// Endereço cru da função: chamada a partir de outro isolate (ver GsxBridge.calibrate).
+  late final Pointer<NativeFunction<GsxTuneCalibrateNative>> gsx_tune_calibrate_ptr =
+      lib.lookup<NativeFunction<GsxTuneCalibrateNative>>('gsx_tune_calibrate');
+
+  late final int Function(Pointer<Utf8> path, Pointer<GsxTuneProfileNative> profile) gsx_tune_save =
+      lib.lookupFunction<Int32 Function(Pointer<Utf8>, Pointer<GsxTuneProfileNative>),
+          int Function(Pointer<Utf8>, Pointer<GsxTuneProfileNative>)>('gsx_tune_save');
+
+  late final int Function(Pointer<Utf8> path, Pointer<GsxTuneProfileNative> out) gsx_tune_load =
+      lib.lookupFunction<Int32 Function(Pointer<Utf8>, Pointer<GsxTuneProfileNative>),
+          int Function(Pointer<Utf8>, Pointer<GsxTuneProfileNative>)>('gsx_tune_load');
+
+  late final void Function(Pointer<GsxTuneProfileNative> profileOrNull) gsx_tune_set_profile =
+      lib.lookupFunction<Void Function(Pointer<GsxTuneProfileNative>),
+          void Function(Pointer<GsxTuneProfileNative>)>('gsx_tune_set_profile');
+
+  late final int Function(Pointer<GsxTuneProfileNative> outOrNull) gsx_tune_get_profile =
+      lib.lookupFunction<Int32 Function(Pointer<GsxTuneProfileNative>),
+          int Function(Pointer<GsxTuneProfileNative>)>('gsx_tune_get_profile');
+
+  late final void Function(
+    Pointer<GsxTuneProfileNative> profile,
+    int pages,
+    int weightBytes,
+    int maxWorkers,
+    Pointer<GsxTunePlanNative> out,
+  ) gsx_tune_plan = lib.lookupFunction<
+      Void Function(Pointer<GsxTuneProfileNative>, Int32, Uint64, Int32, Pointer<GsxTunePlanNative>),
+      void Function(Pointer<GsxTuneProfileNative>, int, int, int, Pointer<GsxTunePlanNative>)>('gsx_tune_plan');
+
+  late final int Function(
+    Pointer<Utf8> inPath,
+    int firstPage,
+    int lastPage,
+    int maxWorkers,
+    Pointer<GsxTunePlanNative> out,
+  ) gsx_tune_plan_file = lib.lookupFunction<
+      Int32 Function(Pointer<Utf8>, Int32, Int32, Int32, Pointer<GsxTunePlanNative>),
+      int Function(Pointer<Utf8>, int, int, int, Pointer<GsxTunePlanNative>)>('gsx_tune_plan_file');
+
+  // -------- Pipeline nativo --------
+  /// Endereço cru da função: chamada a partir de outro isolate (ver GsxBridge.runPipeline).
+  late final Pointer<NativeFunction<GsxPipelineRunNative>> gsx_pipeline_run_ptr =
+      lib.lookup<NativeFunction<GsxPipelineRunNative>>('gsx_pipeline_run');
+
+  // -------- Mesclagem nativa --------
+  late final int Function(
+    Pointer<Pointer<Utf8>> inPaths,
+    int count,
+    Pointer<Utf8> outPath,
+    int flags,
+    Pointer<GsxMergeStatsNative> statsOrNull,
+  ) gsx_merge_pdfs = lib.lookupFunction<
+      Int32 Function(Pointer<Pointer<Utf8>>, Int32, Pointer<Utf8>, Int32,
+          Pointer<GsxMergeStatsNative>),
+      int Function(Pointer<Pointer<Utf8>>, int, Pointer<Utf8>, int,
+          Pointer<GsxMergeStatsNative>)>('gsx_merge_pdfs');
+
+  late final int Function(
+    Pointer<Utf8> inPath,
+    Pointer<Utf8> outPath,
+    Pointer<GsxMergeStatsNative> statsOrNull,
+  ) gsx_dedup_pdf = lib.lookupFunction<
+      Int32 Function(Pointer<Utf8>, Pointer<Utf8>, Pointer<GsxMergeStatsNative>),
+      int Function(Pointer<Utf8>, Pointer<Utf8>,
+          Pointer<GsxMergeStatsNative>)>('gsx_dedup_pdf');
+
+  late final int Function(Pointer<Pointer<Utf8>> jsonOut) gsx_merge_selftest =
+      lib.lookupFunction<Int32 Function(Pointer<Pointer<Utf8>>),
+          int Function(Pointer<Pointer<Utf8>>)>('gsx_merge_selftest');
+
+  // -------- Linearização nativa --------
+  late final int Function(
+    Pointer<Utf8> inPath,
+    Pointer<Utf8> outPath,
+    Pointer<GsxLinearizeStatsNative> statsOrNull,
+  ) gsx_linearize_pdf = lib.lookupFunction<
+      Int32 Function(
+          Pointer<Utf8>, Pointer<Utf8>, Pointer<GsxLinearizeStatsNative>),
+      int Function(Pointer<Utf8>, Pointer<Utf8>,
+          Pointer<GsxLinearizeStatsNative>)>('gsx_linearize_pdf');
+
+  // -------- Pós-passo estrutural --------
+  /// Só o endereço: a chamada roda em outro isolate (ver GsxBridge.optimizePdf).
+  late final Pointer<NativeFunction<GsxOptimizePdfNative>> gsx_optimize_pdf_ptr =
+      lib.lookup<NativeFunction<GsxOptimizePdfNative>>('gsx_optimize_pdf');
+
+  // -------- Kernels de raster --------
+  late final Pointer<Utf8> Function() gsx_simd_level = lib.lookupFunction<
+      Pointer<Utf8> Function(), Pointer<Utf8> Function()>('gsx_simd_level');
+
+  late final int Function(Pointer<Pointer<Utf8>> jsonOut) gsx_kernels_selftest =
+      lib.lookupFunction<Int32 Function(Pointer<Pointer<Utf8>>),
+          int Function(Pointer<Pointer<Utf8>>)>('gsx_kernels_selftest');
+
+  /// Só o endereço: a chamada roda em outro isolate (ver GsxBridge.kernelsBench).
+  late final Pointer<NativeFunction<Int32 Function(Int32, Pointer<Pointer<Utf8>>)>>
+      gsx_kernels_bench_ptr =
+      lib.lookup<NativeFunction<Int32 Function(Int32, Pointer<Pointer<Utf8>>)>>(
+          'gsx_kernels_bench');
+
+  // -------- Teste de resistência --------
+  /// Só o endereço: a chamada roda em outro isolate (ver GsxBridge.soak).
+  late final Pointer<NativeFunction<GsxSoakRunNative>> gsx_soak_run_ptr =
+      lib.lookup<NativeFunction<GsxSoakRunNative>>('gsx_soak_run');
+
+  // -------- Captura e replay de carga --------
+  late final int Function(Pointer<Utf8> path) gsx_capture_start =
+      lib.lookupFunction<Int32 Function(Pointer<Utf8>), int Function(Pointer<Utf8>)>('gsx_capture_start');
+
+  late final void Function() gsx_capture_stop =
+      lib.lookupFunction<Void Function(), void Function()>('gsx_capture_stop');
+
+  late final int Function() gsx_capture_active =
+      lib.lookupFunction<Int32 Function(), int Function()>('gsx_capture_active');
+
+  /// Só o endereço: a chamada roda em outro isolate (ver GsxBridge.replay).
+  late final Pointer<NativeFunction<GsxReplayRunNative>> gsx_replay_run_ptr =
+      lib.lookup<NativeFunction<GsxReplayRunNative>>('gsx_replay_run');
+
   // -------- Util --------
   late final void Function(Pointer<Void>) gsx_free =
       lib.lookupFunction<Void Function(Pointer<Void>), void Function(Pointer<Void>)>(
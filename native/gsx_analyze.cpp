@@ -0,0 +1,434 @@
+// gsx_analyze.cpp — atribuição de bytes de um PDF (gsx_analyze): para onde vai o tamanho
+// do arquivo (imagens, fontes, conteúdo, ICC, metadados, anotações, estrutura), por
+// categoria e por página, mais o inventário de imagens com dpi efetivo.
+//
+// 1) cada objeto da xref recebe um tamanho: objetos soltos pelo intervalo até o próximo
+//    offset; objetos dentro de object streams dividem o stream pelo tamanho serializado;
+// 2) a categoria vem do próprio objeto (Subtype/Type) ou de quem o referencia
+//    (FontFile* → fonte, [/ICCBased n] → ICC, /AP de anotação → anotação...);
+// 3) as páginas são percorridas em ordem e cada objeto conta para a PRIMEIRA página que
+//    o alcança (recursos compartilhados não são contados duas vezes); o que nenhuma página
+//    alcança fica no nível do documento;
+// 4) os content streams são interpretados (gsx_scan_page_images) para achar a área
+//    ocupada por cada imagem e daí o dpi efetivo.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+using namespace gsx_pdf;
+
+namespace {
+
+enum Cat { C_IMAGES, C_FONTS, C_CONTENT, C_ICC, C_METADATA, C_ANNOTS, C_OTHER, C_STRUCTURE, C_COUNT };
+static const char* kCatNames[C_COUNT] = {
+  "images", "fonts", "content", "icc", "metadata", "annotations", "other", "structure"
+};
+static const int kNoHint = -1;
+
+struct ObjInfo {
+  bool present = false;
+  bool is_stream = false;
+  Obj value;
+  uint64_t bytes = 0;
+  int self_cat = C_OTHER;
+  int hint = kNoHint;
+};
+
+struct Analyzer {
+  Document& doc;
+  std::vector<ObjInfo> objs;
+  GsxImageScan scan;
+
+  explicit Analyzer(Document& d) : doc(d) {}
+
+  bool valid(uint32_t n) const { return n > 0 && n < objs.size() && objs[n].present; }
+
+  void hint(const Obj* ref, int cat) {
+    if (!ref) return;
+    if (ref->is_ref()) {
+      uint32_t n = ref->ref_num();
+      if (valid(n) && objs[n].hint == kNoHint) objs[n].hint = cat;
+    } else if (ref->is_array()) {
+      for (auto& x : *ref->arr) hint(&x, cat);
+    }
+  }
+
+  // ---------- 1) tamanhos e carga ----------
+  void load_all() {
+    const auto& xr = doc.xref();
+    objs.assign(xr.size(), ObjInfo());
+
+    std::vector<std::pair<uint64_t, uint32_t>> by_off;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> in_stm;
+    for (uint32_t n = 1; n < xr.size(); ++n) {
+      if (xr[n].type == 1) by_off.emplace_back(xr[n].off, n);
+      else if (xr[n].type == 2) in_stm[(uint32_t)xr[n].off].push_back(n);
+    }
+    std::sort(by_off.begin(), by_off.end());
+
+    for (uint32_t n = 1; n < xr.size(); ++n) {
+      if (!xr[n].type) continue;
+      Indirect ind;
+      if (!doc.load(n, ind)) continue;
+      ObjInfo& o = objs[n];
+      o.present = true;
+      o.is_stream = ind.is_stream;
+      o.value = std::move(ind.value);
+      if (ind.is_stream) o.bytes = ind.stream_len;   // piso; o intervalo abaixo inclui o dicionário
+    }
+
+    for (size_t k = 0; k < by_off.size(); ++k) {
+      uint32_t n = by_off[k].second;
+      if (!objs[n].present) continue;
+      uint64_t end = (k + 1 < by_off.size()) ? by_off[k + 1].first : (uint64_t)doc.size();
+      uint64_t span = end - by_off[k].first;
+      // o último objeto vai até a xref/trailer: limita ao "endobj"
+      if (k + 1 == by_off.size()) {
+        const uint8_t* p = doc.data() + by_off[k].first;
+        size_t left = (size_t)(doc.size() - by_off[k].first);
+        size_t from = objs[n].is_stream ? std::min<size_t>(left, (size_t)objs[n].bytes) : 0;
+        for (size_t i = from; i + 6 <= left; ++i)
+          if (memcmp(p + i, "endobj", 6) == 0) { span = i + 6; break; }
+      }
+      objs[n].bytes = std::max<uint64_t>(objs[n].bytes, span);
+    }
+
+    // object streams: o stream compactado é repartido entre os objetos que contém
+    for (auto& kv : in_stm) {
+      uint32_t stm = kv.first;
+      if (!valid(stm)) continue;
+      std::vector<uint64_t> w(kv.second.size(), 1);
+      uint64_t sum = 0;
+      std::string tmp;
+      for (size_t i = 0; i < kv.second.size(); ++i) {
+        uint32_t n = kv.second[i];
+        if (!valid(n)) continue;
+        tmp.clear();
+        serialize(objs[n].value, tmp);
+        w[i] = tmp.size() + 1;
+        sum += w[i];
+      }
+      uint64_t total = objs[stm].bytes, given = 0;
+      for (size_t i = 0; i < kv.second.size() && sum; ++i) {
+        uint32_t n = kv.second[i];
+        if (!valid(n)) continue;
+        uint64_t share = total * w[i] / sum;
+        objs[n].bytes = share;
+        given += share;
+      }
+      objs[stm].bytes = total - given;    // sobra (arredondamento/índice) = estrutura
+    }
+  }
+
+  // ---------- 2) categorias ----------
+  void scan_icc(const Obj& o, int depth) {
+    if (depth > 16) return;
+    if (o.is_array()) {
+      auto& a = *o.arr;
+      if (a.size() >= 2 && a[0].is_name("ICCBased")) hint(&a[1], C_ICC);
+      for (auto& x : a) scan_icc(x, depth + 1);
+    } else if (o.is_dict()) {
+      for (auto& kv : *o.dict) scan_icc(kv.second, depth + 1);
+    }
+  }
+
+  static bool is_annot(const Obj& d) {
+    const Obj* t = d.get("Type");
+    if (t && t->is_name("Annot")) return true;
+    return d.get("Rect") && d.get("Subtype") && !d.get("Kids");
+  }
+
+  void classify() {
+    for (uint32_t n = 1; n < objs.size(); ++n) {
+      ObjInfo& o = objs[n];
+      if (!o.present) continue;
+      const Obj& v = o.value;
+      const Obj* type = v.get("Type");
+      const Obj* sub = v.get("Subtype");
+      auto type_is = [&](const char* t){ return type && type->is_name(t); };
+
+      if (o.is_stream) {
+        if (sub && sub->is_name("Image")) o.self_cat = C_IMAGES;
+        else if (sub && sub->is_name("Form")) o.self_cat = C_CONTENT;
+        else if (type_is("Metadata") || (sub && sub->is_name("XML"))) o.self_cat = C_METADATA;
+        else if (type_is("ObjStm") || type_is("XRef")) o.self_cat = C_STRUCTURE;
+        else if (type_is("CMap")) o.self_cat = C_FONTS;
+        else o.self_cat = C_OTHER;
+      } else if (v.is_dict()) {
+        if (type_is("Font") || type_is("FontDescriptor") || type_is("Encoding")) o.self_cat = C_FONTS;
+        else if (type_is("Page") || type_is("Pages") || type_is("Catalog")) o.self_cat = C_STRUCTURE;
+        else if (is_annot(v)) o.self_cat = C_ANNOTS;
+        else o.self_cat = C_OTHER;
+      }
+
+      if (v.is_dict()) {
+        if (type_is("FontDescriptor")) {
+          hint(v.get("FontFile"), C_FONTS);
+          hint(v.get("FontFile2"), C_FONTS);
+          hint(v.get("FontFile3"), C_FONTS);
+          hint(v.get("CIDSet"), C_FONTS);
+        }
+        if (type_is("Font")) {
+          hint(v.get("ToUnicode"), C_FONTS);
+          hint(v.get("FontDescriptor"), C_FONTS);
+          hint(v.get("DescendantFonts"), C_FONTS);
+          hint(v.get("Encoding"), C_FONTS);
+          hint(v.get("Widths"), C_FONTS);
+          hint(v.get("W"), C_FONTS);
+          const Obj* cp = v.get("CharProcs");
+          hint(cp, C_FONTS);
+          Obj cpd = cp ? doc.resolve(*cp) : Obj();
+          if (cpd.is_dict()) for (auto& kv : *cpd.dict) hint(&kv.second, C_FONTS);
+        }
+        if (type_is("Page")) {
+          const Obj* c = v.get("Contents");
+          hint(c, C_CONTENT);
+          if (c && c->is_ref() && valid(c->ref_num()) && objs[c->ref_num()].value.is_array())
+            hint(&objs[c->ref_num()].value, C_CONTENT);
+          const Obj* an = v.get("Annots");
+          hint(an, C_ANNOTS);
+          if (an && an->is_ref() && valid(an->ref_num())) hint(&objs[an->ref_num()].value, C_ANNOTS);
+        }
+        if (is_annot(v)) {
+          // /AP << /N fluxo | << /Estado fluxo ... >> >>
+          Obj ap = doc.get(v, "AP");
+          hint(v.get("AP"), C_ANNOTS);
+          if (ap.is_dict()) {
+            for (auto& kv : *ap.dict) {
+              hint(&kv.second, C_ANNOTS);
+              if (kv.second.is_ref() && valid(kv.second.ref_num()) && objs[kv.second.ref_num()].is_stream) continue;
+              Obj states = doc.resolve(kv.second);
+              if (states.is_dict()) for (auto& st : *states.dict) hint(&st.second, C_ANNOTS);
+            }
+          }
+          hint(v.get("Popup"), C_ANNOTS);
+        }
+        hint(v.get("Metadata"), C_METADATA);
+      }
+      scan_icc(v, 0);
+    }
+  }
+
+  int category(uint32_t n) const {
+    const ObjInfo& o = objs[n];
+    if (o.self_cat == C_STRUCTURE || o.self_cat == C_IMAGES) return o.self_cat;
+    return o.hint != kNoHint ? o.hint : o.self_cat;
+  }
+
+  // ---------- 3) atribuição por página (primeiro uso) ----------
+  std::vector<char> seen;
+
+  void claim(const Obj& o, uint64_t* cats, int depth) {
+    if (depth > 64) return;
+    if (o.is_ref()) {
+      uint32_t n = o.ref_num();
+      if (!valid(n) || seen[n]) return;
+      const Obj* t = objs[n].value.get("Type");
+      if (t && (t->is_name("Page") || t->is_name("Pages"))) return;   // outras páginas/árvore
+      seen[n] = 1;
+      cats[category(n)] += objs[n].bytes;
+      claim(objs[n].value, cats, depth + 1);
+    } else if (o.is_array()) {
+      for (auto& x : *o.arr) claim(x, cats, depth + 1);
+    } else if (o.is_dict()) {
+      for (auto& kv : *o.dict) if (kv.first != "Parent") claim(kv.second, cats, depth + 1);
+    }
+  }
+};
+
+static std::string name_list(Document& doc, const Obj& v) {
+  Obj r = doc.resolve(v);
+  if (r.is_name()) return r.s;
+  std::string out;
+  if (r.is_array()) {
+    for (auto& x : *r.arr) {
+      Obj e = doc.resolve(x);
+      if (!e.is_name()) continue;
+      if (!out.empty()) out += "+";
+      out += e.s;
+    }
+  }
+  return out;
+}
+
+static std::string colorspace_name(Document& doc, const Obj& v) {
+  Obj r = doc.resolve(v);
+  if (r.is_name()) return r.s;
+  if (r.is_array() && !r.arr->empty()) {
+    Obj head = doc.resolve((*r.arr)[0]);
+    if (!head.is_name()) return "";
+    if (head.s == "ICCBased" && r.arr->size() >= 2) {
+      Indirect ind;
+      const Obj& ref = (*r.arr)[1];
+      if (ref.is_ref() && doc.load(ref.ref_num(), ind)) {
+        const Obj* n = ind.value.get("N");
+        if (n) return "ICCBased(" + std::to_string(n->as_int(0)) + ")";
+      }
+    }
+    return head.s;
+  }
+  return "";
+}
+
+static void append_cats(std::string& js, const uint64_t* cats) {
+  js += "{";
+  for (int c = 0; c < C_COUNT; ++c) {
+    if (c) js += ",";
+    js += "\"" + std::string(kCatNames[c]) + "\":" + std::to_string(cats[c]);
+  }
+  js += "}";
+}
+
+static std::string fmt1(double v) {
+  char b[32];
+  snprintf(b, sizeof(b), "%.1f", v);
+  return b;
+}
+
+}  // namespace
+
+GSX_API int gsx_analyze(const char* in_path, char** json_out)
+{
+  if (!in_path || !json_out) {
+    set_last_error_json(GSX_E_ARGS, "analyze", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  *json_out = nullptr;
+  Document doc;
+  if (!doc.open(in_path)) {
+    int rc = doc.os_errno() ? GSX_E_INPUT_NOT_FOUND : GSX_E_PDF_PARSE;
+    set_last_error_json(rc, "analyze.open", doc.os_errno(), 0, nullptr);
+    return rc;
+  }
+  if (doc.encrypted()) {
+    set_last_error_json(GSX_E_PDF_ENCRYPTED, "analyze.open", 0, 0, nullptr);
+    return GSX_E_PDF_ENCRYPTED;
+  }
+  std::vector<PageInfo> pages;
+  if (!doc.pages(pages)) {
+    set_last_error_json(GSX_E_PDF_PARSE, "analyze.pages", 0, 0, nullptr);
+    return GSX_E_PDF_PARSE;
+  }
+
+  Analyzer an(doc);
+  an.load_all();
+  an.classify();
+  an.seen.assign(an.objs.size(), 0);
+
+  // totais por página (primeiro uso) + dpi
+  std::vector<std::vector<uint64_t>> per_page(pages.size(), std::vector<uint64_t>(C_COUNT, 0));
+  for (size_t k = 0; k < pages.size(); ++k) {
+    uint64_t* cats = per_page[k].data();
+    uint32_t pn = pages[k].num;
+    if (an.valid(pn) && !an.seen[pn]) {
+      an.seen[pn] = 1;
+      cats[C_STRUCTURE] += an.objs[pn].bytes;
+    }
+    // recursos herdados também pertencem à página
+    Obj d = pages[k].dict;
+    if (!d.get("Resources") && !pages[k].resources.is_null()) {
+      if (d.dict) d.dict = std::make_shared<Dict>(*d.dict);
+      d.set("Resources", pages[k].resources);
+    }
+    an.claim(d, cats, 0);
+    gsx_scan_page_images(doc, pages[k], (int)k + 1, an.scan);
+  }
+
+  // nível do documento: objetos que nenhuma página alcança + bytes fora de objetos
+  uint64_t doc_cats[C_COUNT] = {0};
+  uint64_t totals[C_COUNT] = {0};
+  uint64_t accounted = 0;
+  for (uint32_t n = 1; n < an.objs.size(); ++n) {
+    if (!an.objs[n].present) continue;
+    accounted += an.objs[n].bytes;
+    if (!an.seen[n]) doc_cats[an.category(n)] += an.objs[n].bytes;
+  }
+  if (doc.size() > accounted) doc_cats[C_STRUCTURE] += doc.size() - accounted;   // header, xref, trailer
+  for (int c = 0; c < C_COUNT; ++c) {
+    totals[c] = doc_cats[c];
+    for (auto& pp : per_page) totals[c] += pp[(size_t)c];
+  }
+
+  std::string js;
+  js.reserve(4096 + pages.size() * 160 + an.scan.images.size() * 200);
+  js += "{\"file_size\":" + std::to_string(doc.size());
+  js += ",\"version\":\"" + std::to_string(doc.version() / 10) + "." + std::to_string(doc.version() % 10) + "\"";
+  js += ",\"pages\":" + std::to_string(pages.size());
+  js += ",\"objects\":" + std::to_string(doc.object_count());
+  js += ",\"xref_health\":" + std::to_string((int)doc.health());
+  js += ",\"categories\":";
+  append_cats(js, totals);
+  js += ",\"document_level\":";
+  append_cats(js, doc_cats);
+
+  js += ",\"per_page\":[";
+  for (size_t k = 0; k < per_page.size(); ++k) {
+    uint64_t t = 0;
+    for (uint64_t v : per_page[k]) t += v;
+    if (k) js += ",";
+    js += "{\"page\":" + std::to_string(k + 1) + ",\"total\":" + std::to_string(t) + ",\"bytes\":";
+    append_cats(js, per_page[k].data());
+    js += "}";
+  }
+  js += "]";
+
+  // inventário de imagens (todas as XObject Image, usadas ou não)
+  js += ",\"images\":[";
+  bool first = true;
+  double max_dpi = 0;
+  for (uint32_t n = 1; n < an.objs.size(); ++n) {
+    const ObjInfo& o = an.objs[n];
+    if (!o.present || !o.is_stream) continue;
+    const Obj* sub = o.value.get("Subtype");
+    if (!sub || !sub->is_name("Image")) continue;
+    const Obj& v = o.value;
+    int64_t w = doc.get(v, "Width").as_int(0), h = doc.get(v, "Height").as_int(0);
+    Obj bpc = doc.get(v, "BitsPerComponent");
+    Obj mask = doc.get(v, "ImageMask");
+    if (!first) js += ",";
+    first = false;
+    js += "{\"obj\":" + std::to_string(n);
+    js += ",\"width\":" + std::to_string(w) + ",\"height\":" + std::to_string(h);
+    js += ",\"bpc\":" + std::to_string(mask.type == Type::Bool && mask.b ? 1 : bpc.as_int(0));
+    js += ",\"colorspace\":\"" + gsx_json_escape(mask.type == Type::Bool && mask.b ? "ImageMask" : colorspace_name(doc, v.get("ColorSpace") ? *v.get("ColorSpace") : Obj())) + "\"";
+    js += ",\"filter\":\"" + gsx_json_escape(v.get("Filter") ? name_list(doc, *v.get("Filter")) : "") + "\"";
+    js += ",\"bytes\":" + std::to_string(o.bytes);
+    js += ",\"smask\":" + std::string(v.get("SMask") ? "true" : "false");
+    if (w > 0 && h > 0)
+      js += ",\"bits_per_pixel\":" + fmt1((double)o.bytes * 8.0 / ((double)w * (double)h));
+    auto it = an.scan.images.find(n);
+    if (it != an.scan.images.end() && it->second.w_pt > 0 && it->second.h_pt > 0) {
+      const GsxImageUse& u = it->second;
+      double dx = (double)w * 72.0 / u.w_pt, dy = (double)h * 72.0 / u.h_pt;
+      max_dpi = std::max(max_dpi, std::min(dx, dy));
+      js += ",\"placements\":" + std::to_string(u.placements);
+      js += ",\"dpi_x\":" + fmt1(dx) + ",\"dpi_y\":" + fmt1(dy);
+      js += ",\"pages\":[";
+      for (size_t i = 0; i < u.pages.size(); ++i) { if (i) js += ","; js += std::to_string(u.pages[i]); }
+      js += "]";
+    } else {
+      js += ",\"placements\":0";
+    }
+    js += "}";
+  }
+  js += "]";
+  js += ",\"max_image_dpi\":" + fmt1(max_dpi);
+  js += ",\"inline_images\":{\"count\":" + std::to_string(an.scan.inline_images) +
+        ",\"bytes\":" + std::to_string(an.scan.inline_bytes) + "}";
+  js += "}";
+
+  *json_out = gsx_dup_string(js);
+  if (!*json_out) {
+    set_last_error_json(GSX_E_UNKNOWN, "analyze.alloc", 0, 0, nullptr);
+    return GSX_E_UNKNOWN;
+  }
+  set_last_error_json(GSX_OK, "analyze", 0, 0, nullptr);
+  return GSX_OK;
+}
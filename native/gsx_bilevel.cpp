@@ -0,0 +1,550 @@
+// gsx_bilevel.cpp — motor P&B nativo (gsx_bilevel_pdf)
+//
+// Renderiza as páginas em cinza (pgmraw, com anti-aliasing) direto para a memória,
+// binariza com limiar adaptativo (Sauvola por janela deslizante ou Otsu por ladrilho),
+// remove manchas pequenas e grava cada página como uma imagem 1-bpp (CCITT G4 ou JBIG2
+// genérico) num PDF novo.
+// Cada worker tem sua instância do Ghostscript e processa a página assim que ela
+// chega no stdout; só a imagem comprimida (dezenas de KB) fica em memória até ser gravada.
+//
+// O resultado é só imagem: o texto vira pixels. É o destino certo para papelada
+// digitalizada; para PDFs nascidos digitais o pdfwrite (modo cinza) preserva o texto.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+namespace fs = std::filesystem;
+using namespace gsx_pdf;
+
+static const int   kDefaultDpi = 300;
+static const float kDefaultK = 0.34f;
+static const float kSauvolaR = 128.0f;     // faixa dinâmica do desvio padrão (8 bits)
+static const int   kOtsuMinSpread = 24;    // ladrilho com max-min menor que isto não tem contraste
+
+// ======================= Sauvola =======================
+// T(x,y) = m · (1 + k · (s/R − 1)), com média m e desvio s na janela centrada.
+// As somas da janela vêm de acumuladores por coluna (atualizados linha a linha) e de
+// uma soma de prefixos na horizontal; o limiar e a comparação ficam com gsx_sauvola_row
+// (SIMD, ver gsx_kernels.cpp).
+
+void gsx_binarize_sauvola(const uint8_t* gray, int w, int h, int window, float k, uint8_t* out) {
+  const int r = std::max(1, window / 2);
+  std::vector<uint32_t> col_s((size_t)w, 0), col_q((size_t)w, 0);
+  std::vector<uint64_t> ps((size_t)w + 1), pq((size_t)w + 1);
+  std::vector<float> mean((size_t)w), var((size_t)w);
+
+  auto add_row = [&](int y, int sign) {
+    const uint8_t* g = gray + (size_t)y * (size_t)w;
+    if (sign > 0) for (int x = 0; x < w; ++x) { col_s[x] += g[x]; col_q[x] += (uint32_t)g[x] * g[x]; }
+    else          for (int x = 0; x < w; ++x) { col_s[x] -= g[x]; col_q[x] -= (uint32_t)g[x] * g[x]; }
+  };
+  for (int y = 0; y <= std::min(r, h - 1); ++y) add_row(y, +1);
+
+  for (int y = 0; y < h; ++y) {
+    const int ny = std::min(h - 1, y + r) - std::max(0, y - r) + 1;
+    ps[0] = pq[0] = 0;
+    for (int x = 0; x < w; ++x) { ps[x + 1] = ps[x] + col_s[x]; pq[x + 1] = pq[x] + col_q[x]; }
+    for (int x = 0; x < w; ++x) {
+      const int x0 = std::max(0, x - r), x1 = std::min(w - 1, x + r);
+      const double n = (double)((x1 - x0 + 1) * ny);
+      const double m = (double)(ps[x1 + 1] - ps[x0]) / n;
+      mean[x] = (float)m;
+      var[x] = (float)((double)(pq[x1 + 1] - pq[x0]) / n - m * m);
+    }
+    gsx_sauvola_row(mean.data(), var.data(), gray + (size_t)y * (size_t)w, w, k, kSauvolaR, out + (size_t)y * (size_t)w);
+
+    if (y + r + 1 < h) add_row(y + r + 1, +1);
+    if (y - r >= 0) add_row(y - r, -1);
+  }
+}
+
+// ======================= Otsu por ladrilho =======================
+static int otsu(const uint32_t* hist, uint64_t n) {
+  if (!n) return 127;
+  double sum = 0;
+  for (int i = 0; i < 256; ++i) sum += (double)i * hist[i];
+  double sum_b = 0, best = -1;
+  uint64_t wb = 0;
+  int t = 127;
+  for (int i = 0; i < 256; ++i) {
+    wb += hist[i];
+    if (!wb) continue;
+    uint64_t wf = n - wb;
+    if (!wf) break;
+    sum_b += (double)i * hist[i];
+    double mb = sum_b / (double)wb, mf = (sum - sum_b) / (double)wf;
+    double between = (double)wb * (double)wf * (mb - mf) * (mb - mf);
+    if (between > best) { best = between; t = i; }
+  }
+  return t;
+}
+
+void gsx_binarize_otsu_tiles(const uint8_t* gray, int w, int h, int tile, uint8_t* out) {
+  tile = std::max(16, tile);
+  const int tx = (w + tile - 1) / tile, ty = (h + tile - 1) / tile;
+  std::vector<float> thr((size_t)tx * (size_t)ty);
+  std::vector<char> flat((size_t)tx * (size_t)ty, 0);
+  uint32_t global[256] = {0};
+
+  for (int j = 0; j < ty; ++j) {
+    for (int i = 0; i < tx; ++i) {
+      uint32_t hist[256] = {0};
+      const int x0 = i * tile, x1 = std::min(w, x0 + tile);
+      const int y0 = j * tile, y1 = std::min(h, y0 + tile);
+      for (int y = y0; y < y1; ++y) {
+        const uint8_t* g = gray + (size_t)y * (size_t)w;
+        for (int x = x0; x < x1; ++x) ++hist[g[x]];
+      }
+      // contraste pelos percentis 1%..99%: uma mancha isolada não torna o ladrilho "com tinta"
+      const uint64_t n = (uint64_t)(x1 - x0) * (uint64_t)(y1 - y0), cut = n / 100;
+      int lo = 0, hi = 255;
+      for (uint64_t acc = 0; lo < 255 && (acc += hist[lo]) <= cut; ) ++lo;
+      for (uint64_t acc = 0; hi > 0 && (acc += hist[hi]) <= cut; ) --hi;
+      for (int v = 0; v < 256; ++v) global[v] += hist[v];
+      const size_t idx = (size_t)j * (size_t)tx + (size_t)i;
+      flat[idx] = (hi - lo) < kOtsuMinSpread;
+      thr[idx] = (float)otsu(hist, n);
+    }
+  }
+  const float g_thr = (float)otsu(global, (uint64_t)w * (uint64_t)h);
+  for (size_t i = 0; i < thr.size(); ++i) if (flat[i]) thr[i] = g_thr;
+
+  // interpolação bilinear entre centros de ladrilho
+  std::vector<float> row_thr((size_t)w);
+  for (int y = 0; y < h; ++y) {
+    float fy = ((float)y + 0.5f) / (float)tile - 0.5f;
+    int j0 = std::max(0, std::min(ty - 1, (int)std::floor(fy)));
+    int j1 = std::min(ty - 1, j0 + 1);
+    float ay = std::max(0.0f, std::min(1.0f, fy - (float)j0));
+    for (int x = 0; x < w; ++x) {
+      float fx = ((float)x + 0.5f) / (float)tile - 0.5f;
+      int i0 = std::max(0, std::min(tx - 1, (int)std::floor(fx)));
+      int i1 = std::min(tx - 1, i0 + 1);
+      float ax = std::max(0.0f, std::min(1.0f, fx - (float)i0));
+      float t0 = thr[(size_t)j0 * tx + i0] * (1 - ax) + thr[(size_t)j0 * tx + i1] * ax;
+      float t1 = thr[(size_t)j1 * tx + i0] * (1 - ax) + thr[(size_t)j1 * tx + i1] * ax;
+      row_thr[(size_t)x] = t0 * (1 - ay) + t1 * ay;
+    }
+    const uint8_t* g = gray + (size_t)y * (size_t)w;
+    uint8_t* o = out + (size_t)y * (size_t)w;
+    for (int x = 0; x < w; ++x) o[x] = (float)g[x] <= row_thr[(size_t)x] ? 1 : 0;
+  }
+}
+
+// ======================= Despeckle =======================
+// Busca em largura limitada: um componente que passa de max_px é marcado como "fica"
+// sem ser percorrido inteiro, então o custo é O(pixels · max_px) no pior caso.
+size_t gsx_despeckle(uint8_t* bw, int w, int h, int max_px) {
+  if (max_px <= 0) return 0;
+  enum : uint8_t { UNSEEN = 0, KEEP = 1 };
+  std::vector<uint8_t> mark((size_t)w * (size_t)h, UNSEEN);
+  std::vector<size_t> q;
+  q.reserve((size_t)max_px + 8);
+  size_t removed = 0;
+  for (int y = 0; y < h; ++y) {
+    for (int x = 0; x < w; ++x) {
+      const size_t p0 = (size_t)y * (size_t)w + (size_t)x;
+      if (!bw[p0] || mark[p0] == KEEP) continue;
+      q.clear();
+      q.push_back(p0);
+      mark[p0] = 2;
+      bool big = false;
+      for (size_t qi = 0; qi < q.size() && !big; ++qi) {
+        const int cy = (int)(q[qi] / (size_t)w), cx = (int)(q[qi] % (size_t)w);
+        for (int dy = -1; dy <= 1 && !big; ++dy) {
+          for (int dx = -1; dx <= 1; ++dx) {
+            const int nx = cx + dx, ny = cy + dy;
+            if ((!dx && !dy) || nx < 0 || ny < 0 || nx >= w || ny >= h) continue;
+            const size_t pn = (size_t)ny * (size_t)w + (size_t)nx;
+            if (!bw[pn]) continue;
+            if (mark[pn] == KEEP) { big = true; break; }   // encosta num componente grande
+            if (mark[pn] != UNSEEN) continue;
+            mark[pn] = 2;
+            q.push_back(pn);
+            if ((int)q.size() > max_px) { big = true; break; }
+          }
+        }
+      }
+      if (big) {
+        for (size_t p : q) mark[p] = KEEP;
+      } else {
+        for (size_t p : q) { bw[p] = 0; mark[p] = UNSEEN; }
+        removed += q.size();
+      }
+    }
+  }
+  return removed;
+}
+
+// ======================= Pipeline =======================
+namespace {
+
+struct Job {
+  std::string in_path;
+  int first = 0, last = 0;
+  int dpi = kDefaultDpi;
+  int method = GSX_BIN_SAUVOLA;
+  int window = 0;
+  float k = kDefaultK;
+  int despeckle = 0;
+  int codec = GSX_BIN_G4;
+
+  Writer* w = nullptr;
+  std::mutex w_m;
+  bool write_ok = true;
+  uint32_t pages_num = 0;
+  std::vector<uint32_t> page_nums;        // 3 por página: página, conteúdo, imagem
+
+  std::atomic<int> done{0};
+  std::atomic<uint64_t> img_bytes{0};
+  gsx_progress_cb cb = nullptr;
+  void* user = nullptr;
+  std::mutex cb_m;
+
+  // gsx_bilevel_bench: codifica cada página com os dois codecs em vez de gravar
+  struct BenchPage { int page; int w, h; uint64_t g4, jbig2; double g4_ms, jbig2_ms; };
+  bool bench = false;
+  std::vector<BenchPage> bench_pages;     // índice = página - first
+
+  void report_page() {
+    const int n = first + (++done) - 1;
+    if (!cb) return;
+    // mesmo formato do Ghostscript ("Page N"), contado a partir de first_page
+    const std::string line = "Page " + std::to_string(n);
+    std::lock_guard<std::mutex> lk(cb_m);
+    cb(n, last, line.c_str(), user);
+  }
+};
+
+static double ms_since(std::chrono::steady_clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+}
+
+static std::string fmt_num(double v) {
+  char b[32];
+  snprintf(b, sizeof(b), "%.4f", v);
+  std::string s = b;
+  while (!s.empty() && s.back() == '0') s.pop_back();
+  if (!s.empty() && s.back() == '.') s.pop_back();
+  return s;
+}
+
+struct BilevelReader : GsxPnmReader {
+  Job* job = nullptr;
+  int first = 0, count = 0, got = 0;
+  int w = 0, h = 0, ch = 1;
+  std::vector<uint8_t> gray, bw;
+  std::string enc;
+
+  void on_page(int width, int height, int channels) override {
+    w = width; h = height; ch = channels;
+    gray.resize((size_t)w * (size_t)h);
+  }
+
+  void on_row(int y, const uint8_t* row) override {
+    uint8_t* g = gray.data() + (size_t)y * (size_t)w;
+    if (ch == 1) { memcpy(g, row, (size_t)w); return; }
+    gsx_rgb_to_gray(row, g, (size_t)w);
+  }
+
+  void on_page_end() override {
+    if (got >= count) return;
+    const int page = first + got++;
+    Job& j = *job;
+    bw.resize(gray.size());
+    int window = j.window > 0 ? j.window : std::max(15, j.dpi / 12);
+    if (j.method == GSX_BIN_OTSU) gsx_binarize_otsu_tiles(gray.data(), w, h, window * 4, bw.data());
+    else gsx_binarize_sauvola(gray.data(), w, h, window | 1, j.k, bw.data());
+    int speck = j.despeckle > 0 ? j.despeckle
+              : (j.despeckle == 0 ? std::max(1, j.dpi * j.dpi / 30000) : 0);
+    gsx_despeckle(bw.data(), w, h, speck);
+    if (j.bench) { bench_page(page); return; }
+    enc.clear();
+    if (j.codec == GSX_BIN_JBIG2) gsx_jbig2_encode(bw.data(), w, h, j.dpi, enc);
+    else gsx_g4_encode(bw.data(), w, h, enc);
+    j.img_bytes += enc.size();
+    write_page(page);
+  }
+
+  void bench_page(int page) {
+    Job& j = *job;
+    Job::BenchPage& bp = j.bench_pages[(size_t)(page - j.first)];
+    bp.page = page;
+    bp.w = w;
+    bp.h = h;
+    auto t0 = std::chrono::steady_clock::now();
+    enc.clear();
+    gsx_g4_encode(bw.data(), w, h, enc);
+    bp.g4_ms = ms_since(t0);
+    bp.g4 = enc.size();
+    t0 = std::chrono::steady_clock::now();
+    enc.clear();
+    gsx_jbig2_encode(bw.data(), w, h, j.dpi, enc);
+    bp.jbig2_ms = ms_since(t0);
+    bp.jbig2 = enc.size();
+    j.report_page();
+  }
+
+  void write_page(int page) {
+    Job& j = *job;
+    const size_t base = (size_t)(page - j.first) * 3;
+    const uint32_t page_num = j.page_nums[base], cont_num = j.page_nums[base + 1], img_num = j.page_nums[base + 2];
+    const double wpt = (double)w * 72.0 / (double)j.dpi, hpt = (double)h * 72.0 / (double)j.dpi;
+
+    Obj img = Obj::make_dict();
+    img.set("Type", Obj::make_name("XObject"));
+    img.set("Subtype", Obj::make_name("Image"));
+    img.set("Width", Obj::make_int(w));
+    img.set("Height", Obj::make_int(h));
+    img.set("ColorSpace", Obj::make_name("DeviceGray"));
+    img.set("BitsPerComponent", Obj::make_int(1));
+    if (j.codec == GSX_BIN_JBIG2) {
+      img.set("Filter", Obj::make_name("JBIG2Decode"));
+    } else {
+      Obj parms = Obj::make_dict();
+      parms.set("K", Obj::make_int(-1));
+      parms.set("Columns", Obj::make_int(w));
+      parms.set("Rows", Obj::make_int(h));
+      img.set("Filter", Obj::make_name("CCITTFaxDecode"));
+      img.set("DecodeParms", parms);
+    }
+
+    const std::string content = "q " + fmt_num(wpt) + " 0 0 " + fmt_num(hpt) + " 0 0 cm /Im0 Do Q";
+
+    Obj box = Obj::make_array();
+    box.arr->push_back(Obj::make_int(0));
+    box.arr->push_back(Obj::make_int(0));
+    box.arr->push_back(Obj::make_real(wpt));
+    box.arr->push_back(Obj::make_real(hpt));
+    Obj xo = Obj::make_dict();
+    xo.set("Im0", Obj::make_ref(img_num));
+    Obj res = Obj::make_dict();
+    res.set("XObject", xo);
+    Obj pg = Obj::make_dict();
+    pg.set("Type", Obj::make_name("Page"));
+    pg.set("Parent", Obj::make_ref(j.pages_num));
+    pg.set("MediaBox", box);
+    pg.set("Resources", res);
+    pg.set("Contents", Obj::make_ref(cont_num));
+
+    {
+      std::lock_guard<std::mutex> lk(j.w_m);
+      j.write_ok = j.write_ok &&
+          j.w->write_stream(img_num, img, (const uint8_t*)enc.data(), enc.size()) &&
+          j.w->write_stream(cont_num, Obj::make_dict(), (const uint8_t*)content.data(), content.size()) &&
+          j.w->write_object(page_num, pg);
+    }
+    j.report_page();
+  }
+};
+
+static int render_range(Job& j, int first, int last, volatile int* cancel_flag) {
+  std::vector<std::string> A = {
+    "gs", "-dSAFER", "-dBATCH", "-dNOPAUSE", "-dQUIET", "-sstdout=%stderr",
+    "-sDEVICE=pgmraw", "-r" + std::to_string(j.dpi),
+    "-dTextAlphaBits=4", "-dGraphicsAlphaBits=4",
+    "-dFirstPage=" + std::to_string(first), "-dLastPage=" + std::to_string(last),
+    "-sOutputFile=-", j.in_path
+  };
+  BilevelReader rd;
+  rd.job = &j;
+  rd.first = first;
+  rd.count = last - first + 1;
+  int rc = gsx_run_gs_raw(A, &GsxPnmReader::sink, &rd, nullptr, nullptr, cancel_flag);
+  if (rc < 0) return rc;
+  if (rd.got < rd.count) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "bilevel: %d de %d páginas renderizadas (%d-%d)", rd.got, rd.count, first, last);
+    set_last_error_json(GSX_E_UNKNOWN, "bilevel.render", 0, 0, nullptr);
+    gsx_log_msg(GSX_LOG_ERROR, msg);
+    return GSX_E_UNKNOWN;
+  }
+  return GSX_OK;
+}
+
+static bool opts_valid(const gsx_bilevel_opts_t* o) {
+  return !o || (o->dpi >= 0 && o->dpi <= 1200 && o->k >= 0 && o->k <= 1 &&
+                (o->codec == GSX_BIN_G4 || o->codec == GSX_BIN_JBIG2));
+}
+
+static void apply_opts(Job& j, const gsx_bilevel_opts_t* o) {
+  if (!o) return;
+  if (o->dpi > 0) j.dpi = o->dpi;
+  j.method = o->method;
+  j.window = o->window;
+  if (o->k > 0) j.k = o->k;
+  j.despeckle = o->despeckle;
+  j.codec = o->codec;
+}
+
+}  // namespace
+
+GSX_API int gsx_bilevel_pdf(
+  const char* in_path,
+  const char* out_path,
+  int first_page,
+  int last_page,
+  const gsx_bilevel_opts_t* opts,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  GsxJobScope scope("gsx_bilevel_pdf", in_path, out_path);
+  GsxSpan span("bilevel");
+  if (!in_path || !out_path || first_page < 0 || last_page < 0 || !opts_valid(opts)) {
+    set_last_error_json(GSX_E_ARGS, "bilevel", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  std::error_code ec;
+  if (fs::equivalent(in_path, out_path, ec)) {
+    set_last_error_json(GSX_E_ARGS, "bilevel.same_path", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  auto t0 = std::chrono::steady_clock::now();
+
+  Job j;
+  j.in_path = in_path;
+  j.first = first_page;
+  j.last = last_page;
+  std::vector<uint64_t> weights;
+  int rc = gsx_page_weights(in_path, j.first, j.last, weights);
+  if (rc < 0) return rc;
+  apply_opts(j, opts);
+  j.cb = on_progress;
+  j.user = user;
+  const int total = j.last - j.first + 1;
+
+  fs::create_directories(fs::path(out_path).parent_path(), ec);
+  Writer w;
+  if (!w.open(out_path, 14)) {
+    set_last_error_json(GSX_E_WRITE_OPEN, "bilevel.out", w.os_errno(), 0, nullptr);
+    return GSX_E_WRITE_OPEN;
+  }
+  j.w = &w;
+  const uint32_t catalog_num = w.reserve();
+  j.pages_num = w.reserve();
+  j.page_nums.resize((size_t)total * 3);
+  for (auto& n : j.page_nums) n = w.reserve();
+
+  int used = 0;
+  rc = gsx_run_weighted(weights, j.first, opts ? opts->workers : 0,
+                        [&](int a, int b) { return render_range(j, a, b, cancel_flag); },
+                        cancel_flag, &used);
+  if (rc >= 0 && j.write_ok) {
+    Obj kids = Obj::make_array();
+    for (int i = 0; i < total; ++i) kids.arr->push_back(Obj::make_ref(j.page_nums[(size_t)i * 3]));
+    Obj pages_dict = Obj::make_dict();
+    pages_dict.set("Type", Obj::make_name("Pages"));
+    pages_dict.set("Kids", kids);
+    pages_dict.set("Count", Obj::make_int(total));
+    Obj catalog = Obj::make_dict();
+    catalog.set("Type", Obj::make_name("Catalog"));
+    catalog.set("Pages", Obj::make_ref(j.pages_num));
+    Obj trailer = Obj::make_dict();
+    trailer.set("Root", Obj::make_ref(catalog_num));
+    j.write_ok = w.write_object(j.pages_num, pages_dict) && w.write_object(catalog_num, catalog) &&
+                 w.finish(trailer);
+  }
+  if (rc >= 0 && !j.write_ok) {
+    rc = GSX_E_WRITE_IO;
+    set_last_error_json(rc, "bilevel.write", w.os_errno(), 0, nullptr);
+  } else if (rc == GSX_E_CANCELED) {
+    set_last_error_json(rc, "bilevel", 0, 0, nullptr);
+  }
+  if (rc < 0) {
+    w.close();
+    fs::remove(out_path, ec);
+    return rc;
+  }
+
+  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+  std::string msg = "bilevel_pdf: " + std::to_string(total) + " páginas a " + std::to_string(j.dpi) +
+                    " dpi, " + std::to_string(used) + " workers, " +
+                    (j.codec == GSX_BIN_JBIG2 ? "JBIG2 " : "G4 ") + std::to_string(j.img_bytes.load()) +
+                    " bytes, saída " + std::to_string(w.bytes_written()) +
+                    " bytes em " + std::to_string((long long)ms) + " ms";
+  gsx_log_msg(GSX_LOG_INFO, msg.c_str());
+  set_last_error_json(GSX_OK, "bilevel", 0, 0, nullptr);
+  return total;
+}
+
+GSX_API int gsx_bilevel_bench(
+  const char* in_path,
+  int first_page,
+  int last_page,
+  const gsx_bilevel_opts_t* opts,
+  char** json_out,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  if (!in_path || !json_out || first_page < 0 || last_page < 0 || !opts_valid(opts)) {
+    set_last_error_json(GSX_E_ARGS, "bilevel_bench", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  *json_out = nullptr;
+  Job j;
+  j.in_path = in_path;
+  j.first = first_page;
+  j.last = last_page;
+  std::vector<uint64_t> weights;
+  int rc = gsx_page_weights(in_path, j.first, j.last, weights);
+  if (rc < 0) return rc;
+  apply_opts(j, opts);
+  j.cb = on_progress;
+  j.user = user;
+  j.bench = true;
+  const int total = j.last - j.first + 1;
+  j.bench_pages.assign((size_t)total, Job::BenchPage{0, 0, 0, 0, 0, 0, 0});
+
+  auto t0 = std::chrono::steady_clock::now();
+  int used = 0;
+  rc = gsx_run_weighted(weights, j.first, opts ? opts->workers : 0,
+                        [&](int a, int b) { return render_range(j, a, b, cancel_flag); },
+                        cancel_flag, &used);
+  if (rc < 0) {
+    if (rc == GSX_E_CANCELED) set_last_error_json(rc, "bilevel_bench", 0, 0, nullptr);
+    return rc;
+  }
+  const double wall_ms = ms_since(t0);
+
+  // vazão = megapixels por segundo de CPU de codificação (soma das páginas)
+  uint64_t px = 0, g4 = 0, jb = 0;
+  double g4_ms = 0, jb_ms = 0;
+  std::string pages = "[";
+  for (size_t i = 0; i < j.bench_pages.size(); ++i) {
+    const Job::BenchPage& b = j.bench_pages[i];
+    px += (uint64_t)b.w * (uint64_t)b.h;
+    g4 += b.g4;
+    jb += b.jbig2;
+    g4_ms += b.g4_ms;
+    jb_ms += b.jbig2_ms;
+    if (i) pages += ",";
+    pages += "{\"page\":" + std::to_string(b.page) + ",\"width\":" + std::to_string(b.w) +
+             ",\"height\":" + std::to_string(b.h) + ",\"g4\":" + std::to_string(b.g4) +
+             ",\"jbig2\":" + std::to_string(b.jbig2) + ",\"g4_ms\":" + fmt_num(b.g4_ms) +
+             ",\"jbig2_ms\":" + fmt_num(b.jbig2_ms) + "}";
+  }
+  pages += "]";
+  auto codec = [&](uint64_t bytes, double ms) {
+    return "{\"bytes\":" + std::to_string(bytes) + ",\"encode_ms\":" + fmt_num(ms) +
+           ",\"mpx_per_s\":" + fmt_num(ms > 0 ? (double)px / 1000.0 / ms : 0) + "}";
+  };
+  std::string js = "{\"pages\":" + std::to_string(total) + ",\"dpi\":" + std::to_string(j.dpi) +
+                   ",\"workers\":" + std::to_string(used) + ",\"pixels\":" + std::to_string(px) +
+                   ",\"wall_ms\":" + fmt_num(wall_ms) + ",\"g4\":" + codec(g4, g4_ms) +
+                   ",\"jbig2\":" + codec(jb, jb_ms) +
+                   ",\"jbig2_vs_g4\":" + fmt_num(g4 ? (double)jb / (double)g4 : 0) +
+                   ",\"per_page\":" + pages + "}";
+  *json_out = gsx_dup_string(js);
+  set_last_error_json(GSX_OK, "bilevel_bench", 0, 0, nullptr);
+  return total;
+}
@@ -2,8 +2,12 @@
 
 // compilar com 
 // C:\Program Files\gs\ghostpdl-10.06.0\psi\iapi.h
+// C:\Program Files\gs\ghostpdl-10.06.0\devices\gdevdsp.h (device display, gsx_render.cpp)
 // C:\Program Files\gs\gs10.06.0\bin\gsdll64.lib
-// cl /LD /O2 /EHsc /std:c++17 /MD /I"C:\Program Files\gs\ghostpdl-10.06.0\psi" gsx_bridge.cpp /link /OUT:gsx_bridge.dll /MACHINE:X64 /LIBPATH:"C:\Program Files\gs\gs10.06.0\bin" gsdll64.lib
+// zlib (p.ex. vcpkg: C:\vcpkg\installed\x64-windows) — usado pelo leitor PDF nativo (gsx_pdf.cpp)
+// libjpeg-turbo (vcpkg: libjpeg-turbo) — fundo JPEG do modo MRC (gsx_mrc.cpp)
+// cl /LD /O2 /EHsc /std:c++17 /MD /I"C:\Program Files\gs\ghostpdl-10.06.0\psi" /I"C:\Program Files\gs\ghostpdl-10.06.0\devices" /I"C:\vcpkg\installed\x64-windows\include" gsx_*.cpp /link /OUT:gsx_bridge.dll /MACHINE:X64 /LIBPATH:"C:\Program Files\gs\gs10.06.0\bin" /LIBPATH:"C:\vcpkg\installed\x64-windows\lib" gsdll64.lib zlib.lib jpeg.lib
+// Linux: g++ -std=c++17 -O2 -fPIC -shared -I<ghostpdl>/psi -I<ghostpdl>/devices gsx_*.cpp -o libgsx_bridge.so -lgs -lz -ljpeg -lpthread
 //
 
 #include <atomic>
@@ -31,6 +35,7 @@ extern "C" {
   #include "iapi.h"
 }
 #include "gsx_bridge.h"
+#include "gsx_internal.h"
 
 // ======================= Compat layer (Win / POSIX) =======================
 #ifdef _WIN32
@@ -73,6 +78,41 @@ extern "C" {
   }
 #endif
 
+std::string gsx_make_temp_path(const char* dir, const char* prefix, const char* ext) {
+  if (!dir || !*dir) return make_temp_file(prefix, ext);
+  static std::atomic<unsigned> seq{0};
+  std::error_code ec;
+  fs::create_directories(dir, ec);
+  for (int tries = 0; tries < 100; ++tries) {
+    std::ostringstream name;
+    name << (prefix ? prefix : "GSX") << std::hex
+         << (unsigned)std::chrono::steady_clock::now().time_since_epoch().count()
+         << "_" << seq.fetch_add(1) << (ext ? ext : "");
+    fs::path p = fs::path(dir) / name.str();
+    if (fs::exists(p, ec)) continue;
+    std::ofstream f(p, std::ios::binary);
+    if (f) return p.string();
+  }
+  return make_temp_file(prefix, ext);
+}
+
+std::string gsx_json_escape(const std::string& v) {
+  std::string o;
+  o.reserve(v.size() + 2);
+  for (char c : v) {
+    if (c == '"' || c == '\\') { o.push_back('\\'); o.push_back(c); }
+    else if ((unsigned char)c < 0x20) { char b[8]; snprintf(b, sizeof(b), "\\u%04x", c); o += b; }
+    else o.push_back(c);
+  }
+  return o;
+}
+
+char* gsx_dup_string(const std::string& s) {
+  char* buf = (char*)std::malloc(s.size() + 1);
+  if (buf) memcpy(buf, s.c_str(), s.size() + 1);
+  return buf;
+}
+
 static std::string win_to_fwd_slashes(std::string s){
   for (auto& c : s) if (c == '\\') c = '/';
   return s;
@@ -206,6 +246,8 @@ static void _log(int lvl, const char* msg) {
   }
 }
 
+void gsx_log_msg(int lvl, const char* msg){ _log(lvl, msg); }
+
 void gsx_set_log_callback(gsx_log_cb cb, void* user){
   std::lock_guard<std::mutex> lk(g_log_mtx);
   g_log_cb = cb; g_log_user = user;
@@ -225,8 +267,11 @@ size_t gsx_log_capture_snapshot(char* dst, size_t maxlen){
   size_t n = std::min(maxlen-1, g_ring.size());
   memcpy(dst, g_ring.data(), n); dst[n] = 0; return n;
 }
+thread_local uintptr_t g_gsx_probe_key = 0;
 static thread_local std::string t_last_err_json;
-static void set_last_error_json(int rc, const char* where, int os_errno, int gs_rc, const std::vector<std::string>* argv) {
+static thread_local int t_last_rc = GSX_OK;
+void set_last_error_json(int rc, const char* where, int os_errno, int gs_rc, const std::vector<std::string>* argv) {
+  t_last_rc = rc;
   t_last_err_json.clear();
   t_last_err_json += "{";
   t_last_err_json += "\"rc\":" + std::to_string(rc);
@@ -247,6 +292,7 @@ static void set_last_error_json(int rc, const char* where, int os_errno, int gs_
   _log(GSX_LOG_DEBUG, t_last_err_json.c_str());
 }
 const char* gsx_last_error_json(void){ return t_last_err_json.c_str(); }
+int gsx_last_rc() { return t_last_rc; }
 const char* gsx_strerror(int rc){
   switch (rc){
     case GSX_OK: return "ok";
@@ -257,6 +303,9 @@ const char* gsx_strerror(int rc){
     case GSX_E_TEMP_CREATE: return "falha ao criar arquivo temporário";
     case GSX_E_TEMP_IO: return "falha de I/O em temporário";
     case GSX_E_CANCELED: return "processo cancelado";
+    case GSX_E_PDF_PARSE: return "estrutura do PDF ilegível";
+    case GSX_E_PDF_ENCRYPTED: return "PDF criptografado";
+    case GSX_E_WRITE_IO: return "falha de escrita na saída";
     case GSX_E_UNKNOWN: return "erro desconhecido";
     case -100: return "Ghostscript fatal (-100)";
     default: return "erro";
@@ -269,14 +318,31 @@ struct GsxExecCtx {
   volatile int* cancel_flag = nullptr;
   int page_done = 0;
   int total_pages = 0;
+  // saída do device em -sOutputFile=- (binária); mensagens seguem pelo stderr
+  gsx_raw_sink raw_out = nullptr;
+  void* raw_user = nullptr;
+  // -sDEVICE=display: callbacks recebem este ctx como handle (-sDisplayHandle)
+  display_callback* display = nullptr;
+  void* display_user = nullptr;
+  // página em andamento (última linha "Page N"; 0 = inicialização do PostScript) e,
+  // rastreando, o início do span aberto
+  uint64_t tr_t0 = 0;
+  int tr_page = 0;
+  int pages_seen = 0;   // linhas "Page N" (métricas)
+  uint64_t run_id = 0;  // sondas USDT: identifica a execução
+  bool cancel_seen = false;
 
   static int stdin_fn(void* h, char* buf, int len) { return 0; }
   static int stdout_fn(void* h, const char* d, int len);
-  static int stderr_fn(void* h, const char* d, int len) { return stdout_fn(h, d, len); }
+  static int stderr_fn(void* h, const char* d, int len);
   static int poll_fn(void* h) {
     auto* self = reinterpret_cast<GsxExecCtx*>(h);
-    if (!self || !self->cancel_flag) return 0;
-    return (*self->cancel_flag != 0) ? 1 : 0;
+    if (!self || !self->cancel_flag || *self->cancel_flag == 0) return 0;
+    if (!self->cancel_seen) {
+      self->cancel_seen = true;
+      GSX_PROBE1(cancel, self->run_id);
+    }
+    return 1;
   }
 };
 static void split_lines_and_emit(const char* data, int len, GsxExecCtx* ctx)
@@ -310,6 +376,35 @@ static void split_lines_and_emit(const char* data, int len, GsxExecCtx* ctx)
 
 int GsxExecCtx::stdout_fn(void* h, const char* d, int len) {
   auto* self = reinterpret_cast<GsxExecCtx*>(h);
+  if (self && self->raw_out) return self->raw_out(self->raw_user, d, len);
+  return stderr_fn(h, d, len);
+}
+
+// "Page N" no início de uma linha encerra a etapa anterior (inicialização do
+// PostScript ou a página anterior): conta, dispara a sonda e, rastreando, fecha o
+// span anterior e abre o da página N
+static void scan_pages(GsxExecCtx* ctx, const char* d, int len) {
+  for (int i = 0; i + 5 < len; ++i) {
+    if ((i == 0 || d[i - 1] == '\n') && memcmp(d + i, "Page ", 5) == 0) {
+      const int n = atoi(d + i + 5);
+      if (n <= 0) continue;
+      ++ctx->pages_seen;
+      if (ctx->tr_page) GSX_PROBE2(page_done, ctx->run_id, ctx->tr_page);
+      else GSX_PROBE1(init_done, ctx->run_id);
+      if (ctx->tr_t0) {
+        const uint64_t now = gsx_trace_clock_ns();
+        if (ctx->tr_page) gsx_trace_emit("gs.page", ctx->tr_t0, now, "page", ctx->tr_page);
+        else gsx_trace_emit("gs.ps_init", ctx->tr_t0, now);
+        ctx->tr_t0 = now;
+      }
+      ctx->tr_page = n;
+    }
+  }
+}
+
+int GsxExecCtx::stderr_fn(void* h, const char* d, int len) {
+  auto* self = reinterpret_cast<GsxExecCtx*>(h);
+  if (self) scan_pages(self, d, len);
   if (_debug_enabled()) {
     _append_debug_file_prefix("STDOUT-CHUNK:", d, len);
     _append_debug_per_line("STDOUT:", d, len);
@@ -330,22 +425,49 @@ static int run_gs_with_argv(GsxExecCtx& ctx, int argc, const char** argv,
     _append_debug_file(oss.str());
   }
 
+  static std::atomic<uint64_t> run_seq{0};
+  ctx.run_id = ++run_seq;
+  GSX_PROBE2(job_start, ctx.run_id, g_gsx_probe_key);
+
+  GsxSpan sp_new("gs.new_instance");
   int code = gsapi_new_instance(&ctx.instance, &ctx);
+  sp_new.end();
+  if (code >= 0) {
+    gsx_metric_add(GSX_C_GS_INSTANCES);
+    gsx_gauge_add(GSX_G_GS_ACTIVE, 1);
+  }
   if (code < 0) {
     set_last_error_json(code, "gsapi_new_instance", 0, code, av_log);
     if (_debug_enabled())
       _append_debug_file(std::string("gsapi_new_instance -> ") + std::to_string(code));
+    GSX_PROBE3(job_end, ctx.run_id, code, 0);
     return code;
   }
 
   gsapi_set_arg_encoding(ctx.instance, GS_ARG_ENCODING_UTF8);
   gsapi_set_stdio(ctx.instance, GsxExecCtx::stdin_fn, GsxExecCtx::stdout_fn, GsxExecCtx::stderr_fn);
   gsapi_set_poll(ctx.instance, GsxExecCtx::poll_fn);
+  if (ctx.display) gsapi_set_display_callback(ctx.instance, ctx.display);
 
+  // init_with_args = inicialização do PostScript + interpretação das páginas; a
+  // divisão entre elas vem das linhas "Page N" (scan_pages)
+  if (gsx_trace_on()) ctx.tr_t0 = gsx_trace_clock_ns();
   code = gsapi_init_with_args(ctx.instance, argc, const_cast<char**>(argv));
+  if (ctx.tr_page) GSX_PROBE2(page_done, ctx.run_id, ctx.tr_page);
+  if (ctx.tr_t0) {
+    if (ctx.tr_page) gsx_trace_emit("gs.page", ctx.tr_t0, gsx_trace_clock_ns(), "page", ctx.tr_page);
+    else gsx_trace_emit("gs.ps_init", ctx.tr_t0, gsx_trace_clock_ns());
+    ctx.tr_t0 = 0;
+  }
+  GsxSpan sp_exit("gs.exit");   // fecha o device: o pdfwrite grava a saída aqui
   int code_exit = gsapi_exit(ctx.instance);
+  sp_exit.end();
+  GsxSpan sp_del("gs.delete_instance");
   gsapi_delete_instance(ctx.instance);
+  sp_del.end();
   ctx.instance = nullptr;
+  gsx_gauge_add(GSX_G_GS_ACTIVE, -1);
+  gsx_metric_add(GSX_C_GS_PAGES, (uint64_t)ctx.pages_seen);
 
   if (_debug_enabled()) {
     std::ostringstream oss;
@@ -356,21 +478,20 @@ static int run_gs_with_argv(GsxExecCtx& ctx, int argc, const char** argv,
     _append_debug_file(oss.str());
   }
 
+  int rc = code;
   if (ctx.cancel_flag && *ctx.cancel_flag) {
     set_last_error_json(GSX_E_CANCELED, "gsapi", 0, code, av_log);
-    return GSX_E_CANCELED;
-  }
-  if (code < 0) {
+    rc = GSX_E_CANCELED;
+  } else if (code < 0) {
     set_last_error_json(code, "gsapi_init_with_args", 0, code, av_log);
-    return code;
-  }
-  if (code_exit < 0) {
+  } else if (code_exit < 0) {
     set_last_error_json(code_exit, "gsapi_exit", 0, code_exit, av_log);
-    return code_exit;
+    rc = code_exit;
+  } else {
+    set_last_error_json(GSX_OK, "gsapi", 0, 0, av_log);
   }
-
-  set_last_error_json(GSX_OK, "gsapi", 0, 0, av_log);
-  return code;
+  GSX_PROBE3(job_end, ctx.run_id, rc, ctx.pages_seen);
+  return rc;
 }
 
 
@@ -394,7 +515,7 @@ static void build_pdf_args_vec(std::vector<std::string>& A,
   push(A, "-dNOPAUSE");
   push(A, "-sDEVICE=pdfwrite");
 
-  if (preset && *preset) {
+  if (preset && *preset && strcmp(preset, GSX_PRESET_IMAGES) != 0) {   // "images" não é do pdfwrite
     push(A, std::string("-dPDFSETTINGS=/") + preset);
   }
 
@@ -607,12 +728,48 @@ GSX_API int gsx_run_args_sync(
   return rc;
 }
 
+int gsx_run_gs_raw(const std::vector<std::string>& args, gsx_raw_sink sink, void* sink_user,
+                   gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  std::vector<const char*> argv; vec_to_argv(args, argv);
+  GsxExecCtx ctx; ctx.cb = on_progress; ctx.user = user; ctx.cancel_flag = cancel_flag;
+  ctx.raw_out = sink; ctx.raw_user = sink_user;
+
+  if (_debug_enabled()) _append_debug_file(_join_argv_plain(args));
+
+  return run_gs_with_argv(ctx, (int)argv.size(), argv.data(), &args);
+}
+
+int gsx_run_gs_display(const std::vector<std::string>& args, display_callback_s* cb, void* cb_user,
+                       gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  GsxExecCtx ctx; ctx.cb = on_progress; ctx.user = user; ctx.cancel_flag = cancel_flag;
+  ctx.display = cb; ctx.display_user = cb_user;
+  // o handle dos callbacks é o próprio ctx, venha ele do DisplayHandle ou do caller_handle
+  char handle[40];
+  snprintf(handle, sizeof(handle), "-sDisplayHandle=16#%llx", (unsigned long long)(uintptr_t)&ctx);
+  std::vector<std::string> A = args;
+  A.insert(A.begin() + (A.empty() ? 0 : 1), handle);
+  std::vector<const char*> argv; vec_to_argv(A, argv);
+
+  if (_debug_enabled()) _append_debug_file(_join_argv_plain(A));
+
+  return run_gs_with_argv(ctx, (int)argv.size(), argv.data(), &A);
+}
+
+void* gsx_display_user(void* handle) {
+  return handle ? reinterpret_cast<GsxExecCtx*>(handle)->display_user : nullptr;
+}
+
 GSX_API int gsx_compress_file_sync(
   const char* in_path, const char* out_path,
   int dpi, int jpeg_quality, const char* preset, gsx_color_mode_t mode,
   int first_page, int last_page,
   gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
 {
+  GsxJobScope scope("gsx_compress_file_sync", in_path, out_path);
+  scope.capture({"compress_file", in_path, dpi, jpeg_quality, preset, (int)mode, first_page, last_page, 0, 0});
+  GsxSpan span("compress_file", "first", first_page, "last", last_page);
   if (!in_path || !out_path) {
     set_last_error_json(GSX_E_ARGS, "compress_file_sync", 0, 0, nullptr);
     return GSX_E_ARGS;
@@ -628,6 +785,40 @@ GSX_API int gsx_compress_file_sync(
     return GSX_E_OUTDIR_CREATE;
   }
 
+  if (mode == GSX_COLOR_BILEVEL) {
+    // 1-bpp de verdade: raster + limiar adaptativo + JBIG2. 'dpi' é a resolução das
+    // imagens em tons; o P&B precisa do dobro para manter o traço (como MonoImageResolution).
+    // Uma instância só: o paralelismo fica com quem chama (gsx_compress_parallel_sync).
+    gsx_bilevel_opts_t bo{};
+    bo.dpi = std::max(150, std::min(600, dpi * 2));
+    bo.workers = 1;
+    bo.codec = GSX_BIN_JBIG2;
+    int rc = gsx_bilevel_pdf(in_path, out_path, first_page, last_page, &bo, on_progress, user, cancel_flag);
+    return rc < 0 ? rc : 0;
+  }
+  if (mode == GSX_COLOR_MRC) {
+    // máscara no dobro da dpi (como o P&B), fundo na própria 'dpi' com a qualidade pedida
+    gsx_mrc_opts_t mo{};
+    mo.dpi = std::max(150, std::min(600, dpi * 2));
+    mo.bg_dpi = std::min(dpi, mo.dpi);
+    mo.jpeg_quality = std::max(0, std::min(100, jpeg_quality));
+    mo.codec = GSX_BIN_JBIG2;
+    mo.workers = 1;
+    int rc = gsx_mrc_pdf(in_path, out_path, first_page, last_page, &mo, on_progress, user, cancel_flag);
+    return rc < 0 ? rc : 0;
+  }
+
+  if (gsx_images_engine_applies(preset, in_path, first_page, last_page)) {
+    // só as imagens; o resto do arquivo vai byte a byte. Com intervalo parcial o
+    // preset é ignorado e o pdfwrite segue como sempre
+    gsx_recompress_opts_t ro{};
+    ro.dpi = std::max(0, std::min(1200, dpi));
+    ro.jpeg_quality = std::max(0, std::min(100, jpeg_quality));
+    ro.gray = mode == GSX_COLOR_GRAY;
+    int rc = gsx_recompress_images(in_path, out_path, &ro, nullptr, on_progress, user, cancel_flag);
+    return rc < 0 ? rc : 0;
+  }
+
   std::vector<std::string> A;
   build_pdf_args_vec(A, in_path, out_path, dpi, jpeg_quality, preset, mode, first_page, last_page);
 
@@ -700,6 +891,7 @@ static void job_thread(gsx_job_t* job,
   int first_page, int last_page, gsx_progress_cb cb, void* user)
 {
   if (!job) return;
+  g_gsx_probe_key = (uintptr_t)job;
   int r = gsx_compress_file_sync(in_path.c_str(), out_path.c_str(), dpi, jpeg_q,
                                  preset.empty()?nullptr:preset.c_str(), mode,
                                  first_page, last_page, cb, user, job->cancel_flag);
@@ -716,6 +908,7 @@ GSX_API gsx_job_t* gsx_compress_file_async(
   if (!in_path || !out_path) { set_last_error_json(GSX_E_ARGS, "compress_file_async", 0, 0, nullptr); return nullptr; }
   auto* job = new gsx_job_t();
   job->cancel_flag = cancel_flag;
+  GSX_PROBE3(job_submit, (uintptr_t)job, first_page, last_page);
   std::string presetS = preset ? preset : "";
   
   job->th = std::thread(job_thread, job,
@@ -30,7 +30,8 @@ typedef struct gsx_job_s gsx_job_t; // handle opaco (assíncrono)
 typedef enum gsx_color_mode_e {
   GSX_COLOR_COLOR   = 0,  // colorido (padrão)
   GSX_COLOR_GRAY    = 1,  // tons de cinza
-  GSX_COLOR_BILEVEL = 2   // P&B forte (1-bpp ou alvo agressivo)
+  GSX_COLOR_BILEVEL = 2,  // P&B 1-bpp: gsx_compress_file_sync usa o motor nativo (gsx_bilevel_pdf)
+  GSX_COLOR_MRC     = 3   // digitalização colorida em camadas: texto 1-bpp + cor + fundo JPEG (gsx_mrc_pdf)
 } gsx_color_mode_t;
 
 // ===== Erros padronizados (negativos) =====
@@ -45,6 +46,9 @@ typedef enum gsx_err_e {
   GSX_E_TEMP_CREATE              = -2005, // falha ao criar arquivo temporário
   GSX_E_TEMP_IO                  = -2006, // falha de I/O em temporário
   GSX_E_CANCELED                 = -2007, // cancelado via poll
+  GSX_E_PDF_PARSE                = -2008, // estrutura do PDF ilegível (xref/páginas)
+  GSX_E_PDF_ENCRYPTED            = -2009, // PDF criptografado (não suportado pelas rotinas nativas)
+  GSX_E_WRITE_IO                 = -2010, // falha de escrita no arquivo de saída
   GSX_E_UNKNOWN                  = -2099  // fallback
 
   // Observação: erros nativos do Ghostscript (<0, p.ex. -100) podem ser retornados diretamente.
@@ -78,6 +82,34 @@ GSX_API const char* gsx_strerror(int rc);
 // {"rc":-2002,"where":"compress_file_sync","os_errno":2,"gs_rc":0,"argv":[...]}
 GSX_API const char* gsx_last_error_json(void);
 
+// ===== Rastreamento de etapas (Chrome trace / Perfetto) =====
+// Spans (início/fim, job, thread) nos pontos quentes: fila e lotes da compressão
+// paralela, criação da instância, inicialização do PostScript, cada página, saída
+// (flush do device), mesclagem, deduplicação, linearização e etapas do pipeline. Cada
+// thread grava no próprio buffer circular, sem trava; desligado, um span custa uma
+// leitura atômica. Cada chamada de topo (gsx_compress_file_sync, _parallel_sync,
+// gsx_pipeline_run...) é um job: "pid" no JSON, com o nome da função no rótulo.
+GSX_API void     gsx_trace_enable(int on);                // padrão: desligado
+GSX_API int      gsx_trace_enabled(void);
+// Com dir != NULL, cada job terminado é gravado em dir/gsx_trace_<job>.json.
+GSX_API void     gsx_trace_set_dump_dir(const char* dir);
+// Relógio dos spans (µs, monotônico) — para recortar uma janela com since_us.
+GSX_API uint64_t gsx_trace_now_us(void);
+// Spans do job (0 = todos) que terminaram a partir de since_us (0 = todos) ainda nos
+// buffers, como {"traceEvents":[...]}. gsx_trace_json devolve via malloc (gsx_free).
+GSX_API int      gsx_trace_dump(const char* path, uint64_t job, uint64_t since_us);
+GSX_API char*    gsx_trace_json(uint64_t job, uint64_t since_us);
+GSX_API void     gsx_trace_clear(void);
+
+// ===== Métricas (formato texto do Prometheus) =====
+// Contadores acumulados desde o carregamento da biblioteca, por chamada de topo:
+// resultado (ok/canceled/error) e código de erro, histograma de latência, bytes de
+// entrada e saída; e globais: instâncias e páginas do Ghostscript, lotes que passaram
+// do tempo esperado, acertos do cache de miniaturas, cópias reparadas e os medidores
+// de chamadas/instâncias ativas e lotes na fila. Atualizar custa alguns atômicos por
+// chamada. Devolve via malloc (liberar com gsx_free); NULL se faltar memória.
+GSX_API char*    gsx_metrics_snapshot(void);
+
 // ===== Contexto =====
 GSX_API void* gsx_create_context(void);   // placeholder p/ futuro
 GSX_API void  gsx_destroy_context(void* ctx);
@@ -109,7 +141,7 @@ GSX_API int gsx_compress_file_sync(
   const char* out_path,
   int dpi,
   int jpeg_quality,
-  const char* preset,        // pode ser NULL
+  const char* preset,        // pode ser NULL; GSX_PRESET_IMAGES = gsx_recompress_images
   gsx_color_mode_t mode,
   int first_page,            // 0=ignora
   int last_page,             // 0=ignora
@@ -126,6 +158,28 @@ GSX_API int gsx_compress_bytes_sync(
   gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
 );
 
+// 2b) Compressão por descritores já abertos (servidor: upload num memfd, resposta
+// enviada do descritor de saída com sendfile). No Linux, descritores de arquivo
+// regular (inclusive memfd/tmpfs) são entregues ao Ghostscript como /proc/self/fd/N,
+// sem cópia; pipes/sockets, e qualquer descritor fora do Linux, passam por um
+// temporário. A entrada é lida do início (pipe/socket: até o EOF); a saída é
+// truncada e, sendo arquivo regular, fica com o offset em 0, pronta para ser lida.
+// *out_len (opcional) recebe o tamanho gravado. Os descritores continuam do chamador.
+GSX_API int gsx_compress_fd_sync(
+  int in_fd, int out_fd,
+  int dpi, int jpeg_quality, const char* preset, gsx_color_mode_t mode,
+  int first_page, int last_page,
+  /*out*/ uint64_t* out_len,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// Arquivo anônimo em memória para usar com gsx_compress_fd_sync: memfd no Linux,
+// senão um temporário já removido do disco (some ao fechar). Retorna o fd ou erro
+// (<0). 'name' só aparece em /proc (pode ser NULL).
+GSX_API int gsx_memfd_create(const char* name);
+// Fecha um descritor criado por gsx_memfd_create (ou qualquer fd do processo).
+GSX_API int gsx_fd_close(int fd);
+
 // 3) Execução genérica via argumentos manuais (argv/argc que você mesmo monta)
 GSX_API int gsx_run_args_sync(
   int argc, const char** argv,
@@ -156,5 +210,636 @@ GSX_API int gsx_compress_dir_sync(
   gsx_file_cb on_file
 );
 
+// ===== Inspeção rápida (sem Ghostscript) =====
+typedef struct gsx_probe_s {
+  int      page_count;       // -1 se a árvore de páginas não foi lida
+  int      version;          // 17 == "%PDF-1.7"; 0 = sem header %PDF- (não é PDF)
+  int      encrypted;        // 1 se o trailer tem /Encrypt
+  int      linearized;       // 1 se o 1º objeto é o dicionário de linearização
+  int      xref_health;      // 0 = ok, 1 = reconstruída por varredura, 2 = ilegível
+  int      has_xref_stream;  // 1 se alguma seção é xref stream (PDF 1.5+)
+  int      xref_sections;    // seções na cadeia /Prev (>1 = atualizações incrementais)
+  int      object_count;     // entradas em uso na xref
+  uint64_t file_size;
+  uint64_t header_offset;    // bytes antes de "%PDF-" (lixo/BOM)
+  uint64_t elapsed_us;       // tempo da inspeção
+} gsx_probe_t;
+
+// Mapeia o arquivo e lê header, trailer, xref/xref streams e a raiz da árvore de páginas;
+// a varredura de reparo só roda quando a xref está danificada.
+// Em GSX_E_PDF_PARSE, version/file_size/header_offset continuam preenchidos.
+GSX_API int gsx_probe(const char* in_path, /*out*/ gsx_probe_t* out);
+
+// ===== Normalização (xref reparada uma vez) =====
+typedef struct gsx_normalize_stats_s {
+  int      xref_health;      // da entrada, como em gsx_probe_t
+  int      bad_offsets;      // entradas da xref que não apontam para "N G obj" do número certo
+  int      objects;          // objetos gravados
+  int      dropped;          // entradas ilegíveis, não copiadas
+  uint64_t bytes_out;
+  uint64_t elapsed_us;
+} gsx_normalize_stats_t;
+
+enum { GSX_NORMALIZE_FORCE = 1 };   // regrava mesmo com a xref sã
+
+// Se a xref de in_path está danificada (o Ghostscript a repararia varrendo o arquivo
+// — em cada lote da compressão paralela), reconstrói a tabela com a varredura nativa e
+// grava em out_path uma cópia com os mesmos objetos, xref clássica nova e /Length
+// corrigidos. Retorna 1 se out_path foi gravado, 0 se a entrada está sã (out_path não
+// é tocado) ou erro (<0; criptografados: GSX_E_PDF_ENCRYPTED). stats pode ser NULL.
+// gsx_compress_parallel_sync e gsx_pipeline_run já fazem isso antes dos lotes.
+GSX_API int gsx_normalize_pdf(const char* in_path, const char* out_path, int flags,
+                              /*out*/ gsx_normalize_stats_t* stats);
+
+// Atribuição de bytes: percorre o grafo de objetos e devolve em *json_out (malloc →
+// gsx_free) um objeto JSON com
+//   "categories"     bytes por categoria: images, fonts, content, icc, metadata,
+//                    annotations, other, structure (header/xref/trailer/árvore)
+//   "per_page"       [{page,total,bytes{...}}] — cada objeto conta para a 1ª página
+//                    que o usa; "document_level" fica com o que nenhuma página alcança
+//   "images"         [{obj,width,height,bpc,colorspace,filter,bytes,smask,placements,
+//                    dpi_x,dpi_y,pages}] — dpi pela maior área de exibição encontrada
+//                    nos content streams (cm/Do, Forms aninhados)
+//   "max_image_dpi", "inline_images" {count,bytes}
+// Não roda Ghostscript; PDFs criptografados retornam GSX_E_PDF_ENCRYPTED.
+GSX_API int gsx_analyze(const char* in_path, /*out*/ char** json_out);
+
+// ===== Classificação de páginas (pré-passada em baixa resolução) =====
+typedef enum {
+  GSX_PAGE_BLANK   = 0,  // sem tinta (papel em branco, ruído de digitalização)
+  GSX_PAGE_BILEVEL = 1,  // preto sobre branco: aguenta 1-bpp sem perda visível
+  GSX_PAGE_GRAY    = 2,  // neutra, mas com meios-tons (fotos, sombreados)
+  GSX_PAGE_COLOR   = 3
+} gsx_page_kind_t;
+
+typedef struct gsx_page_class_s {
+  int   page;          // 1-based
+  int   kind;          // gsx_page_kind_t
+  int   image_heavy;   // 1 se boa parte da página é meio-tom (foto/digitalização)
+  float ink;           // fração de pixels mais escuros que o papel
+  float color;         // fração de pixels cromáticos
+  float midtone;       // fração de pixels entre o preto e o papel
+} gsx_page_class_t;
+
+// Renderiza [first_page,last_page] em 'dpi' (0 = 24) sem anti-aliasing, direto da
+// memória (ppmraw em stdout), e classifica cada página pelo histograma.
+// As faixas de páginas são divididas pelo peso estimado (gsx_plan_chunks) entre
+// 'workers' instâncias do Ghostscript (0 = nº de CPUs).
+// 'out' deve ter espaço para as páginas do intervalo (first/last = 0 → todas; a
+// contagem vem de gsx_probe). Páginas que o Ghostscript não entregar ficam COLOR.
+// Retorna o número de páginas classificadas ou erro (<0).
+GSX_API int gsx_classify_pages(
+  const char* in_path,
+  int first_page,
+  int last_page,
+  int dpi,
+  int workers,
+  /*out*/ gsx_page_class_t* out,
+  volatile int* cancel_flag
+);
+
+// ===== Renderização para a memória (device display) =====
+typedef enum {
+  GSX_RENDER_RGB  = 0,   // 24 bpp, R G B
+  GSX_RENDER_GRAY = 1,   // 8 bpp, 0 = preto
+  GSX_RENDER_MONO = 2    // 1 bpp, bit mais significativo à esquerda, 1 = preto
+} gsx_render_color_t;
+
+// Faixa (ou página inteira) renderizada; 'data' só vale durante o callback.
+typedef struct gsx_raster_s {
+  int            page;            // 1-based
+  int            width, height;   // da página, em pixels
+  int            y, rows;         // linhas [y, y+rows) em 'data' (página inteira: 0, height)
+  int            stride;          // bytes por linha
+  int            color;           // gsx_render_color_t
+  int            bits_per_pixel;  // 24, 8 ou 1
+  int            worker;          // instância que renderizou (0..workers-1)
+  const uint8_t* data;
+} gsx_raster_t;
+
+// Chamado das threads dos workers (em paralelo se workers > 1; em ordem de página e
+// de faixa dentro de cada worker). Retornar != 0 cancela a renderização.
+typedef int (GSX_CALL *gsx_raster_cb)(const gsx_raster_t* raster, void* user);
+// Memória dos bitmaps fornecida pelo chamador (página inteira ou faixa).
+typedef void* (GSX_CALL *gsx_render_alloc_cb)(size_t size, void* user);
+typedef void  (GSX_CALL *gsx_render_free_cb)(void* mem, void* user);
+
+typedef struct gsx_render_opts_s {
+  int   dpi;                 // 0 = 72
+  int   color;               // gsx_render_color_t
+  int   band_height;         // 0 = página inteira; >0 = faixas de até N linhas
+  int   render_threads;      // -dNumRenderingThreads (0 = não usa)
+  int   workers;             // instâncias do Ghostscript, uma faixa de páginas cada (0 = nº de CPUs)
+  int   alpha_bits;          // anti-aliasing de texto/gráficos 1, 2 ou 4 (0 = 4; MONO usa 1)
+  gsx_render_alloc_cb alloc; // NULL = pool interno reaproveitado entre páginas e chamadas
+  gsx_render_free_cb  free_mem;
+  void* alloc_user;
+} gsx_render_opts_t;
+
+// Renderiza [first_page,last_page] (0 = documento inteiro) com -sDEVICE=display e
+// entrega cada página (ou faixa, com band_height) a on_raster, sem passar por arquivos.
+// Com band_height o device roda em modo de faixas (display v3, "rectangle request"):
+// só uma faixa por worker fica em memória. As páginas são divididas entre os workers
+// pelo peso estimado (gsx_plan_chunks); render_threads acrescenta threads de
+// rasterização dentro de cada instância. opts pode ser NULL.
+// Progresso: uma chamada por página entregue ("Page N").
+// Retorna o número de páginas entregues ou erro (<0).
+GSX_API int gsx_render_pages(
+  const char* in_path,
+  int first_page,
+  int last_page,
+  const gsx_render_opts_t* opts,
+  gsx_raster_cb on_raster, void* raster_user,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// Libera os bitmaps guardados no pool interno de gsx_render_pages.
+GSX_API void gsx_render_pool_trim(void);
+
+// Coletor pronto para quem não pode tratar o callback na thread do worker (FFI/Dart):
+// passe gsx_raster_list_collect como on_raster e a lista como raster_user. As faixas
+// são montadas em páginas inteiras (stride = bytes mínimos por linha), ordenadas por
+// página em gsx_raster_list_get. A memória é da lista até gsx_raster_list_free.
+typedef struct gsx_raster_list_s gsx_raster_list_t;
+GSX_API gsx_raster_list_t* gsx_raster_list_new(void);
+GSX_API int GSX_CALL gsx_raster_list_collect(const gsx_raster_t* raster, void* list);
+GSX_API int gsx_raster_list_count(gsx_raster_list_t* list);
+GSX_API const gsx_raster_t* gsx_raster_list_get(gsx_raster_list_t* list, int index);
+GSX_API void gsx_raster_list_free(gsx_raster_list_t* list);
+
+// ===== Miniaturas (renderização paralela + cache em disco) =====
+// Níveis fixos de zoom: 0 = 24 dpi, 1 = 48, 2 = 96, 3 = 192.
+#define GSX_THUMB_LEVELS 4
+
+typedef struct gsx_thumbs_opts_s {
+  int workers;      // threads de renderização, uma instância do Ghostscript cada (0 = nº de CPUs)
+  int prefetch;     // páginas vizinhas das visíveis pré-carregadas de cada lado (0 = 4; <0 = nenhuma)
+  int batch_pages;  // páginas consecutivas por instância do Ghostscript (0 = 8)
+  int gray;         // 1 = miniaturas em cinza (PNG de 8 bits)
+} gsx_thumbs_opts_t;
+
+// Serviço de miniaturas PNG com cache persistente em cache_dir, indexado pelo hash do
+// conteúdo do PDF (renomear ou copiar o arquivo não invalida; alterar, sim):
+// <cache_dir>/<hash>/<dpi>/<página>.png. A fila atende primeiro as páginas visíveis
+// do pedido mais recente, depois as vizinhas e por fim o prefetch explícito; um lote
+// de prefetch em andamento cede a vez quando chega página visível. opts pode ser NULL.
+typedef struct gsx_thumbs_s gsx_thumbs_t;
+GSX_API gsx_thumbs_t* gsx_thumbs_open(const char* cache_dir, const gsx_thumbs_opts_t* opts);
+// Cancela a fila, espera os workers e libera o serviço.
+GSX_API void gsx_thumbs_close(gsx_thumbs_t* svc);
+
+// Enfileira [first_page,last_page] no nível 'level' sem bloquear. visible = 1: páginas
+// na tela (prioridade máxima, com prefetch das vizinhas); 0 = segundo plano.
+// Retorna quantas páginas ainda não estavam prontas ou erro (<0).
+GSX_API int gsx_thumbs_request(gsx_thumbs_t* svc, const char* in_path, int first_page,
+                               int last_page, int level, int visible);
+
+// Caminho do PNG da página (liberar com gsx_free), renderizando como visível se preciso;
+// bloqueia até ficar pronto. GSX_OK ou erro (<0).
+GSX_API int gsx_thumbs_get(gsx_thumbs_t* svc, const char* in_path, int page, int level,
+                           char** png_path_out);
+
+// Contadores em JSON (liberar com gsx_free): acertos do cache, páginas renderizadas,
+// falhas, fila, lotes cedidos, tempo de renderização.
+GSX_API int gsx_thumbs_stats(gsx_thumbs_t* svc, char** json_out);
+
+// ===== P&B nativo (raster → limiar adaptativo → CCITT G4 / JBIG2) =====
+typedef enum {
+  GSX_BIN_SAUVOLA = 0,   // limiar local por média/desvio na janela (padrão)
+  GSX_BIN_OTSU    = 1    // Otsu por ladrilho, interpolado entre ladrilhos
+} gsx_bin_method_t;
+
+typedef enum {
+  GSX_BIN_G4    = 0,     // CCITT Grupo 4 (/CCITTFaxDecode, PDF 1.2+)
+  GSX_BIN_JBIG2 = 1      // JBIG2 região genérica sem perdas (/JBIG2Decode, PDF 1.4+)
+} gsx_bin_codec_t;
+
+typedef struct gsx_bilevel_opts_s {
+  int   dpi;         // resolução do raster e da saída (0 = 300)
+  int   method;      // gsx_bin_method_t
+  int   window;      // janela Sauvola em px (ladrilho Otsu = 4×); 0 = dpi/12
+  float k;           // sensibilidade Sauvola 0..1 (0 = 0.34; maior = mais claro)
+  int   despeckle;   // apaga manchas pretas de até N px (0 = automático pela dpi, <0 = não)
+  int   workers;     // instâncias simultâneas do Ghostscript (0 = nº de CPUs)
+  int   codec;       // gsx_bin_codec_t
+} gsx_bilevel_opts_t;
+
+// Renderiza [first_page,last_page] em cinza direto para a memória, binariza cada página
+// e grava out_path só com imagens 1-bpp G4 ou JBIG2 (uma por página, tamanho original).
+// O texto vira imagem: indicado para documentos digitalizados.
+// first/last = 0 → documento inteiro; opts pode ser NULL.
+// Progresso no formato do Ghostscript ("Page N"). Retorna as páginas gravadas ou erro (<0).
+GSX_API int gsx_bilevel_pdf(
+  const char* in_path,
+  const char* out_path,
+  int first_page,
+  int last_page,
+  const gsx_bilevel_opts_t* opts,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// Mesmo pipeline do gsx_bilevel_pdf sem gravar nada: cada página binarizada é codificada
+// em G4 e em JBIG2 e *json_out (malloc → gsx_free) recebe bytes e tempo de codificação
+// por codec ("g4"/"jbig2": bytes, encode_ms, mpx_per_s), a razão "jbig2_vs_g4" e
+// "per_page". opts->codec é ignorado. Retorna as páginas medidas ou erro (<0).
+GSX_API int gsx_bilevel_bench(
+  const char* in_path,
+  int first_page,
+  int last_page,
+  const gsx_bilevel_opts_t* opts,
+  /*out*/ char** json_out,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// ===== MRC (máscara de texto 1-bpp + cor do texto + fundo JPEG) =====
+typedef struct gsx_mrc_opts_s {
+  int dpi;           // resolução do raster e da máscara de texto (0 = 300)
+  int bg_dpi;        // resolução do fundo JPEG (0 = dpi/3)
+  int jpeg_quality;  // qualidade do fundo 1..100 (0 = 50)
+  int codec;         // gsx_bin_codec_t da máscara
+  int workers;       // instâncias simultâneas do Ghostscript (0 = nº de CPUs)
+} gsx_mrc_opts_t;
+
+// Renderiza [first_page,last_page] em RGB e separa cada página em máscara de texto
+// (resolução cheia), camada de cor do texto (grade grossa) e fundo JPEG (bg_dpi).
+// O texto vira imagem, mas nítida; fotos e fundos ficam no JPEG.
+// first/last = 0 → documento inteiro; opts pode ser NULL.
+// Progresso no formato do Ghostscript ("Page N"). Retorna as páginas gravadas ou erro (<0).
+GSX_API int gsx_mrc_pdf(
+  const char* in_path,
+  const char* out_path,
+  int first_page,
+  int last_page,
+  const gsx_mrc_opts_t* opts,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// ===== Recompressão só das imagens (sem pdfwrite) =====
+// Preset de gsx_compress_*: em vez de regravar tudo pelo pdfwrite, só as imagens são
+// recomprimidas (gsx_recompress_images). Vale para o documento inteiro; com intervalo
+// de páginas parcial o pdfwrite continua sendo usado (sem -dPDFSETTINGS).
+#define GSX_PRESET_IMAGES "images"
+
+typedef struct gsx_recompress_opts_s {
+  int dpi;           // resolução máxima na página; acima de 1.5× é reduzida (0 = 150)
+  int jpeg_quality;  // qualidade do JPEG 1..100 (0 = 75)
+  int gray;          // != 0 → imagens RGB viram cinza
+  int workers;       // threads de decodificação/codificação (0 = nº de CPUs)
+} gsx_recompress_opts_t;
+
+typedef struct gsx_recompress_stats_s {
+  int      images;            // imagens XObject no arquivo
+  int      recompressed;      // substituídas por JPEG (ou JBIG2, as de 1 bit)
+  int      downsampled;       // dessas, reduzidas de resolução
+  uint64_t image_bytes_in;    // streams substituídos: bytes antes
+  uint64_t image_bytes_out;   // ... e depois
+  uint64_t bytes_in;          // tamanho do arquivo de entrada
+  uint64_t bytes_out;         // tamanho do arquivo gerado
+} gsx_recompress_stats_t;
+
+// Regrava in_path em out_path trocando só os streams de imagem: cada imagem de 8 bits
+// em cinza/RGB (sem filtro, Flate ou DCT) é decodificada, reduzida à 'dpi' se estiver
+// acima de 1.5× (pela maior área em que é desenhada) e recodificada em JPEG; fica a
+// versão menor. Imagens de 1 bit (/ImageMask ou DeviceGray, sem filtro ou Flate) viram
+// JBIG2 sem perdas, na mesma resolução, quando fica menor. Os demais objetos são
+// copiados byte a byte (os de object streams são reserializados) e a xref é reescrita.
+// Máscaras, JPX/JBIG2/CCITT, CMYK e imagens indexadas não são tocadas. PDFs criptografados retornam GSX_E_PDF_ENCRYPTED.
+// Progresso: uma chamada por imagem processada ("Image N"). opts/stats_out podem ser NULL.
+// Retorna as imagens substituídas ou erro (<0); em erro out_path é removido.
+GSX_API int gsx_recompress_images(
+  const char* in_path,
+  const char* out_path,
+  const gsx_recompress_opts_t* opts,
+  /*out*/ gsx_recompress_stats_t* stats_out,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// ===== Planejamento de chunks (sem Ghostscript) =====
+typedef struct gsx_chunk_s {
+  int      first_page;   // 1-based, inclusivo
+  int      last_page;    // inclusivo
+  uint64_t weight;       // custo estimado (bytes de conteúdo + imagens + custo fixo por página)
+} gsx_chunk_t;
+
+// Lê a xref do PDF, mede o "peso" de cada página (content streams + XObjects de imagem,
+// incluindo os referenciados por Forms) e divide [first_page,last_page] em até max_chunks
+// intervalos contíguos que equilibram o custo estimado entre os workers.
+// first_page/last_page = 0 → documento inteiro.
+// Retorna o número de chunks escritos em chunks_out (capacidade >= max_chunks) ou erro (<0).
+GSX_API int gsx_plan_chunks(
+  const char* in_path,
+  int first_page,
+  int last_page,
+  int max_chunks,
+  /*out*/ gsx_chunk_t* chunks_out
+);
+
+// ===== Compressão paralela (fila de lotes + replicação de retardatários) =====
+typedef struct gsx_parallel_opts_s {
+  int workers;             // instâncias simultâneas do Ghostscript (0 = nº de CPUs);
+                           // com perfil ativo e batches_per_worker = 0, é o teto
+  int batches_per_worker;  // granularidade da fila: lotes ≈ workers × isto (0 = 4, ou o
+                           // que o perfil de gsx_tune_set_profile escolher)
+  int straggler_pct;       // lote é retardatário após pct% do tempo esperado (0 = 250)
+  int straggler_min_ms;    // nunca replica um lote antes disso (0 = 2000)
+  const char* work_dir;    // pasta das partes (NULL = temporária do sistema)
+} gsx_parallel_opts_t;
+
+// Divide [first_page,last_page] em lotes pequenos de peso parecido (mesma medição do
+// gsx_plan_chunks) e os despacha de uma fila compartilhada para 'workers' instâncias.
+// Quando um lote passa muito do tempo esperado e há workers ociosos, o intervalo dele
+// é redividido e rodado em paralelo; vence quem terminar primeiro e o outro é cancelado.
+// Em sucesso, *parts_json recebe (malloc → gsx_free) um array JSON com os caminhos das
+// partes em ordem de página; mesclar e apagar as partes fica com o chamador.
+// Com GSX_PRESET_IMAGES no documento inteiro não há lotes: uma parte só, já completa.
+// Xref danificada é reparada uma vez antes dos lotes (gsx_normalize_pdf, numa cópia
+// temporária em work_dir), com a linha de progresso "normalize: xref table was repaired".
+// opts pode ser NULL (todos os padrões).
+GSX_API int gsx_compress_parallel_sync(
+  const char* in_path,
+  int dpi, int jpeg_quality, const char* preset, gsx_color_mode_t mode,
+  int first_page,            // 0 = 1
+  int last_page,             // 0 = última
+  const gsx_parallel_opts_t* opts,
+  /*out*/ char** parts_json,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// ===== Auto-ajuste: quando dividir e em quantos lotes =====
+// Modelo de custo ajustado por gsx_tune_calibrate nesta máquina:
+//   lote     = chunk_fixed_ms + page_ms × páginas + ms_per_mb × MB de peso (gsx_page_weights)
+//   mesclar  = merge_fixed_ms + merge_part_ms × partes + merge_ms_per_mb × MB das partes
+// Com k instâncias ao mesmo tempo cada uma rende parallel_eff (medido com eff_workers)
+// do que rende sozinha; entre 1 e eff_workers a perda é interpolada.
+typedef struct gsx_tune_profile_s {
+  double chunk_fixed_ms;     // inicialização do interpretador, fontes, abertura do PDF
+  double page_ms;
+  double ms_per_mb;
+  double merge_fixed_ms;
+  double merge_part_ms;
+  double merge_ms_per_mb;
+  double out_ratio;          // bytes das partes / peso das páginas
+  double parallel_eff;       // 0..1
+  int    eff_workers;
+  int    cpus;               // núcleos da máquina calibrada
+  int    samples;            // execuções medidas
+} gsx_tune_profile_t;
+
+typedef struct gsx_tune_opts_s {
+  int dpi;                   // 0 = 150; como na compressão que será ajustada
+  int jpeg_quality;          // 0 = 65
+  const char* preset;
+  gsx_color_mode_t mode;
+  int max_pages;             // maior lote medido por documento (0 = 16)
+  int max_seconds;           // orçamento da calibração (0 = 60); para entre execuções
+  const char* work_dir;      // saídas temporárias (NULL = pasta temporária do sistema)
+} gsx_tune_opts_t;
+
+typedef struct gsx_tune_plan_s {
+  int    chunks;             // 1 = não vale dividir
+  int    workers;
+  double est_ms;             // estimativa com 'chunks' lotes (mesclagem inclusa)
+  double est_single_ms;      // estimativa sem dividir
+} gsx_tune_plan_t;
+
+// Roda o corpus com a compressão de opts em lotes de 1..max_pages páginas (um de cada
+// vez), mescla as saídas em grupos crescentes e repete o maior lote em paralelo; ajusta
+// o modelo por mínimos quadrados. O progresso traz uma linha por execução. Retorna o
+// número de execuções medidas ou erro (<0; GSX_E_ARGS se nada pôde ser medido).
+GSX_API int gsx_tune_calibrate(const char* const* corpus, int count, const gsx_tune_opts_t* opts,
+                               /*out*/ gsx_tune_profile_t* out,
+                               gsx_progress_cb on_progress, void* user, volatile int* cancel_flag);
+
+// Perfil em JSON (gravado/lido pela própria biblioteca).
+GSX_API int gsx_tune_save(const char* path, const gsx_tune_profile_t* profile);
+GSX_API int gsx_tune_load(const char* path, /*out*/ gsx_tune_profile_t* profile);
+
+// Perfil usado pela compressão paralela e por gsx_tune_plan_file (global do processo;
+// NULL desativa). Retorna 1 se *out recebeu o perfil ativo, 0 se não há.
+GSX_API void gsx_tune_set_profile(const gsx_tune_profile_t* profile);
+GSX_API int  gsx_tune_get_profile(/*out*/ gsx_tune_profile_t* out);
+
+// Menor tempo estimado para 'pages' páginas de peso total weight_bytes com até
+// max_workers instâncias (0 = nº de CPUs; nunca mais que profile->cpus), com o perfil
+// dado. Sempre preenche *out.
+GSX_API void gsx_tune_plan(const gsx_tune_profile_t* profile, int pages, uint64_t weight_bytes,
+                           int max_workers, /*out*/ gsx_tune_plan_t* out);
+// Idem para [first_page,last_page] de in_path com o perfil ativo. Retorna 1 com plano,
+// 0 sem perfil ativo (*out = 1 lote) ou erro (<0).
+GSX_API int gsx_tune_plan_file(const char* in_path, int first_page, int last_page, int max_workers,
+                               /*out*/ gsx_tune_plan_t* out);
+
+// ===== Pipeline nativo (probe → chunk → compress → merge → dedup → linearize) =====
+typedef struct gsx_pipeline_opts_s {
+  int dpi;                   // 0 = 150
+  int jpeg_quality;          // 0 = 65
+  const char* preset;        // como em gsx_compress_file_sync
+  gsx_color_mode_t mode;
+  int first_page;            // 0 = 1
+  int last_page;             // 0 = última
+  int workers;               // instâncias simultâneas do Ghostscript (0 = nº de CPUs)
+  int skip_dedup;            // 1 = não funde objetos idênticos entre as partes
+  int linearize;             // 1 = saída linearizada (fast web view)
+  int mem_budget_mb;         // partes em memória (memfd) até este total estimado; 0 = 512; <0 = nunca
+  const char* work_dir;      // partes que não cabem na memória (NULL = pasta temporária do sistema)
+} gsx_pipeline_opts_t;
+
+// Requisição inteira numa chamada: lotes do pdfwrite em paralelo (mesma fila de
+// gsx_compress_parallel_sync), partes entregues à mesclagem em memória (memfd no
+// Linux, dentro de mem_budget_mb) e saída final gravada uma vez só, já deduplicada e,
+// se pedido, linearizada. O disco é tocado para ler in_path e escrever out_path.
+// Xref danificada é reparada uma vez antes dos lotes (ver gsx_normalize_pdf).
+// Se report_json != NULL recebe (malloc → gsx_free) {"pages","parts","parts_in_memory",
+// "handoff":"memfd"|"mixed"|"file","part_bytes","bytes_in","bytes_out","objects",
+// "normalized","linearized","total_ms","stages":[{"stage","ms"}]} com as etapas probe,
+// normalize, chunk, compress, merge, dedup e linearize (ou write); com uma parte só, merge e
+// dedup não rodam (a parte vai direto para a saída). Progresso como no compressor paralelo, mais uma linha "pipeline: <etapa>" (0, 0) no início de cada fase longa.
+// A entrada precisa ser legível pelo leitor nativo (senão GSX_E_PDF_PARSE: use o
+// caminho com arquivos). Retorna o número de páginas ou erro (<0).
+GSX_API int gsx_pipeline_run(
+  const char* in_path,
+  const char* out_path,
+  const gsx_pipeline_opts_t* opts,
+  /*out*/ char** report_json,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// ===== Mesclagem nativa (sem qpdf) =====
+enum {
+  GSX_MERGE_DEDUP = 1,     // funde objetos idênticos entre as entradas (fontes, ICC, imagens)
+  GSX_MERGE_LINEARIZE = 2  // grava já linearizado (fast web view), na mesma passada
+};
+
+typedef struct gsx_merge_stats_s {
+  int      pages;
+  int      objects_in;            // objetos alcançáveis coletados das entradas
+  int      objects_out;           // objetos gravados (após deduplicação)
+  uint64_t stream_bytes_saved;    // bytes de stream não gravados por serem duplicados
+  uint64_t bytes_out;             // tamanho do arquivo gerado
+} gsx_merge_stats_t;
+
+// Concatena as páginas de in_paths[0..count-1], nessa ordem, em out_path.
+// Objetos alcançáveis a partir das páginas são renumerados e os streams copiados sem
+// decodificar; a árvore de páginas da saída é plana. Outlines/AcroForm não são levados,
+// exceto com uma entrada só: aí o catálogo (menos /Pages) e /Info e /ID são mantidos.
+// flags: GSX_MERGE_*; stats_out pode ser NULL. out_path não pode ser uma das entradas.
+// Retorna o total de páginas gravadas ou erro (<0); em erro out_path é removido.
+GSX_API int gsx_merge_pdfs(
+  const char* const* in_paths,
+  int count,
+  const char* out_path,
+  int flags,
+  /*out*/ gsx_merge_stats_t* stats_out
+);
+
+// Deduplicação avulsa: regrava in_path em out_path fundindo objetos idênticos
+// (equivale a gsx_merge_pdfs com uma entrada e GSX_MERGE_DEDUP; catálogo, /Info e /ID
+// da entrada são preservados).
+GSX_API int gsx_dedup_pdf(
+  const char* in_path,
+  const char* out_path,
+  /*out*/ gsx_merge_stats_t* stats_out
+);
+
+// Confere a deduplicação em grafos sintéticos (cadeias de até 1000 elos que diferem só na
+// cauda, cadeias e ciclos idênticos). Retorna o número de casos errados (0 = ok). Se
+// json_out != NULL recebe (malloc → gsx_free) {"cases","failures","mismatches":[...]}.
+GSX_API int gsx_merge_selftest(/*out*/ char** json_out);
+
+// ===== Linearização nativa (fast web view, sem qpdf) =====
+typedef struct gsx_linearize_stats_s {
+  int      pages;
+  int      objects;               // objetos gravados
+  int      first_page_objects;    // seção da 1ª página
+  int      shared_objects;        // usados por várias páginas (fora da 1ª)
+  uint64_t first_page_end;        // /E: bytes até o fim da 1ª página
+  uint64_t hint_bytes;            // hint stream (tabelas de páginas e compartilhados)
+  uint64_t bytes_out;
+} gsx_linearize_stats_t;
+
+// Regrava in_path linearizado em out_path: dicionário de linearização, hint tables e
+// 1ª página no início do arquivo, depois cada página com seus objetos exclusivos.
+// Streams copiados sem recodificar; xref clássica. Para mesclar e linearizar numa
+// passada só, use gsx_merge_pdfs com GSX_MERGE_LINEARIZE. stats_out pode ser NULL;
+// out_path não pode ser in_path. Retorna o número de páginas ou erro (<0).
+GSX_API int gsx_linearize_pdf(
+  const char* in_path,
+  const char* out_path,
+  /*out*/ gsx_linearize_stats_t* stats_out
+);
+
+// ===== Pós-passo estrutural (recompressão Flate + object streams) =====
+typedef struct gsx_optimize_opts_s {
+  int level;            // zlib 1..9; 0 = esforço máximo (nível 9, estratégias padrão e filtrada)
+  int workers;          // threads de compressão (0 = nº de CPUs)
+  int classic_xref;     // 1 = mantém xref clássica, sem object streams
+  int skip_unfiltered;  // 1 = não comprime streams sem filtro
+} gsx_optimize_opts_t;
+
+typedef struct gsx_optimize_stats_s {
+  int      objects;               // objetos gravados (alcançáveis a partir do trailer)
+  int      objects_packed;        // dentro de object streams
+  int      object_streams;
+  int      streams;
+  int      streams_recompressed;  // Flate reinflado e recomprimido menor
+  int      streams_deflated;      // sem filtro → Flate
+  uint64_t stream_bytes_in, stream_bytes_out;
+  uint64_t bytes_in, bytes_out;
+  uint64_t cpu_us;                // tempo de CPU somado das threads de compressão
+  uint64_t elapsed_us;
+} gsx_optimize_stats_t;
+
+// Regrava in_path em out_path sem Ghostscript: recomprime em paralelo os streams
+// /FlateDecode (e comprime os sem filtro), ficando com o original quando não há ganho;
+// empacota os objetos sem stream em object streams com xref stream (PDF 1.5) e descarta
+// o que não é alcançável. Pensado como etapa opcional depois do pdfwrite/mesclagem.
+// Progresso: (streams prontos, total). opts/stats_out podem ser NULL; out_path não
+// pode ser in_path. Retorna o número de objetos gravados ou erro (<0).
+GSX_API int gsx_optimize_pdf(
+  const char* in_path,
+  const char* out_path,
+  const gsx_optimize_opts_t* opts,
+  /*out*/ gsx_optimize_stats_t* stats_out,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag
+);
+
+// ===== Kernels de raster (diagnóstico) =====
+// Conversão RGB→cinza, limiarização e reamostragem usadas pelos motores nativos têm
+// variantes escalar, SSE4.2 e AVX2, escolhidas pela CPU na primeira chamada.
+// A variável de ambiente GSX_SIMD=scalar|sse4.2|avx2 força um nível (se suportado).
+
+// Nível em uso: "scalar", "sse4.2" ou "avx2" (string estática).
+GSX_API const char* gsx_simd_level(void);
+
+// Compara, em entradas aleatórias com tamanhos que exercitam as sobras dos laços, cada
+// variante SIMD disponível com a escalar. Retorna o número de casos divergentes (0 = todas
+// idênticas bit a bit). Se json_out != NULL recebe (malloc → gsx_free)
+// {"active","levels","cases","failures","mismatches":[{level,kernel,case}]}.
+GSX_API int gsx_kernels_selftest(/*out*/ char** json_out);
+
+// Microbenchmark: cada kernel em cada nível disponível sobre ~megapixels Mpx (0 = 16,
+// máx. 64), melhor de 3. *json_out (malloc → gsx_free) =
+// {"active","megapixels","levels","kernels":[{kernel,mpx_per_s{nível:valor}}]}.
+GSX_API int gsx_kernels_bench(int megapixels, /*out*/ char** json_out);
+
+// ===== Teste de resistência (vazamentos em processos longos) =====
+typedef struct gsx_soak_opts_s {
+  int seconds;               // duração (0 = 300)
+  int workers;               // laços simultâneos (0 = 4)
+  int sample_ms;             // intervalo entre amostras (0 = 2000)
+  int warmup_pct;            // % inicial das amostras fora da análise (0 = 20)
+  int dpi;                   // 0 = 150
+  int jpeg_quality;          // 0 = 65
+  const char* preset;
+  gsx_color_mode_t mode;
+  int max_pages;             // páginas por job (0 = 4)
+  unsigned seed;             // sorteio dos jobs (0 = relógio; sai no relatório)
+  const char* work_dir;      // saídas e partes (NULL = pasta temporária do sistema)
+} gsx_soak_opts_t;
+
+// Roda jobs misturados (síncronos, assíncronos, cancelados, com falha, pipeline e
+// gsx_build_pdfwrite_args) em 'workers' laços até 'seconds' e amostra RSS, descritores,
+// threads (Linux) e temporários GSX* a cada sample_ms, com uma linha de progresso por
+// amostra. Se report_json != NULL recebe (malloc → gsx_free) {"seconds","workers","seed",
+// "jobs":{tipo:n},"unexpected","unexpected_msgs","series":[{name,measured,first,last,
+// tolerance,growing}],"growing","conclusive","samples":[{t_ms,rss_kb,fds,threads,
+// tmp_files,tmp_bytes,jobs}]}. "unexpected" conta jobs válidos que falharam (ou o
+// inexistente que passou). Retorna quantos recursos crescem (0 = passou) ou erro (<0).
+GSX_API int gsx_soak_run(const char* const* corpus, int count, const gsx_soak_opts_t* opts,
+                         /*out*/ char** report_json,
+                         gsx_progress_cb on_progress, void* user, volatile int* cancel_flag);
+
+// ===== Captura e replay de carga =====
+// Com a captura ligada, cada chamada de topo de compressão (gsx_compress_file_sync,
+// gsx_compress_fd_sync, gsx_compress_parallel_sync, gsx_pipeline_run) vira uma linha JSON
+// em 'path': {"t" (ms desde gsx_capture_start), "call", "in", "size", "hash" (da entrada
+// inteira, lida no início da chamada), "dpi","q","preset","mode","first","last","workers",
+// "flags", "rc", "ms", "out" (bytes gravados)}. A primeira linha é {"gsx_capture":1,...}.
+// Retorna GSX_OK ou GSX_E_WRITE_OPEN; uma captura anterior é encerrada antes.
+GSX_API int gsx_capture_start(const char* path);
+GSX_API void gsx_capture_stop(void);
+GSX_API int gsx_capture_active(void);
+
+typedef struct gsx_replay_opts_s {
+  double speed;              // 1 = ritmo gravado, N = N vezes mais rápido, 0 = sem esperar
+  int concurrency;           // jobs simultâneos (0 = 8)
+  int limit;                 // só os primeiros N registros (0 = todos)
+  const char* inputs_dir;    // procura por tamanho e hash quando o caminho gravado não confere
+  const char* work_dir;      // saídas descartáveis (NULL = pasta temporária do sistema)
+} gsx_replay_opts_t;
+
+// Reemite a carga de uma captura contra esta build, na chegada gravada dividida por
+// 'speed' (laço aberto: um job atrasado não segura os próximos). Chamadas por fd voltam
+// como gsx_compress_file_sync; as saídas são apagadas. Latência conta da chegada
+// prevista (inclui a espera por um worker), serviço só a execução. Uma linha de
+// progresso por job. Se report_json != NULL recebe (malloc → gsx_free) {"records",
+// "replayed","missing","failed","outcome_mismatch","speed","concurrency","wall_ms",
+// "jobs_per_s","latency_ms","service_ms","captured_ms"} — os três últimos com
+// {p50,p90,p99,max,mean}; "captured_ms" é a duração gravada dos mesmos jobs.
+// Retorna quantos jobs foram reemitidos ou erro (<0).
+GSX_API int gsx_replay_run(const char* capture_path, const gsx_replay_opts_t* opts,
+                           /*out*/ char** report_json,
+                           gsx_progress_cb on_progress, void* user, volatile int* cancel_flag);
+
 // ===== Util =====
 GSX_API void gsx_free(void* p);
@@ -0,0 +1,181 @@
+// gsx_classify.cpp — pré-passada de classificação de páginas (gsx_classify_pages)
+//
+// Renderiza o intervalo em baixa resolução (ppmraw, sem anti-aliasing) direto para a
+// memória e classifica cada página como em branco, P&B, cinza ou colorida a partir do
+// histograma de luminância e da contagem de pixels cromáticos. Sem anti-aliasing o
+// texto vetorial sai só em preto/branco e as imagens são amostradas sem interpolação,
+// então meios-tons indicam conteúdo realmente em tons (foto, sombreado, digitalização).
+//
+// As faixas de páginas são equilibradas pelo mesmo peso do gsx_plan_chunks e cada
+// uma roda numa instância própria do Ghostscript.
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+static const int kDefaultDpi = 24;
+// pixel cromático: max(r,g,b) - min(r,g,b) acima disto (ruído de scanner fica abaixo)
+static const int kChromaMin = 48;
+// "tinta" = mais escuro que o papel por pelo menos isto
+static const int kInkDelta = 48;
+// abaixo disto é preto (não meio-tom)
+static const int kBlackMax = 80;
+
+struct PageStats {
+  uint64_t hist[256];
+  uint64_t colored;
+  uint64_t n;
+  void reset() { memset(hist, 0, sizeof(hist)); colored = 0; n = 0; }
+};
+
+static void classify_stats(const PageStats& st, gsx_page_class_t& out) {
+  if (st.n == 0) { out.kind = GSX_PAGE_COLOR; return; }
+
+  // papel = pico (janela de 5 níveis) na metade clara do histograma
+  int bg = 255;
+  uint64_t best = 0;
+  for (int i = 128; i < 256; ++i) {
+    uint64_t s = 0;
+    for (int j = std::max(128, i - 2); j <= std::min(255, i + 2); ++j) s += st.hist[j];
+    if (s > best) { best = s; bg = i; }
+  }
+  const int ink_lim = std::max(0, bg - kInkDelta);
+  uint64_t ink = 0, mid = 0;
+  for (int i = 0; i < ink_lim; ++i) {
+    ink += st.hist[i];
+    if (i >= kBlackMax) mid += st.hist[i];
+  }
+  const double n = (double)st.n;
+  out.ink = (float)(ink / n);
+  out.color = (float)(st.colored / n);
+  out.midtone = (float)(mid / n);
+  out.image_heavy = out.midtone >= 0.15f ? 1 : 0;
+
+  if (out.color >= 0.002f)                                   out.kind = GSX_PAGE_COLOR;
+  else if (out.ink < 0.0005f)                                out.kind = GSX_PAGE_BLANK;
+  else if (out.midtone < 0.002f || mid * 4 <= ink)           out.kind = GSX_PAGE_BILEVEL;
+  else                                                       out.kind = GSX_PAGE_GRAY;
+}
+
+// Estatísticas por página a partir das linhas RGB do ppmraw.
+struct ClassifyReader : GsxPnmReader {
+  gsx_page_class_t* out = nullptr;
+  int capacity = 0;
+  int first_page = 0;
+  int done = 0;
+  int w = 0, ch = 3;
+  PageStats st;
+
+  void on_page(int width, int, int channels) override { w = width; ch = channels; st.reset(); }
+
+  void on_row(int, const uint8_t* row) override {
+    if (ch == 1) {
+      for (int x = 0; x < w; ++x) ++st.hist[row[x]];
+      st.n += (uint64_t)w;
+      return;
+    }
+    for (int x = 0; x < w; ++x, row += 3) {
+      int r = row[0], g = row[1], b = row[2];
+      int mx = std::max(r, std::max(g, b)), mn = std::min(r, std::min(g, b));
+      ++st.hist[(r * 77 + g * 150 + b * 29) >> 8];
+      if (mx - mn >= kChromaMin) ++st.colored;
+    }
+    st.n += (uint64_t)w;
+  }
+
+  void on_page_end() override {
+    if (done < capacity) {
+      gsx_page_class_t& c = out[done];
+      c.page = first_page + done;
+      classify_stats(st, c);
+    }
+    ++done;
+  }
+};
+
+static int classify_range(const char* in_path, int first, int last, int dpi,
+                          gsx_page_class_t* out, volatile int* cancel_flag) {
+  std::vector<std::string> A = {
+    "gs", "-dSAFER", "-dBATCH", "-dNOPAUSE", "-dQUIET", "-sstdout=%stderr",
+    "-sDEVICE=ppmraw", "-r" + std::to_string(dpi),
+    "-dTextAlphaBits=1", "-dGraphicsAlphaBits=1", "-dNOINTERPOLATE",
+    "-dFirstPage=" + std::to_string(first), "-dLastPage=" + std::to_string(last),
+    "-sOutputFile=-", in_path
+  };
+  ClassifyReader ps;
+  ps.out = out;
+  ps.capacity = last - first + 1;
+  ps.first_page = first;
+  int rc = gsx_run_gs_raw(A, &GsxPnmReader::sink, &ps, nullptr, nullptr, cancel_flag);
+  if (rc < 0) return rc;
+  if (ps.done < ps.capacity) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "classify: %d de %d páginas renderizadas (%d-%d)",
+             ps.done, ps.capacity, first, last);
+    gsx_log_msg(GSX_LOG_WARN, msg);
+  }
+  return ps.done;
+}
+
+GSX_API int gsx_classify_pages(
+  const char* in_path,
+  int first_page,
+  int last_page,
+  int dpi,
+  int workers,
+  gsx_page_class_t* out,
+  volatile int* cancel_flag)
+{
+  if (!in_path || !out || first_page < 0 || last_page < 0 ||
+      (last_page && first_page > last_page) || dpi < 0 || dpi > 300) {
+    set_last_error_json(GSX_E_ARGS, "classify_pages", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  if (dpi == 0) dpi = kDefaultDpi;
+
+  int first = first_page, last = last_page;
+  std::vector<uint64_t> weights;
+  int rc = gsx_page_weights(in_path, first, last, weights);
+  if (rc < 0) return rc;
+  const int total = last - first + 1;
+
+  // páginas que o Ghostscript não entregar ficam como coloridas (nenhuma conversão)
+  for (int i = 0; i < total; ++i) {
+    memset(&out[i], 0, sizeof(out[i]));
+    out[i].page = first + i;
+    out[i].kind = GSX_PAGE_COLOR;
+  }
+
+  if (workers <= 0) workers = (int)std::thread::hardware_concurrency();
+  workers = std::max(1, std::min(workers, total));
+  auto ranges = gsx_partition_weights(weights, workers);
+
+  std::vector<int> rcs(ranges.size(), 0);
+  std::vector<std::thread> pool;
+  for (size_t k = 0; k < ranges.size(); ++k) {
+    pool.emplace_back([&, k] {
+      int a = first + (int)ranges[k].first, b = first + (int)ranges[k].second;
+      rcs[k] = classify_range(in_path, a, b, dpi, out + ranges[k].first, cancel_flag);
+    });
+  }
+  for (auto& t : pool) t.join();
+
+  if (cancel_flag && *cancel_flag) {
+    set_last_error_json(GSX_E_CANCELED, "classify_pages", 0, 0, nullptr);
+    return GSX_E_CANCELED;
+  }
+  for (int r : rcs) {
+    if (r < 0) {
+      set_last_error_json(r, "classify_pages", 0, r, nullptr);
+      return r;
+    }
+  }
+  set_last_error_json(GSX_OK, "classify_pages", 0, 0, nullptr);
+  return total;
+}
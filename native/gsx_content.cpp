@@ -0,0 +1,143 @@
+// gsx_content.cpp — interpretação mínima de content streams: só o necessário para saber
+// onde cada imagem XObject é desenhada (q/Q/cm/Do e Forms aninhados). Texto, caminhos e
+// cores são ignorados; imagens inline só são contadas e puladas.
+//
+// Usado pelo gsx_analyze (dpi efetivo no inventário) e pelo gsx_recompress_images
+// (resolução de destino de cada imagem).
+
+#include <cmath>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+using namespace gsx_pdf;
+
+namespace {
+
+static const int kMaxFormDepth = 8;
+
+struct Matrix {
+  double a = 1, b = 0, c = 0, d = 1, e = 0, f = 0;
+  // this × m
+  Matrix mul(const Matrix& m) const {
+    Matrix r;
+    r.a = a * m.a + b * m.c;  r.b = a * m.b + b * m.d;
+    r.c = c * m.a + d * m.c;  r.d = c * m.b + d * m.d;
+    r.e = e * m.a + f * m.c + m.e;
+    r.f = e * m.b + f * m.d + m.f;
+    return r;
+  }
+};
+
+static bool matrix_from(const Obj& arr, Matrix& m) {
+  if (!arr.is_array() || arr.arr->size() < 6) return false;
+  auto& a = *arr.arr;
+  m.a = a[0].as_num(); m.b = a[1].as_num(); m.c = a[2].as_num();
+  m.d = a[3].as_num(); m.e = a[4].as_num(); m.f = a[5].as_num();
+  return true;
+}
+
+// pula os dados de uma imagem inline (após "ID") até "EI" delimitado
+static size_t skip_inline(const uint8_t* p, size_t n, size_t pos) {
+  if (pos < n && Lexer::is_ws(p[pos])) ++pos;
+  for (size_t i = pos; i + 2 <= n; ++i) {
+    if (p[i] == 'E' && p[i + 1] == 'I' && (i == 0 || Lexer::is_ws(p[i - 1])) &&
+        (i + 2 == n || Lexer::is_ws(p[i + 2]) || Lexer::is_delim(p[i + 2])))
+      return i + 2;
+  }
+  return n;
+}
+
+struct Walker {
+  Document& doc;
+  GsxImageScan& scan;
+  int page;
+  std::unordered_set<uint32_t> on_path;     // Forms em execução (ciclos)
+
+  void run(const std::string& data, const Obj& resources, Matrix ctm, int depth) {
+    Obj res = doc.resolve(resources);
+    Obj xobjs = res.is_dict() ? doc.get(res, "XObject") : Obj();
+    Lexer lx((const uint8_t*)data.data(), data.size());
+    std::vector<Obj> ops;
+    std::vector<Matrix> stack;
+    for (;;) {
+      lx.skip_ws();
+      if (lx.pos() >= data.size()) break;
+      const size_t at = lx.pos();
+      const uint8_t c0 = (uint8_t)data[at];
+      Obj o;
+      if (lx.parse(o)) { if (ops.size() < 64) ops.push_back(std::move(o)); continue; }
+      if (lx.pos() <= at) lx.seek(at + 1);       // token inválido: não trava
+      const bool is_kw = (c0 >= 'A' && c0 <= 'Z') || (c0 >= 'a' && c0 <= 'z') || c0 == '\'' || c0 == '"';
+      const std::string kw = is_kw ? lx.kw() : std::string();
+      if (kw == "q") { if (stack.size() < 256) stack.push_back(ctm); }
+      else if (kw == "Q") { if (!stack.empty()) { ctm = stack.back(); stack.pop_back(); } }
+      else if (kw == "cm" && ops.size() >= 6) {
+        Matrix m;
+        size_t b = ops.size() - 6;
+        m.a = ops[b].as_num(); m.b = ops[b + 1].as_num(); m.c = ops[b + 2].as_num();
+        m.d = ops[b + 3].as_num(); m.e = ops[b + 4].as_num(); m.f = ops[b + 5].as_num();
+        ctm = m.mul(ctm);
+      }
+      else if (kw == "ID") {
+        size_t end = skip_inline((const uint8_t*)data.data(), data.size(), lx.pos());
+        ++scan.inline_images;
+        scan.inline_bytes += end - lx.pos();
+        lx.seek(end);
+      }
+      else if (kw == "Do" && !ops.empty() && ops.back().is_name() && xobjs.is_dict()) {
+        const Obj* ref = xobjs.get(ops.back().s.c_str());
+        if (ref && ref->is_ref()) draw(ref->ref_num(), resources, ctm, depth);
+      }
+      ops.clear();
+    }
+  }
+
+  void draw(uint32_t n, const Obj& parent_res, const Matrix& ctm, int depth) {
+    Indirect ind;
+    if (!doc.load(n, ind) || !ind.is_stream) return;
+    const Obj* sub = ind.value.get("Subtype");
+    if (!sub) return;
+    if (sub->is_name("Image")) {
+      GsxImageUse& u = scan.images[n];
+      if (u.pages.empty() || u.pages.back() != page) u.pages.push_back(page);
+      ++u.placements;
+      double w = std::hypot(ctm.a, ctm.b), h = std::hypot(ctm.c, ctm.d);
+      if (w * h > u.w_pt * u.h_pt) { u.w_pt = w; u.h_pt = h; }
+      return;
+    }
+    if (!sub->is_name("Form") || depth >= kMaxFormDepth || !on_path.insert(n).second) return;
+    std::string data;
+    if (doc.decode_stream(ind, data)) {
+      Matrix fm;
+      Matrix m = ctm;
+      if (matrix_from(doc.get(ind.value, "Matrix"), fm)) m = fm.mul(ctm);
+      const Obj* r = ind.value.get("Resources");
+      run(data, r ? *r : parent_res, m, depth + 1);
+    }
+    on_path.erase(n);
+  }
+};
+
+}  // namespace
+
+void gsx_scan_page_images(Document& doc, const PageInfo& pg, int page, GsxImageScan& scan) {
+  Obj contents = doc.get(pg.dict, "Contents");
+  std::string all, part;
+  auto add = [&](const Obj& ref) {
+    Indirect ind;
+    if (ref.is_ref() && doc.load(ref.ref_num(), ind) && doc.decode_stream(ind, part)) {
+      all += part;
+      all.push_back('\n');
+    }
+  };
+  const Obj* c = pg.dict.get("Contents");
+  if (c && c->is_ref() && !contents.is_array()) add(*c);
+  else if (contents.is_array()) for (auto& r : *contents.arr) add(r);
+  if (all.empty()) return;
+  Walker wk{doc, scan, page, {}};
+  wk.run(all, pg.resources, Matrix(), 0);
+}
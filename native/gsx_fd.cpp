@@ -0,0 +1,242 @@
+// gsx_fd.cpp — compressão por descritores (gsx_compress_fd_sync) e memfd
+//
+// O servidor recebe o upload num memfd e devolve a resposta do descritor de saída,
+// sem caminhos temporários no meio. No Linux um descritor de arquivo regular (memfd
+// e tmpfs inclusive) é aberto de novo pelo Ghostscript/leitor nativo como
+// /proc/self/fd/N: nada é copiado. Pipes e sockets não podem ser reabertos assim
+// (nem mapeados/buscados), então passam por um temporário — a entrada é gravada
+// nele até o EOF e a saída é copiada para o descritor no fim (sendfile no Linux).
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#ifdef _WIN32
+  #include <io.h>
+#else
+  #include <unistd.h>
+#endif
+#ifdef __linux__
+  #include <sys/mman.h>
+  #include <sys/sendfile.h>
+#endif
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+#ifdef _WIN32
+static long long fd_read(int fd, void* p, size_t n) { return _read(fd, p, (unsigned)std::min<size_t>(n, 1u << 30)); }
+static long long fd_write(int fd, const void* p, size_t n) { return _write(fd, p, (unsigned)std::min<size_t>(n, 1u << 30)); }
+static bool fd_rewind(int fd) { return _lseeki64(fd, 0, SEEK_SET) == 0; }
+static bool fd_truncate(int fd) { return _chsize_s(fd, 0) == 0; }
+static bool fd_regular(int fd) { struct _stat64 st; return _fstat64(fd, &st) == 0 && (st.st_mode & _S_IFREG); }
+static int fd_open_read(const std::string& p) { return _open(p.c_str(), _O_RDONLY | _O_BINARY); }
+static int fd_close(int fd) { return _close(fd); }
+#else
+static long long fd_read(int fd, void* p, size_t n) {
+  ssize_t r;
+  do r = ::read(fd, p, n); while (r < 0 && errno == EINTR);
+  return r;
+}
+static long long fd_write(int fd, const void* p, size_t n) {
+  ssize_t r;
+  do r = ::write(fd, p, n); while (r < 0 && errno == EINTR);
+  return r;
+}
+static bool fd_rewind(int fd) { return lseek(fd, 0, SEEK_SET) == 0; }
+static bool fd_truncate(int fd) { return ftruncate(fd, 0) == 0; }
+static bool fd_regular(int fd) { struct stat st; return fstat(fd, &st) == 0 && S_ISREG(st.st_mode); }
+static int fd_open_read(const std::string& p) { return ::open(p.c_str(), O_RDONLY | O_CLOEXEC); }
+static int fd_close(int fd) { return ::close(fd); }
+#endif
+
+// Caminho pelo qual o descritor pode ser reaberto sem cópia ("" = precisa de temporário)
+static std::string reopen_path(int fd) {
+#ifdef __linux__
+  if (fd_regular(fd)) return "/proc/self/fd/" + std::to_string(fd);
+#else
+  (void)fd;
+#endif
+  return std::string();
+}
+
+static bool write_all(int fd, const char* p, size_t n) {
+  while (n) {
+    long long w = fd_write(fd, p, n);
+    if (w <= 0) return false;
+    p += w;
+    n -= (size_t)w;
+  }
+  return true;
+}
+
+// Entrada num temporário: arquivo regular desde o início, pipe/socket até o EOF
+static int spool_in(int fd, const std::string& path) {
+  FILE* f = std::fopen(path.c_str(), "wb");
+  if (!f) {
+    set_last_error_json(GSX_E_TEMP_CREATE, "compress_fd.spool", errno, 0, nullptr);
+    return GSX_E_TEMP_CREATE;
+  }
+  if (fd_regular(fd)) fd_rewind(fd);
+  std::vector<char> buf(1u << 20);
+  for (;;) {
+    long long r = fd_read(fd, buf.data(), buf.size());
+    if (r == 0) break;
+    if (r < 0 || std::fwrite(buf.data(), 1, (size_t)r, f) != (size_t)r) {
+      const int e = errno;
+      std::fclose(f);
+      set_last_error_json(r < 0 ? GSX_E_INPUT_NOT_FOUND : GSX_E_TEMP_IO, "compress_fd.spool", e, 0, nullptr);
+      return r < 0 ? GSX_E_INPUT_NOT_FOUND : GSX_E_TEMP_IO;
+    }
+  }
+  if (std::fclose(f) != 0) {
+    set_last_error_json(GSX_E_TEMP_IO, "compress_fd.spool", errno, 0, nullptr);
+    return GSX_E_TEMP_IO;
+  }
+  return GSX_OK;
+}
+
+// Saída do temporário para o descritor
+static int copy_out(const std::string& path, int out_fd, uint64_t* written) {
+  int in = fd_open_read(path);
+  if (in < 0) {
+    set_last_error_json(GSX_E_TEMP_IO, "compress_fd.copy", errno, 0, nullptr);
+    return GSX_E_TEMP_IO;
+  }
+  uint64_t total = 0;
+  bool ok = true;
+#ifdef __linux__
+  // sendfile: kernel → kernel, inclusive para sockets
+  bool fallback = false;
+  for (;;) {
+    ssize_t s = sendfile(out_fd, in, nullptr, 1u << 30);
+    if (s < 0 && errno == EINTR) continue;
+    if (s < 0 && (errno == EINVAL || errno == ENOSYS) && total == 0) { fallback = true; break; }
+    if (s < 0) { ok = false; break; }
+    if (s == 0) break;
+    total += (uint64_t)s;
+  }
+  if (fallback)
+#endif
+  {
+    std::vector<char> buf(1u << 20);
+    for (;;) {
+      long long r = fd_read(in, buf.data(), buf.size());
+      if (r == 0) break;
+      if (r < 0 || !write_all(out_fd, buf.data(), (size_t)r)) { ok = false; break; }
+      total += (uint64_t)r;
+    }
+  }
+  const int e = errno;
+  fd_close(in);
+  if (!ok) {
+    set_last_error_json(GSX_E_WRITE_IO, "compress_fd.copy", e, 0, nullptr);
+    return GSX_E_WRITE_IO;
+  }
+  *written = total;
+  return GSX_OK;
+}
+
+}  // namespace
+
+GSX_API int gsx_compress_fd_sync(int in_fd, int out_fd,
+                                 int dpi, int jpeg_quality, const char* preset, gsx_color_mode_t mode,
+                                 int first_page, int last_page, uint64_t* out_len,
+                                 gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  GsxJobScope scope("gsx_compress_fd_sync");
+  if (out_len) *out_len = 0;
+  if (in_fd < 0 || out_fd < 0 || in_fd == out_fd) {
+    set_last_error_json(GSX_E_ARGS, "compress_fd", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  std::error_code ec;
+  const bool out_regular = fd_regular(out_fd);
+  std::string in_path = reopen_path(in_fd);
+  std::string out_path = reopen_path(out_fd);
+  std::string tmp_in, tmp_out;
+  auto cleanup = [&] {
+    if (!tmp_in.empty()) fs::remove(tmp_in, ec);
+    if (!tmp_out.empty()) fs::remove(tmp_out, ec);
+  };
+
+  if (in_path.empty()) {
+    tmp_in = in_path = gsx_make_temp_path(nullptr, "GSXI", ".pdf");
+    GsxSpan span("fd.spool_in");
+    int rc = spool_in(in_fd, tmp_in);
+    if (rc < 0) { cleanup(); return rc; }
+  }
+  // depois do spool: a captura lê a entrada pelo caminho
+  scope.capture({"compress_fd", in_path.c_str(), dpi, jpeg_quality, preset, (int)mode, first_page, last_page, 0, 0});
+  if (out_regular && !fd_truncate(out_fd)) {
+    set_last_error_json(GSX_E_WRITE_OPEN, "compress_fd", errno, 0, nullptr);
+    cleanup();
+    return GSX_E_WRITE_OPEN;
+  }
+  if (out_path.empty()) tmp_out = out_path = gsx_make_temp_path(nullptr, "GSXO", ".pdf");
+
+  int rc = gsx_compress_file_sync(in_path.c_str(), out_path.c_str(), dpi, jpeg_quality, preset, mode,
+                                  first_page, last_page, on_progress, user, cancel_flag);
+  if (rc < 0) { cleanup(); return rc; }
+  uint64_t in_bytes = (uint64_t)fs::file_size(in_path, ec);
+  if (ec) in_bytes = 0;
+
+  uint64_t written = 0;
+  if (!tmp_out.empty()) {
+    GsxSpan span("fd.copy_out");
+    int crc = copy_out(tmp_out, out_fd, &written);
+    if (crc < 0) { cleanup(); return crc; }
+  } else {
+    written = (uint64_t)fs::file_size(out_path, ec);
+  }
+  // pronto para ser lido (ou enviado) do início
+  if (out_regular) fd_rewind(out_fd);
+  cleanup();
+  if (out_len) *out_len = written;
+  scope.bytes(in_bytes, written);
+  set_last_error_json(GSX_OK, "compress_fd", 0, 0, nullptr);
+  return rc;
+}
+
+GSX_API int gsx_memfd_create(const char* name) {
+#ifdef __linux__
+  int fd = memfd_create(name && *name ? name : "gsx", MFD_CLOEXEC);
+  if (fd >= 0) return fd;
+#else
+  (void)name;
+#endif
+  // sem memfd: temporário removido logo após abrir (no Windows, apagado ao fechar)
+  std::string path = gsx_make_temp_path(nullptr, "GSXM", ".pdf");
+#ifdef _WIN32
+  int fd2 = _open(path.c_str(), _O_RDWR | _O_BINARY | _O_TEMPORARY);
+#else
+  int fd2 = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+  if (fd2 >= 0) ::unlink(path.c_str());
+#endif
+  if (fd2 < 0) {
+    const int e = errno;
+    std::error_code ec;
+    fs::remove(path, ec);
+    set_last_error_json(GSX_E_TEMP_CREATE, "memfd_create", e, 0, nullptr);
+    return GSX_E_TEMP_CREATE;
+  }
+  return fd2;
+}
+
+GSX_API int gsx_fd_close(int fd) {
+  if (fd < 0 || fd_close(fd) != 0) {
+    set_last_error_json(GSX_E_ARGS, "fd_close", errno, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  return GSX_OK;
+}
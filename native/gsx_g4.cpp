@@ -0,0 +1,149 @@
+// gsx_g4.cpp — codificador CCITT Grupo 4 (ITU-T T.6) para imagens 1-bpp.
+//
+// Entrada: um byte por pixel (0 = branco, != 0 = preto), linha a linha. Cada linha é
+// reduzida à lista de "elementos de mudança" (posições onde a cor troca) e codificada
+// contra a linha anterior nos modos pass / vertical / horizontal. A saída termina com
+// EOFB e é o que o filtro /CCITTFaxDecode espera com /K -1 e /BlackIs1 false.
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "gsx_internal.h"
+
+namespace {
+
+struct Code { uint8_t len; uint16_t bits; };
+
+// Códigos de terminação 0..63 (T.4, tabela 2)
+static const Code kWhiteTerm[64] = {
+  {8,0b00110101},{6,0b000111},{4,0b0111},{4,0b1000},{4,0b1011},{4,0b1100},{4,0b1110},{4,0b1111},
+  {5,0b10011},{5,0b10100},{5,0b00111},{5,0b01000},{6,0b001000},{6,0b000011},{6,0b110100},{6,0b110101},
+  {6,0b101010},{6,0b101011},{7,0b0100111},{7,0b0001100},{7,0b0001000},{7,0b0010111},{7,0b0000011},{7,0b0000100},
+  {7,0b0101000},{7,0b0101011},{7,0b0010011},{7,0b0100100},{7,0b0011000},{8,0b00000010},{8,0b00000011},{8,0b00011010},
+  {8,0b00011011},{8,0b00010010},{8,0b00010011},{8,0b00010100},{8,0b00010101},{8,0b00010110},{8,0b00010111},{8,0b00101000},
+  {8,0b00101001},{8,0b00101010},{8,0b00101011},{8,0b00101100},{8,0b00101101},{8,0b00000100},{8,0b00000101},{8,0b00001010},
+  {8,0b00001011},{8,0b01010010},{8,0b01010011},{8,0b01010100},{8,0b01010101},{8,0b00100100},{8,0b00100101},{8,0b01011000},
+  {8,0b01011001},{8,0b01011010},{8,0b01011011},{8,0b01001010},{8,0b01001011},{8,0b00110010},{8,0b00110011},{8,0b00110100},
+};
+static const Code kBlackTerm[64] = {
+  {10,0b0000110111},{3,0b010},{2,0b11},{2,0b10},{3,0b011},{4,0b0011},{4,0b0010},{5,0b00011},
+  {6,0b000101},{6,0b000100},{7,0b0000100},{7,0b0000101},{7,0b0000111},{8,0b00000100},{8,0b00000111},{9,0b000011000},
+  {10,0b0000010111},{10,0b0000011000},{10,0b0000001000},{11,0b00001100111},{11,0b00001101000},{11,0b00001101100},{11,0b00000110111},{11,0b00000101000},
+  {11,0b00000010111},{11,0b00000011000},{12,0b000011001010},{12,0b000011001011},{12,0b000011001100},{12,0b000011001101},{12,0b000001101000},{12,0b000001101001},
+  {12,0b000001101010},{12,0b000001101011},{12,0b000011010010},{12,0b000011010011},{12,0b000011010100},{12,0b000011010101},{12,0b000011010110},{12,0b000011010111},
+  {12,0b000001101100},{12,0b000001101101},{12,0b000011011010},{12,0b000011011011},{12,0b000001010100},{12,0b000001010101},{12,0b000001010110},{12,0b000001010111},
+  {12,0b000001100100},{12,0b000001100101},{12,0b000001010010},{12,0b000001010011},{12,0b000000100100},{12,0b000000110111},{12,0b000000111000},{12,0b000000100111},
+  {12,0b000000101000},{12,0b000001011000},{12,0b000001011001},{12,0b000000101011},{12,0b000000101100},{12,0b000001011010},{12,0b000001100110},{12,0b000001100111},
+};
+// Códigos de formação 64..1728 (T.4, tabela 3), índice = run/64 - 1
+static const Code kWhiteMakeup[27] = {
+  {5,0b11011},{5,0b10010},{6,0b010111},{7,0b0110111},{8,0b00110110},{8,0b00110111},{8,0b01100100},{8,0b01100101},
+  {8,0b01101000},{8,0b01100111},{9,0b011001100},{9,0b011001101},{9,0b011010010},{9,0b011010011},{9,0b011010100},{9,0b011010101},
+  {9,0b011010110},{9,0b011010111},{9,0b011011000},{9,0b011011001},{9,0b011011010},{9,0b011011011},{9,0b010011000},{9,0b010011001},
+  {9,0b010011010},{6,0b011000},{9,0b010011011},
+};
+static const Code kBlackMakeup[27] = {
+  {10,0b0000001111},{12,0b000011001000},{12,0b000011001001},{12,0b000001011011},{12,0b000000110011},{12,0b000000110100},{12,0b000000110101},{13,0b0000001101100},
+  {13,0b0000001101101},{13,0b0000001001010},{13,0b0000001001011},{13,0b0000001001100},{13,0b0000001001101},{13,0b0000001110010},{13,0b0000001110011},{13,0b0000001110100},
+  {13,0b0000001110101},{13,0b0000001110110},{13,0b0000001110111},{13,0b0000001010010},{13,0b0000001010011},{13,0b0000001010100},{13,0b0000001010101},{13,0b0000001011010},
+  {13,0b0000001011011},{13,0b0000001100100},{13,0b0000001100101},
+};
+// Formação estendida 1792..2560 (comum às duas cores), índice = run/64 - 28
+static const Code kExtMakeup[13] = {
+  {11,0b00000001000},{11,0b00000001100},{11,0b00000001101},{12,0b000000010010},{12,0b000000010011},{12,0b000000010100},{12,0b000000010101},
+  {12,0b000000010110},{12,0b000000010111},{12,0b000000011100},{12,0b000000011101},{12,0b000000011110},{12,0b000000011111},
+};
+
+static const Code kPass = {4, 0b0001};
+static const Code kHoriz = {3, 0b001};
+// vertical: índice = a1 - b1 + 3  (VL3..V0..VR3)
+static const Code kVert[7] = {
+  {7,0b0000010},{6,0b000010},{3,0b010},{1,0b1},{3,0b011},{6,0b000011},{7,0b0000011},
+};
+static const Code kEol = {12, 0b000000000001};
+
+struct BitWriter {
+  std::string& out;
+  uint64_t acc = 0;
+  int n = 0;
+  explicit BitWriter(std::string& o) : out(o) {}
+  void put(Code c) {
+    acc = (acc << c.len) | c.bits;
+    n += c.len;
+    while (n >= 8) { n -= 8; out.push_back((char)(uint8_t)(acc >> n)); }
+  }
+  void flush() {
+    if (n > 0) out.push_back((char)(uint8_t)(acc << (8 - n)));
+    n = 0; acc = 0;
+  }
+};
+
+static void put_run(BitWriter& bw, int run, bool black) {
+  const Code* term = black ? kBlackTerm : kWhiteTerm;
+  const Code* mk = black ? kBlackMakeup : kWhiteMakeup;
+  while (run >= 2624) { bw.put(kExtMakeup[12]); run -= 2560; }   // 2560 + terminação >= 64
+  if (run >= 64) {
+    int m = run / 64;
+    bw.put(m >= 28 ? kExtMakeup[m - 28] : mk[m - 1]);
+    run -= m * 64;
+  }
+  bw.put(term[run]);
+}
+
+// Posições de mudança de cor da linha (pixel imaginário branco antes da coluna 0),
+// seguidas de duas sentinelas = w.
+static void changes(const uint8_t* row, int w, std::vector<int>& out) {
+  out.clear();
+  uint8_t prev = 0;
+  for (int x = 0; x < w; ++x) {
+    uint8_t c = row[x] ? 1 : 0;
+    if (c != prev) { out.push_back(x); prev = c; }
+  }
+  out.push_back(w);
+  out.push_back(w);
+}
+
+}  // namespace
+
+void gsx_g4_encode(const uint8_t* px, int w, int h, std::string& out) {
+  BitWriter bw(out);
+  std::vector<int> ref, cur;
+  ref.assign(2, w);                       // linha de referência inicial: toda branca
+  for (int y = 0; y < h; ++y) {
+    changes(px + (size_t)y * (size_t)w, w, cur);
+    int a0 = -1;
+    bool black = false;                   // cor de a0
+    size_t ia = 0, ib = 0;                // cursores em cur/ref (só avançam)
+    while (a0 < w) {
+      // a1: 1ª mudança na linha atual depois de a0
+      while (cur[ia] <= a0 && cur[ia] < w) ++ia;
+      int a1 = cur[ia];
+      // b1: 1ª mudança na referência depois de a0 com a cor oposta à de a0
+      // (índice par = branco→preto); b2 é a seguinte
+      while (ib > 0 && ref[ib - 1] > a0) --ib;
+      while (ref[ib] < w && (ref[ib] <= a0 || (int)(ib & 1) != (black ? 1 : 0))) ++ib;
+      int b1 = ref[ib];
+      int b2 = (b1 < w) ? ref[ib + 1] : w;
+
+      if (b2 < a1) {                      // modo pass
+        bw.put(kPass);
+        a0 = b2;
+      } else if (a1 - b1 >= -3 && a1 - b1 <= 3) {   // modo vertical
+        bw.put(kVert[a1 - b1 + 3]);
+        a0 = a1;
+        black = !black;
+      } else {                            // modo horizontal: a0a1 e a1a2
+        int a2 = (a1 < w) ? cur[ia + 1] : w;
+        bw.put(kHoriz);
+        put_run(bw, a1 - (a0 < 0 ? 0 : a0), black);
+        put_run(bw, a2 - a1, !black);
+        a0 = a2;
+      }
+    }
+    ref.swap(cur);
+  }
+  bw.put(kEol);
+  bw.put(kEol);
+  bw.flush();
+}
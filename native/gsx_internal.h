@@ -0,0 +1,304 @@
+// gsx_internal.h — utilidades compartilhadas entre os .cpp do gsx_bridge (NÃO exportadas)
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "gsx_bridge.h"
+
+namespace gsx_pdf { class Document; struct PageInfo; }
+struct display_callback_s;
+
+// Log global (mesmo destino de gsx_set_log_callback / ring-buffer)
+void gsx_log_msg(int lvl, const char* msg);
+
+// ===== Rastreamento (gsx_trace.cpp) =====
+// Spans gravados no buffer da thread; com o rastreamento desligado só o teste
+// gsx_trace_on() é pago. Nomes e chaves precisam ser literais (o buffer guarda o ponteiro).
+extern std::atomic<bool> g_gsx_trace_on;
+inline bool gsx_trace_on() { return g_gsx_trace_on.load(std::memory_order_relaxed); }
+uint64_t gsx_trace_clock_ns();
+void gsx_trace_emit(const char* name, uint64_t t0_ns, uint64_t t1_ns,
+                    const char* k1 = nullptr, int64_t v1 = 0, const char* k2 = nullptr, int64_t v2 = 0);
+// Job de rastreamento da thread (0 = nenhum). gsx_trace_job_open devolve 0 com o
+// rastreamento desligado; quem abre fecha com gsx_trace_job_close (ver GsxJobScope).
+uint64_t gsx_trace_job();
+void gsx_trace_set_job(uint64_t job);
+uint64_t gsx_trace_job_open(const char* name);
+void gsx_trace_job_close(uint64_t job, const char* name, uint64_t t0_ns);
+
+class GsxSpan {
+public:
+  explicit GsxSpan(const char* name, const char* k1 = nullptr, int64_t v1 = 0,
+                   const char* k2 = nullptr, int64_t v2 = 0)
+      : name_(name), k1_(k1), k2_(k2), v1_(v1), v2_(v2), t0_(gsx_trace_on() ? gsx_trace_clock_ns() : 0) {}
+  ~GsxSpan() { end(); }
+  void end() {
+    if (t0_) gsx_trace_emit(name_, t0_, gsx_trace_clock_ns(), k1_, v1_, k2_, v2_);
+    t0_ = 0;
+  }
+  GsxSpan(const GsxSpan&) = delete;
+  GsxSpan& operator=(const GsxSpan&) = delete;
+private:
+  const char *name_, *k1_, *k2_;
+  int64_t v1_, v2_;
+  uint64_t t0_;
+};
+
+// ===== Sondas estáticas (USDT, provider "gsx") =====
+// Com <sys/sdt.h> (systemtap-sdt-dev) cada sonda vira um nop mais uma nota ELF: sem
+// ninguém anexado o custo é esse nop; bpftrace/perf trocam por um breakpoint ao anexar.
+//   bpftrace -e 'usdt:./libgsx.so:gsx:page_done { @[arg1] = count(); }'
+// Sem o cabeçalho (ou com -DGSX_NO_USDT) as macros somem. Argumentos: inteiros baratos.
+#if !defined(GSX_NO_USDT) && defined(__linux__) && defined(__has_include)
+#if __has_include(<sys/sdt.h>)
+#include <sys/sdt.h>
+#define GSX_PROBE(name) DTRACE_PROBE(gsx, name)
+#define GSX_PROBE1(name, a) DTRACE_PROBE1(gsx, name, a)
+#define GSX_PROBE2(name, a, b) DTRACE_PROBE2(gsx, name, a, b)
+#define GSX_PROBE3(name, a, b, c) DTRACE_PROBE3(gsx, name, a, b, c)
+#endif
+#endif
+#ifndef GSX_PROBE
+#define GSX_PROBE(name) do {} while (0)
+#define GSX_PROBE1(name, a) do {} while (0)
+#define GSX_PROBE2(name, a, b) do {} while (0)
+#define GSX_PROBE3(name, a, b, c) do {} while (0)
+#endif
+
+// Submissão (job_submit) que a thread está executando; job_start a repete para ligar
+// a espera na fila à execução. 0 = chamada direta.
+extern thread_local uintptr_t g_gsx_probe_key;
+
+// ===== Captura de carga (gsx_replay.cpp) =====
+// Parâmetros de um job de compressão para o arquivo de captura (gsx_capture_start).
+struct GsxCaptureParams {
+  const char* call;          // "compress_file", "compress_fd", "compress_parallel", "pipeline"
+  const char* in_path;
+  int dpi, jpeg_quality;
+  const char* preset;
+  int mode, first_page, last_page;
+  int workers;               // paralela/pipeline (0 = padrão)
+  int flags;                 // pipeline: 1 = linearize, 2 = sem dedup
+};
+extern std::atomic<bool> g_gsx_capture_on;
+inline bool gsx_capture_on() { return g_gsx_capture_on.load(std::memory_order_relaxed); }
+// Início do registro (parâmetros, tamanho e hash da entrada — lidos agora, enquanto a
+// entrada existe); gsx_capture_write completa com chegada, resultado e duração.
+std::string gsx_capture_params(const GsxCaptureParams& p);
+void gsx_capture_write(const std::string& params, std::chrono::steady_clock::time_point arrival, int rc,
+                       double ms, uint64_t bytes_out);
+
+// ===== Chamadas de topo e métricas (gsx_metrics.cpp) =====
+// Escopo de uma chamada pública de topo; as aninhadas (lotes da paralela, compressões
+// da calibração) não abrem outro. Abre o job do rastreamento e, no fim, conta a chamada
+// pelo resultado (rc do último set_last_error_json da thread), a latência e os bytes de
+// entrada/saída (tamanho dos caminhos, ou os informados com bytes()).
+class GsxJobScope {
+public:
+  explicit GsxJobScope(const char* name, const char* in_path = nullptr, const char* out_path = nullptr);
+  ~GsxJobScope();
+  void bytes(uint64_t in, uint64_t out) { in_bytes_ = in; out_bytes_ = out; out_path_ = nullptr; }
+  // Com a captura ligada, registra esta chamada (só as de topo) ao terminar.
+  void capture(const GsxCaptureParams& p) {
+    if (top_ && gsx_capture_on()) capture_ = gsx_capture_params(p);
+  }
+  GsxJobScope(const GsxJobScope&) = delete;
+  GsxJobScope& operator=(const GsxJobScope&) = delete;
+private:
+  const char* name_;
+  const char* out_path_;
+  bool top_ = false;
+  uint64_t trace_job_ = 0, t0_ns_ = 0, in_bytes_ = 0, out_bytes_ = 0;
+  std::chrono::steady_clock::time_point t0_;
+  std::string capture_;
+};
+
+// Threads auxiliares herdam o job de quem as criou: capture o token na criadora.
+struct GsxJobToken { uint64_t trace = 0; bool active = false; };
+GsxJobToken gsx_job_token();
+class GsxJobAdopt {
+public:
+  explicit GsxJobAdopt(GsxJobToken t);
+  ~GsxJobAdopt();
+private:
+  GsxJobToken prev_;
+};
+
+// Contadores e medidores globais (expostos por gsx_metrics_snapshot)
+enum GsxCounter {
+  GSX_C_GS_INSTANCES,        // instâncias do Ghostscript criadas
+  GSX_C_GS_PAGES,            // linhas "Page N" (páginas interpretadas; hedges contam de novo)
+  GSX_C_BATCH_TIMEOUTS,      // lotes que passaram do tempo esperado e viraram hedge
+  GSX_C_THUMB_HIT_MEM,
+  GSX_C_THUMB_HIT_DISK,
+  GSX_C_THUMB_MISS,          // miniaturas renderizadas
+  GSX_C_NORMALIZED,          // cópias com xref reparada
+  GSX_C_COUNT
+};
+enum GsxGauge {
+  GSX_G_JOBS_ACTIVE,
+  GSX_G_GS_ACTIVE,           // instâncias do Ghostscript rodando
+  GSX_G_QUEUE_DEPTH,         // lotes na fila da compressão paralela
+  GSX_G_COUNT
+};
+void gsx_metric_add(GsxCounter c, uint64_t n = 1);
+void gsx_gauge_add(GsxGauge g, int64_t d);
+// rc do último set_last_error_json desta thread
+int gsx_last_rc();
+
+// Último erro detalhado (por thread), ver gsx_last_error_json()
+void set_last_error_json(int rc, const char* where, int os_errno, int gs_rc,
+                         const std::vector<std::string>* argv);
+
+// Caminho temporário único (o arquivo é criado vazio). dir == NULL → pasta temporária do sistema.
+std::string gsx_make_temp_path(const char* dir, const char* prefix, const char* ext);
+
+// Hash de 64 bits (não criptográfico) de n bytes; 'seed' encadeia blocos.
+uint64_t gsx_hash_bytes(const uint8_t* p, size_t n, uint64_t seed);
+
+// gsx_normalize_pdf com destino preparado só quando preciso: make_out() devolve o
+// caminho (temporário, memfd...) e *out_path o recebe quando o retorno é 1.
+int gsx_normalize_lazy(const char* in_path, int flags, const std::function<std::string()>& make_out,
+                       std::string* out_path, gsx_normalize_stats_t* stats);
+
+// Escapa aspas, barras e controles para uso dentro de "..." em JSON.
+std::string gsx_json_escape(const std::string& v);
+// Cópia via malloc (liberada pelo chamador com gsx_free); nullptr se faltar memória.
+char* gsx_dup_string(const std::string& s);
+
+// Roda o Ghostscript com 'args' (args[0] = "gs") entregando a saída do device
+// (-sOutputFile=-) a 'sink'; as mensagens vão para on_progress como de costume.
+// Use -sstdout=%stderr para que o PostScript não misture texto na saída.
+typedef int (*gsx_raw_sink)(void* user, const char* data, int len);
+int gsx_run_gs_raw(const std::vector<std::string>& args, gsx_raw_sink sink, void* sink_user,
+                   gsx_progress_cb on_progress, void* user, volatile int* cancel_flag);
+
+// Idem com -sDEVICE=display: 'cb' (display_callback do gdevdsp.h) é registrado com
+// gsapi_set_display_callback e recebe como handle o contexto da execução; o 'cb_user'
+// sai de gsx_display_user(handle). O chamador monta -dDisplayFormat etc. em 'args'.
+int gsx_run_gs_display(const std::vector<std::string>& args, display_callback_s* cb, void* cb_user,
+                       gsx_progress_cb on_progress, void* user, volatile int* cancel_flag);
+void* gsx_display_user(void* handle);
+
+// Leitor incremental de uma sequência de PNM binários (P5 cinza / P6 RGB, maxval 255),
+// p.ex. a saída de pgmraw/ppmraw em gsx_run_gs_raw. Entrega cada linha completa;
+// use GsxPnmReader::sink como gsx_raw_sink. Cabeçalhos inválidos são descartados.
+class GsxPnmReader {
+public:
+  virtual ~GsxPnmReader() {}
+  virtual void on_page(int w, int h, int channels) = 0;
+  virtual void on_row(int y, const uint8_t* row) = 0;
+  virtual void on_page_end() = 0;
+
+  void feed(const uint8_t* d, size_t len);
+  static int sink(void* user, const char* d, int len);
+
+private:
+  bool parse_header();
+  std::string hdr_;
+  std::vector<uint8_t> row_;
+  size_t row_fill_ = 0;
+  int w_ = 0, h_ = 0, y_ = 0, ch_ = 0;
+  bool in_pixels_ = false;
+};
+
+// ===== Bilevel (gsx_bilevel.cpp / gsx_g4.cpp / gsx_jbig2.cpp) =====
+// Imagens 1-bpp em memória: um byte por pixel, 1 = preto.
+// Sauvola com janela 'window' (ímpar) e sensibilidade k (tipicamente 0.2..0.5).
+void gsx_binarize_sauvola(const uint8_t* gray, int w, int h, int window, float k, uint8_t* out);
+// Otsu por ladrilho ('tile' px), limiares interpolados entre os centros dos ladrilhos;
+// ladrilhos sem contraste usam o limiar global.
+void gsx_binarize_otsu_tiles(const uint8_t* gray, int w, int h, int tile, uint8_t* out);
+// Apaga componentes pretos (8-conexos) de até max_px pixels. Retorna quantos pixels apagou.
+size_t gsx_despeckle(uint8_t* bw, int w, int h, int max_px);
+// CCITT G4 (T.6) terminado com EOFB; acrescenta em 'out'. Decodifica com /K -1 /BlackIs1 false.
+void gsx_g4_encode(const uint8_t* bw, int w, int h, std::string& out);
+// JBIG2 região genérica sem perdas (gabarito 0, TPGDON) como "embedded stream" com
+// informação de página; acrescenta em 'out'. Vai no PDF com /JBIG2Decode sem globais.
+void gsx_jbig2_encode(const uint8_t* bw, int w, int h, int dpi, std::string& out);
+
+// ===== Kernels de raster (gsx_kernels.cpp) =====
+// Nível SIMD escolhido uma vez pelo cpuid (ver gsx_simd_level); resultados idênticos
+// em todos os níveis.
+// gray[i] = (77·R + 150·G + 29·B) >> 8, n pixels RGB contíguos.
+void gsx_rgb_to_gray(const uint8_t* rgb, uint8_t* gray, size_t n);
+// Limiar global: out[i] = gray[i] <= t ? 1 : 0.
+void gsx_threshold(const uint8_t* gray, size_t n, uint8_t t, uint8_t* out);
+// Limiar de Sauvola de uma linha, com média/variância da janela já calculadas:
+// out[x] = g[x] <= mean·(1 + k·(√var/r − 1)) ? 1 : 0.
+void gsx_sauvola_row(const float* mean, const float* var, const uint8_t* g, int w, float k, float r, uint8_t* out);
+// Reamostragem separável de pixels de 'ch' bytes (pesos em ponto fixo, 8 bits por passada).
+enum { GSX_FILTER_BOX = 0, GSX_FILTER_LANCZOS3 = 1 };
+// BOX = média de área (redução sem serrilhado, barata); LANCZOS3 = mais nítido (miniaturas).
+void gsx_resample(const uint8_t* src, int w, int h, int ch, uint8_t* dst, int nw, int nh, int filter);
+
+// ===== Planejamento (gsx_plan.cpp) =====
+// Peso estimado de cada página em [first,last]; 0 = documento inteiro (ajustados na saída).
+int gsx_page_weights(const char* in_path, int& first, int& last, std::vector<uint64_t>& weights);
+// Partição contígua de 'w' em até k faixas [ini,fim] (índices) minimizando a mais pesada.
+std::vector<std::pair<size_t, size_t>> gsx_partition_weights(const std::vector<uint64_t>& w, int k);
+// Roda fn(a, b) (páginas inclusivas) em até 'workers' threads (0 = nº de CPUs), uma por
+// faixa equilibrada pelo peso. Retorna o primeiro erro, GSX_E_CANCELED ou GSX_OK;
+// *used = faixas de fato usadas.
+int gsx_run_weighted(const std::vector<uint64_t>& weights, int first, int workers,
+                     const std::function<int(int, int)>& fn, volatile int* cancel_flag, int* used);
+
+// ===== Compressão paralela (gsx_parallel.cpp) =====
+// Destino das partes do pdfwrite: create() devolve um caminho gravável (arquivo
+// temporário, /proc/self/fd/N de um memfd...) dado o tamanho esperado; drop() descarta.
+struct GsxPartStore {
+  virtual ~GsxPartStore() {}
+  virtual std::string create(uint64_t expect_bytes) = 0;
+  virtual void drop(const std::string& path) = 0;
+};
+// Núcleo de gsx_compress_parallel_sync com os pesos já medidos (weights[i] = página
+// first+i). Em sucesso 'parts' recebe as partes em ordem de página (donas do chamador,
+// liberar com store.drop); as demais já foram descartadas.
+int gsx_parallel_compress(const char* in_path, int dpi, int jpeg_quality, const char* preset,
+                          gsx_color_mode_t mode, int first, std::vector<uint64_t> weights,
+                          const gsx_parallel_opts_t* opts, GsxPartStore& store,
+                          std::vector<std::string>& parts,
+                          gsx_progress_cb on_progress, void* user, volatile int* cancel_flag);
+
+// ===== Mesclagem (gsx_merge.cpp) =====
+// gsx_merge_pdfs com o tempo de cada fase (µs): coleta, deduplicação e escrita
+// (que inclui a linearização com GSX_MERGE_LINEARIZE).
+struct GsxMergeTimes { uint64_t collect_us = 0, dedup_us = 0, write_us = 0; };
+int gsx_merge_timed(const char* const* in_paths, int count, const char* out_path, int flags,
+                    gsx_merge_stats_t* stats_out, GsxMergeTimes* times);
+
+// ===== Content streams (gsx_content.cpp) =====
+struct GsxImageUse {
+  std::vector<int> pages;        // páginas em que aparece (sem repetição, em ordem)
+  int placements = 0;
+  double w_pt = 0, h_pt = 0;     // maior área de exibição encontrada
+};
+struct GsxImageScan {
+  std::unordered_map<uint32_t, GsxImageUse> images;   // por número do objeto
+  uint64_t inline_images = 0, inline_bytes = 0;
+};
+// Interpreta os content streams da página (q/Q/cm/Do, Forms aninhados) e acumula em
+// 'scan' onde cada imagem XObject é desenhada; 'page' é o número (1-based) registrado.
+void gsx_scan_page_images(gsx_pdf::Document& doc, const gsx_pdf::PageInfo& pg, int page, GsxImageScan& scan);
+
+// ===== JPEG em memória (gsx_jpeg.cpp) =====
+// px: linhas contíguas de w × comps bytes (comps 1 = cinza, 3 = RGB). false em erro.
+bool gsx_jpeg_encode(const uint8_t* px, int w, int h, int comps, int quality, std::string& out);
+// Só JPEG de 1 ou 3 componentes (CMYK/YCCK → false); sai em cinza ou RGB.
+bool gsx_jpeg_decode(const uint8_t* data, size_t len, std::vector<uint8_t>& px, int& w, int& h, int& comps);
+
+// ===== PNG em memória (gsx_png.cpp) =====
+// Linhas de w × comps bytes (1 = cinza, 3 = RGB) a cada 'stride' bytes (0 = contíguas).
+bool gsx_png_encode(const uint8_t* px, int w, int h, int comps, size_t stride, std::string& out);
+
+// ===== Recompressão de imagens (gsx_recompress.cpp) =====
+// true se preset == GSX_PRESET_IMAGES e [first,last] cobre o documento inteiro
+// (0 = sem limite), isto é, se gsx_compress_* deve usar gsx_recompress_images.
+bool gsx_images_engine_applies(const char* preset, const char* in_path, int first_page, int last_page);
@@ -0,0 +1,202 @@
+// gsx_jbig2.cpp — codificador JBIG2 (ITU-T T.88) de região genérica para imagens 1-bpp.
+//
+// Sem dicionário de símbolos: cada página vira uma única região genérica sem perdas,
+// codificada pelo codificador aritmético MQ com o gabarito 0 (16 pixels de contexto,
+// pixels AT nas posições padrão) e predição típica (TPGDON), que resolve com um único
+// símbolo as linhas iguais à anterior — a maior parte de uma página digitalizada.
+//
+// Entrada no mesmo formato do gsx_g4_encode (um byte por pixel, != 0 = preto). A saída
+// é um "embedded stream" (T.88 anexo D.3, sem cabeçalho de arquivo) com o segmento de
+// informação de página e o de região genérica: é o que o filtro /JBIG2Decode espera,
+// sem /JBIG2Globals.
+
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gsx_internal.h"
+
+namespace {
+
+// Tabela de estados do MQ (T.88 tabela E.1): Qe, próximo estado após MPS / LPS, troca.
+struct QeState { uint16_t qe; uint8_t nmps, nlps, sw; };
+static const QeState kQe[47] = {
+  {0x5601, 1, 1, 1},  {0x3401, 2, 6, 0},  {0x1801, 3, 9, 0},  {0x0AC1, 4, 12, 0},
+  {0x0521, 5, 29, 0}, {0x0221, 38, 33, 0}, {0x5601, 7, 6, 1}, {0x5401, 8, 14, 0},
+  {0x4801, 9, 14, 0}, {0x3801, 10, 14, 0}, {0x3001, 11, 17, 0}, {0x2401, 12, 18, 0},
+  {0x1C01, 13, 20, 0}, {0x1601, 29, 21, 0}, {0x5601, 15, 14, 1}, {0x5401, 16, 14, 0},
+  {0x5101, 17, 15, 0}, {0x4801, 18, 16, 0}, {0x3801, 19, 17, 0}, {0x3401, 20, 18, 0},
+  {0x3001, 21, 19, 0}, {0x2801, 22, 19, 0}, {0x2401, 23, 20, 0}, {0x2201, 24, 21, 0},
+  {0x1C01, 25, 22, 0}, {0x1801, 26, 23, 0}, {0x1601, 27, 24, 0}, {0x1401, 28, 25, 0},
+  {0x1201, 29, 26, 0}, {0x1101, 30, 27, 0}, {0x0AC1, 31, 28, 0}, {0x09C1, 32, 29, 0},
+  {0x08A1, 33, 30, 0}, {0x0521, 34, 31, 0}, {0x0441, 35, 32, 0}, {0x02A1, 36, 33, 0},
+  {0x0221, 37, 34, 0}, {0x0141, 38, 35, 0}, {0x0111, 39, 36, 0}, {0x0085, 40, 37, 0},
+  {0x0049, 41, 38, 0}, {0x0025, 42, 39, 0}, {0x0015, 43, 40, 0}, {0x0009, 44, 41, 0},
+  {0x0005, 45, 42, 0}, {0x0001, 45, 43, 0}, {0x5601, 46, 46, 0},
+};
+
+// Codificador MQ (T.88 E.2). O byte B fica pendente até o próximo BYTEOUT porque o
+// transporte (carry) de C ainda pode incrementá-lo.
+class MqEncoder {
+ public:
+  explicit MqEncoder(std::string& out) : out_(out), cx_(65536, 0) {}
+
+  // cx = contexto; o estado guarda índice na tabela << 1 | MPS
+  inline void encode(uint32_t cx, int d) {
+    uint8_t& st = cx_[cx];
+    const QeState& q = kQe[st >> 1];
+    const int mps = st & 1;
+    a_ -= q.qe;
+    if (d == mps) {
+      if (a_ & 0x8000) { c_ += q.qe; return; }
+      if (a_ < q.qe) a_ = q.qe; else c_ += q.qe;
+      st = (uint8_t)((q.nmps << 1) | mps);
+    } else {
+      if (a_ < q.qe) c_ += q.qe; else a_ = q.qe;
+      st = (uint8_t)((q.nlps << 1) | (q.sw ? 1 - mps : mps));
+    }
+    renorm();
+  }
+
+  void flush() {
+    const uint32_t tempc = c_ + a_;            // SETBITS
+    c_ |= 0xFFFF;
+    if (c_ >= tempc) c_ -= 0x8000;
+    c_ <<= ct_;
+    byteout();
+    c_ <<= ct_;
+    byteout();
+    emit();
+    if (b_ != 0xFF) { b_ = 0xFF; emit(); }
+    b_ = 0xAC;                                  // marcador de fim dos dados aritméticos
+    emit();
+  }
+
+ private:
+  inline void renorm() {
+    do {
+      a_ <<= 1;
+      c_ <<= 1;
+      if (--ct_ == 0) byteout();
+    } while (!(a_ & 0x8000));
+  }
+
+  inline void emit() {
+    if (have_b_) out_.push_back((char)b_);
+    have_b_ = true;
+  }
+
+  void byteout() {
+    if (b_ == 0xFF) {
+      emit(); b_ = (uint8_t)(c_ >> 20); c_ &= 0xFFFFF; ct_ = 7;
+    } else if (c_ < 0x8000000) {
+      emit(); b_ = (uint8_t)(c_ >> 19); c_ &= 0x7FFFF; ct_ = 8;
+    } else {
+      ++b_;
+      if (b_ == 0xFF) {
+        c_ &= 0x7FFFFFF;
+        emit(); b_ = (uint8_t)(c_ >> 20); c_ &= 0xFFFFF; ct_ = 7;
+      } else {
+        emit(); b_ = (uint8_t)(c_ >> 19); c_ &= 0x7FFFF; ct_ = 8;
+      }
+    }
+  }
+
+  std::string& out_;
+  std::vector<uint8_t> cx_;
+  uint32_t a_ = 0x8000, c_ = 0;
+  int ct_ = 12;
+  uint8_t b_ = 0;          // byte "anterior ao início" (BPST − 1): nunca é emitido
+  bool have_b_ = false;
+};
+
+static void put_u32(std::string& s, uint32_t v) {
+  s.push_back((char)(v >> 24)); s.push_back((char)(v >> 16));
+  s.push_back((char)(v >> 8));  s.push_back((char)v);
+}
+
+// Cabeçalho de segmento (T.88 7.2) sem segmentos referidos, associado à página 1.
+static void put_segment_header(std::string& s, uint32_t number, uint8_t type, uint32_t data_len) {
+  put_u32(s, number);
+  s.push_back((char)type);      // página com 1 byte, sem "deferred non-retain"
+  s.push_back(0);               // 0 segmentos referidos
+  s.push_back(1);               // página 1
+  put_u32(s, data_len);
+}
+
+// Contexto da predição típica para o gabarito 0 (T.88 6.2.5.7)
+static const uint32_t kTpgdonCx0 = 0x9B25;
+
+// Gabarito 0 com AT padrão, bits do mais significativo ao menos (como em 6.2.5.3):
+//   linha y-2: x-2(A4) x-1 x x+1 x+2(A3)      → bits 15..11
+//   linha y-1: x-3(A2) x-2 .. x+2 x+3(A1)     → bits 10..4
+//   linha y  : x-4 .. x-1                     → bits 3..0
+// Cada janela desliza um pixel por vez sobre linhas com 4 pixels brancos de margem.
+static void encode_generic(const uint8_t* px, int w, int h, std::string& out) {
+  const int pad = 4;
+  std::vector<uint8_t> rows((size_t)(w + 2 * pad) * 3, 0);
+  uint8_t* r2 = rows.data() + pad;                              // y-2
+  uint8_t* r1 = r2 + (w + 2 * pad);                             // y-1
+  uint8_t* r0 = r1 + (w + 2 * pad);                             // y
+  MqEncoder mq(out);
+  int ltp = 0;
+
+  for (int y = 0; y < h; ++y) {
+    const uint8_t* src = px + (size_t)y * (size_t)w;
+    for (int x = 0; x < w; ++x) r0[x] = src[x] ? 1 : 0;
+
+    const int same = memcmp(r0, r1, (size_t)w) == 0;
+    mq.encode(kTpgdonCx0, same ^ ltp);
+    ltp = same;
+    if (!same) {
+      uint32_t l2 = ((uint32_t)r2[-2] << 4) | (r2[-1] << 3) | (r2[0] << 2) | (r2[1] << 1) | r2[2];
+      uint32_t l1 = ((uint32_t)r1[-3] << 6) | (r1[-2] << 5) | (r1[-1] << 4) | (r1[0] << 3) |
+                    (r1[1] << 2) | (r1[2] << 1) | r1[3];
+      uint32_t l0 = 0;
+      for (int x = 0; x < w; ++x) {
+        const int d = r0[x];
+        mq.encode((l2 << 11) | (l1 << 4) | l0, d);
+        l2 = ((l2 << 1) | r2[x + 3]) & 0x1F;
+        l1 = ((l1 << 1) | r1[x + 4]) & 0x7F;
+        l0 = ((l0 << 1) | (uint32_t)d) & 0xF;
+      }
+    }
+    // roda as linhas: y-1 → y-2, y → y-1
+    uint8_t* t = r2; r2 = r1; r1 = r0; r0 = t;
+  }
+  mq.flush();
+}
+
+}  // namespace
+
+void gsx_jbig2_encode(const uint8_t* px, int w, int h, int dpi, std::string& out) {
+  const uint32_t ppm = dpi > 0 ? (uint32_t)(dpi * 39.3701 + 0.5) : 0;   // pixels por metro
+
+  // segmento 0: informação de página (7.4.8)
+  put_segment_header(out, 0, 48, 19);
+  put_u32(out, (uint32_t)w);
+  put_u32(out, (uint32_t)h);
+  put_u32(out, ppm);
+  put_u32(out, ppm);
+  out.push_back(1);             // página sem perdas, fundo branco, combinação OR
+  out.push_back(0); out.push_back(0);   // sem faixas
+
+  // segmento 1: região genérica imediata sem perdas (7.4.6). O tamanho só é conhecido
+  // depois de codificar, então o cabeçalho é completado no fim.
+  const size_t hdr = out.size();
+  put_segment_header(out, 1, 39, 0);
+  const size_t data0 = out.size();
+  put_u32(out, (uint32_t)w);    // informação da região (7.4.1)
+  put_u32(out, (uint32_t)h);
+  put_u32(out, 0);
+  put_u32(out, 0);
+  out.push_back(0);             // combinação externa OR
+  out.push_back(0x08);          // MMR=0, GBTEMPLATE=0, TPGDON=1
+  static const int8_t kAt[8] = {3, -1, -3, -1, 2, -2, -2, -2};
+  for (int8_t a : kAt) out.push_back((char)a);
+  encode_generic(px, w, h, out);
+
+  const uint32_t len = (uint32_t)(out.size() - data0);
+  for (int i = 0; i < 4; ++i) out[hdr + 7 + i] = (char)(len >> (24 - 8 * i));
+}
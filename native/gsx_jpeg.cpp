@@ -0,0 +1,95 @@
+// gsx_jpeg.cpp — JPEG em memória (libjpeg / libjpeg-turbo) para as rotinas nativas:
+// fundo do MRC (gsx_mrc.cpp) e recompressão de imagens (gsx_recompress.cpp).
+// Erros da libjpeg viram 'false' (longjmp a partir do error_exit), nunca exit().
+
+#include <csetjmp>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <jpeglib.h>
+
+#include "gsx_internal.h"
+
+namespace {
+
+struct JpegErr {
+  jpeg_error_mgr mgr;
+  jmp_buf jb;
+  unsigned char* mem = nullptr;          // aqui (e não numa local) para sobreviver ao longjmp
+  unsigned long mem_len = 0;
+};
+
+static void jpeg_fail(j_common_ptr c) { longjmp(((JpegErr*)c->err)->jb, 1); }
+static void jpeg_quiet(j_common_ptr, int) {}   // avisos (dados corrompidos etc.) não vão para stderr
+
+}  // namespace
+
+bool gsx_jpeg_encode(const uint8_t* px, int w, int h, int comps, int quality, std::string& out) {
+  if (!px || w <= 0 || h <= 0 || (comps != 1 && comps != 3)) return false;
+  jpeg_compress_struct c;
+  JpegErr err;
+  c.err = jpeg_std_error(&err.mgr);
+  err.mgr.error_exit = jpeg_fail;
+  if (setjmp(err.jb)) {
+    jpeg_destroy_compress(&c);
+    free(err.mem);
+    return false;
+  }
+  jpeg_create_compress(&c);
+  jpeg_mem_dest(&c, &err.mem, &err.mem_len);
+  c.image_width = (JDIMENSION)w;
+  c.image_height = (JDIMENSION)h;
+  c.input_components = comps;
+  c.in_color_space = comps == 1 ? JCS_GRAYSCALE : JCS_RGB;
+  jpeg_set_defaults(&c);
+  jpeg_set_quality(&c, quality, TRUE);
+  c.optimize_coding = TRUE;
+  jpeg_start_compress(&c, TRUE);
+  const size_t stride = (size_t)w * (size_t)comps;
+  while (c.next_scanline < c.image_height) {
+    JSAMPROW rp = (JSAMPROW)(px + (size_t)c.next_scanline * stride);
+    jpeg_write_scanlines(&c, &rp, 1);
+  }
+  jpeg_finish_compress(&c);
+  out.assign((const char*)err.mem, err.mem_len);
+  jpeg_destroy_compress(&c);
+  free(err.mem);
+  return true;
+}
+
+bool gsx_jpeg_decode(const uint8_t* data, size_t len, std::vector<uint8_t>& px, int& w, int& h, int& comps) {
+  if (!data || !len) return false;
+  jpeg_decompress_struct c;
+  JpegErr err;
+  c.err = jpeg_std_error(&err.mgr);
+  err.mgr.error_exit = jpeg_fail;
+  err.mgr.emit_message = jpeg_quiet;
+  if (setjmp(err.jb)) {
+    jpeg_destroy_decompress(&c);
+    return false;
+  }
+  jpeg_create_decompress(&c);
+  jpeg_mem_src(&c, (const unsigned char*)data, (unsigned long)len);
+  if (jpeg_read_header(&c, TRUE) != JPEG_HEADER_OK ||
+      (c.num_components != 1 && c.num_components != 3)) {   // CMYK/YCCK: fora do escopo
+    jpeg_destroy_decompress(&c);
+    return false;
+  }
+  c.out_color_space = c.num_components == 1 ? JCS_GRAYSCALE : JCS_RGB;
+  jpeg_start_decompress(&c);
+  w = (int)c.output_width;
+  h = (int)c.output_height;
+  comps = c.output_components;
+  const size_t stride = (size_t)w * (size_t)comps;
+  px.resize(stride * (size_t)h);
+  while (c.output_scanline < c.output_height) {
+    JSAMPROW rp = px.data() + (size_t)c.output_scanline * stride;
+    jpeg_read_scanlines(&c, &rp, 1);
+  }
+  jpeg_finish_decompress(&c);
+  jpeg_destroy_decompress(&c);
+  return true;
+}
@@ -0,0 +1,660 @@
+// gsx_kernels.cpp — kernels de raster compartilhados pelos motores nativos
+// (bilevel, MRC, recompressão de imagens, miniaturas): RGB→cinza, limiarização
+// (global e Sauvola) e reamostragem separável (caixa/área e Lanczos-3).
+//
+// Cada kernel tem uma versão escalar (a referência) e, em x86, variantes SSE4.2 e AVX2
+// compiladas com atributos de alvo e escolhidas em tempo de execução pelo cpuid.
+// GSX_SIMD=scalar|sse4.2|avx2 força um nível (limitado ao que a CPU suporta); outros
+// valores são ignorados com um aviso no log.
+//
+// As variantes têm de bater bit a bit com a escalar: tudo é aritmética inteira, menos o
+// limiar de Sauvola, que faz as mesmas operações IEEE na mesma ordem (sem FMA).
+// gsx_kernels_selftest confere isso; gsx_kernels_bench mede Mpx/s por nível.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+  #define GSX_KERNELS_X86 1
+  #include <immintrin.h>
+  #if defined(_MSC_VER) && !defined(__clang__)
+    #include <intrin.h>
+    #define GSX_TARGET(t)
+  #else
+    #define GSX_TARGET(t) __attribute__((target(t)))
+  #endif
+#endif
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+namespace {
+
+static const int kWeightBits = 14;                       // pesos em ponto fixo: soma = 1 << 14
+static const int kLanczosA = 3;
+
+// ======================= Tabela de kernels =======================
+struct Kernels {
+  const char* name;
+  // gray[i] = (77·R + 150·G + 29·B) >> 8
+  void (*rgb_to_gray)(const uint8_t* rgb, uint8_t* gray, size_t n);
+  // out[i] = gray[i] <= t ? 1 : 0
+  void (*threshold)(const uint8_t* gray, size_t n, uint8_t t, uint8_t* out);
+  // out[x] = g[x] <= m·(1 + k·(√var·(1/R) − 1)) ? 1 : 0
+  void (*sauvola_row)(const float* mean, const float* var, const uint8_t* g, int w,
+                      float k, float inv_r, uint8_t* out);
+  // out[i] = clamp((Σ wt[k]·rows[k][i] + 2^13) >> 14, 0, 255)
+  void (*vpass)(const uint8_t* const* rows, const int16_t* wt, int taps, size_t n, uint8_t* out);
+};
+
+// ----------------------- escalar -----------------------
+static inline uint8_t gray_px(const uint8_t* p) {
+  return (uint8_t)((p[0] * 77 + p[1] * 150 + p[2] * 29) >> 8);
+}
+
+static inline uint8_t sauvola_px(float m, float v, uint8_t g, float k, float inv_r) {
+  const float s = std::sqrt(std::max(v, 0.0f));
+  const float t = m * (1.0f + k * (s * inv_r - 1.0f));
+  return (float)g <= t ? 1 : 0;
+}
+
+static inline uint8_t vpass_px(const uint8_t* const* rows, const int16_t* wt, int taps, size_t i) {
+  int32_t s = 0;
+  for (int k = 0; k < taps; ++k) s += (int32_t)wt[k] * rows[k][i];
+  s = (s + (1 << (kWeightBits - 1))) >> kWeightBits;
+  return (uint8_t)std::max(0, std::min(255, (int)s));
+}
+
+static void rgb_to_gray_scalar(const uint8_t* rgb, uint8_t* gray, size_t n) {
+  for (size_t i = 0; i < n; ++i) gray[i] = gray_px(rgb + i * 3);
+}
+
+static void threshold_scalar(const uint8_t* gray, size_t n, uint8_t t, uint8_t* out) {
+  for (size_t i = 0; i < n; ++i) out[i] = gray[i] <= t ? 1 : 0;
+}
+
+static void sauvola_row_scalar(const float* mean, const float* var, const uint8_t* g, int w,
+                               float k, float inv_r, uint8_t* out) {
+  for (int x = 0; x < w; ++x) out[x] = sauvola_px(mean[x], var[x], g[x], k, inv_r);
+}
+
+static void vpass_scalar(const uint8_t* const* rows, const int16_t* wt, int taps, size_t n, uint8_t* out) {
+  for (size_t i = 0; i < n; ++i) out[i] = vpass_px(rows, wt, taps, i);
+}
+
+static const Kernels kScalar = {"scalar", rgb_to_gray_scalar, threshold_scalar, sauvola_row_scalar, vpass_scalar};
+
+#ifdef GSX_KERNELS_X86
+// ----------------------- SSE4.2 -----------------------
+// Máscaras pshufb que separam 16 pixels RGB (3 × 16 bytes) em 16 R, 16 G e 16 B.
+struct DeinterleaveMasks {
+  alignas(16) int8_t m[3][3][16];      // [canal][bloco de 16 bytes][posição]
+  DeinterleaveMasks() {
+    for (int c = 0; c < 3; ++c)
+      for (int j = 0; j < 3; ++j)
+        for (int p = 0; p < 16; ++p) {
+          const int idx = p * 3 + c;
+          m[c][j][p] = idx / 16 == j ? (int8_t)(idx % 16) : (int8_t)0x80;
+        }
+  }
+};
+static const DeinterleaveMasks kDeint;
+
+GSX_TARGET("sse4.2")
+static inline __m128i deint_channel(__m128i a, __m128i b, __m128i c, int ch) {
+  const __m128i ma = _mm_load_si128((const __m128i*)kDeint.m[ch][0]);
+  const __m128i mb = _mm_load_si128((const __m128i*)kDeint.m[ch][1]);
+  const __m128i mc = _mm_load_si128((const __m128i*)kDeint.m[ch][2]);
+  return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(a, ma), _mm_shuffle_epi8(b, mb)), _mm_shuffle_epi8(c, mc));
+}
+
+// 16 bits sem sinal: 77·255 + 150·255 + 29·255 = 65280 cabe, então mullo/add não transbordam
+GSX_TARGET("sse4.2")
+static inline __m128i gray8_sse(__m128i r, __m128i g, __m128i b) {
+  const __m128i wr = _mm_set1_epi16(77), wg = _mm_set1_epi16(150), wb = _mm_set1_epi16(29);
+  __m128i s = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(r, wr), _mm_mullo_epi16(g, wg)), _mm_mullo_epi16(b, wb));
+  return _mm_srli_epi16(s, 8);
+}
+
+GSX_TARGET("sse4.2")
+static void rgb_to_gray_sse42(const uint8_t* rgb, uint8_t* gray, size_t n) {
+  size_t i = 0;
+  const __m128i zero = _mm_setzero_si128();
+  for (; i + 16 <= n; i += 16) {
+    const uint8_t* p = rgb + i * 3;
+    __m128i a = _mm_loadu_si128((const __m128i*)p);
+    __m128i b = _mm_loadu_si128((const __m128i*)(p + 16));
+    __m128i c = _mm_loadu_si128((const __m128i*)(p + 32));
+    __m128i r = deint_channel(a, b, c, 0), g = deint_channel(a, b, c, 1), bl = deint_channel(a, b, c, 2);
+    __m128i lo = gray8_sse(_mm_unpacklo_epi8(r, zero), _mm_unpacklo_epi8(g, zero), _mm_unpacklo_epi8(bl, zero));
+    __m128i hi = gray8_sse(_mm_unpackhi_epi8(r, zero), _mm_unpackhi_epi8(g, zero), _mm_unpackhi_epi8(bl, zero));
+    _mm_storeu_si128((__m128i*)(gray + i), _mm_packus_epi16(lo, hi));
+  }
+  for (; i < n; ++i) gray[i] = gray_px(rgb + i * 3);
+}
+
+GSX_TARGET("sse4.2")
+static void threshold_sse42(const uint8_t* gray, size_t n, uint8_t t, uint8_t* out) {
+  size_t i = 0;
+  const __m128i vt = _mm_set1_epi8((char)t), one = _mm_set1_epi8(1);
+  for (; i + 16 <= n; i += 16) {
+    __m128i g = _mm_loadu_si128((const __m128i*)(gray + i));
+    __m128i le = _mm_cmpeq_epi8(_mm_min_epu8(g, vt), g);          // g <= t
+    _mm_storeu_si128((__m128i*)(out + i), _mm_and_si128(le, one));
+  }
+  for (; i < n; ++i) out[i] = gray[i] <= t ? 1 : 0;
+}
+
+GSX_TARGET("sse4.2")
+static void sauvola_row_sse42(const float* mean, const float* var, const uint8_t* g, int w,
+                              float k, float inv_r, uint8_t* out) {
+  int x = 0;
+  const __m128 vk = _mm_set1_ps(k), vinv_r = _mm_set1_ps(inv_r);
+  const __m128 one = _mm_set1_ps(1.0f), zero = _mm_setzero_ps();
+  for (; x + 4 <= w; x += 4) {
+    __m128 s = _mm_sqrt_ps(_mm_max_ps(_mm_loadu_ps(var + x), zero));
+    __m128 t = _mm_mul_ps(_mm_loadu_ps(mean + x),
+                          _mm_add_ps(one, _mm_mul_ps(vk, _mm_sub_ps(_mm_mul_ps(s, vinv_r), one))));
+    int g4;
+    memcpy(&g4, g + x, 4);
+    __m128 gv = _mm_cvtepi32_ps(_mm_cvtepu8_epi32(_mm_cvtsi32_si128(g4)));
+    const int mask = _mm_movemask_ps(_mm_cmple_ps(gv, t));
+    out[x]     = (uint8_t)(mask & 1);
+    out[x + 1] = (uint8_t)((mask >> 1) & 1);
+    out[x + 2] = (uint8_t)((mask >> 2) & 1);
+    out[x + 3] = (uint8_t)((mask >> 3) & 1);
+  }
+  for (; x < w; ++x) out[x] = sauvola_px(mean[x], var[x], g[x], k, inv_r);
+}
+
+// Duas linhas por vez: bytes intercalados (a0 b0 a1 b1 ...) × par de pesos (wa wb) no
+// pmaddwd dá wa·a + wb·b em 32 bits, exato.
+GSX_TARGET("sse4.2")
+static void vpass_sse42(const uint8_t* const* rows, const int16_t* wt, int taps, size_t n, uint8_t* out) {
+  size_t i = 0;
+  const __m128i round = _mm_set1_epi32(1 << (kWeightBits - 1));
+  for (; i + 8 <= n; i += 8) {
+    __m128i lo = round, hi = round;
+    for (int k = 0; k < taps; k += 2) {
+      __m128i a = _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(rows[k] + i)));
+      __m128i b = k + 1 < taps ? _mm_cvtepu8_epi16(_mm_loadl_epi64((const __m128i*)(rows[k + 1] + i)))
+                               : _mm_setzero_si128();
+      const int16_t wb = k + 1 < taps ? wt[k + 1] : 0;
+      const __m128i w2 = _mm_set1_epi32((int)(uint16_t)wt[k] | ((int)(uint16_t)wb << 16));
+      lo = _mm_add_epi32(lo, _mm_madd_epi16(_mm_unpacklo_epi16(a, b), w2));
+      hi = _mm_add_epi32(hi, _mm_madd_epi16(_mm_unpackhi_epi16(a, b), w2));
+    }
+    lo = _mm_srai_epi32(lo, kWeightBits);
+    hi = _mm_srai_epi32(hi, kWeightBits);
+    __m128i p = _mm_packs_epi32(lo, hi);
+    _mm_storel_epi64((__m128i*)(out + i), _mm_packus_epi16(p, p));
+  }
+  for (; i < n; ++i) out[i] = vpass_px(rows, wt, taps, i);
+}
+
+static const Kernels kSse42 = {"sse4.2", rgb_to_gray_sse42, threshold_sse42, sauvola_row_sse42, vpass_sse42};
+
+// ----------------------- AVX2 -----------------------
+GSX_TARGET("avx2")
+static void rgb_to_gray_avx2(const uint8_t* rgb, uint8_t* gray, size_t n) {
+  size_t i = 0;
+  const __m256i wr = _mm256_set1_epi16(77), wg = _mm256_set1_epi16(150), wb = _mm256_set1_epi16(29);
+  for (; i + 16 <= n; i += 16) {
+    const uint8_t* p = rgb + i * 3;
+    __m128i a = _mm_loadu_si128((const __m128i*)p);
+    __m128i b = _mm_loadu_si128((const __m128i*)(p + 16));
+    __m128i c = _mm_loadu_si128((const __m128i*)(p + 32));
+    __m256i r = _mm256_cvtepu8_epi16(deint_channel(a, b, c, 0));
+    __m256i g = _mm256_cvtepu8_epi16(deint_channel(a, b, c, 1));
+    __m256i bl = _mm256_cvtepu8_epi16(deint_channel(a, b, c, 2));
+    __m256i s = _mm256_add_epi16(_mm256_add_epi16(_mm256_mullo_epi16(r, wr), _mm256_mullo_epi16(g, wg)),
+                                 _mm256_mullo_epi16(bl, wb));
+    s = _mm256_srli_epi16(s, 8);
+    _mm_storeu_si128((__m128i*)(gray + i),
+                     _mm_packus_epi16(_mm256_castsi256_si128(s), _mm256_extracti128_si256(s, 1)));
+  }
+  for (; i < n; ++i) gray[i] = gray_px(rgb + i * 3);
+}
+
+GSX_TARGET("avx2")
+static void threshold_avx2(const uint8_t* gray, size_t n, uint8_t t, uint8_t* out) {
+  size_t i = 0;
+  const __m256i vt = _mm256_set1_epi8((char)t), one = _mm256_set1_epi8(1);
+  for (; i + 32 <= n; i += 32) {
+    __m256i g = _mm256_loadu_si256((const __m256i*)(gray + i));
+    __m256i le = _mm256_cmpeq_epi8(_mm256_min_epu8(g, vt), g);
+    _mm256_storeu_si256((__m256i*)(out + i), _mm256_and_si256(le, one));
+  }
+  for (; i < n; ++i) out[i] = gray[i] <= t ? 1 : 0;
+}
+
+GSX_TARGET("avx2")
+static void sauvola_row_avx2(const float* mean, const float* var, const uint8_t* g, int w,
+                             float k, float inv_r, uint8_t* out) {
+  int x = 0;
+  const __m256 vk = _mm256_set1_ps(k), vinv_r = _mm256_set1_ps(inv_r);
+  const __m256 one = _mm256_set1_ps(1.0f), zero = _mm256_setzero_ps();
+  for (; x + 8 <= w; x += 8) {
+    __m256 s = _mm256_sqrt_ps(_mm256_max_ps(_mm256_loadu_ps(var + x), zero));
+    __m256 t = _mm256_mul_ps(_mm256_loadu_ps(mean + x),
+                             _mm256_add_ps(one, _mm256_mul_ps(vk, _mm256_sub_ps(_mm256_mul_ps(s, vinv_r), one))));
+    __m256 gv = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)(g + x))));
+    const int mask = _mm256_movemask_ps(_mm256_cmp_ps(gv, t, _CMP_LE_OQ));
+    for (int b = 0; b < 8; ++b) out[x + b] = (uint8_t)((mask >> b) & 1);
+  }
+  for (; x < w; ++x) out[x] = sauvola_px(mean[x], var[x], g[x], k, inv_r);
+}
+
+// Como vpass_sse42 com 16 pixels: unpack/pack agem por metade de 128 bits, então a
+// ordem volta certa ao juntar as duas metades no fim.
+GSX_TARGET("avx2")
+static void vpass_avx2(const uint8_t* const* rows, const int16_t* wt, int taps, size_t n, uint8_t* out) {
+  size_t i = 0;
+  const __m256i round = _mm256_set1_epi32(1 << (kWeightBits - 1));
+  for (; i + 16 <= n; i += 16) {
+    __m256i lo = round, hi = round;
+    for (int k = 0; k < taps; k += 2) {
+      __m256i a = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(rows[k] + i)));
+      __m256i b = k + 1 < taps ? _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*)(rows[k + 1] + i)))
+                               : _mm256_setzero_si256();
+      const int16_t wb = k + 1 < taps ? wt[k + 1] : 0;
+      const __m256i w2 = _mm256_set1_epi32((int)(uint16_t)wt[k] | ((int)(uint16_t)wb << 16));
+      lo = _mm256_add_epi32(lo, _mm256_madd_epi16(_mm256_unpacklo_epi16(a, b), w2));
+      hi = _mm256_add_epi32(hi, _mm256_madd_epi16(_mm256_unpackhi_epi16(a, b), w2));
+    }
+    __m256i p = _mm256_packs_epi32(_mm256_srai_epi32(lo, kWeightBits), _mm256_srai_epi32(hi, kWeightBits));
+    _mm_storeu_si128((__m128i*)(out + i),
+                     _mm_packus_epi16(_mm256_castsi256_si128(p), _mm256_extracti128_si256(p, 1)));
+  }
+  for (; i < n; ++i) out[i] = vpass_px(rows, wt, taps, i);
+}
+
+static const Kernels kAvx2 = {"avx2", rgb_to_gray_avx2, threshold_avx2, sauvola_row_avx2, vpass_avx2};
+
+// ----------------------- detecção -----------------------
+static int cpu_level() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int r[4];
+  __cpuid(r, 0);
+  const int max_leaf = r[0];
+  __cpuid(r, 1);
+  const bool ssse3 = (r[2] >> 9) & 1, sse42 = (r[2] >> 20) & 1;
+  const bool osxsave = (r[2] >> 27) & 1, avx = (r[2] >> 28) & 1;
+  bool avx2 = false;
+  if (max_leaf >= 7 && osxsave && avx && (_xgetbv(0) & 6) == 6) {
+    __cpuidex(r, 7, 0);
+    avx2 = (r[1] >> 5) & 1;
+  }
+#else
+  __builtin_cpu_init();
+  const bool ssse3 = __builtin_cpu_supports("ssse3"), sse42 = __builtin_cpu_supports("sse4.2");
+  const bool avx2 = __builtin_cpu_supports("avx2");      // já considera o suporte do SO (XCR0)
+#endif
+  if (avx2 && sse42 && ssse3) return 2;
+  if (sse42 && ssse3) return 1;
+  return 0;
+}
+#endif  // GSX_KERNELS_X86
+
+// níveis disponíveis nesta CPU, do escalar ao melhor
+static const std::vector<const Kernels*>& available() {
+  static const std::vector<const Kernels*> v = [] {
+    std::vector<const Kernels*> r{&kScalar};
+#ifdef GSX_KERNELS_X86
+    const int lvl = cpu_level();
+    if (lvl >= 1) r.push_back(&kSse42);
+    if (lvl >= 2) r.push_back(&kAvx2);
+#endif
+    return r;
+  }();
+  return v;
+}
+
+static const Kernels& active() {
+  static const Kernels* k = [] {
+    const auto& av = available();
+    const char* env = getenv("GSX_SIMD");
+    if (env && *env) {
+      for (const Kernels* c : av)
+        if (strcmp(c->name, env) == 0) return c;
+      // nível conhecido mas indisponível: o melhor da CPU já fica abaixo dele;
+      // valor desconhecido é ignorado (automático), nunca um nível que a CPU pode não ter
+      if (strcmp(env, "scalar") != 0 && strcmp(env, "sse4.2") != 0 && strcmp(env, "avx2") != 0)
+        gsx_log_msg(GSX_LOG_WARN, (std::string("GSX_SIMD desconhecido: '") + env + "'; usando " +
+                                   av.back()->name).c_str());
+    }
+    return av.back();
+  }();
+  return *k;
+}
+
+// ======================= Reamostragem =======================
+// Pesos de uma dimensão em ponto fixo: a saída o usa count[o] amostras a partir de
+// first[o]; os pesos de cada saída somam exatamente 1 << kWeightBits.
+struct Taps {
+  std::vector<int> first, count;
+  std::vector<size_t> off;
+  std::vector<int16_t> wt;
+};
+
+static double sinc(double x) {
+  if (std::fabs(x) < 1e-9) return 1.0;
+  x *= 3.14159265358979323846;
+  return std::sin(x) / x;
+}
+
+static void make_taps(int src, int dst, int filter, Taps& t) {
+  const double s = (double)src / dst;
+  t.first.resize((size_t)dst);
+  t.count.resize((size_t)dst);
+  t.off.resize((size_t)dst);
+  t.wt.clear();
+  std::vector<double> w;
+  for (int o = 0; o < dst; ++o) {
+    int i0, i1;
+    w.clear();
+    if (filter == GSX_FILTER_LANCZOS3) {
+      // na redução o núcleo é esticado por s (passa-baixas); na ampliação fica com raio 3
+      const double fs = std::max(1.0, s), support = kLanczosA * fs;
+      const double c = (o + 0.5) * s;
+      i0 = std::max(0, (int)std::floor(c - support));
+      i1 = std::min(src, (int)std::ceil(c + support));
+      for (int i = i0; i < i1; ++i) {
+        const double x = (i + 0.5 - c) / fs;
+        w.push_back(std::fabs(x) < kLanczosA ? sinc(x) * sinc(x / kLanczosA) : 0.0);
+      }
+    } else {
+      // área: a saída o cobre [o·s, (o+1)·s) e cada amostra pesa a fração que ocupa
+      const double a = o * s, b = std::min((double)src, (o + 1) * s);
+      i0 = std::min(src - 1, (int)a);
+      i1 = std::max(i0 + 1, std::min(src, (int)std::ceil(b - 1e-9)));
+      for (int i = i0; i < i1; ++i) w.push_back(std::max(0.0, std::min(b, (double)i + 1) - std::max(a, (double)i)));
+    }
+    // corta zeros das pontas
+    size_t lo = 0, hi = w.size();
+    while (hi - lo > 1 && w[lo] == 0.0) ++lo;
+    while (hi - lo > 1 && w[hi - 1] == 0.0) --hi;
+    double sum = 0;
+    for (size_t k = lo; k < hi; ++k) sum += w[k];
+    if (sum == 0) { sum = 1; w[lo] = 1; }
+    t.first[(size_t)o] = i0 + (int)lo;
+    t.count[(size_t)o] = (int)(hi - lo);
+    t.off[(size_t)o] = t.wt.size();
+    int total = 0;
+    size_t big = t.wt.size();
+    for (size_t k = lo; k < hi; ++k) {
+      const int q = (int)std::lround(w[k] / sum * (1 << kWeightBits));
+      if (t.wt.size() == big || q > t.wt[big]) big = t.wt.size();
+      t.wt.push_back((int16_t)q);
+      total += q;
+    }
+    t.wt[big] = (int16_t)(t.wt[big] + ((1 << kWeightBits) - total));   // resto de arredondamento no maior peso
+  }
+}
+
+// Passada vertical: 'nh' linhas de saída de n bytes a partir de 'h' linhas de origem
+static void vertical(const Kernels& K, const uint8_t* src, int h, size_t n, uint8_t* dst, int nh, int filter) {
+  Taps t;
+  make_taps(h, nh, filter, t);
+  std::vector<const uint8_t*> rows;
+  for (int o = 0; o < nh; ++o) {
+    const int cnt = t.count[(size_t)o];
+    rows.resize((size_t)cnt);
+    for (int k = 0; k < cnt; ++k) rows[(size_t)k] = src + (size_t)(t.first[(size_t)o] + k) * n;
+    K.vpass(rows.data(), t.wt.data() + t.off[(size_t)o], cnt, n, dst + (size_t)o * n);
+  }
+}
+
+// Transposição de pixels de 'ch' bytes em blocos de 32×32: a escrita é sequencial e as
+// linhas lidas do bloco ficam na cache
+template <int CH>
+static void transpose_ch(const uint8_t* src, int w, int h, uint8_t* dst) {
+  const int B = 32;
+  for (int x0 = 0; x0 < w; x0 += B) {
+    const int x1 = std::min(w, x0 + B);
+    for (int y0 = 0; y0 < h; y0 += B) {
+      const int y1 = std::min(h, y0 + B);
+      for (int x = x0; x < x1; ++x) {
+        uint8_t* d = dst + ((size_t)x * h + y0) * CH;
+        const uint8_t* s = src + ((size_t)y0 * w + x) * CH;
+        for (int y = y0; y < y1; ++y, d += CH, s += (size_t)w * CH)
+          for (int c = 0; c < CH; ++c) d[c] = s[c];
+      }
+    }
+  }
+}
+
+static void transpose(const uint8_t* src, int w, int h, int ch, uint8_t* dst) {
+  switch (ch) {
+    case 1: transpose_ch<1>(src, w, h, dst); break;
+    case 3: transpose_ch<3>(src, w, h, dst); break;
+    case 4: transpose_ch<4>(src, w, h, dst); break;
+    default: {
+      for (int y = 0; y < h; ++y)
+        for (int x = 0; x < w; ++x)
+          memcpy(dst + ((size_t)x * h + y) * ch, src + ((size_t)y * w + x) * ch, (size_t)ch);
+    }
+  }
+}
+
+// Separável, as duas passadas pelo mesmo kernel vertical (a horizontal roda sobre a
+// imagem transposta). Cada passada arredonda para 8 bits.
+static void resample_with(const Kernels& K, const uint8_t* src, int w, int h, int ch,
+                          uint8_t* dst, int nw, int nh, int filter) {
+  const size_t row = (size_t)w * (size_t)ch;
+  std::vector<uint8_t> v(row * (size_t)nh), vt(v.size()), ht((size_t)nh * (size_t)ch * (size_t)nw);
+  vertical(K, src, h, row, v.data(), nh, filter);                  // w × nh
+  transpose(v.data(), w, nh, ch, vt.data());                       // nh × w
+  vertical(K, vt.data(), w, (size_t)nh * ch, ht.data(), nw, filter);   // nh × nw
+  transpose(ht.data(), nh, nw, ch, dst);                           // nw × nh
+}
+
+// ======================= selftest / bench =======================
+struct Rng {
+  uint32_t s;
+  uint32_t next() { s = s * 1664525u + 1013904223u; return s >> 8; }
+};
+
+static void fill_random(std::vector<uint8_t>& v, Rng& r, bool smooth) {
+  uint32_t acc = 128;
+  for (auto& b : v) {
+    // metade dos casos suave (foto), metade ruído puro, para exercitar saturação e arredondamento
+    acc = smooth ? (acc * 7 + (r.next() & 255)) / 8 : (r.next() & 255);
+    b = (uint8_t)acc;
+  }
+}
+
+static double now_s() {
+  return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void sauvola_stats(const std::vector<uint8_t>& g, std::vector<float>& mean, std::vector<float>& var, Rng& r) {
+  mean.resize(g.size());
+  var.resize(g.size());
+  for (size_t i = 0; i < g.size(); ++i) {
+    mean[i] = (float)g[i] + (float)((int)(r.next() % 64) - 32) * 0.73f;
+    var[i] = (float)(r.next() % 6000) * 0.61f - 50.0f;                      // negativos incluídos
+  }
+}
+
+}  // namespace
+
+// ======================= API interna =======================
+void gsx_rgb_to_gray(const uint8_t* rgb, uint8_t* gray, size_t n) { active().rgb_to_gray(rgb, gray, n); }
+
+void gsx_threshold(const uint8_t* gray, size_t n, uint8_t t, uint8_t* out) { active().threshold(gray, n, t, out); }
+
+void gsx_sauvola_row(const float* mean, const float* var, const uint8_t* g, int w, float k, float r,
+                     uint8_t* out) {
+  active().sauvola_row(mean, var, g, w, k, 1.0f / r, out);
+}
+
+void gsx_resample(const uint8_t* src, int w, int h, int ch, uint8_t* dst, int nw, int nh, int filter) {
+  resample_with(active(), src, w, h, ch, dst, nw, nh, filter);
+}
+
+// ======================= API exportada =======================
+GSX_API const char* gsx_simd_level(void) { return active().name; }
+
+GSX_API int gsx_kernels_selftest(char** json_out) {
+  if (json_out) *json_out = nullptr;
+  const auto& av = available();
+  const Kernels& S = kScalar;
+  Rng rng{12345};
+  int cases = 0, failures = 0;
+  std::string fails;
+  auto fail = [&](const Kernels& K, const char* kernel, const std::string& what) {
+    ++failures;
+    if (failures > 20) return;
+    if (!fails.empty()) fails += ",";
+    fails += "{\"level\":\"" + std::string(K.name) + "\",\"kernel\":\"" + kernel +
+             "\",\"case\":\"" + gsx_json_escape(what) + "\"}";
+  };
+
+  static const int kSizes[] = {0, 1, 7, 15, 16, 17, 31, 33, 64, 100, 257, 1023};
+  for (size_t li = 1; li < av.size(); ++li) {
+    const Kernels& K = *av[li];
+    for (int n : kSizes) {
+      for (int smooth = 0; smooth < 2; ++smooth) {
+        std::vector<uint8_t> rgb((size_t)n * 3), g1((size_t)n), g2((size_t)n);
+        fill_random(rgb, rng, smooth != 0);
+        S.rgb_to_gray(rgb.data(), g1.data(), (size_t)n);
+        K.rgb_to_gray(rgb.data(), g2.data(), (size_t)n);
+        ++cases;
+        if (g1 != g2) fail(K, "rgb_to_gray", "n=" + std::to_string(n));
+
+        for (int t : {0, 1, 127, 128, 254, 255}) {
+          std::vector<uint8_t> b1((size_t)n), b2((size_t)n);
+          S.threshold(g1.data(), (size_t)n, (uint8_t)t, b1.data());
+          K.threshold(g1.data(), (size_t)n, (uint8_t)t, b2.data());
+          ++cases;
+          if (b1 != b2) fail(K, "threshold", "n=" + std::to_string(n) + " t=" + std::to_string(t));
+        }
+
+        std::vector<float> mean, var;
+        sauvola_stats(g1, mean, var, rng);
+        std::vector<uint8_t> s1((size_t)n), s2((size_t)n);
+        for (float k : {0.2f, 0.34f, 0.5f}) {
+          S.sauvola_row(mean.data(), var.data(), g1.data(), n, k, 1.0f / 128.0f, s1.data());
+          K.sauvola_row(mean.data(), var.data(), g1.data(), n, k, 1.0f / 128.0f, s2.data());
+          ++cases;
+          if (s1 != s2) fail(K, "sauvola_row", "n=" + std::to_string(n) + " k=" + std::to_string(k));
+        }
+      }
+    }
+
+    // reamostragem: reduções inteiras e fracionárias, ampliação, 1/3/4 canais
+    static const int kShapes[][4] = {
+        {1, 1, 1, 1}, {17, 9, 5, 3}, {64, 48, 32, 24}, {100, 77, 33, 41}, {301, 203, 97, 61},
+        {40, 30, 90, 70}, {1000, 8, 37, 3}, {8, 999, 3, 40}, {257, 255, 256, 128}};
+    for (const auto& sh : kShapes) {
+      for (int ch : {1, 3, 4}) {
+        for (int filter : {GSX_FILTER_BOX, GSX_FILTER_LANCZOS3}) {
+          const int w = sh[0], h = sh[1], nw = sh[2], nh = sh[3];
+          std::vector<uint8_t> src((size_t)w * h * ch);
+          fill_random(src, rng, (w + ch) % 2 == 0);
+          std::vector<uint8_t> o1((size_t)nw * nh * ch), o2(o1.size());
+          resample_with(S, src.data(), w, h, ch, o1.data(), nw, nh, filter);
+          resample_with(K, src.data(), w, h, ch, o2.data(), nw, nh, filter);
+          ++cases;
+          if (o1 != o2) {
+            char buf[96];
+            snprintf(buf, sizeof buf, "%dx%dx%d->%dx%d %s", w, h, ch, nw, nh,
+                     filter == GSX_FILTER_BOX ? "box" : "lanczos3");
+            fail(K, "resample", buf);
+          }
+        }
+      }
+    }
+  }
+
+  if (json_out) {
+    std::string js = "{\"active\":\"" + std::string(active().name) + "\",\"levels\":[";
+    for (size_t li = 0; li < av.size(); ++li) js += (li ? ",\"" : "\"") + std::string(av[li]->name) + "\"";
+    js += "],\"cases\":" + std::to_string(cases) + ",\"failures\":" + std::to_string(failures) +
+          ",\"mismatches\":[" + fails + "]}";
+    *json_out = gsx_dup_string(js);
+  }
+  return failures;
+}
+
+GSX_API int gsx_kernels_bench(int megapixels, char** json_out) {
+  if (!json_out) {
+    set_last_error_json(GSX_E_ARGS, "kernels_bench", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  *json_out = nullptr;
+  if (megapixels <= 0) megapixels = 16;
+  megapixels = std::min(megapixels, 64);
+  const int w = 4096, h = std::max(1, megapixels * 1000000 / w);
+  const size_t n = (size_t)w * h;
+  Rng rng{777};
+  std::vector<uint8_t> rgb(n * 3), gray(n), bw(n), out(n);
+  fill_random(rgb, rng, true);
+  kScalar.rgb_to_gray(rgb.data(), gray.data(), n);
+  std::vector<float> mean, var;
+  sauvola_stats(std::vector<uint8_t>(gray.begin(), gray.begin() + w), mean, var, rng);
+
+  // Mpx/s sobre os pixels de entrada; melhor de 3 execuções
+  auto measure = [&](const std::function<void()>& fn) {
+    double best = 1e30;
+    for (int r = 0; r < 3; ++r) {
+      const double t0 = now_s();
+      fn();
+      best = std::min(best, now_s() - t0);
+    }
+    return best > 0 ? (double)n / 1e6 / best : 0.0;
+  };
+
+  struct Row { const char* kernel; std::vector<double> mpx; };
+  std::vector<Row> rows = {{"rgb_to_gray", {}}, {"threshold", {}}, {"sauvola_row", {}},
+                           {"box_rgb_1/3", {}}, {"lanczos3_rgb_1/3", {}}, {"lanczos3_gray_1/2", {}}};
+  const auto& av = available();
+  for (const Kernels* K : av) {
+    rows[0].mpx.push_back(measure([&] { K->rgb_to_gray(rgb.data(), gray.data(), n); }));
+    rows[1].mpx.push_back(measure([&] { K->threshold(gray.data(), n, 128, bw.data()); }));
+    rows[2].mpx.push_back(measure([&] {
+      for (int y = 0; y < h; ++y)
+        K->sauvola_row(mean.data(), var.data(), gray.data() + (size_t)y * w, w, 0.34f, 1.0f / 128.0f,
+                       bw.data() + (size_t)y * w);
+    }));
+    rows[3].mpx.push_back(measure([&] {
+      resample_with(*K, rgb.data(), w, h, 3, out.data(), w / 3, h / 3, GSX_FILTER_BOX);
+    }));
+    rows[4].mpx.push_back(measure([&] {
+      resample_with(*K, rgb.data(), w, h, 3, out.data(), w / 3, h / 3, GSX_FILTER_LANCZOS3);
+    }));
+    rows[5].mpx.push_back(measure([&] {
+      resample_with(*K, gray.data(), w, h, 1, out.data(), w / 2, h / 2, GSX_FILTER_LANCZOS3);
+    }));
+  }
+
+  std::string js = "{\"active\":\"" + std::string(active().name) + "\",\"megapixels\":" +
+                   std::to_string((double)n / 1e6) + ",\"levels\":[";
+  for (size_t li = 0; li < av.size(); ++li) js += (li ? ",\"" : "\"") + std::string(av[li]->name) + "\"";
+  js += "],\"kernels\":[";
+  char buf[64];
+  for (size_t r = 0; r < rows.size(); ++r) {
+    js += (r ? ",{\"kernel\":\"" : "{\"kernel\":\"") + std::string(rows[r].kernel) + "\",\"mpx_per_s\":{";
+    for (size_t li = 0; li < av.size(); ++li) {
+      snprintf(buf, sizeof buf, "%s\"%s\":%.1f", li ? "," : "", av[li]->name, rows[r].mpx[li]);
+      js += buf;
+    }
+    js += "}}";
+  }
+  js += "]}";
+  *json_out = gsx_dup_string(js);
+  if (!*json_out) {
+    set_last_error_json(GSX_E_UNKNOWN, "kernels_bench.alloc", 0, 0, nullptr);
+    return GSX_E_UNKNOWN;
+  }
+  set_last_error_json(GSX_OK, "kernels_bench", 0, 0, nullptr);
+  return GSX_OK;
+}
@@ -0,0 +1,610 @@
+// gsx_linearize.cpp — linearização nativa ("fast web view") sem qpdf
+//
+// write_linearized recebe o grafo de objetos já montado (pela mesclagem ou por
+// gsx_linearize_pdf) e grava o arquivo final de uma vez:
+//  1) partição (anexo F): cada objeto alcançável a partir da 1ª página vai para a seção
+//     da 1ª página; os alcançáveis de uma única página vão logo depois dela; os de
+//     várias páginas vão para a seção de compartilhados; o resto (árvore de páginas,
+//     /Info, outlines...) fica no fim. A busca a partir de uma página não entra em
+//     outros nós /Page nem /Pages (/Parent, destinos de links).
+//  2) numeração: seção principal 1..m na ordem do arquivo; dicionário de
+//     linearização, catálogo, hint stream e 1ª página depois de m.
+//  3) layout: só os dicionários são serializados; com os tamanhos dos streams já
+//     conhecidos, todos os offsets saem antes de escrever o primeiro byte. As hint
+//     tables usam offsets "sem o hint stream" (como manda a especificação), então
+//     dependem só desse primeiro layout; os números do dicionário de linearização e o
+//     /Prev da 1ª xref têm largura fixa.
+//  4) escrita sequencial, conferindo cada offset com o planejado.
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+namespace fs = std::filesystem;
+
+namespace gsx_pdf {
+namespace {
+
+enum Part : uint8_t { P_NONE, P_DOC, P_FIRST, P_PAGE, P_SHARED, P_OTHER };
+enum Kind : uint8_t { K_OBJ, K_PAGE, K_PAGES, K_CATALOG };
+
+// Catálogo: entradas que o leitor usa antes de mostrar a 1ª página
+static const char* const kDocKeys[] = {"ViewerPreferences", "PageMode", "Threads", "OpenAction", "AcroForm"};
+
+static void collect_refs(const Obj& o, std::vector<uint32_t>& out) {
+  switch (o.type) {
+    case Type::Ref: out.push_back(o.ref_num()); break;
+    case Type::Array: if (o.arr) for (auto& v : *o.arr) collect_refs(v, out); break;
+    case Type::Dict: if (o.dict) for (auto& kv : *o.dict) collect_refs(kv.second, out); break;
+    default: break;
+  }
+}
+
+static Obj renumber(const Obj& o, const std::vector<uint32_t>& num) {
+  switch (o.type) {
+    case Type::Ref: {
+      const uint32_t r = o.ref_num();
+      return (r < num.size() && num[r]) ? Obj::make_ref(num[r]) : Obj();
+    }
+    case Type::Array: {
+      Obj a = Obj::make_array();
+      a.arr->reserve(o.arr ? o.arr->size() : 0);
+      if (o.arr) for (auto& v : *o.arr) a.arr->push_back(renumber(v, num));
+      return a;
+    }
+    case Type::Dict: {
+      Obj d = Obj::make_dict();
+      d.dict->reserve(o.dict ? o.dict->size() : 0);
+      if (o.dict) for (auto& kv : *o.dict) d.dict->emplace_back(kv.first, renumber(kv.second, num));
+      return d;
+    }
+    default:
+      return o;
+  }
+}
+
+// Bits para representar v (0 => 0 bits)
+static int nbits(uint64_t v) {
+  int b = 0;
+  while (v) { ++b; v >>= 1; }
+  return b;
+}
+
+// Escrita de campos em bits, do mais significativo para o menos (anexo F.3)
+struct BitWriter {
+  std::string out;
+  uint32_t acc = 0;
+  int n = 0;
+  void put(uint64_t v, int bits) {
+    for (int b = bits - 1; b >= 0; --b) {
+      acc = (acc << 1) | (uint32_t)((v >> b) & 1);
+      if (++n == 8) { out.push_back((char)acc); acc = 0; n = 0; }
+    }
+  }
+  void align() {
+    if (n) { out.push_back((char)(acc << (8 - n))); acc = 0; n = 0; }
+  }
+};
+
+// Objeto na ordem do arquivo: índice de entrada (0 = gerado aqui) e texto serializado
+struct Slot {
+  uint32_t src = 0;
+  std::string head;        // "N 0 obj\n<<...>>\nstream\n" ou o objeto inteiro
+  bool is_stream = false;
+};
+
+static const char kStreamTail[] = "\nendstream\nendobj\n";
+
+}  // namespace
+
+bool write_linearized(const char* path, int version, const std::vector<LinObject>& objs,
+                      uint32_t catalog, const std::vector<uint32_t>& pages, const Obj& trailer,
+                      LinStats* stats, int* os_errno)
+{
+  if (os_errno) *os_errno = 0;
+  const size_t n = objs.size();
+  if (!path || pages.empty() || catalog == 0 || catalog >= n) return false;
+
+  std::vector<uint8_t> kind(n, K_OBJ);
+  for (size_t i = 1; i < n; ++i) {
+    const Obj& v = objs[i].value;
+    const Obj* ty = v.is_dict() ? v.get("Type") : nullptr;
+    if (ty && ty->is_name("Pages")) kind[i] = K_PAGES;
+  }
+  kind[catalog] = K_CATALOG;
+  for (uint32_t p : pages) {
+    if (p == 0 || p >= n || kind[p] == K_PAGE || kind[p] == K_CATALOG) return false;
+    kind[p] = K_PAGE;
+  }
+
+  // 1) partição. stamp evita revisitar dentro de uma mesma busca.
+  std::vector<uint8_t> part(n, P_NONE);
+  std::vector<uint32_t> stamp(n, 0), users(n, 0);
+  uint32_t mark = 0;
+  std::vector<uint32_t> stack, refs;
+  // busca em profundidade a partir de 'starts'; enter(t) decide se t entra
+  auto walk = [&](const std::vector<uint32_t>& starts, auto&& enter, std::vector<uint32_t>& out) {
+    ++mark;
+    stack.clear();
+    for (auto it = starts.rbegin(); it != starts.rend(); ++it)
+      if (*it && *it < n && stamp[*it] != mark) { stamp[*it] = mark; stack.push_back(*it); }
+    while (!stack.empty()) {
+      const uint32_t u = stack.back();
+      stack.pop_back();
+      out.push_back(u);
+      refs.clear();
+      collect_refs(objs[u].value, refs);
+      for (auto it = refs.rbegin(); it != refs.rend(); ++it) {
+        const uint32_t t = *it;
+        if (t == 0 || t >= n || stamp[t] == mark || !enter(t)) continue;
+        stamp[t] = mark;
+        stack.push_back(t);
+      }
+    }
+  };
+  auto page_local = [&](uint32_t t) { return kind[t] == K_OBJ; };
+
+  std::vector<std::vector<uint32_t>> reach(pages.size());
+  for (size_t pi = 0; pi < pages.size(); ++pi) {
+    walk({pages[pi]}, page_local, reach[pi]);
+    for (uint32_t u : reach[pi]) ++users[u];
+  }
+
+  std::vector<uint32_t> first_sec = reach[0];
+  for (uint32_t u : first_sec) part[u] = P_FIRST;
+  std::vector<std::vector<uint32_t>> page_sec(pages.size());
+  std::vector<uint32_t> shared_sec;
+  for (size_t pi = 1; pi < pages.size(); ++pi) {
+    for (uint32_t u : reach[pi]) {
+      if (part[u] != P_NONE) continue;
+      if (users[u] == 1) { part[u] = P_PAGE; page_sec[pi].push_back(u); }
+      else { part[u] = P_SHARED; shared_sec.push_back(u); }
+    }
+  }
+
+  std::vector<uint32_t> doc_sec{catalog};
+  part[catalog] = P_DOC;
+  {
+    std::vector<uint32_t> starts;
+    const Obj& cv = objs[catalog].value;
+    for (const char* k : kDocKeys) {
+      const Obj* v = cv.is_dict() ? cv.get(k) : nullptr;
+      if (v) collect_refs(*v, starts);
+    }
+    std::vector<uint32_t> got;
+    walk(starts, [&](uint32_t t) { return kind[t] == K_OBJ && part[t] == P_NONE; }, got);
+    for (uint32_t u : got) {
+      if (part[u] != P_NONE || kind[u] != K_OBJ) continue;
+      part[u] = P_DOC;
+      doc_sec.push_back(u);
+    }
+  }
+
+  // resto: tudo que ainda é alcançável (árvore de páginas, /Info, outlines, nomes...)
+  std::vector<uint32_t> other_sec;
+  {
+    std::vector<uint32_t> starts{catalog};
+    collect_refs(trailer, starts);
+    for (auto* sec : {&first_sec, &shared_sec}) starts.insert(starts.end(), sec->begin(), sec->end());
+    for (auto& s : page_sec) starts.insert(starts.end(), s.begin(), s.end());
+    starts.insert(starts.end(), doc_sec.begin(), doc_sec.end());
+    std::vector<uint32_t> got;
+    walk(starts, [&](uint32_t t) { return part[t] == P_NONE; }, got);
+    for (uint32_t u : got) {
+      if (part[u] != P_NONE) continue;
+      part[u] = P_OTHER;
+      other_sec.push_back(u);
+    }
+  }
+
+  // 2) numeração na ordem do arquivo
+  std::vector<uint32_t> num(n, 0);
+  std::vector<uint32_t> order_main;    // 1..m
+  for (size_t pi = 1; pi < pages.size(); ++pi) {
+    order_main.push_back(pages[pi]);
+    for (uint32_t u : page_sec[pi]) if (u != pages[pi]) order_main.push_back(u);
+  }
+  order_main.insert(order_main.end(), shared_sec.begin(), shared_sec.end());
+  order_main.insert(order_main.end(), other_sec.begin(), other_sec.end());
+  const uint32_t m = (uint32_t)order_main.size();
+  for (uint32_t k = 0; k < m; ++k) num[order_main[k]] = k + 1;
+  const uint32_t lin_num = m + 1;
+  uint32_t next = lin_num + 1;
+  for (uint32_t u : doc_sec) num[u] = next++;
+  const uint32_t hint_num = next++;
+  for (uint32_t u : first_sec) num[u] = next++;
+  const uint32_t total = next;                         // /Size da 1ª xref
+  const uint32_t first_count = total - lin_num;        // entradas da 1ª xref
+
+  // 3) textos (por número) e tamanhos
+  std::vector<Slot> slot(total);
+  std::vector<uint64_t> size_of(total, 0);
+  for (size_t i = 1; i < n; ++i) {
+    if (!num[i]) continue;
+    Slot& s = slot[num[i]];
+    s.src = (uint32_t)i;
+    s.is_stream = objs[i].is_stream;
+    Obj v = renumber(objs[i].value, num);
+    s.head = std::to_string(num[i]) + " 0 obj\n";
+    if (s.is_stream) {
+      if (!v.is_dict()) v = Obj::make_dict();
+      v.set("Length", Obj::make_int((int64_t)objs[i].len));
+      serialize(v, s.head);
+      s.head += "\nstream\n";
+      size_of[num[i]] = s.head.size() + objs[i].len + (sizeof(kStreamTail) - 1);
+    } else {
+      serialize(v, s.head);
+      s.head += "\nendobj\n";
+      size_of[num[i]] = s.head.size();
+    }
+  }
+
+  char hdr[32];
+  if (version < 12 || version > 20) version = version < 12 ? 14 : 17;   // linearização: PDF 1.2+
+  const int hdr_len = snprintf(hdr, sizeof hdr, "%%PDF-%d.%d\n%%\xE2\xE3\xCF\xD3\n", version / 10, version % 10);
+
+  auto lin_text = [&](uint64_t L, uint64_t hoff, uint64_t hlen, uint64_t E, uint64_t T) {
+    char b[256];
+    int k = snprintf(b, sizeof b,
+                     "%u 0 obj\n<< /Linearized 1 /L %010llu /H [ %010llu %010llu ] /O %u /E %010llu "
+                     "/N %u /T %010llu >>\nendobj\n",
+                     lin_num, (unsigned long long)L, (unsigned long long)hoff, (unsigned long long)hlen,
+                     num[pages[0]], (unsigned long long)E, (unsigned)pages.size(), (unsigned long long)T);
+    return std::string(b, (size_t)k);
+  };
+  // trailer da 1ª xref: /Prev (xref principal) com largura fixa
+  std::string first_trailer_head = "trailer\n<< /Size " + std::to_string(total) + " /Root " +
+                                   std::to_string(num[catalog]) + " 0 R";
+  {
+    const Obj* info = trailer.get("Info");
+    if (info && info->is_ref() && info->ref_num() < n && num[info->ref_num()])
+      first_trailer_head += " /Info " + std::to_string(num[info->ref_num()]) + " 0 R";
+    if (const Obj* id = trailer.get("ID")) {
+      first_trailer_head += " /ID ";
+      serialize(*id, first_trailer_head);
+    }
+  }
+  auto first_xref_tail = [&](uint64_t prev) {
+    char b[64];
+    int k = snprintf(b, sizeof b, " /Prev %010llu >>\nstartxref\n0\n%%%%EOF\n", (unsigned long long)prev);
+    return std::string(b, (size_t)k);
+  };
+  const std::string first_xref_head = "xref\n" + std::to_string(lin_num) + " " + std::to_string(first_count) + "\n";
+  const uint64_t first_xref_len = first_xref_head.size() + 20ull * first_count +
+                                  first_trailer_head.size() + first_xref_tail(0).size();
+  const std::string main_xref_head = "xref\n0 " + std::to_string(m + 1) + "\n";
+
+  // offsets por número (na ordem do arquivo) para um tamanho de hint stream
+  struct Layout {
+    std::vector<uint64_t> off;
+    uint64_t lin_off = 0, first_xref_off = 0, hint_off = 0, first_end = 0, main_xref_off = 0, L = 0;
+  };
+  const uint64_t lin_len = lin_text(0, 0, 0, 0, 0).size();
+  auto layout = [&](uint64_t hint_len) {
+    Layout lo;
+    lo.off.assign(total, 0);
+    uint64_t pos = (uint64_t)hdr_len;
+    lo.lin_off = pos;           lo.off[lin_num] = pos; pos += lin_len;
+    lo.first_xref_off = pos;    pos += first_xref_len;
+    for (uint32_t u : doc_sec) { lo.off[num[u]] = pos; pos += size_of[num[u]]; }
+    lo.hint_off = pos;          lo.off[hint_num] = pos; pos += hint_len;
+    for (uint32_t u : first_sec) { lo.off[num[u]] = pos; pos += size_of[num[u]]; }
+    lo.first_end = pos;
+    for (uint32_t k = 1; k <= m; ++k) { lo.off[k] = pos; pos += size_of[k]; }
+    lo.main_xref_off = pos;
+    std::string tail = "trailer\n<< /Size " + std::to_string(m + 1) + " >>\nstartxref\n" +
+                       std::to_string(lo.first_xref_off) + "\n%%EOF\n";
+    pos += main_xref_head.size() + 20ull * (m + 1) + tail.size();
+    lo.L = pos;
+    return lo;
+  };
+
+  // 4) hint tables a partir do layout sem o hint stream
+  const Layout l0 = layout(0);
+  std::vector<uint32_t> shared_id(n, UINT32_MAX);      // identificador na tabela de compartilhados
+  for (size_t k = 0; k < first_sec.size(); ++k) shared_id[first_sec[k]] = (uint32_t)k;
+  for (size_t k = 0; k < shared_sec.size(); ++k) shared_id[shared_sec[k]] = (uint32_t)(first_sec.size() + k);
+  const size_t shared_total = first_sec.size() + shared_sec.size();
+
+  const size_t np = pages.size();
+  std::vector<uint64_t> pg_objs(np), pg_len(np);
+  std::vector<std::vector<uint32_t>> pg_shared(np);
+  pg_objs[0] = first_sec.size();
+  pg_len[0] = l0.first_end - l0.off[num[pages[0]]];
+  for (size_t pi = 1; pi < np; ++pi) {
+    pg_objs[pi] = page_sec[pi].size();
+    uint64_t len = 0;
+    for (uint32_t u : page_sec[pi]) len += size_of[num[u]];
+    pg_len[pi] = len;
+    // a 1ª página não lista compartilhados: os seus estão todos na própria seção
+    for (uint32_t u : reach[pi])
+      if (part[u] == P_SHARED || part[u] == P_FIRST) pg_shared[pi].push_back(shared_id[u]);
+  }
+  const uint64_t min_objs = *std::min_element(pg_objs.begin(), pg_objs.end());
+  const uint64_t max_objs = *std::max_element(pg_objs.begin(), pg_objs.end());
+  const uint64_t min_len = *std::min_element(pg_len.begin(), pg_len.end());
+  const uint64_t max_len = *std::max_element(pg_len.begin(), pg_len.end());
+  size_t max_refs = 0;
+  for (auto& v : pg_shared) max_refs = std::max(max_refs, v.size());
+  const int b_objs = nbits(max_objs - min_objs);
+  const int b_len = nbits(max_len - min_len);
+  const int b_refs = nbits(max_refs);
+  const int b_id = nbits(shared_total ? shared_total - 1 : 0);
+
+  BitWriter hw;
+  // tabela de offsets de página (F.3.1); o tamanho do conteúdo é aproximado pelo da
+  // página inteira, como fazem Acrobat e qpdf
+  hw.put(min_objs, 32);
+  hw.put(l0.off[num[pages[0]]], 32);
+  hw.put((uint64_t)b_objs, 16);
+  hw.put(min_len, 32);
+  hw.put((uint64_t)b_len, 16);
+  hw.put(0, 32);                    // menor offset do content stream
+  hw.put(0, 16);
+  hw.put(min_len, 32);              // menor tamanho de content stream
+  hw.put((uint64_t)b_len, 16);
+  hw.put((uint64_t)b_refs, 16);
+  hw.put((uint64_t)b_id, 16);
+  hw.put(0, 16);                    // bits do numerador (posição fracionária)
+  hw.put(4, 16);                    // denominador
+  for (size_t pi = 0; pi < np; ++pi) hw.put(pg_objs[pi] - min_objs, b_objs);
+  hw.align();
+  for (size_t pi = 0; pi < np; ++pi) hw.put(pg_len[pi] - min_len, b_len);
+  hw.align();
+  for (size_t pi = 0; pi < np; ++pi) hw.put(pg_shared[pi].size(), b_refs);
+  hw.align();
+  for (size_t pi = 0; pi < np; ++pi) for (uint32_t id : pg_shared[pi]) hw.put(id, b_id);
+  hw.align();
+  hw.align();                       // numeradores: 0 bits
+  hw.align();                       // offsets de conteúdo: 0 bits
+  for (size_t pi = 0; pi < np; ++pi) hw.put(pg_len[pi] - min_len, b_len);
+  hw.align();
+  const size_t shared_table_at = hw.out.size();
+
+  // tabela de objetos compartilhados (F.3.2): um grupo por objeto
+  std::vector<uint64_t> grp;
+  for (uint32_t u : first_sec) grp.push_back(size_of[num[u]]);
+  for (uint32_t u : shared_sec) grp.push_back(size_of[num[u]]);
+  const uint64_t min_grp = grp.empty() ? 0 : *std::min_element(grp.begin(), grp.end());
+  const uint64_t max_grp = grp.empty() ? 0 : *std::max_element(grp.begin(), grp.end());
+  const int b_grp = nbits(max_grp - min_grp);
+  hw.put(shared_sec.empty() ? 0 : num[shared_sec[0]], 32);
+  hw.put(shared_sec.empty() ? 0 : l0.off[num[shared_sec[0]]], 32);
+  hw.put(first_sec.size(), 32);
+  hw.put(shared_total, 32);
+  hw.put(0, 16);                    // bits do nº de objetos por grupo (sempre 1)
+  hw.put(min_grp, 32);
+  hw.put((uint64_t)b_grp, 16);
+  for (uint64_t g : grp) hw.put(g - min_grp, b_grp);
+  hw.align();
+  for (size_t k = 0; k < grp.size(); ++k) hw.put(0, 1);   // sem assinatura MD5
+  hw.align();
+
+  std::string hint_z;
+  if (!flate_encode((const uint8_t*)hw.out.data(), hw.out.size(), 9, 0, hint_z)) return false;
+  std::string hint_head = std::to_string(hint_num) + " 0 obj\n<< /Filter /FlateDecode /S " +
+                          std::to_string(shared_table_at) + " /Length " + std::to_string(hint_z.size()) +
+                          " >>\nstream\n";
+  const uint64_t hint_len = hint_head.size() + hint_z.size() + (sizeof(kStreamTail) - 1);
+
+  // 5) layout final e escrita
+  const Layout lo = layout(hint_len);
+  const uint64_t T = lo.main_xref_off + main_xref_head.size() - 1;   // \n antes da 1ª entrada
+
+  Writer w;
+  if (!w.open(path, version)) { if (os_errno) *os_errno = w.os_errno(); return false; }
+  bool ok = w.bytes_written() == (uint64_t)hdr_len;
+  auto put = [&](const std::string& s) { ok = ok && w.write_bytes(s.data(), s.size()); };
+  auto xref_rows = [&](uint32_t from, uint32_t count) {
+    std::string rows;
+    rows.reserve(20u * count);
+    char line[32];
+    for (uint32_t k = from; k < from + count; ++k) {
+      if (k == 0) rows += "0000000000 65535 f\r\n";
+      else {
+        snprintf(line, sizeof line, "%010llu 00000 n\r\n", (unsigned long long)lo.off[k]);
+        rows.append(line, 20);
+      }
+    }
+    return rows;
+  };
+  auto put_obj = [&](uint32_t k) {
+    ok = ok && w.bytes_written() == lo.off[k];
+    const Slot& s = slot[k];
+    put(s.head);
+    if (s.is_stream) {
+      const LinObject& o = objs[s.src];
+      ok = ok && (o.len == 0 || w.write_bytes(o.data, o.len)) && w.write_bytes(kStreamTail, sizeof(kStreamTail) - 1);
+    }
+  };
+
+  put(lin_text(lo.L, lo.hint_off, hint_len, lo.first_end, T));
+  ok = ok && w.bytes_written() == lo.first_xref_off;
+  put(first_xref_head);
+  put(xref_rows(lin_num, first_count));
+  put(first_trailer_head);
+  put(first_xref_tail(lo.main_xref_off));
+  for (uint32_t u : doc_sec) put_obj(num[u]);
+  ok = ok && w.bytes_written() == lo.hint_off;
+  put(hint_head);
+  ok = ok && w.write_bytes(hint_z.data(), hint_z.size()) && w.write_bytes(kStreamTail, sizeof(kStreamTail) - 1);
+  for (uint32_t u : first_sec) put_obj(num[u]);
+  ok = ok && w.bytes_written() == lo.first_end;
+  for (uint32_t k = 1; k <= m; ++k) put_obj(k);
+  ok = ok && w.bytes_written() == lo.main_xref_off;
+  put(main_xref_head);
+  put(xref_rows(0, m + 1));
+  put("trailer\n<< /Size " + std::to_string(m + 1) + " >>\nstartxref\n" +
+      std::to_string(lo.first_xref_off) + "\n%%EOF\n");
+  ok = ok && w.bytes_written() == lo.L && w.finish_raw();
+  if (!ok) {
+    if (os_errno) *os_errno = w.os_errno();
+    w.close();
+    return false;
+  }
+
+  if (stats) {
+    stats->objects = (size_t)m + doc_sec.size() + first_sec.size();
+    stats->first_page_objects = first_sec.size();
+    stats->shared_objects = shared_sec.size();
+    stats->first_page_end = lo.first_end;
+    stats->hint_bytes = hint_z.size();
+    stats->bytes_out = lo.L;
+  }
+  return true;
+}
+
+}  // namespace gsx_pdf
+
+using namespace gsx_pdf;
+
+namespace {
+
+// Grafo alcançável a partir do trailer, com índices 1..n em ordem de visita
+struct Graph {
+  Document& doc;
+  std::unordered_map<uint32_t, uint32_t> idx;
+  std::vector<Indirect> todo;
+
+  uint32_t map(uint32_t n) {
+    auto it = idx.find(n);
+    if (it != idx.end()) return it->second;
+    Indirect ind;
+    if (n == 0 || !doc.load(n, ind)) return 0;
+    const uint32_t k = (uint32_t)todo.size() + 1;
+    idx[n] = k;
+    todo.push_back(std::move(ind));
+    return k;
+  }
+
+  Obj rewrite(const Obj& o) {
+    switch (o.type) {
+      case Type::Ref: {
+        uint32_t t = map(o.ref_num());
+        return t ? Obj::make_ref(t) : Obj();
+      }
+      case Type::Array: {
+        Obj a = Obj::make_array();
+        a.arr->reserve(o.arr ? o.arr->size() : 0);
+        if (o.arr) for (auto& v : *o.arr) a.arr->push_back(rewrite(v));
+        return a;
+      }
+      case Type::Dict: {
+        Obj d = Obj::make_dict();
+        d.dict->reserve(o.dict ? o.dict->size() : 0);
+        if (o.dict) for (auto& kv : *o.dict) d.dict->emplace_back(kv.first, rewrite(kv.second));
+        return d;
+      }
+      default:
+        return o;
+    }
+  }
+};
+
+}  // namespace
+
+GSX_API int gsx_linearize_pdf(const char* in_path, const char* out_path, gsx_linearize_stats_t* stats_out)
+{
+  GsxJobScope scope("gsx_linearize_pdf", in_path, out_path);
+  GsxSpan span("linearize");
+  if (stats_out) memset(stats_out, 0, sizeof(*stats_out));
+  std::error_code ec;
+  if (!in_path || !out_path || fs::equivalent(in_path, out_path, ec)) {
+    set_last_error_json(GSX_E_ARGS, "linearize", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  Document doc;
+  if (!doc.open(in_path)) {
+    int rc = doc.os_errno() ? GSX_E_INPUT_NOT_FOUND : GSX_E_PDF_PARSE;
+    set_last_error_json(rc, "linearize.open", doc.os_errno(), 0, nullptr);
+    return rc;
+  }
+  if (doc.encrypted()) {
+    set_last_error_json(GSX_E_PDF_ENCRYPTED, "linearize.open", 0, 0, nullptr);
+    return GSX_E_PDF_ENCRYPTED;
+  }
+  std::vector<PageInfo> infos;
+  const Obj* root = doc.trailer().get("Root");
+  if (!root || !root->is_ref() || !doc.pages(infos) || infos.empty()) {
+    set_last_error_json(GSX_E_PDF_PARSE, "linearize.pages", 0, 0, nullptr);
+    return GSX_E_PDF_PARSE;
+  }
+
+  Graph g{doc, {}, {}};
+  Obj trailer = Obj::make_dict();
+  const uint32_t catalog = g.map(root->ref_num());
+  if (const Obj* info = doc.trailer().get("Info")) {
+    Obj v = g.rewrite(*info);
+    if (v.is_ref()) trailer.set("Info", v);
+  }
+  if (const Obj* id = doc.trailer().get("ID")) trailer.set("ID", *id);
+
+  // atributos herdados vão para a própria página: a busca por página não sobe pela
+  // árvore, e assim Resources/MediaBox ficam na seção da página
+  struct Inherit { uint32_t page; const char* key; Obj value; };
+  std::vector<uint32_t> pages;
+  std::vector<Inherit> inherit;
+  for (auto& pi : infos) {
+    const uint32_t k = g.map(pi.num);
+    if (!k) continue;
+    pages.push_back(k);
+    const std::pair<const char*, const Obj*> attrs[] = {
+      {"Resources", &pi.resources}, {"MediaBox", &pi.media_box}, {"CropBox", &pi.crop_box}, {"Rotate", &pi.rotate}};
+    for (auto& a : attrs)
+      if (!a.second->is_null() && !pi.dict.get(a.first)) inherit.push_back({k, a.first, g.rewrite(*a.second)});
+  }
+
+  std::vector<LinObject> objs(1);
+  for (size_t next = 0; next < g.todo.size(); ++next) {
+    Indirect ind = std::move(g.todo[next]);
+    LinObject o;
+    if (ind.is_stream && ind.value.is_dict()) {
+      Obj d = ind.value;
+      d.dict = std::make_shared<Dict>(*d.dict);
+      d.erase("Length");      // regravado com o tamanho real; não arrasta o objeto
+      o.value = g.rewrite(d);
+      o.is_stream = true;
+      o.data = doc.data() + ind.stream_off;
+      o.len = ind.stream_len;
+    } else {
+      o.value = g.rewrite(ind.value);
+    }
+    objs.push_back(std::move(o));
+  }
+  for (auto& in : inherit)
+    if (objs[in.page].value.is_dict()) objs[in.page].value.set(in.key, in.value);
+
+  LinStats ls;
+  int err = 0;
+  if (!catalog || !write_linearized(out_path, doc.version(), objs, catalog, pages, trailer, &ls, &err)) {
+    fs::remove(out_path, ec);
+    const int rc = err ? GSX_E_WRITE_IO : GSX_E_PDF_PARSE;
+    set_last_error_json(rc, "linearize.write", err, 0, nullptr);
+    return rc;
+  }
+  if (stats_out) {
+    stats_out->pages = (int)pages.size();
+    stats_out->objects = (int)ls.objects;
+    stats_out->first_page_objects = (int)ls.first_page_objects;
+    stats_out->shared_objects = (int)ls.shared_objects;
+    stats_out->first_page_end = ls.first_page_end;
+    stats_out->hint_bytes = ls.hint_bytes;
+    stats_out->bytes_out = ls.bytes_out;
+  }
+  char msg[200];
+  snprintf(msg, sizeof msg,
+           "linearize_pdf: %zu páginas, %zu objetos (%zu na 1ª página, %zu compartilhados), /E %llu, saída %llu bytes",
+           pages.size(), ls.objects, ls.first_page_objects, ls.shared_objects,
+           (unsigned long long)ls.first_page_end, (unsigned long long)ls.bytes_out);
+  gsx_log_msg(GSX_LOG_DEBUG, msg);
+  set_last_error_json(GSX_OK, "linearize", 0, 0, nullptr);
+  return (int)pages.size();
+}
@@ -0,0 +1,545 @@
+// gsx_merge.cpp — concatenação nativa de PDFs (gsx_merge_pdfs), substitui "qpdf --empty --pages",
+// e deduplicação de objetos idênticos entre as partes (GSX_MERGE_DEDUP / gsx_dedup_pdf)
+//
+// Cada entrada é mapeada em memória; a partir das páginas coletamos só os objetos
+// alcançáveis (dicionários em memória, dados de stream continuam no mmap), renumeramos
+// e gravamos direto na saída. Streams são copiados byte a byte (sem decodificar), então
+// o custo fica perto de uma cópia do arquivo. Atributos herdáveis (Resources/MediaBox/
+// CropBox/Rotate) são achatados em cada página e a árvore vira um único /Pages plano.
+//
+// Deduplicação: cada parte do pdfwrite embute sua própria cópia de perfis ICC, imagens
+// e fontes repetidas. Classes de equivalência são refinadas até o ponto fixo (chave =
+// classe atual + conteúdo com as referências trocadas pela classe do alvo; streams
+// entram pelo hash dos bytes crus), então grafos idênticos colapsam mesmo com ciclos.
+// Páginas nunca são fundidas.
+//
+// GSX_MERGE_LINEARIZE: o grafo final vai direto para gsx_pdf::write_linearized
+// (gsx_linearize.cpp), sem gravar a versão plana nem reler o arquivo.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+using namespace gsx_pdf;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Referências internas (entre coleta e escrita) apontam para índices em Merge::nodes.
+static const uint32_t kPagesNode = 0xFFFFFFFFu;   // qualquer nó /Pages antigo
+static const uint32_t kNullNode  = 0xFFFFFFFEu;   // referência órfã
+static const uint32_t kRootNode  = 0xFFFFFFFDu;   // catálogo da entrada (só com keep_catalog)
+
+struct Node {
+  Obj value;                 // Refs já reescritas para índices de nó
+  bool is_stream = false;
+  bool pinned = false;       // páginas: nunca deduplicadas
+  const uint8_t* data = nullptr;
+  size_t len = 0;
+  uint64_t data_hash = 0;
+};
+
+struct Merge {
+  std::vector<Node> nodes;
+  std::vector<uint32_t> kids;        // nós das páginas, em ordem
+  Obj catalog;                       // keep_catalog: /Root da entrada sem /Pages
+  Obj trailer;                       // keep_catalog: /Info e /ID da entrada
+
+  // Coleta de um documento: número na entrada → índice de nó
+  struct Collector {
+    Merge& m;
+    Document& doc;
+    std::unordered_map<uint32_t, uint32_t> local;
+    std::vector<std::pair<uint32_t, Indirect>> todo;
+
+    uint32_t discover(uint32_t num) {
+      auto it = local.find(num);
+      if (it != local.end()) return it->second;
+      Indirect ind;
+      if (!doc.load(num, ind)) { local[num] = kNullNode; return kNullNode; }
+      const Obj* type = ind.value.get("Type");
+      if (!ind.is_stream && type && type->is_name("Pages")) {
+        // nós intermediários da árvore antiga colapsam no /Pages novo
+        local[num] = kPagesNode;
+        return kPagesNode;
+      }
+      uint32_t id = (uint32_t)m.nodes.size();
+      m.nodes.emplace_back();
+      local[num] = id;
+      todo.emplace_back(id, std::move(ind));
+      return id;
+    }
+
+    Obj rewrite(const Obj& o) {
+      switch (o.type) {
+        case Type::Ref: return Obj::make_ref(discover(o.ref_num()));
+        case Type::Array: {
+          Obj a = Obj::make_array();
+          a.arr->reserve(o.arr ? o.arr->size() : 0);
+          if (o.arr) for (auto& v : *o.arr) a.arr->push_back(rewrite(v));
+          return a;
+        }
+        case Type::Dict: {
+          Obj d = Obj::make_dict();
+          d.dict->reserve(o.dict ? o.dict->size() : 0);
+          if (o.dict) for (auto& kv : *o.dict) d.dict->emplace_back(kv.first, rewrite(kv.second));
+          return d;
+        }
+        default:
+          return o;
+      }
+    }
+
+    void drain() {
+      while (!todo.empty()) {
+        auto item = std::move(todo.back());
+        todo.pop_back();
+        Indirect& ind = item.second;
+        Obj v = ind.value;
+        if (ind.is_stream && v.dict) {
+          v.dict = std::make_shared<Dict>(*v.dict);
+          v.erase("Length");      // pode ser indireto; o Writer grava o tamanho real
+        }
+        v = rewrite(v);
+        Node& n = m.nodes[item.first];     // rewrite() pode ter realocado 'nodes'
+        n.value = std::move(v);
+        if (ind.is_stream) {
+          n.is_stream = true;
+          n.data = doc.data() + ind.stream_off;
+          n.len = ind.stream_len;
+        }
+      }
+    }
+  };
+
+  // keep_catalog (entrada única): também coleta o catálogo (Outlines, Names, AcroForm,
+  // Metadata...) e /Info e /ID do trailer, que a concatenação descarta
+  bool collect(Document& doc, bool keep_catalog) {
+    std::vector<PageInfo> pages;
+    if (!doc.pages(pages)) return false;
+    Collector c{*this, doc, {}, {}};
+    const Obj* root_ref = doc.trailer().get("Root");
+    if (keep_catalog && root_ref && root_ref->is_ref()) c.local[root_ref->ref_num()] = kRootNode;
+    size_t first = nodes.size();
+    for (auto& pg : pages) {
+      uint32_t id = (uint32_t)nodes.size();
+      nodes.emplace_back();
+      nodes.back().pinned = true;
+      c.local[pg.num] = id;
+      kids.push_back(id);
+    }
+    for (size_t k = 0; k < pages.size(); ++k) {
+      const PageInfo& pg = pages[k];
+      Obj d = pg.dict.is_dict() ? pg.dict : Obj::make_dict();
+      if (d.dict) d.dict = std::make_shared<Dict>(*d.dict);
+      auto flatten = [&](const char* key, const Obj& inherited) {
+        if (!d.get(key) && !inherited.is_null()) d.set(key, inherited);
+      };
+      flatten("Resources", pg.resources);
+      flatten("MediaBox", pg.media_box);
+      flatten("CropBox", pg.crop_box);
+      flatten("Rotate", pg.rotate);
+      d.erase("Parent");
+      Obj v = c.rewrite(d);
+      nodes[first + k].value = std::move(v);
+      c.drain();
+    }
+    if (keep_catalog) {
+      Obj root = doc.root();
+      if (root.is_dict()) {
+        root.dict = std::make_shared<Dict>(*root.dict);
+        root.erase("Pages");
+        catalog = c.rewrite(root);
+      }
+      trailer = Obj::make_dict();
+      if (const Obj* info = doc.trailer().get("Info")) {
+        Obj v = c.rewrite(*info);
+        if (v.is_ref() && v.ref_num() < kRootNode) trailer.set("Info", v);
+      }
+      if (const Obj* id = doc.trailer().get("ID")) trailer.set("ID", *id);
+      c.drain();
+    }
+    return true;
+  }
+};
+
+}  // namespace
+
+// Hash de 64 bits para os bytes crus dos streams (8 bytes por passo).
+uint64_t gsx_hash_bytes(const uint8_t* p, size_t n, uint64_t seed) {
+  const uint64_t m = 0x9E3779B97F4A7C15ull;
+  uint64_t h = (0xCBF29CE484222325ull ^ seed) ^ (n * m);
+  size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    uint64_t w;
+    memcpy(&w, p + i, 8);
+    h = (h ^ (w * m)) * 0xFF51AFD7ED558CCDull;
+    h ^= h >> 32;
+  }
+  uint64_t t = 0;
+  for (size_t k = 0; i < n; ++i, ++k) t |= (uint64_t)p[i] << (8 * k);
+  h = (h ^ (t * m)) * 0xC4CEB9FE1A85EC53ull;
+  return h ^ (h >> 29);
+}
+
+namespace {
+
+// Chave canônica do conteúdo com cada Ref trocada pela classe do alvo.
+static void class_key(const Obj& o, const std::vector<uint32_t>& cls, std::string& out) {
+  switch (o.type) {
+    case Type::Ref: {
+      uint32_t t = (uint32_t)o.i;
+      uint32_t c = t >= kRootNode ? t : cls[t];
+      out.push_back('@');
+      out.append((const char*)&c, sizeof(c));
+      return;
+    }
+    case Type::Array:
+      out.push_back('[');
+      if (o.arr) for (auto& v : *o.arr) class_key(v, cls, out);
+      out.push_back(']');
+      return;
+    case Type::Dict: {
+      // ordem das chaves não importa: ordena por nome
+      out.push_back('<');
+      if (o.dict) {
+        std::vector<const std::pair<std::string, Obj>*> kv;
+        kv.reserve(o.dict->size());
+        for (auto& e : *o.dict) kv.push_back(&e);
+        std::sort(kv.begin(), kv.end(), [](auto* a, auto* b){ return a->first < b->first; });
+        for (auto* e : kv) { serialize(Obj::make_name(e->first), out); class_key(e->second, cls, out); }
+      }
+      out.push_back('>');
+      return;
+    }
+    default:
+      serialize(o, out);
+      out.push_back(' ');
+  }
+}
+
+// Refina as classes até o ponto fixo; devolve o representante (menor índice) de cada nó.
+static std::vector<uint32_t> dedup_classes(std::vector<Node>& nodes) {
+  const size_t n = nodes.size();
+  for (auto& nd : nodes)
+    if (nd.is_stream) nd.data_hash = gsx_hash_bytes(nd.data, nd.len, 0);
+
+  std::vector<uint32_t> cls(n, 0);
+  size_t count = 1;
+  std::string key;
+  // cada passada só divide classes (a chave inclui a classe atual), então o número de
+  // classes cresce até estabilizar; cadeias longas precisam de tantas passadas quanto o
+  // comprimento até a diferença, por isso não há limite fixo
+  for (;;) {
+    std::unordered_map<std::string, uint32_t> intern;
+    intern.reserve(n);
+    std::vector<uint32_t> next(n);
+    for (size_t i = 0; i < n; ++i) {
+      key.clear();
+      key.append((const char*)&cls[i], sizeof(uint32_t));
+      if (nodes[i].pinned) {
+        key.push_back('P');
+        key.append((const char*)&i, sizeof(i));
+      } else if (nodes[i].is_stream) {
+        key.push_back('S');
+        key.append((const char*)&nodes[i].data_hash, sizeof(uint64_t));
+        key.append((const char*)&nodes[i].len, sizeof(size_t));
+      }
+      class_key(nodes[i].value, cls, key);
+      auto ins = intern.emplace(key, (uint32_t)intern.size());
+      next[i] = ins.first->second;
+    }
+    cls.swap(next);
+    if (intern.size() == count) break;
+    count = intern.size();
+  }
+
+  std::vector<uint32_t> rep_of_class(count + 1, UINT32_MAX);
+  std::vector<uint32_t> rep(n);
+  for (size_t i = 0; i < n; ++i) {
+    uint32_t& r = rep_of_class[cls[i]];
+    if (r == UINT32_MAX) r = (uint32_t)i;
+    rep[i] = r;
+    // hash igual não basta: confirma os bytes antes de descartar um stream
+    if (rep[i] != i && nodes[i].is_stream &&
+        (nodes[r].len != nodes[i].len || memcmp(nodes[r].data, nodes[i].data, nodes[i].len) != 0))
+      rep[i] = (uint32_t)i;
+  }
+  return rep;
+}
+
+static Obj final_refs(const Obj& o, const std::vector<uint32_t>& out_num, uint32_t pages_num,
+                      uint32_t catalog_num) {
+  switch (o.type) {
+    case Type::Ref: {
+      uint32_t t = (uint32_t)o.i;
+      if (t == kNullNode) return Obj();
+      if (t == kRootNode) return Obj::make_ref(catalog_num);
+      return Obj::make_ref(t == kPagesNode ? pages_num : out_num[t]);
+    }
+    case Type::Array: {
+      Obj a = Obj::make_array();
+      a.arr->reserve(o.arr ? o.arr->size() : 0);
+      if (o.arr) for (auto& v : *o.arr) a.arr->push_back(final_refs(v, out_num, pages_num, catalog_num));
+      return a;
+    }
+    case Type::Dict: {
+      Obj d = Obj::make_dict();
+      d.dict->reserve(o.dict ? o.dict->size() : 0);
+      if (o.dict) for (auto& kv : *o.dict) d.dict->emplace_back(kv.first, final_refs(kv.second, out_num, pages_num, catalog_num));
+      return d;
+    }
+    default:
+      return o;
+  }
+}
+
+}  // namespace
+
+GSX_API int gsx_merge_pdfs(const char* const* in_paths, int count, const char* out_path,
+                           int flags, gsx_merge_stats_t* stats_out)
+{
+  return gsx_merge_timed(in_paths, count, out_path, flags, stats_out, nullptr);
+}
+
+int gsx_merge_timed(const char* const* in_paths, int count, const char* out_path, int flags,
+                    gsx_merge_stats_t* stats_out, GsxMergeTimes* times)
+{
+  using Clock = std::chrono::steady_clock;
+  auto us_since = [](Clock::time_point t) {
+    return (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - t).count();
+  };
+  Clock::time_point t0 = Clock::now();
+  GsxJobScope scope("gsx_merge_pdfs", nullptr, out_path);
+  GSX_PROBE2(merge_begin, count, flags);
+  struct ProbeEnd {
+    ~ProbeEnd() { GSX_PROBE1(merge_end, gsx_last_rc()); }
+  } probe_end;
+  GsxSpan sp_collect("merge.collect", "parts", count);
+  if (stats_out) memset(stats_out, 0, sizeof(*stats_out));
+  if (!in_paths || count <= 0 || !out_path) {
+    set_last_error_json(GSX_E_ARGS, "merge", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+
+  // 1) abre tudo antes de escrever: a versão do cabeçalho é a maior das entradas
+  std::vector<std::unique_ptr<Document>> docs;
+  int version = 14;
+  for (int i = 0; i < count; ++i) {
+    std::unique_ptr<Document> d(new Document());
+    std::error_code ec;
+    if (in_paths[i] && fs::equivalent(in_paths[i], out_path, ec)) {
+      // a saída truncaria um arquivo ainda mapeado
+      set_last_error_json(GSX_E_ARGS, "merge.same_path", 0, 0, nullptr);
+      return GSX_E_ARGS;
+    }
+    if (!in_paths[i] || !d->open(in_paths[i])) {
+      int rc = (!in_paths[i] || d->os_errno()) ? GSX_E_INPUT_NOT_FOUND : GSX_E_PDF_PARSE;
+      set_last_error_json(rc, "merge.open", d->os_errno(), 0, nullptr);
+      return rc;
+    }
+    if (d->encrypted()) {
+      set_last_error_json(GSX_E_PDF_ENCRYPTED, "merge.open", 0, 0, nullptr);
+      return GSX_E_PDF_ENCRYPTED;
+    }
+    version = std::max(version, d->version());
+    docs.push_back(std::move(d));
+  }
+
+  // 2) coleta: páginas + objetos alcançáveis (streams ficam no mmap)
+  Merge m;
+  for (auto& d : docs) {
+    if (!m.collect(*d, count == 1)) {
+      set_last_error_json(GSX_E_PDF_PARSE, "merge.pages", 0, 0, nullptr);
+      return GSX_E_PDF_PARSE;
+    }
+  }
+
+  if (times) times->collect_us = us_since(t0);
+  t0 = Clock::now();
+  sp_collect.end();
+  GsxSpan sp_dedup("merge.dedup", "objects", (int64_t)m.nodes.size());
+
+  // 3) deduplicação opcional
+  const size_t n = m.nodes.size();
+  std::vector<uint32_t> rep(n);
+  if (flags & GSX_MERGE_DEDUP) rep = dedup_classes(m.nodes);
+  else for (size_t i = 0; i < n; ++i) rep[i] = (uint32_t)i;
+
+  if (times) times->dedup_us = us_since(t0);
+  t0 = Clock::now();
+  sp_dedup.end();
+  GsxSpan sp_write((flags & GSX_MERGE_LINEARIZE) ? "merge.linearize" : "merge.write");
+
+  // 4) numeração final (só representantes) e escrita
+  uint32_t count_out = 0;
+  const uint32_t catalog_num = ++count_out;
+  const uint32_t pages_num = ++count_out;
+  std::vector<uint32_t> out_num(n, 0);
+  size_t objects_out = 0;
+  uint64_t saved = 0;
+  for (size_t i = 0; i < n; ++i) {
+    if (rep[i] == i) { out_num[i] = ++count_out; ++objects_out; }
+    else if (m.nodes[i].is_stream) saved += m.nodes[i].len;
+  }
+  for (size_t i = 0; i < n; ++i) out_num[i] = out_num[rep[i]];
+
+  Obj kids = Obj::make_array();
+  for (uint32_t k : m.kids) kids.arr->push_back(Obj::make_ref(out_num[k]));
+  Obj pages_dict = Obj::make_dict();
+  pages_dict.set("Type", Obj::make_name("Pages"));
+  pages_dict.set("Kids", kids);
+  pages_dict.set("Count", Obj::make_int((int64_t)m.kids.size()));
+  Obj catalog = m.catalog.is_dict() ? final_refs(m.catalog, out_num, pages_num, catalog_num) : Obj::make_dict();
+  catalog.set("Type", Obj::make_name("Catalog"));
+  catalog.set("Pages", Obj::make_ref(pages_num));
+  Obj trailer = m.trailer.is_dict() ? final_refs(m.trailer, out_num, pages_num, catalog_num) : Obj::make_dict();
+  trailer.set("Root", Obj::make_ref(catalog_num));
+
+  bool ok = true;
+  int err = 0;
+  uint64_t bytes_out = 0;
+  if (flags & GSX_MERGE_LINEARIZE) {
+    // mesmo grafo entregue ao linearizador: mescla e linearização numa escrita só
+    std::vector<LinObject> objs(count_out + 1);
+    for (size_t i = 0; i < n; ++i) {
+      if (rep[i] != i) continue;
+      const Node& nd = m.nodes[i];
+      LinObject& o = objs[out_num[i]];
+      o.value = final_refs(nd.value, out_num, pages_num, catalog_num);
+      if (nd.pinned) o.value.set("Parent", Obj::make_ref(pages_num));
+      o.is_stream = nd.is_stream;
+      o.data = nd.data;
+      o.len = nd.len;
+    }
+    objs[pages_num].value = pages_dict;
+    objs[catalog_num].value = catalog;
+    std::vector<uint32_t> pages;
+    pages.reserve(m.kids.size());
+    for (uint32_t k : m.kids) pages.push_back(out_num[k]);
+    LinStats ls;
+    ok = write_linearized(out_path, version, objs, catalog_num, pages, trailer, &ls, &err);
+    bytes_out = ls.bytes_out;
+  } else {
+    Writer w;
+    if (!w.open(out_path, version)) {
+      set_last_error_json(GSX_E_WRITE_OPEN, "merge.out", w.os_errno(), 0, nullptr);
+      return GSX_E_WRITE_OPEN;
+    }
+    for (uint32_t k = 0; k < count_out; ++k) w.reserve();
+    for (size_t i = 0; i < n && ok; ++i) {
+      if (rep[i] != i) continue;
+      const Node& nd = m.nodes[i];
+      Obj v = final_refs(nd.value, out_num, pages_num, catalog_num);
+      if (nd.pinned) v.set("Parent", Obj::make_ref(pages_num));
+      ok = nd.is_stream ? w.write_stream(out_num[i], v, nd.data, nd.len) : w.write_object(out_num[i], v);
+    }
+    ok = ok && w.write_object(pages_num, pages_dict) && w.write_object(catalog_num, catalog) && w.finish(trailer);
+    err = w.os_errno();
+    bytes_out = w.bytes_written();
+    if (!ok) w.close();
+  }
+  if (!ok) {
+    std::error_code ec;
+    fs::remove(out_path, ec);
+    set_last_error_json(GSX_E_WRITE_IO, "merge.write", err, 0, nullptr);
+    return GSX_E_WRITE_IO;
+  }
+  if (times) times->write_us = us_since(t0);
+
+  if (stats_out) {
+    stats_out->pages = (int)m.kids.size();
+    stats_out->objects_in = (int)n;
+    stats_out->objects_out = (int)objects_out;
+    stats_out->stream_bytes_saved = saved;
+    stats_out->bytes_out = bytes_out;
+  }
+  std::string msg = "merge_pdfs: " + std::to_string(count) + " entradas, " +
+                    std::to_string(m.kids.size()) + " páginas, objetos " + std::to_string(n) +
+                    " -> " + std::to_string(objects_out) + ", streams duplicados " +
+                    std::to_string(saved) + " bytes, saída " + std::to_string(bytes_out) + " bytes" +
+                    ((flags & GSX_MERGE_LINEARIZE) ? " (linearizada)" : "");
+  gsx_log_msg(GSX_LOG_DEBUG, msg.c_str());
+  uint64_t bytes_in = 0;
+  for (const auto& d : docs) bytes_in += d->size();
+  scope.bytes(bytes_in, bytes_out);
+  set_last_error_json(GSX_OK, "merge", 0, 0, nullptr);
+  return (int)m.kids.size();
+}
+
+GSX_API int gsx_dedup_pdf(const char* in_path, const char* out_path, gsx_merge_stats_t* stats_out)
+{
+  GsxJobScope scope("gsx_dedup_pdf", in_path, out_path);
+  if (!in_path || !out_path) {
+    if (stats_out) memset(stats_out, 0, sizeof(*stats_out));
+    set_last_error_json(GSX_E_ARGS, "dedup", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  const char* in[1] = { in_path };
+  return gsx_merge_pdfs(in, 1, out_path, GSX_MERGE_DEDUP, stats_out);
+}
+
+// Grafos sintéticos com resposta conhecida para dedup_classes: cadeias mais longas que
+// qualquer limite de passadas que diferem só na cauda, cadeias idênticas e ciclos.
+GSX_API int gsx_merge_selftest(char** json_out)
+{
+  if (json_out) *json_out = nullptr;
+  int cases = 0, failures = 0;
+  std::string fails;
+  auto fail = [&](const std::string& what) {
+    ++failures;
+    if (!fails.empty()) fails += ",";
+    fails += "\"" + gsx_json_escape(what) + "\"";
+  };
+  // duas cadeias a[0]→…→a[len-1] e b[0]→…→b[len-1]; a cauda guarda tail_a / tail_b
+  auto chains = [](std::vector<Node>& nodes, int len, int64_t tail_a, int64_t tail_b, bool cycle) {
+    nodes.assign((size_t)len * 2, Node());
+    for (int c = 0; c < 2; ++c) {
+      const uint32_t base = (uint32_t)(c * len);
+      for (int i = 0; i < len; ++i) {
+        Obj d = Obj::make_dict();
+        d.set("I", Obj::make_int(i));          // elos distintos: ciclos não colapsam em um nó
+        if (i + 1 < len) d.set("Next", Obj::make_ref(base + (uint32_t)i + 1));
+        else if (cycle) d.set("Next", Obj::make_ref(base));
+        else d.set("Tail", Obj::make_int(c == 0 ? tail_a : tail_b));
+        nodes[base + (uint32_t)i].value = d;
+      }
+    }
+  };
+  for (int len : {1, 2, 63, 64, 65, 200, 1000}) {
+    std::vector<Node> nodes;
+    chains(nodes, len, 1, 2, false);
+    std::vector<uint32_t> rep = dedup_classes(nodes);
+    int merged = 0;
+    for (size_t i = 0; i < rep.size(); ++i) merged += rep[i] != i;
+    ++cases;
+    if (merged != 0)
+      fail("cauda diferente len=" + std::to_string(len) + ": " + std::to_string(merged) + " fundidos");
+
+    for (int cycle = 0; cycle < 2; ++cycle) {
+      chains(nodes, len, 7, 7, cycle != 0);
+      rep = dedup_classes(nodes);
+      bool ok = true;
+      for (int i = 0; i < len; ++i) ok = ok && rep[(size_t)i] == (uint32_t)i && rep[(size_t)(len + i)] == (uint32_t)i;
+      ++cases;
+      if (!ok) fail(std::string(cycle ? "ciclos" : "cadeias") + " idênticos len=" + std::to_string(len));
+    }
+  }
+  if (json_out) {
+    std::string js = "{\"cases\":" + std::to_string(cases) + ",\"failures\":" + std::to_string(failures) +
+                     ",\"mismatches\":[" + fails + "]}";
+    *json_out = gsx_dup_string(js);
+  }
+  set_last_error_json(GSX_OK, "merge_selftest", 0, 0, nullptr);
+  return failures;
+}
@@ -0,0 +1,233 @@
+// gsx_metrics.cpp — contadores das chamadas de topo e snapshot Prometheus (gsx_metrics_*)
+//
+// Tudo é atômico e relaxado: cada chamada de topo atualiza meia dúzia de contadores no
+// fim (resultado, histograma de latência, bytes) e os pontos quentes só somam em
+// contadores globais. A única trava protege a tabela de códigos de erro, tocada apenas
+// quando uma chamada falha. As estatísticas de cada função ficam em slots fixos, presos
+// pelo nome na primeira chamada (kSlots cobre com folga as funções públicas).
+
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Limites do histograma em segundos (o último bucket, +Inf, é o count)
+constexpr double kBounds[] = {0.05, 0.1, 0.25, 0.5, 1, 2.5, 5, 10, 30, 60, 120, 300};
+constexpr int kBuckets = (int)(sizeof(kBounds) / sizeof(kBounds[0]));
+constexpr int kSlots = 32;
+
+struct CallStats {
+  std::atomic<const char*> name{nullptr};
+  std::atomic<uint64_t> ok{0}, canceled{0}, error{0};
+  std::atomic<uint64_t> bucket[kBuckets + 1] = {};   // não cumulativos; o último é > kBounds[-1]
+  std::atomic<uint64_t> sum_us{0};
+  std::atomic<uint64_t> bytes_in{0}, bytes_out{0};
+};
+
+struct Metrics {
+  CallStats calls[kSlots];
+  std::atomic<uint64_t> counters[GSX_C_COUNT] = {};
+  std::atomic<int64_t> gauges[GSX_G_COUNT] = {};
+  std::mutex err_m;
+  std::map<std::pair<std::string, int>, uint64_t> errors;   // (função, rc) → chamadas
+};
+
+// Nunca destruído: chamadas podem terminar depois dos destrutores estáticos
+static Metrics& met() {
+  static Metrics* m = new Metrics;
+  return *m;
+}
+
+// Dentro de uma chamada de topo (ou de uma thread que adotou o job dela)
+static thread_local bool t_in_job = false;
+
+static CallStats* slot(const char* name) {
+  Metrics& m = met();
+  for (CallStats& c : m.calls) {
+    const char* cur = c.name.load(std::memory_order_acquire);
+    if (!cur) {
+      if (c.name.compare_exchange_strong(cur, name, std::memory_order_acq_rel)) return &c;
+      // outra thread pegou o slot: 'cur' agora tem o nome dela
+    }
+    if (cur == name || std::strcmp(cur, name) == 0) return &c;
+  }
+  return nullptr;   // sem slot: a chamada não é contada
+}
+
+static uint64_t path_size(const char* path) {
+  if (!path || !*path) return 0;
+  std::error_code ec;
+  const uintmax_t n = fs::file_size(path, ec);
+  return ec ? 0 : (uint64_t)n;
+}
+
+static void line(std::string& out, const char* fmt, ...) {
+  char buf[512];
+  va_list ap;
+  va_start(ap, fmt);
+  int n = vsnprintf(buf, sizeof buf, fmt, ap);
+  va_end(ap);
+  if (n > 0) out.append(buf, std::min((size_t)n, sizeof buf - 1));
+}
+
+static void header(std::string& out, const char* name, const char* type, const char* help) {
+  line(out, "# HELP %s %s\n# TYPE %s %s\n", name, help, name, type);
+}
+
+}  // namespace
+
+GsxJobScope::GsxJobScope(const char* name, const char* in_path, const char* out_path)
+    : name_(name), out_path_(out_path) {
+  if (t_in_job) return;
+  top_ = true;
+  t_in_job = true;
+  trace_job_ = gsx_trace_job_open(name);
+  if (trace_job_) t0_ns_ = gsx_trace_clock_ns();
+  in_bytes_ = path_size(in_path);
+  gsx_gauge_add(GSX_G_JOBS_ACTIVE, 1);
+  t0_ = std::chrono::steady_clock::now();
+}
+
+GsxJobScope::~GsxJobScope() {
+  if (!top_) return;
+  const uint64_t us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                          std::chrono::steady_clock::now() - t0_).count();
+  const int rc = gsx_last_rc();
+  const uint64_t out_bytes = rc < 0 ? 0 : out_path_ ? path_size(out_path_) : out_bytes_;
+  if (CallStats* c = slot(name_)) {
+    if (rc >= 0) {
+      c->ok.fetch_add(1, std::memory_order_relaxed);
+      c->bytes_in.fetch_add(in_bytes_, std::memory_order_relaxed);
+      c->bytes_out.fetch_add(out_bytes, std::memory_order_relaxed);
+    } else if (rc == GSX_E_CANCELED) {
+      c->canceled.fetch_add(1, std::memory_order_relaxed);
+    } else {
+      c->error.fetch_add(1, std::memory_order_relaxed);
+      Metrics& m = met();
+      std::lock_guard<std::mutex> lk(m.err_m);
+      ++m.errors[std::make_pair(std::string(name_), rc)];
+    }
+    int b = 0;
+    while (b < kBuckets && us > (uint64_t)(kBounds[b] * 1e6)) ++b;
+    c->bucket[b].fetch_add(1, std::memory_order_relaxed);
+    c->sum_us.fetch_add(us, std::memory_order_relaxed);
+  }
+  gsx_gauge_add(GSX_G_JOBS_ACTIVE, -1);
+  if (!capture_.empty()) gsx_capture_write(capture_, t0_, rc, (double)us / 1000.0, out_bytes);
+  gsx_trace_job_close(trace_job_, name_, t0_ns_);
+  t_in_job = false;
+}
+
+GsxJobToken gsx_job_token() {
+  GsxJobToken t;
+  t.trace = gsx_trace_job();
+  t.active = t_in_job;
+  return t;
+}
+
+GsxJobAdopt::GsxJobAdopt(GsxJobToken t) {
+  prev_ = gsx_job_token();
+  gsx_trace_set_job(t.trace);
+  t_in_job = t.active;
+}
+
+GsxJobAdopt::~GsxJobAdopt() {
+  gsx_trace_set_job(prev_.trace);
+  t_in_job = prev_.active;
+}
+
+void gsx_metric_add(GsxCounter c, uint64_t n) {
+  met().counters[c].fetch_add(n, std::memory_order_relaxed);
+}
+
+void gsx_gauge_add(GsxGauge g, int64_t d) {
+  met().gauges[g].fetch_add(d, std::memory_order_relaxed);
+}
+
+GSX_API char* gsx_metrics_snapshot(void) {
+  Metrics& m = met();
+  std::string out;
+  out.reserve(16 * 1024);
+
+  // fotografa os slots em uso uma vez: as seções abaixo repetem a ordem
+  std::vector<CallStats*> calls;
+  for (CallStats& c : m.calls)
+    if (c.name.load(std::memory_order_acquire)) calls.push_back(&c);
+  auto load = [](const std::atomic<uint64_t>& v) { return (unsigned long long)v.load(std::memory_order_relaxed); };
+
+  header(out, "gsx_jobs_total", "counter", "Chamadas de topo concluídas, por resultado.");
+  for (CallStats* c : calls) {
+    const char* n = c->name.load(std::memory_order_relaxed);
+    line(out, "gsx_jobs_total{call=\"%s\",outcome=\"ok\"} %llu\n", n, load(c->ok));
+    line(out, "gsx_jobs_total{call=\"%s\",outcome=\"canceled\"} %llu\n", n, load(c->canceled));
+    line(out, "gsx_jobs_total{call=\"%s\",outcome=\"error\"} %llu\n", n, load(c->error));
+  }
+
+  header(out, "gsx_job_errors_total", "counter", "Chamadas de topo com erro, por código (gsx_err_t).");
+  {
+    std::lock_guard<std::mutex> lk(m.err_m);
+    for (const auto& e : m.errors)
+      line(out, "gsx_job_errors_total{call=\"%s\",code=\"%d\"} %llu\n", e.first.first.c_str(), e.first.second,
+           (unsigned long long)e.second);
+  }
+
+  header(out, "gsx_job_duration_seconds", "histogram", "Latência das chamadas de topo.");
+  for (CallStats* c : calls) {
+    const char* n = c->name.load(std::memory_order_relaxed);
+    unsigned long long acc = 0;
+    for (int b = 0; b < kBuckets; ++b) {
+      acc += load(c->bucket[b]);
+      line(out, "gsx_job_duration_seconds_bucket{call=\"%s\",le=\"%g\"} %llu\n", n, kBounds[b], acc);
+    }
+    acc += load(c->bucket[kBuckets]);
+    line(out, "gsx_job_duration_seconds_bucket{call=\"%s\",le=\"+Inf\"} %llu\n", n, acc);
+    line(out, "gsx_job_duration_seconds_sum{call=\"%s\"} %.6f\n", n, load(c->sum_us) / 1e6);
+    line(out, "gsx_job_duration_seconds_count{call=\"%s\"} %llu\n", n, acc);
+  }
+
+  header(out, "gsx_bytes_in_total", "counter", "Bytes de entrada das chamadas concluídas com sucesso.");
+  for (CallStats* c : calls)
+    line(out, "gsx_bytes_in_total{call=\"%s\"} %llu\n", c->name.load(std::memory_order_relaxed), load(c->bytes_in));
+  header(out, "gsx_bytes_out_total", "counter", "Bytes gravados pelas chamadas concluídas com sucesso.");
+  for (CallStats* c : calls)
+    line(out, "gsx_bytes_out_total{call=\"%s\"} %llu\n", c->name.load(std::memory_order_relaxed), load(c->bytes_out));
+
+  const auto& k = m.counters;
+  header(out, "gsx_pages_total", "counter", "Páginas interpretadas pelo Ghostscript (lotes repetidos contam de novo).");
+  line(out, "gsx_pages_total %llu\n", load(k[GSX_C_GS_PAGES]));
+  header(out, "gsx_gs_instances_total", "counter", "Instâncias do Ghostscript criadas.");
+  line(out, "gsx_gs_instances_total %llu\n", load(k[GSX_C_GS_INSTANCES]));
+  header(out, "gsx_batch_timeouts_total", "counter",
+         "Lotes da compressão paralela que passaram do tempo esperado e ganharam uma cópia.");
+  line(out, "gsx_batch_timeouts_total %llu\n", load(k[GSX_C_BATCH_TIMEOUTS]));
+  header(out, "gsx_cache_hits_total", "counter", "Acertos do cache de miniaturas.");
+  line(out, "gsx_cache_hits_total{cache=\"thumbs_mem\"} %llu\n", load(k[GSX_C_THUMB_HIT_MEM]));
+  line(out, "gsx_cache_hits_total{cache=\"thumbs_disk\"} %llu\n", load(k[GSX_C_THUMB_HIT_DISK]));
+  header(out, "gsx_cache_misses_total", "counter", "Miniaturas renderizadas (fora do cache).");
+  line(out, "gsx_cache_misses_total{cache=\"thumbs\"} %llu\n", load(k[GSX_C_THUMB_MISS]));
+  header(out, "gsx_normalized_total", "counter", "Entradas com xref danificada reparadas antes de processar.");
+  line(out, "gsx_normalized_total %llu\n", load(k[GSX_C_NORMALIZED]));
+
+  const auto& g = m.gauges;
+  auto gauge = [&](GsxGauge i) { return (long long)g[i].load(std::memory_order_relaxed); };
+  header(out, "gsx_jobs_active", "gauge", "Chamadas de topo em andamento.");
+  line(out, "gsx_jobs_active %lld\n", gauge(GSX_G_JOBS_ACTIVE));
+  header(out, "gsx_gs_instances_active", "gauge", "Instâncias do Ghostscript rodando.");
+  line(out, "gsx_gs_instances_active %lld\n", gauge(GSX_G_GS_ACTIVE));
+  header(out, "gsx_queue_depth", "gauge", "Lotes aguardando worker na compressão paralela.");
+  line(out, "gsx_queue_depth %lld\n", gauge(GSX_G_QUEUE_DEPTH));
+  return gsx_dup_string(out);
+}
@@ -0,0 +1,538 @@
+// gsx_mrc.cpp — modo MRC (mixed raster content) para digitalizações coloridas (gsx_mrc_pdf)
+//
+// Cada página é renderizada uma vez em RGB na resolução da máscara e separada em três
+// camadas, como no ITU-T T.44:
+//   - máscara: texto/traço em 1-bpp na resolução cheia (JBIG2 ou G4);
+//   - frente: cor do texto numa grade grossa (cores chapadas, Flate);
+//   - fundo: o resto da página reamostrado em baixa resolução (JPEG), com os pixels de
+//     texto substituídos pela média da vizinhança para não deixar halo nem gastar bytes.
+// A página vira "fundo; frente com /Mask = máscara": o texto sai nítido e o fundo pode
+// ser bem comprimido. Fundo branco não gera imagem; fundo sem cor vira JPEG em cinza.
+//
+// A segmentação usa o Sauvola do gsx_bilevel (limiar vetorizado) e descarta componentes
+// grandes demais para serem caracteres (fotos, fios, bordas), que ficam no fundo.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+namespace fs = std::filesystem;
+using namespace gsx_pdf;
+
+static const int   kDefaultDpi = 300;
+static const int   kDefaultQuality = 50;
+static const float kSauvolaK = 0.34f;
+static const int   kFgDpi = 36;          // resolução da camada de cor do texto
+static const int   kWhiteMin = 248;      // fundo com todos os canais acima disto = papel branco
+static const int   kGrayChroma = 12;     // fundo com max-min abaixo disto vira JPEG em cinza
+static const int   kMinContrast = 40;    // traço pelo menos isto mais escuro que o entorno (textura de foto não passa)
+
+// ======================= Segmentação =======================
+namespace {
+
+struct Rgb { uint8_t r, g, b; };
+
+// Preenche as células sem amostra com a vizinha mais próxima na linha e, nas linhas
+// vazias, com a linha preenchida mais próxima. Mantém as camadas chapadas (comprimem
+// melhor) e sem buracos pretos onde não havia amostra.
+static void fill_holes(std::vector<Rgb>& px, std::vector<uint8_t>& have, int w, int h, Rgb dflt) {
+  std::vector<uint8_t> row_ok((size_t)h, 0);
+  for (int y = 0; y < h; ++y) {
+    Rgb* r = px.data() + (size_t)y * (size_t)w;
+    uint8_t* hv = have.data() + (size_t)y * (size_t)w;
+    int last = -1;
+    for (int x = 0; x < w; ++x) {
+      if (!hv[x]) continue;
+      for (int k = last + 1; k < x; ++k) r[k] = (last < 0 || x - k < k - last) ? r[x] : r[last];
+      last = x;
+    }
+    if (last < 0) continue;
+    for (int k = last + 1; k < w; ++k) r[k] = r[last];
+    row_ok[(size_t)y] = 1;
+  }
+  int prev = -1;
+  for (int y = 0; y < h; ++y) {
+    if (!row_ok[(size_t)y]) continue;
+    for (int k = prev + 1; k < y; ++k) {
+      const int src = (prev < 0 || y - k < k - prev) ? y : prev;
+      memcpy(px.data() + (size_t)k * w, px.data() + (size_t)src * w, (size_t)w * sizeof(Rgb));
+    }
+    prev = y;
+  }
+  if (prev < 0) { std::fill(px.begin(), px.end(), dflt); return; }
+  for (int k = prev + 1; k < h; ++k)
+    memcpy(px.data() + (size_t)k * w, px.data() + (size_t)prev * w, (size_t)w * sizeof(Rgb));
+}
+
+// Dilatação 3×3 da máscara: os pixels de borda do texto (anti-aliasing) também ficam
+// fora da média do fundo. Só ORs de linhas inteiras, vetorizável pelo compilador.
+static void dilate3(const uint8_t* m, int w, int h, uint8_t* out) {
+  std::vector<uint8_t> v((size_t)w);
+  for (int y = 0; y < h; ++y) {
+    const uint8_t* a = m + (size_t)std::max(0, y - 1) * w;
+    const uint8_t* b = m + (size_t)y * w;
+    const uint8_t* c = m + (size_t)std::min(h - 1, y + 1) * w;
+    for (int x = 0; x < w; ++x) v[x] = a[x] | b[x] | c[x];
+    uint8_t* o = out + (size_t)y * w;
+    o[0] = v[0] | (w > 1 ? v[1] : 0);
+    for (int x = 1; x + 1 < w; ++x) o[x] = v[x - 1] | v[x] | v[x + 1];
+    if (w > 1) o[w - 1] = v[w - 2] | v[w - 1];
+  }
+}
+
+struct Layers {
+  int w = 0, h = 0;                      // raster / máscara
+  std::vector<uint8_t> mask;             // 1 = texto
+  size_t text_px = 0;
+  int fw = 0, fh = 0;                    // frente
+  std::vector<Rgb> fg;
+  int bw = 0, bh = 0;                    // fundo
+  std::vector<Rgb> bg;
+  bool bg_white = true, bg_gray = true;
+};
+
+// Componentes 8-conexos da máscara: mantém os que têm tamanho de caractere e contraste
+// de tinta contra o entorno (a textura de uma foto também passa no Sauvola, mas com
+// pouco contraste), calcula a cor de cada um (média dos pixels mais escuros que a média
+// do componente, para o anti-aliasing não clarear o traço) e acumula essa cor nas
+// células da frente.
+static void keep_glyphs(Layers& L, const uint8_t* rgb, const uint8_t* gray, int dpi, int min_px) {
+  const int w = L.w, h = L.h;
+  const int max_dim = dpi;               // ~72 pt: títulos grandes ainda entram
+  const int cell = std::max(2, dpi / kFgDpi);
+  L.fw = (w + cell - 1) / cell;
+  L.fh = (h + cell - 1) / cell;
+  std::vector<uint32_t> sum((size_t)L.fw * L.fh * 4, 0);   // r, g, b, n
+
+  std::vector<uint8_t>& m = L.mask;
+  std::vector<uint8_t> seen((size_t)w * h, 0);
+  std::vector<uint32_t> q;
+  for (int y0 = 0; y0 < h; ++y0) {
+    for (int x0 = 0; x0 < w; ++x0) {
+      const size_t p0 = (size_t)y0 * w + x0;
+      if (!m[p0] || seen[p0]) continue;
+      q.clear();
+      q.push_back((uint32_t)p0);
+      seen[p0] = 1;
+      int minx = x0, maxx = x0, miny = y0, maxy = y0;
+      uint64_t gsum = 0;
+      for (size_t qi = 0; qi < q.size(); ++qi) {
+        const int cy = (int)(q[qi] / (uint32_t)w), cx = (int)(q[qi] % (uint32_t)w);
+        gsum += gray[q[qi]];
+        minx = std::min(minx, cx); maxx = std::max(maxx, cx);
+        miny = std::min(miny, cy); maxy = std::max(maxy, cy);
+        for (int dy = -1; dy <= 1; ++dy) {
+          const int ny = cy + dy;
+          if (ny < 0 || ny >= h) continue;
+          for (int dx = -1; dx <= 1; ++dx) {
+            const int nx = cx + dx;
+            if (nx < 0 || nx >= w) continue;
+            const size_t pn = (size_t)ny * w + nx;
+            if (m[pn] && !seen[pn]) { seen[pn] = 1; q.push_back((uint32_t)pn); }
+          }
+        }
+      }
+      bool glyph = (int)q.size() >= min_px && maxx - minx < max_dim && maxy - miny < max_dim;
+      const uint32_t gmean = (uint32_t)(gsum / q.size());
+      uint64_t cr = 0, cg = 0, cb = 0, core = 0, n = 0;
+      if (glyph) {
+        for (uint32_t p : q) {
+          if (gray[p] > gmean) continue;
+          cr += rgb[(size_t)p * 3]; cg += rgb[(size_t)p * 3 + 1]; cb += rgb[(size_t)p * 3 + 2];
+          core += gray[p];
+          ++n;
+        }
+        if (!n) n = 1;
+        // entorno: caixa do componente com 2 px de margem, sem os pixels da máscara
+        uint64_t ring = 0, rn = 0;
+        for (int y = std::max(0, miny - 2); y <= std::min(h - 1, maxy + 2); ++y) {
+          const uint8_t* g = gray + (size_t)y * w;
+          const uint8_t* mm = m.data() + (size_t)y * w;
+          for (int x = std::max(0, minx - 2); x <= std::min(w - 1, maxx + 2); ++x)
+            if (!mm[x]) { ring += g[x]; ++rn; }
+        }
+        glyph = rn && (int)(ring / rn) - (int)(core / n) >= kMinContrast;
+      }
+      if (!glyph) {
+        for (uint32_t p : q) m[p] = 0;
+        continue;
+      }
+      int r = (int)(cr / n), g = (int)(cg / n), b = (int)(cb / n);
+      // escuro e sem cor → preto de verdade (o scanner nunca entrega 0,0,0)
+      if (std::max(r, std::max(g, b)) - std::min(r, std::min(g, b)) < 32 && (r * 77 + g * 150 + b * 29) >> 8 < 96)
+        r = g = b = 0;
+      for (uint32_t p : q) {
+        const int cx = (int)(p % (uint32_t)w) / cell, cy = (int)(p / (uint32_t)w) / cell;
+        uint32_t* s = &sum[((size_t)cy * L.fw + cx) * 4];
+        s[0] += (uint32_t)r; s[1] += (uint32_t)g; s[2] += (uint32_t)b; ++s[3];
+      }
+      L.text_px += q.size();
+    }
+  }
+
+  L.fg.assign((size_t)L.fw * L.fh, Rgb{0, 0, 0});
+  std::vector<uint8_t> have((size_t)L.fw * L.fh, 0);
+  for (size_t i = 0; i < have.size(); ++i) {
+    const uint32_t* s = &sum[i * 4];
+    if (!s[3]) continue;
+    L.fg[i] = Rgb{(uint8_t)(s[0] / s[3]), (uint8_t)(s[1] / s[3]), (uint8_t)(s[2] / s[3])};
+    have[i] = 1;
+  }
+  fill_holes(L.fg, have, L.fw, L.fh, Rgb{0, 0, 0});
+}
+
+// Fundo: média dos pixels fora da máscara dilatada em blocos factor×factor.
+static void build_background(Layers& L, const uint8_t* rgb, int factor) {
+  const int w = L.w, h = L.h;
+  L.bw = (w + factor - 1) / factor;
+  L.bh = (h + factor - 1) / factor;
+  std::vector<uint8_t> dil((size_t)w * h);
+  dilate3(L.mask.data(), w, h, dil.data());
+
+  std::vector<uint32_t> acc((size_t)L.bw * 4);
+  std::vector<uint8_t> have((size_t)L.bw * L.bh, 0);
+  L.bg.assign((size_t)L.bw * L.bh, Rgb{255, 255, 255});
+  for (int by = 0; by < L.bh; ++by) {
+    std::fill(acc.begin(), acc.end(), 0);
+    for (int y = by * factor; y < std::min(h, (by + 1) * factor); ++y) {
+      const uint8_t* px = rgb + (size_t)y * w * 3;
+      const uint8_t* d = dil.data() + (size_t)y * w;
+      for (int x = 0; x < w; ++x) {
+        if (d[x]) continue;
+        uint32_t* a = &acc[(size_t)(x / factor) * 4];
+        a[0] += px[x * 3]; a[1] += px[x * 3 + 1]; a[2] += px[x * 3 + 2]; ++a[3];
+      }
+    }
+    for (int bx = 0; bx < L.bw; ++bx) {
+      const uint32_t* a = &acc[(size_t)bx * 4];
+      if (!a[3]) continue;
+      const size_t i = (size_t)by * L.bw + bx;
+      Rgb c{(uint8_t)(a[0] / a[3]), (uint8_t)(a[1] / a[3]), (uint8_t)(a[2] / a[3])};
+      L.bg[i] = c;
+      have[i] = 1;
+      const int mx = std::max(c.r, std::max(c.g, c.b)), mn = std::min(c.r, std::min(c.g, c.b));
+      if (mn < kWhiteMin) L.bg_white = false;
+      if (mx - mn > kGrayChroma) L.bg_gray = false;
+    }
+  }
+  fill_holes(L.bg, have, L.bw, L.bh, Rgb{255, 255, 255});
+}
+
+// ======================= JPEG / Flate =======================
+static bool encode_jpeg(const std::vector<Rgb>& px, int w, int h, bool gray, int quality, std::string& out) {
+  if (!gray) return gsx_jpeg_encode((const uint8_t*)px.data(), w, h, 3, quality, out);
+  std::vector<uint8_t> g(px.size());
+  gsx_rgb_to_gray((const uint8_t*)px.data(), g.data(), px.size());
+  return gsx_jpeg_encode(g.data(), w, h, 1, quality, out);
+}
+
+static bool encode_flate(const std::vector<Rgb>& px, std::string& out) {
+  uLongf n = compressBound((uLong)(px.size() * 3));
+  out.resize(n);
+  if (compress2((Bytef*)&out[0], &n, (const Bytef*)px.data(), (uLong)(px.size() * 3), 9) != Z_OK) return false;
+  out.resize(n);
+  return true;
+}
+
+// ======================= Pipeline =======================
+struct Job {
+  std::string in_path;
+  int first = 0, last = 0;
+  int dpi = kDefaultDpi;
+  int bg_dpi = 0;
+  int quality = kDefaultQuality;
+  int codec = GSX_BIN_JBIG2;
+
+  Writer* w = nullptr;
+  std::mutex w_m;
+  bool write_ok = true;
+  bool encode_ok = true;
+  uint32_t pages_num = 0;
+  std::vector<uint32_t> nums;            // 5 por página: página, conteúdo, fundo, frente, máscara
+
+  std::atomic<int> done{0};
+  std::atomic<uint64_t> mask_bytes{0}, fg_bytes{0}, bg_bytes{0};
+  gsx_progress_cb cb = nullptr;
+  void* user = nullptr;
+  std::mutex cb_m;
+};
+
+static std::string fmt_num(double v) {
+  char b[32];
+  snprintf(b, sizeof(b), "%.4f", v);
+  std::string s = b;
+  while (!s.empty() && s.back() == '0') s.pop_back();
+  if (!s.empty() && s.back() == '.') s.pop_back();
+  return s;
+}
+
+static Obj image_dict(int w, int h, const char* cs, const char* filter) {
+  Obj d = Obj::make_dict();
+  d.set("Type", Obj::make_name("XObject"));
+  d.set("Subtype", Obj::make_name("Image"));
+  d.set("Width", Obj::make_int(w));
+  d.set("Height", Obj::make_int(h));
+  if (cs) d.set("ColorSpace", Obj::make_name(cs));
+  d.set("BitsPerComponent", Obj::make_int(cs ? 8 : 1));
+  d.set("Filter", Obj::make_name(filter));
+  return d;
+}
+
+struct MrcReader : GsxPnmReader {
+  Job* job = nullptr;
+  int first = 0, count = 0, got = 0;
+  int w = 0, h = 0, ch = 3;
+  std::vector<uint8_t> rgb, gray;
+  Layers L;
+  std::string mask_enc, fg_enc, bg_enc;
+
+  void on_page(int width, int height, int channels) override {
+    w = width; h = height; ch = channels;
+    rgb.resize((size_t)w * h * 3);
+    gray.resize((size_t)w * h);
+  }
+
+  void on_row(int y, const uint8_t* row) override {
+    uint8_t* c = rgb.data() + (size_t)y * w * 3;
+    uint8_t* g = gray.data() + (size_t)y * w;
+    if (ch == 1) {
+      memcpy(g, row, (size_t)w);
+      for (int x = 0; x < w; ++x) c[x * 3] = c[x * 3 + 1] = c[x * 3 + 2] = row[x];
+      return;
+    }
+    memcpy(c, row, (size_t)w * 3);
+    gsx_rgb_to_gray(row, g, (size_t)w);
+  }
+
+  void on_page_end() override {
+    if (got >= count) return;
+    const int page = first + got++;
+    Job& j = *job;
+
+    L = Layers();
+    L.w = w;
+    L.h = h;
+    L.mask.resize((size_t)w * h);
+    gsx_binarize_sauvola(gray.data(), w, h, std::max(15, j.dpi / 12) | 1, kSauvolaK, L.mask.data());
+    keep_glyphs(L, rgb.data(), gray.data(), j.dpi, std::max(2, j.dpi * j.dpi / 30000));
+    const int bg_dpi = j.bg_dpi > 0 ? j.bg_dpi : std::max(1, j.dpi / 3);   // dpi 1..2: sem divisão por zero abaixo
+    build_background(L, rgb.data(), std::max(1, (j.dpi + bg_dpi / 2) / bg_dpi));
+
+    mask_enc.clear(); fg_enc.clear(); bg_enc.clear();
+    bool ok = true;
+    if (L.text_px) {
+      if (j.codec == GSX_BIN_JBIG2) gsx_jbig2_encode(L.mask.data(), w, h, j.dpi, mask_enc);
+      else gsx_g4_encode(L.mask.data(), w, h, mask_enc);
+      ok = encode_flate(L.fg, fg_enc);
+    }
+    if (ok && !L.bg_white) ok = encode_jpeg(L.bg, L.bw, L.bh, L.bg_gray, j.quality, bg_enc);
+    if (!ok) { j.encode_ok = false; return; }
+    j.mask_bytes += mask_enc.size();
+    j.fg_bytes += fg_enc.size();
+    j.bg_bytes += bg_enc.size();
+    write_page(page);
+  }
+
+  void write_page(int page) {
+    Job& j = *job;
+    const uint32_t* n = &j.nums[(size_t)(page - j.first) * 5];
+    const double wpt = (double)w * 72.0 / (double)j.dpi, hpt = (double)h * 72.0 / (double)j.dpi;
+    const std::string cm = "q " + fmt_num(wpt) + " 0 0 " + fmt_num(hpt) + " 0 0 cm ";
+
+    std::string content;
+    Obj xo = Obj::make_dict();
+    Obj bg_img, fg_img, mask_img;
+    if (!bg_enc.empty()) {
+      bg_img = image_dict(L.bw, L.bh, L.bg_gray ? "DeviceGray" : "DeviceRGB", "DCTDecode");
+      xo.set("Bg", Obj::make_ref(n[2]));
+      content += cm + "/Bg Do Q\n";
+    }
+    if (!mask_enc.empty()) {
+      mask_img = image_dict(w, h, nullptr, j.codec == GSX_BIN_JBIG2 ? "JBIG2Decode" : "CCITTFaxDecode");
+      mask_img.set("ImageMask", Obj::make_bool(true));
+      if (j.codec != GSX_BIN_JBIG2) {
+        Obj parms = Obj::make_dict();
+        parms.set("K", Obj::make_int(-1));
+        parms.set("Columns", Obj::make_int(w));
+        parms.set("Rows", Obj::make_int(h));
+        mask_img.set("DecodeParms", parms);
+      }
+      fg_img = image_dict(L.fw, L.fh, "DeviceRGB", "FlateDecode");
+      fg_img.set("Mask", Obj::make_ref(n[4]));
+      xo.set("Fg", Obj::make_ref(n[3]));
+      content += cm + "/Fg Do Q\n";
+    }
+
+    Obj box = Obj::make_array();
+    box.arr->push_back(Obj::make_int(0));
+    box.arr->push_back(Obj::make_int(0));
+    box.arr->push_back(Obj::make_real(wpt));
+    box.arr->push_back(Obj::make_real(hpt));
+    Obj res = Obj::make_dict();
+    res.set("XObject", xo);
+    Obj pg = Obj::make_dict();
+    pg.set("Type", Obj::make_name("Page"));
+    pg.set("Parent", Obj::make_ref(j.pages_num));
+    pg.set("MediaBox", box);
+    pg.set("Resources", res);
+    pg.set("Contents", Obj::make_ref(n[1]));
+
+    {
+      std::lock_guard<std::mutex> lk(j.w_m);
+      bool ok = j.write_ok;
+      if (ok && !bg_enc.empty())
+        ok = j.w->write_stream(n[2], bg_img, (const uint8_t*)bg_enc.data(), bg_enc.size());
+      if (ok && !mask_enc.empty())
+        ok = j.w->write_stream(n[4], mask_img, (const uint8_t*)mask_enc.data(), mask_enc.size()) &&
+             j.w->write_stream(n[3], fg_img, (const uint8_t*)fg_enc.data(), fg_enc.size());
+      j.write_ok = ok &&
+          j.w->write_stream(n[1], Obj::make_dict(), (const uint8_t*)content.data(), content.size()) &&
+          j.w->write_object(n[0], pg);
+    }
+    const int d = ++j.done;
+    if (j.cb) {
+      // mesmo formato do Ghostscript ("Page N"), contado a partir de first_page
+      const int pn = j.first + d - 1;
+      const std::string line = "Page " + std::to_string(pn);
+      std::lock_guard<std::mutex> lk(j.cb_m);
+      j.cb(pn, j.last, line.c_str(), j.user);
+    }
+  }
+};
+
+static int render_range(Job& j, int first, int last, volatile int* cancel_flag) {
+  std::vector<std::string> A = {
+    "gs", "-dSAFER", "-dBATCH", "-dNOPAUSE", "-dQUIET", "-sstdout=%stderr",
+    "-sDEVICE=ppmraw", "-r" + std::to_string(j.dpi),
+    "-dTextAlphaBits=4", "-dGraphicsAlphaBits=4",
+    "-dFirstPage=" + std::to_string(first), "-dLastPage=" + std::to_string(last),
+    "-sOutputFile=-", j.in_path
+  };
+  MrcReader rd;
+  rd.job = &j;
+  rd.first = first;
+  rd.count = last - first + 1;
+  int rc = gsx_run_gs_raw(A, &GsxPnmReader::sink, &rd, nullptr, nullptr, cancel_flag);
+  if (rc < 0) return rc;
+  if (!j.encode_ok) {
+    set_last_error_json(GSX_E_UNKNOWN, "mrc.encode", 0, 0, nullptr);
+    return GSX_E_UNKNOWN;
+  }
+  if (rd.got < rd.count) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "mrc: %d de %d páginas renderizadas (%d-%d)", rd.got, rd.count, first, last);
+    set_last_error_json(GSX_E_UNKNOWN, "mrc.render", 0, 0, nullptr);
+    gsx_log_msg(GSX_LOG_ERROR, msg);
+    return GSX_E_UNKNOWN;
+  }
+  return GSX_OK;
+}
+
+}  // namespace
+
+GSX_API int gsx_mrc_pdf(
+  const char* in_path,
+  const char* out_path,
+  int first_page,
+  int last_page,
+  const gsx_mrc_opts_t* opts,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  GsxJobScope scope("gsx_mrc_pdf", in_path, out_path);
+  GsxSpan span("mrc");
+  if (!in_path || !out_path || first_page < 0 || last_page < 0 ||
+      (opts && (opts->dpi < 0 || opts->dpi > 1200 || opts->bg_dpi < 0 ||
+                opts->jpeg_quality < 0 || opts->jpeg_quality > 100 ||
+                (opts->codec != GSX_BIN_G4 && opts->codec != GSX_BIN_JBIG2)))) {
+    set_last_error_json(GSX_E_ARGS, "mrc", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  std::error_code ec;
+  if (fs::equivalent(in_path, out_path, ec)) {
+    set_last_error_json(GSX_E_ARGS, "mrc.same_path", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  auto t0 = std::chrono::steady_clock::now();
+
+  Job j;
+  j.in_path = in_path;
+  j.first = first_page;
+  j.last = last_page;
+  std::vector<uint64_t> weights;
+  int rc = gsx_page_weights(in_path, j.first, j.last, weights);
+  if (rc < 0) return rc;
+  if (opts) {
+    if (opts->dpi > 0) j.dpi = opts->dpi;
+    j.bg_dpi = std::min(opts->bg_dpi, j.dpi);
+    if (opts->jpeg_quality > 0) j.quality = opts->jpeg_quality;
+    j.codec = opts->codec;
+  }
+  j.cb = on_progress;
+  j.user = user;
+  const int total = j.last - j.first + 1;
+
+  fs::create_directories(fs::path(out_path).parent_path(), ec);
+  Writer w;
+  if (!w.open(out_path, 14)) {
+    set_last_error_json(GSX_E_WRITE_OPEN, "mrc.out", w.os_errno(), 0, nullptr);
+    return GSX_E_WRITE_OPEN;
+  }
+  j.w = &w;
+  const uint32_t catalog_num = w.reserve();
+  j.pages_num = w.reserve();
+  j.nums.resize((size_t)total * 5);
+  for (auto& n : j.nums) n = w.reserve();
+
+  int used = 0;
+  rc = gsx_run_weighted(weights, j.first, opts ? opts->workers : 0,
+                        [&](int a, int b) { return render_range(j, a, b, cancel_flag); },
+                        cancel_flag, &used);
+  if (rc >= 0 && j.write_ok) {
+    Obj kids = Obj::make_array();
+    for (int i = 0; i < total; ++i) kids.arr->push_back(Obj::make_ref(j.nums[(size_t)i * 5]));
+    Obj pages_dict = Obj::make_dict();
+    pages_dict.set("Type", Obj::make_name("Pages"));
+    pages_dict.set("Kids", kids);
+    pages_dict.set("Count", Obj::make_int(total));
+    Obj catalog = Obj::make_dict();
+    catalog.set("Type", Obj::make_name("Catalog"));
+    catalog.set("Pages", Obj::make_ref(j.pages_num));
+    Obj trailer = Obj::make_dict();
+    trailer.set("Root", Obj::make_ref(catalog_num));
+    j.write_ok = w.write_object(j.pages_num, pages_dict) && w.write_object(catalog_num, catalog) &&
+                 w.finish(trailer);
+  }
+  if (rc >= 0 && !j.write_ok) {
+    rc = GSX_E_WRITE_IO;
+    set_last_error_json(rc, "mrc.write", w.os_errno(), 0, nullptr);
+  } else if (rc == GSX_E_CANCELED) {
+    set_last_error_json(rc, "mrc", 0, 0, nullptr);
+  }
+  if (rc < 0) {
+    w.close();
+    fs::remove(out_path, ec);
+    return rc;
+  }
+
+  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+  std::string msg = "mrc_pdf: " + std::to_string(total) + " páginas a " + std::to_string(j.dpi) + " dpi, " +
+                    std::to_string(used) + " workers; máscara " + std::to_string(j.mask_bytes.load()) +
+                    " + frente " + std::to_string(j.fg_bytes.load()) + " + fundo " +
+                    std::to_string(j.bg_bytes.load()) + " bytes, saída " + std::to_string(w.bytes_written()) +
+                    " bytes em " + std::to_string((long long)ms) + " ms";
+  gsx_log_msg(GSX_LOG_INFO, msg.c_str());
+  set_last_error_json(GSX_OK, "mrc", 0, 0, nullptr);
+  return total;
+}
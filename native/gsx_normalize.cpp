@@ -0,0 +1,170 @@
+// gsx_normalize.cpp — cópia normalizada de PDFs com xref danificada (gsx_normalize_pdf)
+//
+// Com a xref quebrada o Ghostscript reconstrói a tabela varrendo o arquivo inteiro
+// ("xref table was repaired") — e cada instância da compressão paralela repete a
+// varredura. Aqui a varredura nativa (Document::repair) roda uma vez e o documento é
+// regravado com os mesmos números de objeto, xref clássica nova, /Length corrigidos e
+// sem os object streams/xref streams antigos (os objetos deles saem soltos).
+//
+// "Danificada" = a xref não serviu (reparo por varredura) ou alguma entrada não aponta
+// para "N G obj" do número certo — o que o Ghostscript também conserta varrendo.
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+using namespace gsx_pdf;
+namespace fs = std::filesystem;
+
+namespace {
+
+// Entradas tipo 1 cujo offset não começa com "num gen obj"
+static int count_bad_offsets(const Document& doc) {
+  const std::vector<XrefEntry>& x = doc.xref();
+  int bad = 0;
+  for (uint32_t n = 1; n < x.size(); ++n) {
+    if (x[n].type != 1) continue;
+    if (x[n].off >= doc.size()) { ++bad; continue; }
+    Lexer lx(doc.data(), doc.size(), (size_t)x[n].off);
+    if (lx.next() != Lexer::T_INT || lx.ival() != (int64_t)n || lx.next() != Lexer::T_INT ||
+        lx.next() != Lexer::T_KEYWORD || lx.text() != "obj")
+      ++bad;
+  }
+  return bad;
+}
+
+// O Writer grava tudo com geração 0: as referências acompanham
+static Obj zero_gens(const Obj& o) {
+  switch (o.type) {
+    case Type::Ref:
+      return o.gen ? Obj::make_ref(o.ref_num(), 0) : o;
+    case Type::Array: {
+      if (!o.arr) return o;
+      Obj a = Obj::make_array();
+      a.arr->reserve(o.arr->size());
+      for (auto& v : *o.arr) a.arr->push_back(zero_gens(v));
+      return a;
+    }
+    case Type::Dict: {
+      if (!o.dict) return o;
+      Obj d = Obj::make_dict();
+      d.dict->reserve(o.dict->size());
+      for (auto& kv : *o.dict) d.dict->emplace_back(kv.first, zero_gens(kv.second));
+      return d;
+    }
+    default:
+      return o;
+  }
+}
+
+}  // namespace
+
+int gsx_normalize_lazy(const char* in_path, int flags, const std::function<std::string()>& make_out,
+                       std::string* out_path, gsx_normalize_stats_t* stats)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  GsxSpan span("normalize");
+  gsx_normalize_stats_t st{};
+  if (stats) *stats = st;
+  if (!in_path || !make_out) {
+    set_last_error_json(GSX_E_ARGS, "normalize", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  Document doc;
+  if (!doc.open(in_path)) {
+    int rc = doc.os_errno() ? GSX_E_INPUT_NOT_FOUND : GSX_E_PDF_PARSE;
+    set_last_error_json(rc, "normalize.open", doc.os_errno(), 0, nullptr);
+    return rc;
+  }
+  st.xref_health = doc.health();
+  st.bad_offsets = doc.health() == XREF_OK ? count_bad_offsets(doc) : 0;
+  auto finish_stats = [&] {
+    st.elapsed_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - t0).count();
+    if (stats) *stats = st;
+  };
+  if (st.xref_health == XREF_OK && st.bad_offsets == 0 && !(flags & GSX_NORMALIZE_FORCE)) {
+    finish_stats();
+    set_last_error_json(GSX_OK, "normalize", 0, 0, nullptr);
+    return 0;
+  }
+  if (doc.encrypted()) {
+    // strings e streams cifrados com a chave do objeto: não dá para regravar soltos
+    finish_stats();
+    set_last_error_json(GSX_E_PDF_ENCRYPTED, "normalize", 0, 0, nullptr);
+    return GSX_E_PDF_ENCRYPTED;
+  }
+  // offsets errados numa xref "legível": a varredura acha as definições reais
+  if (st.bad_offsets && !doc.repair()) {
+    finish_stats();
+    set_last_error_json(GSX_E_PDF_PARSE, "normalize.repair", 0, 0, nullptr);
+    return GSX_E_PDF_PARSE;
+  }
+
+  const std::string out = make_out();
+  Writer w;
+  if (!w.open(out.c_str(), doc.version() ? doc.version() : 14)) {
+    set_last_error_json(GSX_E_WRITE_OPEN, "normalize.write", w.os_errno(), 0, nullptr);
+    return GSX_E_WRITE_OPEN;
+  }
+  const std::vector<XrefEntry> x = doc.xref();
+  for (uint32_t n = 1; n < x.size(); ++n) w.reserve();
+  bool io_ok = true;
+  for (uint32_t n = 1; n < x.size() && io_ok; ++n) {
+    if (x[n].type == 0) continue;
+    Indirect ind;
+    if (!doc.load(n, ind)) { ++st.dropped; continue; }
+    if (ind.value.is_dict()) {
+      const Obj* type = ind.value.get("Type");
+      if (type && (type->is_name("ObjStm") || type->is_name("XRef"))) continue;
+    }
+    Obj v = zero_gens(ind.value);
+    if (ind.is_stream)
+      io_ok = w.write_stream(n, v, doc.data() + ind.stream_off, ind.stream_len);
+    else
+      io_ok = w.write_object(n, v);
+    ++st.objects;
+  }
+  Obj trailer = Obj::make_dict();
+  for (const char* key : {"Root", "Info", "ID"}) {
+    const Obj* v = doc.trailer().get(key);
+    if (v) trailer.set(key, zero_gens(*v));
+  }
+  if (!io_ok || !w.finish(trailer)) {
+    const int e = w.os_errno();
+    w.close();
+    std::error_code ec;
+    fs::remove(out, ec);
+    set_last_error_json(GSX_E_WRITE_IO, "normalize.write", e, 0, nullptr);
+    return GSX_E_WRITE_IO;
+  }
+  st.bytes_out = w.bytes_written();
+  finish_stats();
+  if (out_path) *out_path = out;
+
+  char msg[160];
+  snprintf(msg, sizeof msg, "normalize: xref %s, %d offsets errados, %d objetos (%d ilegíveis), %llu bytes",
+           st.xref_health == XREF_REPAIRED ? "reconstruída" : "lida", st.bad_offsets, st.objects,
+           st.dropped, (unsigned long long)st.bytes_out);
+  gsx_log_msg(GSX_LOG_DEBUG, msg);
+  gsx_metric_add(GSX_C_NORMALIZED);
+  set_last_error_json(GSX_OK, "normalize", 0, 0, nullptr);
+  return 1;
+}
+
+GSX_API int gsx_normalize_pdf(const char* in_path, const char* out_path, int flags,
+                              gsx_normalize_stats_t* stats)
+{
+  std::error_code ec;
+  if (!out_path || (in_path && fs::equivalent(in_path, out_path, ec))) {
+    set_last_error_json(GSX_E_ARGS, "normalize", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  GsxJobScope scope("gsx_normalize_pdf", in_path, out_path);
+  return gsx_normalize_lazy(in_path, flags, [&] { return std::string(out_path); }, nullptr, stats);
+}
@@ -0,0 +1,343 @@
+// gsx_optimize.cpp — pós-passo estrutural sem Ghostscript (gsx_optimize_pdf)
+//
+// O pdfwrite grava os content streams com o nível padrão da zlib, um objeto indireto
+// por dicionário e xref clássica. Aqui o PDF é regravado com:
+//  - streams /FlateDecode reinflados e recomprimidos em paralelo (nível 9 e, no
+//    esforço máximo, também Z_FILTERED; fica o menor, nunca maior que o original);
+//    preditores/DecodeParms são mantidos porque só a camada deflate muda;
+//  - streams sem filtro comprimidos com Flate (exceto /Metadata, que fica legível);
+//  - objetos sem stream empacotados em object streams e xref stream (Writer compacto);
+//  - só o que é alcançável a partir do trailer, renumerado em ordem de visita
+//    (dicionário de linearização, hint streams e xref antigas ficam para trás).
+// Os streams são processados em janelas de ~64 MB de dados, na ordem de escrita, para
+// a memória não crescer com o arquivo.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <zlib.h>
+#ifdef _WIN32
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <time.h>
+#endif
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+using namespace gsx_pdf;
+namespace fs = std::filesystem;
+
+static const size_t kWindowBytes = 64u << 20;
+
+namespace {
+
+struct Item {
+  Obj value;                  // Refs já renumeradas
+  bool is_stream = false;
+  const uint8_t* data = nullptr;
+  size_t len = 0;
+  int action = 0;             // 0 = copia; 1 = reinfla e recomprime; 2 = comprime (sem filtro)
+  std::string out;            // dados novos (vazio = copia os originais)
+};
+
+enum { ACT_COPY = 0, ACT_REDEFLATE = 1, ACT_DEFLATE = 2 };
+
+// Tempo de CPU da thread atual em µs (o custo real, mesmo com mais threads que núcleos)
+static uint64_t thread_cpu_us() {
+#ifdef _WIN32
+  FILETIME c, e, k, u;
+  if (!GetThreadTimes(GetCurrentThread(), &c, &e, &k, &u)) return 0;
+  const uint64_t t = ((uint64_t)k.dwHighDateTime << 32 | k.dwLowDateTime) +
+                     ((uint64_t)u.dwHighDateTime << 32 | u.dwLowDateTime);
+  return t / 10;
+#else
+  timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0;
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+#endif
+}
+
+// Inflate estrito: só aceita o stream completo (Z_STREAM_END), ao contrário de
+// flate_decode, que devolve o que conseguiu de dados truncados.
+static bool inflate_strict(const uint8_t* p, size_t n, std::string& out) {
+  out.clear();
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if (inflateInit(&zs) != Z_OK) return false;
+  zs.next_in = const_cast<Bytef*>(p);
+  zs.avail_in = (uInt)n;
+  out.resize(std::max<size_t>(n * 4, 4096));
+  size_t have = 0;
+  int rc;
+  for (;;) {
+    if (have == out.size()) out.resize(out.size() * 2);
+    zs.next_out = (Bytef*)&out[have];
+    zs.avail_out = (uInt)(out.size() - have);
+    rc = inflate(&zs, Z_NO_FLUSH);
+    have = zs.total_out;
+    if (rc == Z_OK || (rc == Z_BUF_ERROR && zs.avail_out == 0)) continue;
+    break;
+  }
+  inflateEnd(&zs);
+  out.resize(have);
+  return rc == Z_STREAM_END;
+}
+
+// Filtro único /FlateDecode (nome ou array de um elemento)
+static bool flate_only(const Obj& dict) {
+  const Obj* f = dict.get("Filter");
+  if (!f) return false;
+  if (f->is_name("FlateDecode")) return true;
+  return f->is_array() && f->arr->size() == 1 && (*f->arr)[0].is_name("FlateDecode");
+}
+
+static void compress_item(Item& it, int level, bool both_strategies) {
+  std::string raw;
+  const uint8_t* src = it.data;
+  size_t n = it.len;
+  if (it.action == ACT_REDEFLATE) {
+    if (!inflate_strict(it.data, it.len, raw)) { it.action = ACT_COPY; return; }
+    src = (const uint8_t*)raw.data();
+    n = raw.size();
+  }
+  std::string z;
+  if (!flate_encode(src, n, level, 0, it.out)) it.out.clear();
+  if (both_strategies && flate_encode(src, n, level, 1, z) &&
+      (it.out.empty() || z.size() < it.out.size()))
+    it.out.swap(z);
+  if (it.out.empty() || it.out.size() >= it.len) {   // não ganhou: mantém o original
+    it.out.clear();
+    it.action = ACT_COPY;
+  }
+}
+
+struct Collect {
+  Document& doc;
+  std::unordered_map<uint32_t, uint32_t> num;   // número na entrada → na saída (1-based)
+  std::vector<Indirect> todo;                   // carregados, ainda não convertidos
+
+  uint32_t map(uint32_t n) {
+    auto it = num.find(n);
+    if (it != num.end()) return it->second;
+    Indirect ind;
+    if (n == 0 || !doc.load(n, ind)) return 0;    // referência órfã vira null
+    const uint32_t out = (uint32_t)todo.size() + 1;
+    num[n] = out;
+    todo.push_back(std::move(ind));
+    return out;
+  }
+
+  Obj rewrite(const Obj& o) {
+    switch (o.type) {
+      case Type::Ref: {
+        uint32_t t = map(o.ref_num());
+        return t ? Obj::make_ref(t) : Obj();
+      }
+      case Type::Array: {
+        Obj a = Obj::make_array();
+        a.arr->reserve(o.arr ? o.arr->size() : 0);
+        if (o.arr) for (auto& v : *o.arr) a.arr->push_back(rewrite(v));
+        return a;
+      }
+      case Type::Dict: {
+        Obj d = Obj::make_dict();
+        d.dict->reserve(o.dict ? o.dict->size() : 0);
+        if (o.dict) for (auto& kv : *o.dict) d.dict->emplace_back(kv.first, rewrite(kv.second));
+        return d;
+      }
+      default:
+        return o;
+    }
+  }
+};
+
+}  // namespace
+
+GSX_API int gsx_optimize_pdf(const char* in_path, const char* out_path,
+                             const gsx_optimize_opts_t* opts, gsx_optimize_stats_t* stats_out,
+                             gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  const auto t0 = std::chrono::steady_clock::now();
+  GsxJobScope scope("gsx_optimize_pdf", in_path, out_path);
+  GsxSpan span("optimize");
+  if (stats_out) memset(stats_out, 0, sizeof(*stats_out));
+  gsx_optimize_opts_t o{};
+  if (opts) o = *opts;
+  if (!in_path || !out_path || o.level < 0 || o.level > 9) {
+    set_last_error_json(GSX_E_ARGS, "optimize", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  const bool both = o.level == 0;            // esforço máximo
+  const int level = o.level ? o.level : 9;
+  std::error_code ec;
+  if (fs::equivalent(in_path, out_path, ec)) {
+    set_last_error_json(GSX_E_ARGS, "optimize.same_path", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+
+  Document doc;
+  if (!doc.open(in_path)) {
+    int rc = doc.os_errno() ? GSX_E_INPUT_NOT_FOUND : GSX_E_PDF_PARSE;
+    set_last_error_json(rc, "optimize.open", doc.os_errno(), 0, nullptr);
+    return rc;
+  }
+  if (doc.encrypted()) {
+    set_last_error_json(GSX_E_PDF_ENCRYPTED, "optimize.open", 0, 0, nullptr);
+    return GSX_E_PDF_ENCRYPTED;
+  }
+  const Obj* root = doc.trailer().get("Root");
+  if (!root || !root->is_ref()) {
+    set_last_error_json(GSX_E_PDF_PARSE, "optimize.root", 0, 0, nullptr);
+    return GSX_E_PDF_PARSE;
+  }
+
+  // 1) objetos alcançáveis a partir do trailer, renumerados em ordem de visita
+  Collect c{doc, {}, {}};
+  Obj trailer = Obj::make_dict();
+  trailer.set("Root", c.rewrite(*root));
+  if (const Obj* info = doc.trailer().get("Info")) {
+    Obj v = c.rewrite(*info);
+    if (!v.is_null()) trailer.set("Info", v);
+  }
+  if (const Obj* id = doc.trailer().get("ID")) trailer.set("ID", *id);
+
+  // todo cresce enquanto as referências são reescritas; índice k = objeto k+1 da saída
+  std::vector<Item> items;
+  for (size_t next = 0; next < c.todo.size(); ++next) {
+    Indirect ind = std::move(c.todo[next]);
+    Item it;
+    if (ind.is_stream && ind.value.is_dict()) {
+      // /Length é regravado direto: não arrasta o objeto do comprimento
+      Obj d = ind.value;
+      d.dict = std::make_shared<Dict>(*d.dict);
+      d.erase("Length");
+      it.value = c.rewrite(d);
+      it.is_stream = true;
+      it.data = doc.data() + ind.stream_off;
+      it.len = ind.stream_len;
+      if (flate_only(d)) it.action = ACT_REDEFLATE;
+      else if (!d.get("Filter") && !d.get("F") && !o.skip_unfiltered) {
+        const Obj* ty = d.get("Type");
+        if (!ty || !ty->is_name("Metadata")) it.action = ACT_DEFLATE;
+      }
+    } else {
+      it.value = c.rewrite(ind.value);
+    }
+    items.push_back(std::move(it));
+  }
+  c.todo.clear();
+
+  // 2) escrita, com os streams de cada janela recomprimidos em paralelo
+  Writer w;
+  w.set_compact(!o.classic_xref);
+  if (!w.open(out_path, doc.version())) {
+    set_last_error_json(GSX_E_WRITE_OPEN, "optimize.out", w.os_errno(), 0, nullptr);
+    return GSX_E_WRITE_OPEN;
+  }
+  for (size_t k = 0; k < items.size(); ++k) w.reserve();
+
+  int workers = o.workers > 0 ? o.workers : (int)std::thread::hardware_concurrency();
+  workers = std::max(1, workers);
+  size_t total_streams = 0;
+  for (auto& it : items) total_streams += it.is_stream ? 1 : 0;
+
+  gsx_optimize_stats_t st{};
+  st.objects = (int)items.size();
+  st.bytes_in = doc.size();
+  std::atomic<uint64_t> cpu_us{0};
+  size_t streams_done = 0;
+  bool ok = true, canceled = false;
+  size_t k = 0;
+  while (k < items.size() && ok) {
+    if (cancel_flag && *cancel_flag) { canceled = true; break; }
+    // janela [k, e): até kWindowBytes de dados de stream
+    size_t e = k, bytes = 0;
+    std::vector<size_t> work;
+    while (e < items.size() && (bytes < kWindowBytes || e == k)) {
+      if (items[e].is_stream) {
+        bytes += items[e].len;
+        if (items[e].action != ACT_COPY) work.push_back(e);
+      }
+      ++e;
+    }
+    std::atomic<size_t> pick{0};
+    auto run = [&] {
+      const uint64_t c0 = thread_cpu_us();
+      for (size_t i; (i = pick.fetch_add(1)) < work.size();) {
+        if (cancel_flag && *cancel_flag) break;
+        compress_item(items[work[i]], level, both);
+      }
+      cpu_us += thread_cpu_us() - c0;
+    };
+    const int nt = (int)std::min<size_t>((size_t)workers, work.size());
+    std::vector<std::thread> pool;
+    for (int t = 1; t < nt; ++t) pool.emplace_back(run);
+    run();
+    for (auto& t : pool) t.join();
+    if (cancel_flag && *cancel_flag) { canceled = true; break; }
+
+    for (; k < e && ok; ++k) {
+      Item& it = items[k];
+      const uint32_t num = (uint32_t)k + 1;
+      if (!it.is_stream) { ok = w.write_object(num, it.value); it.value = Obj(); continue; }
+      ++st.streams;
+      st.stream_bytes_in += it.len;
+      if (it.action == ACT_COPY) {
+        st.stream_bytes_out += it.len;
+        ok = w.write_stream(num, it.value, it.data, it.len);
+      } else {
+        if (it.action == ACT_REDEFLATE) ++st.streams_recompressed;
+        else { ++st.streams_deflated; it.value.set("Filter", Obj::make_name("FlateDecode")); }
+        st.stream_bytes_out += it.out.size();
+        ok = w.write_stream(num, it.value, (const uint8_t*)it.out.data(), it.out.size());
+      }
+      it.out = std::string();
+      it.value = Obj();
+      ++streams_done;
+    }
+    if (on_progress && total_streams) {
+      char line[96];
+      snprintf(line, sizeof line, "optimize: %zu/%zu streams", streams_done, total_streams);
+      on_progress((int)streams_done, (int)total_streams, line, user);
+    }
+  }
+  ok = ok && !canceled && w.finish(trailer);
+  if (!ok) {
+    int err = w.os_errno();
+    w.close();
+    fs::remove(out_path, ec);
+    int rc = canceled ? GSX_E_CANCELED : GSX_E_WRITE_IO;
+    set_last_error_json(rc, "optimize.write", err, 0, nullptr);
+    return rc;
+  }
+
+  st.objects_packed = (int)w.objects_packed();
+  st.object_streams = (int)w.object_streams();
+  st.bytes_out = w.bytes_written();
+  st.cpu_us = cpu_us.load();
+  st.elapsed_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - t0).count();
+  if (stats_out) *stats_out = st;
+
+  char msg[256];
+  snprintf(msg, sizeof msg,
+           "optimize_pdf: %d objetos (%d em %d object streams), streams %llu -> %llu bytes, "
+           "arquivo %llu -> %llu bytes, cpu %.1f ms",
+           st.objects, st.objects_packed, st.object_streams,
+           (unsigned long long)st.stream_bytes_in, (unsigned long long)st.stream_bytes_out,
+           (unsigned long long)st.bytes_in, (unsigned long long)st.bytes_out, st.cpu_us / 1000.0);
+  gsx_log_msg(GSX_LOG_DEBUG, msg);
+  set_last_error_json(GSX_OK, "optimize", 0, 0, nullptr);
+  return st.objects;
+}
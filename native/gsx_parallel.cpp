@@ -0,0 +1,493 @@
+// gsx_parallel.cpp — compressão paralela com fila compartilhada de lotes e
+// replicação de retardatários (gsx_compress_parallel_sync)
+//
+// Fluxo:
+//  0) xref danificada: cópia normalizada uma vez (gsx_normalize.cpp), para que os
+//     lotes não repitam a varredura de reparo do Ghostscript cada um;
+//  1) o intervalo é dividido em ~workers×batches_per_worker lotes de peso parecido
+//     (mesma medição do gsx_plan_chunks) — ou no número de lotes que o perfil
+//     calibrado indicar (gsx_tune.cpp); os mais pesados entram primeiro na fila;
+//  2) cada worker puxa o próximo lote e roda pdfwrite só naquelas páginas;
+//  3) o coordenador (thread chamadora) acompanha o tempo de cada lote contra a mediana
+//     ms/peso dos lotes já concluídos. Quando a fila esvazia, há workers ociosos e um
+//     lote passou muito do esperado, o intervalo dele é redividido entre os ociosos
+//     (hedge). O pdfwrite só grava a saída no fim, então as páginas que o lote original
+//     já processou não são aproveitáveis: o hedge cobre o intervalo inteiro;
+//  4) vence quem terminar primeiro (o original ou o grupo de hedge completo); o outro é
+//     cancelado via poll do Ghostscript e sua saída descartada.
+// As saídas vêm de um GsxPartStore: arquivos temporários aqui, memfd no pipeline
+// (gsx_pipeline.cpp).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Sched;
+
+// Uma execução de pdfwrite sobre [first,last] (original ou hedge)
+struct Attempt {
+  Sched* s = nullptr;
+  int slot = 0;
+  bool hedge = false;
+  int first = 0, last = 0;
+  uint64_t weight = 0;
+  std::string out_path;
+  volatile int cancel = 0;
+  std::atomic<int> pages_done{0};
+  Clock::time_point t0;
+  uint64_t tr_queued = 0;             // rastreamento: entrada na fila
+  bool running = false;
+  bool finished = false;
+  int rc = 0;
+};
+
+// Lote original; a ordem dos slots é a ordem das páginas na saída
+struct Slot {
+  int first = 0, last = 0;
+  size_t w_begin = 0;                 // índice do 1º peso da faixa em Sched::weights
+  uint64_t weight = 0;
+  Attempt* orig = nullptr;
+  std::vector<Attempt*> hedges;
+  int hedges_ok = 0;
+  bool orig_failed = false;
+  bool hedge_failed = false;
+  int state = 0;                      // 0 = em aberto, 1 = venceu o original, 2 = venceu o hedge
+};
+
+struct Sched {
+  // parâmetros do job
+  std::string in_path, preset;
+  GsxPartStore* store = nullptr;
+  uint64_t in_bytes = 0, total_weight = 0;   // estimativa do tamanho de cada parte
+  int dpi = 150, jpeg_q = 65;
+  gsx_color_mode_t mode = GSX_COLOR_COLOR;
+  int straggler_pct = 250, straggler_min_ms = 2000;
+  GsxJobToken job;                    // job da chamadora, herdado pelos workers
+
+  std::vector<uint64_t> weights;      // peso por página (índice 0 = 1ª página do intervalo)
+  int first_page = 1;
+
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<Attempt*> pending;
+  std::vector<std::unique_ptr<Attempt>> attempts;
+  std::vector<Slot> slots;
+  std::vector<double> ms_per_weight;  // execuções concluídas com sucesso
+  int idle = 0;
+  size_t resolved = 0;
+  int fatal_rc = 0;
+  bool stop = false;
+
+  // progresso agregado
+  std::mutex cb_m;
+  gsx_progress_cb cb = nullptr;
+  void* user = nullptr;
+  int total_pages = 0;
+
+  Attempt* new_attempt(int slot, bool hedge, int first, int last) {
+    std::unique_ptr<Attempt> a(new Attempt());
+    a->s = this; a->slot = slot; a->hedge = hedge;
+    a->first = first; a->last = last;
+    for (int p = first; p <= last; ++p) a->weight += weights[(size_t)(p - first_page)];
+    if (gsx_trace_on()) a->tr_queued = gsx_trace_clock_ns();
+    GSX_PROBE3(job_submit, (uintptr_t)a.get(), first, last);
+    a->out_path = store->create(total_weight ? in_bytes * a->weight / total_weight : 0);
+    attempts.push_back(std::move(a));
+    return attempts.back().get();
+  }
+};
+
+static double median(std::vector<double> v) {
+  if (v.empty()) return 0;
+  std::nth_element(v.begin(), v.begin() + (long)(v.size() / 2), v.end());
+  return v[v.size() / 2];
+}
+
+static void remove_quiet(const std::string& p) {
+  std::error_code ec;
+  fs::remove(p, ec);
+}
+
+// Partes em arquivos temporários (work_dir ou pasta do sistema)
+struct TempPartStore : GsxPartStore {
+  std::string dir;
+  std::string create(uint64_t) override {
+    return gsx_make_temp_path(dir.empty() ? nullptr : dir.c_str(), "GSXP", ".pdf");
+  }
+  void drop(const std::string& path) override { remove_quiet(path); }
+};
+
+// Páginas concluídas no job inteiro (slots resolvidos + melhor progresso dos em aberto).
+static int pages_done_locked(Sched& s) {
+  int done = 0;
+  for (auto& sl : s.slots) {
+    int n = sl.last - sl.first + 1;
+    if (sl.state != 0) { done += n; continue; }
+    int best = sl.orig ? sl.orig->pages_done.load() : 0;
+    int h = 0;
+    for (auto* a : sl.hedges) h += a->pages_done.load();
+    done += std::min(n, std::max(best, h));
+  }
+  return done;
+}
+
+static void GSX_CALL attempt_progress(int page_done, int /*total*/, const char* line, void* user) {
+  auto* a = reinterpret_cast<Attempt*>(user);
+  if (!a) return;
+  // conforme a versão, "Page N" vem absoluto ou relativo a -dFirstPage
+  int n = page_done >= a->first ? page_done - a->first + 1 : page_done;
+  if (n > 0) a->pages_done.store(std::min(n, a->last - a->first + 1));
+  Sched& s = *a->s;
+  if (!s.cb) return;
+  int done;
+  { std::lock_guard<std::mutex> lk(s.m); done = pages_done_locked(s); }
+  std::lock_guard<std::mutex> lk(s.cb_m);
+  s.cb(done, s.total_pages, line, s.user);
+}
+
+static void cancel_attempt(Sched& s, Attempt* a) {
+  a->cancel = 1;
+  const size_t before = s.pending.size();
+  s.pending.erase(std::remove(s.pending.begin(), s.pending.end(), a), s.pending.end());
+  gsx_gauge_add(GSX_G_QUEUE_DEPTH, -(int64_t)(before - s.pending.size()));
+}
+
+// Decide o destino do slot quando uma execução termina (chamada com s.m travado).
+static void on_finished(Sched& s, Attempt* a) {
+  Slot& sl = s.slots[(size_t)a->slot];
+  bool ours = a->cancel != 0;    // cancelada por nós (perdedora ou parada geral)
+
+  if (a->rc >= 0 && a->weight > 0) {
+    double ms = (double)std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - a->t0).count();
+    s.ms_per_weight.push_back(ms / (double)a->weight);
+  }
+  if (sl.state != 0) return;     // o slot já tem vencedor; a saída desta é descartada
+
+  if (!a->hedge) {
+    if (a->rc >= 0) {
+      sl.state = 1;
+      ++s.resolved;
+      for (auto* h : sl.hedges) cancel_attempt(s, h);
+    } else if (!ours) {
+      sl.orig_failed = true;
+      if (sl.hedges.empty() || sl.hedge_failed) s.fatal_rc = a->rc;
+    }
+    return;
+  }
+
+  if (a->rc >= 0) {
+    if (++sl.hedges_ok == (int)sl.hedges.size()) {
+      sl.state = 2;
+      ++s.resolved;
+      if (sl.orig) cancel_attempt(s, sl.orig);
+      std::string msg = "compress_parallel: hedge venceu o lote " + std::to_string(sl.first) + "-" +
+                        std::to_string(sl.last);
+      gsx_log_msg(GSX_LOG_INFO, msg.c_str());
+    }
+  } else if (!ours) {
+    sl.hedge_failed = true;
+    for (auto* h : sl.hedges) if (h != a) cancel_attempt(s, h);
+    if (sl.orig_failed) s.fatal_rc = a->rc;
+  }
+}
+
+static void worker_main(Sched* sp) {
+  Sched& s = *sp;
+  GsxJobAdopt adopt(s.job);
+  std::unique_lock<std::mutex> lk(s.m);
+  for (;;) {
+    ++s.idle;
+    s.cv.notify_all();
+    s.cv.wait(lk, [&]{ return s.stop || !s.pending.empty(); });
+    --s.idle;
+    if (s.stop) return;
+
+    Attempt* a = s.pending.front();
+    s.pending.pop_front();
+    gsx_gauge_add(GSX_G_QUEUE_DEPTH, -1);
+    if (s.slots[(size_t)a->slot].state != 0 || a->cancel) {
+      a->finished = true;
+      a->rc = GSX_E_CANCELED;
+      continue;
+    }
+    a->running = true;
+    a->t0 = Clock::now();
+    lk.unlock();
+
+    if (a->tr_queued)
+      gsx_trace_emit("parallel.queue", a->tr_queued, gsx_trace_clock_ns(), "first", a->first, "last", a->last);
+    GsxSpan span(a->hedge ? "parallel.hedge" : "parallel.batch", "first", a->first, "last", a->last);
+    g_gsx_probe_key = (uintptr_t)a;
+    int rc = gsx_compress_file_sync(s.in_path.c_str(), a->out_path.c_str(), s.dpi, s.jpeg_q,
+                                    s.preset.empty() ? nullptr : s.preset.c_str(), s.mode,
+                                    a->first, a->last, attempt_progress, a, &a->cancel);
+    g_gsx_probe_key = 0;
+    span.end();
+    lk.lock();
+    a->running = false;
+    a->finished = true;
+    a->rc = rc;
+    on_finished(s, a);
+    s.cv.notify_all();
+  }
+}
+
+// Procura o pior retardatário e cria o grupo de hedge (chamada com s.m travado).
+static void maybe_hedge(Sched& s) {
+  if (!s.pending.empty() || s.idle <= 0 || s.ms_per_weight.empty()) return;
+  double rate = median(s.ms_per_weight);
+  Clock::time_point now = Clock::now();
+
+  Slot* worst = nullptr;
+  double worst_ratio = 0;
+  for (auto& sl : s.slots) {
+    if (sl.state != 0 || !sl.hedges.empty() || !sl.orig || !sl.orig->running) continue;
+    if (sl.last <= sl.first) continue;                 // 1 página: não há o que redividir
+    double elapsed = (double)std::chrono::duration_cast<std::chrono::milliseconds>(now - sl.orig->t0).count();
+    double expected = rate * (double)sl.weight;
+    if (elapsed < s.straggler_min_ms || elapsed * 100.0 < expected * s.straggler_pct) continue;
+    double ratio = expected > 0 ? elapsed / expected : elapsed;
+    if (ratio > worst_ratio) { worst_ratio = ratio; worst = &sl; }
+  }
+  if (!worst) return;
+  gsx_metric_add(GSX_C_BATCH_TIMEOUTS);
+
+  int pages = worst->last - worst->first + 1;
+  int parts = std::max(2, std::min(pages, s.idle));
+  std::vector<uint64_t> w(s.weights.begin() + (long)worst->w_begin,
+                          s.weights.begin() + (long)worst->w_begin + pages);
+  auto ranges = gsx_partition_weights(w, parts);
+  int slot_idx = (int)(worst - s.slots.data());
+  for (auto& r : ranges) {
+    Attempt* h = s.new_attempt(slot_idx, true, worst->first + (int)r.first, worst->first + (int)r.second);
+    worst->hedges.push_back(h);
+    s.pending.push_back(h);
+  }
+  gsx_gauge_add(GSX_G_QUEUE_DEPTH, (int64_t)ranges.size());
+  std::string msg = "compress_parallel: lote " + std::to_string(worst->first) + "-" +
+                    std::to_string(worst->last) + " retardatário; redividido em " +
+                    std::to_string(ranges.size()) + " partes";
+  gsx_log_msg(GSX_LOG_INFO, msg.c_str());
+  s.cv.notify_all();
+}
+
+}  // namespace
+
+GSX_API int gsx_compress_parallel_sync(
+  const char* in_path,
+  int dpi, int jpeg_quality, const char* preset, gsx_color_mode_t mode,
+  int first_page, int last_page,
+  const gsx_parallel_opts_t* opts,
+  char** parts_json,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  GsxJobScope scope("gsx_compress_parallel_sync", in_path);
+  scope.capture({"compress_parallel", in_path, dpi, jpeg_quality, preset, (int)mode, first_page, last_page,
+                 opts ? opts->workers : 0, 0});
+  if (!in_path || !parts_json) {
+    set_last_error_json(GSX_E_ARGS, "compress_parallel", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  *parts_json = nullptr;
+  std::error_code ec;
+  if (!fs::exists(in_path, ec)) {
+    set_last_error_json(GSX_E_INPUT_NOT_FOUND, "compress_parallel", (int)errno, 0, nullptr);
+    return GSX_E_INPUT_NOT_FOUND;
+  }
+
+  if (gsx_images_engine_applies(preset, in_path, first_page, last_page)) {
+    // o motor de imagens já usa todas as threads e trabalha no documento inteiro: uma parte só
+    const char* dir = opts && opts->work_dir && *opts->work_dir ? opts->work_dir : nullptr;
+    std::string part = gsx_make_temp_path(dir, "GSXP", ".pdf");
+    int rc = gsx_compress_file_sync(in_path, part.c_str(), dpi, jpeg_quality, preset, mode,
+                                    first_page, last_page, on_progress, user, cancel_flag);
+    if (rc < 0) { remove_quiet(part); return rc; }
+    char* buf = gsx_dup_string("[\"" + gsx_json_escape(part) + "\"]");
+    if (!buf) {
+      remove_quiet(part);
+      set_last_error_json(GSX_E_UNKNOWN, "compress_parallel.alloc", 0, 0, nullptr);
+      return GSX_E_UNKNOWN;
+    }
+    *parts_json = buf;
+    set_last_error_json(GSX_OK, "compress_parallel", 0, 0, nullptr);
+    return GSX_OK;
+  }
+
+  TempPartStore store;
+  if (opts && opts->work_dir) store.dir = opts->work_dir;
+
+  // 0) xref danificada: reparada uma vez aqui, e não pelo Ghostscript em cada lote.
+  //    Se o leitor nativo não der conta (<0), os lotes seguem com o original.
+  std::string normalized;
+  if (gsx_normalize_lazy(in_path, 0, [&] {
+        return gsx_make_temp_path(store.dir.empty() ? nullptr : store.dir.c_str(), "GSXN", ".pdf");
+      }, &normalized, nullptr) == 1) {
+    in_path = normalized.c_str();
+    if (on_progress) on_progress(0, 0, "normalize: xref table was repaired (uma vez, antes dos lotes)", user);
+  }
+
+  // 1) pesos por página
+  int first = first_page, last = last_page;
+  std::vector<uint64_t> weights;
+  int rc = gsx_page_weights(in_path, first, last, weights);
+  if (rc < 0) {
+    if (rc != GSX_E_PDF_PARSE || last_page <= 0) {
+      if (!normalized.empty()) remove_quiet(normalized);
+      return rc;
+    }
+    // estrutura que o leitor nativo não entende: pesos uniformes, o Ghostscript decide
+    first = first_page > 0 ? first_page : 1;
+    last = last_page;
+    if (first > last) {
+      if (!normalized.empty()) remove_quiet(normalized);
+      set_last_error_json(GSX_E_ARGS, "compress_parallel.range", 0, 0, nullptr);
+      return GSX_E_ARGS;
+    }
+    weights.assign((size_t)(last - first + 1), 1);
+  }
+
+  std::vector<std::string> keep;
+  rc = gsx_parallel_compress(in_path, dpi, jpeg_quality, preset, mode, first, std::move(weights), opts,
+                             store, keep, on_progress, user, cancel_flag);
+  if (!normalized.empty()) remove_quiet(normalized);
+  if (rc < 0) return rc;
+
+  std::string js = "[";
+  for (size_t i = 0; i < keep.size(); ++i) {
+    if (i) js += ",";
+    js += "\"" + gsx_json_escape(keep[i]) + "\"";
+  }
+  js += "]";
+  char* buf = gsx_dup_string(js);
+  if (!buf) {
+    for (auto& k : keep) remove_quiet(k);
+    set_last_error_json(GSX_E_UNKNOWN, "compress_parallel.alloc", 0, 0, nullptr);
+    return GSX_E_UNKNOWN;
+  }
+  *parts_json = buf;
+  set_last_error_json(GSX_OK, "compress_parallel", 0, 0, nullptr);
+  return GSX_OK;
+}
+
+int gsx_parallel_compress(const char* in_path, int dpi, int jpeg_quality, const char* preset,
+                          gsx_color_mode_t mode, int first, std::vector<uint64_t> weights,
+                          const gsx_parallel_opts_t* opts, GsxPartStore& store,
+                          std::vector<std::string>& parts,
+                          gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  parts.clear();
+  if (weights.empty()) {
+    set_last_error_json(GSX_E_ARGS, "compress_parallel.range", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  Sched s;
+  s.in_path = in_path;
+  s.preset = preset ? preset : "";
+  s.dpi = dpi; s.jpeg_q = jpeg_quality; s.mode = mode;
+  s.cb = on_progress; s.user = user;
+  s.store = &store;
+  s.job = gsx_job_token();
+  std::error_code ec;
+  s.in_bytes = (uint64_t)fs::file_size(in_path, ec);
+  if (ec) s.in_bytes = 0;
+
+  int workers = opts && opts->workers > 0 ? opts->workers : (int)std::thread::hardware_concurrency();
+  workers = std::max(1, workers);
+  int per_worker = opts && opts->batches_per_worker > 0 ? opts->batches_per_worker : 4;
+  if (opts && opts->straggler_pct > 0) s.straggler_pct = std::max(100, opts->straggler_pct);
+  if (opts && opts->straggler_min_ms > 0) s.straggler_min_ms = opts->straggler_min_ms;
+
+  s.weights = std::move(weights);
+  for (uint64_t w : s.weights) s.total_weight += w;
+  s.first_page = first;
+  s.total_pages = (int)s.weights.size();
+
+  // perfil calibrado (gsx_tune.cpp): o modelo de custo escolhe lotes e workers
+  int batches = workers * per_worker;
+  gsx_tune_profile_t tp;
+  if (!(opts && opts->batches_per_worker > 0) && gsx_tune_get_profile(&tp)) {
+    gsx_tune_plan_t plan;
+    gsx_tune_plan(&tp, s.total_pages, s.total_weight, workers, &plan);
+    batches = plan.chunks;
+    workers = plan.workers;
+    char line[160];
+    snprintf(line, sizeof line, "compress_parallel: perfil → %d lotes, %d workers (est. %.0f ms; sem dividir %.0f ms)",
+             plan.chunks, plan.workers, plan.est_ms, plan.est_single_ms);
+    gsx_log_msg(GSX_LOG_DEBUG, line);
+  }
+
+  auto ranges = gsx_partition_weights(s.weights, batches);
+  s.slots.resize(ranges.size());
+  for (size_t i = 0; i < ranges.size(); ++i) {
+    Slot& sl = s.slots[i];
+    sl.first = first + (int)ranges[i].first;
+    sl.last  = first + (int)ranges[i].second;
+    sl.w_begin = ranges[i].first;
+    for (size_t k = ranges[i].first; k <= ranges[i].second; ++k) sl.weight += s.weights[k];
+    sl.orig = s.new_attempt((int)i, false, sl.first, sl.last);
+  }
+  // mais pesados primeiro (LPT): reduz a cauda antes mesmo de precisar de hedge
+  std::vector<Attempt*> order;
+  for (auto& sl : s.slots) order.push_back(sl.orig);
+  std::stable_sort(order.begin(), order.end(), [](Attempt* a, Attempt* b){ return a->weight > b->weight; });
+  s.pending.assign(order.begin(), order.end());
+  gsx_gauge_add(GSX_G_QUEUE_DEPTH, (int64_t)s.pending.size());
+  workers = std::min(workers, s.total_pages);   // ociosos além dos lotes servem aos hedges
+
+  std::string msg = "compress_parallel: " + std::to_string(s.total_pages) + " páginas, " +
+                    std::to_string(s.slots.size()) + " lotes, " + std::to_string(workers) + " workers";
+  gsx_log_msg(GSX_LOG_DEBUG, msg.c_str());
+
+  // 2) workers + coordenação
+  std::vector<std::thread> pool;
+  for (int i = 0; i < workers; ++i) pool.emplace_back(worker_main, &s);
+  {
+    std::unique_lock<std::mutex> lk(s.m);
+    while (s.resolved < s.slots.size() && s.fatal_rc == 0) {
+      s.cv.wait_for(lk, std::chrono::milliseconds(100));
+      if (cancel_flag && *cancel_flag) { s.fatal_rc = GSX_E_CANCELED; break; }
+      maybe_hedge(s);
+    }
+    s.stop = true;
+    for (auto& a : s.attempts) if (a->running || !a->finished) a->cancel = 1;
+    gsx_gauge_add(GSX_G_QUEUE_DEPTH, -(int64_t)s.pending.size());
+    s.pending.clear();
+    s.cv.notify_all();
+  }
+  for (auto& t : pool) t.join();
+
+  // 3) resultado em ordem de página; o resto é descartado
+  if (s.fatal_rc == 0) {
+    for (auto& sl : s.slots) {
+      if (sl.state == 1) parts.push_back(sl.orig->out_path);
+      else for (auto* h : sl.hedges) parts.push_back(h->out_path);
+    }
+  }
+  for (auto& a : s.attempts)
+    if (std::find(parts.begin(), parts.end(), a->out_path) == parts.end()) store.drop(a->out_path);
+
+  if (s.fatal_rc != 0) {
+    set_last_error_json(s.fatal_rc, "compress_parallel", 0, s.fatal_rc == GSX_E_CANCELED ? 0 : s.fatal_rc, nullptr);
+    return s.fatal_rc;
+  }
+  return GSX_OK;
+}
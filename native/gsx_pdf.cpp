@@ -0,0 +1,1294 @@
+// gsx_pdf.cpp — leitor/escritor PDF mínimo (ver gsx_pdf.h)
+
+#include "gsx_pdf.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <unordered_set>
+
+#include <zlib.h>
+
+#ifdef _WIN32
+  #define NOMINMAX
+  #include <windows.h>
+#else
+  #include <fcntl.h>
+  #include <sys/mman.h>
+  #include <sys/stat.h>
+  #include <unistd.h>
+#endif
+
+namespace gsx_pdf {
+
+// ======================= MappedFile =======================
+#ifdef _WIN32
+static std::wstring utf8_to_wide(const char* s) {
+  int n = MultiByteToWideChar(CP_UTF8, 0, s, -1, nullptr, 0);
+  std::wstring w(n > 0 ? (size_t)n : 0, L'\0');
+  if (n > 0) MultiByteToWideChar(CP_UTF8, 0, s, -1, &w[0], n);
+  if (!w.empty() && w.back() == L'\0') w.pop_back();
+  return w;
+}
+
+bool MappedFile::open(const char* path) {
+  close();
+  std::wstring w = utf8_to_wide(path);
+  HANDLE h = CreateFileW(w.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+                         nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+  if (h == INVALID_HANDLE_VALUE) {
+    err_ = (GetLastError() == ERROR_FILE_NOT_FOUND || GetLastError() == ERROR_PATH_NOT_FOUND) ? ENOENT : EIO;
+    return false;
+  }
+  LARGE_INTEGER sz;
+  if (!GetFileSizeEx(h, &sz)) { err_ = EIO; CloseHandle(h); return false; }
+  file_ = h;
+  size_ = (size_t)sz.QuadPart;
+  if (size_ == 0) return true;
+  HANDLE m = CreateFileMappingW(h, nullptr, PAGE_READONLY, 0, 0, nullptr);
+  if (!m) { err_ = EIO; close(); return false; }
+  map_ = m;
+  data_ = (const uint8_t*)MapViewOfFile(m, FILE_MAP_READ, 0, 0, 0);
+  if (!data_) { err_ = ENOMEM; close(); return false; }
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_) UnmapViewOfFile((LPCVOID)data_);
+  if (map_) CloseHandle((HANDLE)map_);
+  if (file_) CloseHandle((HANDLE)file_);
+  data_ = nullptr; map_ = nullptr; file_ = nullptr; size_ = 0;
+}
+#else
+bool MappedFile::open(const char* path) {
+  close();
+  fd_ = ::open(path, O_RDONLY | O_CLOEXEC);
+  if (fd_ < 0) { err_ = errno; return false; }
+  struct stat st;
+  if (fstat(fd_, &st) != 0) { err_ = errno; close(); return false; }
+  size_ = (size_t)st.st_size;
+  if (size_ == 0) return true;
+  void* p = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+  if (p == MAP_FAILED) { err_ = errno; close(); return false; }
+  data_ = (const uint8_t*)p;
+  return true;
+}
+
+void MappedFile::close() {
+  if (data_) munmap((void*)data_, size_);
+  if (fd_ >= 0) ::close(fd_);
+  data_ = nullptr; size_ = 0; fd_ = -1;
+}
+#endif
+
+// ======================= Obj =======================
+const Obj* Obj::get(const char* key) const {
+  if (!is_dict()) return nullptr;
+  for (auto& kv : *dict) if (kv.first == key) return &kv.second;
+  return nullptr;
+}
+Obj* Obj::get(const char* key) {
+  if (!is_dict()) return nullptr;
+  for (auto& kv : *dict) if (kv.first == key) return &kv.second;
+  return nullptr;
+}
+void Obj::set(const std::string& key, Obj v) {
+  if (!is_dict()) return;
+  for (auto& kv : *dict) if (kv.first == key) { kv.second = std::move(v); return; }
+  dict->emplace_back(key, std::move(v));
+}
+void Obj::erase(const char* key) {
+  if (!is_dict()) return;
+  dict->erase(std::remove_if(dict->begin(), dict->end(),
+                             [&](const std::pair<std::string, Obj>& kv){ return kv.first == key; }),
+              dict->end());
+}
+Obj Obj::make_bool(bool v)    { Obj o; o.type = Type::Bool; o.b = v; return o; }
+Obj Obj::make_int(int64_t v)  { Obj o; o.type = Type::Int;  o.i = v; return o; }
+Obj Obj::make_real(double v)  { Obj o; o.type = Type::Real; o.r = v; return o; }
+Obj Obj::make_name(const std::string& n) { Obj o; o.type = Type::Name; o.s = n; return o; }
+Obj Obj::make_string(const std::string& bytes, bool hex) {
+  Obj o; o.type = Type::String; o.s = bytes; o.hex = hex; return o;
+}
+Obj Obj::make_ref(uint32_t num, int gen) { Obj o; o.type = Type::Ref; o.i = num; o.gen = gen; return o; }
+Obj Obj::make_array() { Obj o; o.type = Type::Array; o.arr = std::make_shared<Array>(); return o; }
+Obj Obj::make_dict()  { Obj o; o.type = Type::Dict;  o.dict = std::make_shared<Dict>(); return o; }
+
+// ======================= Lexer =======================
+static int hexval(uint8_t c) {
+  if (c >= '0' && c <= '9') return c - '0';
+  if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+  if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+  return -1;
+}
+
+void Lexer::skip_ws() {
+  while (pos_ < n_) {
+    uint8_t c = p_[pos_];
+    if (is_ws(c)) { ++pos_; continue; }
+    if (c == '%') {
+      while (pos_ < n_ && p_[pos_] != '\n' && p_[pos_] != '\r') ++pos_;
+      continue;
+    }
+    break;
+  }
+}
+
+Lexer::Tok Lexer::next() {
+  skip_ws();
+  text_.clear();
+  if (pos_ >= n_) return T_EOF;
+  uint8_t c = p_[pos_];
+
+  if (c == '[') { ++pos_; return T_ARR_OPEN; }
+  if (c == ']') { ++pos_; return T_ARR_CLOSE; }
+  if (c == '{' || c == '}') { ++pos_; text_.assign(1, (char)c); return T_KEYWORD; }
+
+  if (c == '<') {
+    if (pos_ + 1 < n_ && p_[pos_ + 1] == '<') { pos_ += 2; return T_DICT_OPEN; }
+    ++pos_;
+    int hi = -1;
+    while (pos_ < n_ && p_[pos_] != '>') {
+      int v = hexval(p_[pos_++]);
+      if (v < 0) continue;
+      if (hi < 0) hi = v; else { text_.push_back((char)((hi << 4) | v)); hi = -1; }
+    }
+    if (hi >= 0) text_.push_back((char)(hi << 4));
+    if (pos_ < n_) ++pos_;
+    return T_HEXSTR;
+  }
+  if (c == '>') {
+    if (pos_ + 1 < n_ && p_[pos_ + 1] == '>') { pos_ += 2; return T_DICT_CLOSE; }
+    ++pos_; return T_ERR;
+  }
+
+  if (c == '(') {
+    ++pos_;
+    int depth = 1;
+    while (pos_ < n_) {
+      uint8_t d = p_[pos_++];
+      if (d == '\\') {
+        if (pos_ >= n_) break;
+        uint8_t e = p_[pos_++];
+        switch (e) {
+          case 'n': text_.push_back('\n'); break;
+          case 'r': text_.push_back('\r'); break;
+          case 't': text_.push_back('\t'); break;
+          case 'b': text_.push_back('\b'); break;
+          case 'f': text_.push_back('\f'); break;
+          case '\r': if (pos_ < n_ && p_[pos_] == '\n') ++pos_; break;   // continuação de linha
+          case '\n': break;
+          default:
+            if (e >= '0' && e <= '7') {
+              int v = e - '0';
+              for (int k = 0; k < 2 && pos_ < n_ && p_[pos_] >= '0' && p_[pos_] <= '7'; ++k)
+                v = v * 8 + (p_[pos_++] - '0');
+              text_.push_back((char)(v & 0xFF));
+            } else {
+              text_.push_back((char)e);
+            }
+        }
+        continue;
+      }
+      if (d == '(') ++depth;
+      else if (d == ')') { if (--depth == 0) break; }
+      text_.push_back((char)d);
+    }
+    return T_STR;
+  }
+
+  if (c == '/') {
+    ++pos_;
+    while (pos_ < n_) {
+      uint8_t d = p_[pos_];
+      if (is_ws(d) || is_delim(d)) break;
+      if (d == '#' && pos_ + 2 < n_ && hexval(p_[pos_ + 1]) >= 0 && hexval(p_[pos_ + 2]) >= 0) {
+        text_.push_back((char)((hexval(p_[pos_ + 1]) << 4) | hexval(p_[pos_ + 2])));
+        pos_ += 3;
+        continue;
+      }
+      text_.push_back((char)d);
+      ++pos_;
+    }
+    return T_NAME;
+  }
+
+  if (c == ')') { ++pos_; return T_ERR; }
+
+  // número ou keyword
+  size_t start = pos_;
+  while (pos_ < n_ && !is_ws(p_[pos_]) && !is_delim(p_[pos_])) ++pos_;
+  text_.assign((const char*)p_ + start, pos_ - start);
+  if (text_.empty()) { ++pos_; return T_ERR; }
+
+  uint8_t f = (uint8_t)text_[0];
+  if ((f >= '0' && f <= '9') || f == '+' || f == '-' || f == '.') {
+    bool real = false, ok = true, digit = false;
+    for (size_t k = 0; k < text_.size(); ++k) {
+      char ch = text_[k];
+      if (ch >= '0' && ch <= '9') digit = true;
+      else if (ch == '.') { if (real) ok = false; real = true; }
+      else if ((ch == '+' || ch == '-') && k == 0) {}
+      else if (ch == '-' && k > 0 && text_[k-1] == '-') {}      // "--5" visto em arquivos reais
+      else ok = false;
+    }
+    if (ok && digit) {
+      if (real) { rval_ = strtod(text_.c_str(), nullptr); return T_REAL; }
+      errno = 0;
+      const char* s = text_.c_str();
+      while (s[0] == '-' && s[1] == '-') ++s;
+      long long v = strtoll(s, nullptr, 10);
+      ival_ = (errno == ERANGE) ? 0 : (int64_t)v;
+      return T_INT;
+    }
+  }
+  return T_KEYWORD;
+}
+
+bool Lexer::parse(Obj& out, int depth) {
+  out = Obj();
+  if (depth > 64) return false;
+  Tok t = next();
+  switch (t) {
+    case T_INT: {
+      int64_t a = ival_;
+      size_t save = pos_;
+      if (a >= 0 && next() == T_INT) {
+        int64_t g = ival_;
+        if (next() == T_KEYWORD && text_ == "R") { out = Obj::make_ref((uint32_t)a, (int)g); return true; }
+      }
+      pos_ = save;
+      out = Obj::make_int(a);
+      return true;
+    }
+    case T_REAL:   out = Obj::make_real(rval_); return true;
+    case T_NAME:   out = Obj::make_name(text_); return true;
+    case T_STR:    out = Obj::make_string(text_, false); return true;
+    case T_HEXSTR: out = Obj::make_string(text_, true); return true;
+    case T_ARR_OPEN: {
+      out = Obj::make_array();
+      for (;;) {
+        skip_ws();
+        if (pos_ >= n_) return false;
+        if (p_[pos_] == ']') { ++pos_; return true; }
+        Obj v;
+        if (!parse(v, depth + 1)) return false;
+        out.arr->push_back(std::move(v));
+      }
+    }
+    case T_DICT_OPEN: {
+      out = Obj::make_dict();
+      for (;;) {
+        Tok k = next();
+        if (k == T_DICT_CLOSE) return true;
+        if (k != T_NAME) return false;
+        std::string key = text_;
+        Obj v;
+        size_t save = pos_;
+        if (!parse(v, depth + 1)) {
+          // valor ausente (p.ex. "/Key >>"): trata como null e segue
+          pos_ = save; skip_ws();
+          if (pos_ + 1 < n_ && p_[pos_] == '>' && p_[pos_ + 1] == '>') { pos_ += 2; return true; }
+          return false;
+        }
+        out.dict->emplace_back(std::move(key), std::move(v));
+      }
+    }
+    case T_KEYWORD:
+      if (text_ == "true")  { out = Obj::make_bool(true); return true; }
+      if (text_ == "false") { out = Obj::make_bool(false); return true; }
+      if (text_ == "null")  { return true; }
+      return false;
+    default:
+      return false;
+  }
+}
+
+// ======================= Flate / preditores =======================
+bool flate_decode(const uint8_t* p, size_t n, std::string& out) {
+  out.clear();
+  if (!p || n == 0) return false;
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if (inflateInit(&zs) != Z_OK) return false;
+  zs.next_in = const_cast<Bytef*>(p);
+  zs.avail_in = (uInt)std::min<size_t>(n, 0x7FFFFFFF);
+  size_t cap = std::max<size_t>(n * 4, 4096);
+  out.resize(cap);
+  int rc = Z_OK;
+  size_t have = 0;
+  for (;;) {
+    if (have == out.size()) out.resize(out.size() * 2);
+    size_t room = std::min<size_t>(out.size() - have, 0x7FFFFFFF);
+    zs.next_out = (Bytef*)&out[have];
+    zs.avail_out = (uInt)room;
+    rc = inflate(&zs, Z_NO_FLUSH);
+    have += room - zs.avail_out;
+    if (rc == Z_STREAM_END) break;
+    if (rc == Z_OK) continue;
+    if (rc == Z_BUF_ERROR && zs.avail_out == 0) continue;
+    break;   // dados truncados/corrompidos
+  }
+  inflateEnd(&zs);
+  out.resize(have);
+  return rc == Z_STREAM_END || have > 0;
+}
+
+bool flate_encode(const uint8_t* p, size_t n, int level, int strategy, std::string& out) {
+  out.clear();
+  z_stream zs;
+  memset(&zs, 0, sizeof(zs));
+  if (deflateInit2(&zs, level, Z_DEFLATED, 15, 9, strategy ? Z_FILTERED : Z_DEFAULT_STRATEGY) != Z_OK)
+    return false;
+  out.resize(deflateBound(&zs, (uLong)n));
+  zs.next_in = const_cast<Bytef*>(p);
+  zs.avail_in = (uInt)n;
+  zs.next_out = (Bytef*)&out[0];
+  zs.avail_out = (uInt)out.size();
+  int rc = deflate(&zs, Z_FINISH);
+  out.resize(zs.total_out);
+  deflateEnd(&zs);
+  return rc == Z_STREAM_END;
+}
+
+bool apply_predictor(std::string& data, const Obj& parms) {
+  if (!parms.is_dict()) return true;
+  const Obj* pr = parms.get("Predictor");
+  int predictor = pr ? (int)pr->as_int(1) : 1;
+  if (predictor <= 1) return true;
+  const Obj* o;
+  int colors  = (o = parms.get("Colors"))           ? (int)o->as_int(1) : 1;
+  int bpc     = (o = parms.get("BitsPerComponent")) ? (int)o->as_int(8) : 8;
+  int columns = (o = parms.get("Columns"))          ? (int)o->as_int(1) : 1;
+  if (colors < 1 || colors > 32 || bpc < 1 || bpc > 16 || columns < 1) return false;
+  size_t row = ((size_t)colors * bpc * columns + 7) / 8;
+  size_t bpp = std::max<size_t>(1, (size_t)colors * bpc / 8);
+
+  if (predictor == 2) {
+    if (bpc != 8) return false;
+    for (size_t r = 0; r + row <= data.size(); r += row)
+      for (size_t k = bpp; k < row; ++k)
+        data[r + k] = (char)((uint8_t)data[r + k] + (uint8_t)data[r + k - bpp]);
+    return true;
+  }
+  if (predictor < 10) return false;
+
+  std::string out;
+  out.reserve(data.size());
+  std::vector<uint8_t> prev(row, 0), cur(row);
+  size_t pos = 0;
+  while (pos < data.size()) {
+    uint8_t ft = (uint8_t)data[pos++];
+    size_t take = std::min(row, data.size() - pos);
+    memcpy(cur.data(), data.data() + pos, take);
+    if (take < row) memset(cur.data() + take, 0, row - take);
+    pos += take;
+    for (size_t k = 0; k < row; ++k) {
+      uint8_t a = k >= bpp ? cur[k - bpp] : 0;
+      uint8_t b = prev[k];
+      uint8_t c = k >= bpp ? prev[k - bpp] : 0;
+      switch (ft) {
+        case 0: break;
+        case 1: cur[k] = (uint8_t)(cur[k] + a); break;
+        case 2: cur[k] = (uint8_t)(cur[k] + b); break;
+        case 3: cur[k] = (uint8_t)(cur[k] + ((a + b) >> 1)); break;
+        case 4: {
+          int p = a + b - c, pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+          cur[k] = (uint8_t)(cur[k] + ((pa <= pb && pa <= pc) ? a : (pb <= pc ? b : c)));
+          break;
+        }
+        default: return false;
+      }
+    }
+    out.append((const char*)cur.data(), take);
+    prev.swap(cur);
+  }
+  data.swap(out);
+  return true;
+}
+
+// ======================= Document =======================
+static const uint8_t* find_bytes(const uint8_t* hay, size_t n, const char* needle) {
+  size_t m = strlen(needle);
+  if (m == 0 || n < m) return nullptr;
+  const uint8_t* end = hay + n - m + 1;
+  for (const uint8_t* p = hay; p < end; ) {
+    p = (const uint8_t*)memchr(p, needle[0], (size_t)(end - p));
+    if (!p) return nullptr;
+    if (memcmp(p, needle, m) == 0) return p;
+    ++p;
+  }
+  return nullptr;
+}
+
+static const uint8_t* rfind_bytes(const uint8_t* hay, size_t n, const char* needle) {
+  size_t m = strlen(needle);
+  if (m == 0 || n < m) return nullptr;
+  for (size_t k = n - m + 1; k-- > 0; )
+    if (hay[k] == (uint8_t)needle[0] && memcmp(hay + k, needle, m) == 0) return hay + k;
+  return nullptr;
+}
+
+bool Document::open(const char* path) {
+  file_.reset(new MappedFile());
+  if (!file_->open(path)) { os_errno_ = file_->os_errno(); file_.reset(); return false; }
+  data_ = file_->data();
+  size_ = file_->size();
+  return init();
+}
+
+bool Document::open_memory(const uint8_t* data, size_t len) {
+  file_.reset();
+  data_ = data;
+  size_ = len;
+  return init();
+}
+
+bool Document::init() {
+  if (!data_ || size_ < 8) { health_ = XREF_BROKEN; return false; }
+
+  // header (tolera lixo antes de %PDF-)
+  const uint8_t* h = find_bytes(data_, std::min<size_t>(size_, 1024), "%PDF-");
+  if (h) {
+    header_off_ = (size_t)(h - data_);
+    if (header_off_ + 8 <= size_ && h[5] >= '0' && h[5] <= '9' && h[6] == '.' && h[7] >= '0' && h[7] <= '9')
+      version_ = (h[5] - '0') * 10 + (h[7] - '0');
+  }
+
+  // startxref nos últimos bytes
+  size_t tail = std::min<size_t>(size_, 4096);
+  const uint8_t* sx = rfind_bytes(data_ + size_ - tail, tail, "startxref");
+  bool ok = false;
+  if (sx) {
+    Lexer lx(data_, size_, (size_t)(sx - data_) + 9);
+    if (lx.next() == Lexer::T_INT && lx.ival() > 0 && (uint64_t)lx.ival() < size_) {
+      ok = read_xref_chain((size_t)lx.ival());
+      if (!ok && header_off_ > 0 && (uint64_t)lx.ival() + header_off_ < size_) {
+        // offsets relativos ao %PDF- quando há lixo antes do header
+        xref_.clear(); trailer_ = Obj(); xref_sections_ = 0;
+        ok = read_xref_chain((size_t)lx.ival() + header_off_);
+        if (ok) {
+          for (auto& e : xref_) if (e.type == 1) e.off += header_off_;
+        }
+      }
+    }
+  }
+
+  // confere /Root e /Pages; sem eles a xref não serve
+  if (ok) {
+    Obj r = root();
+    ok = r.is_dict() && get(r, "Pages").is_dict();
+  }
+  if (!ok) {
+    if (!repair()) { health_ = XREF_BROKEN; return false; }
+    health_ = XREF_REPAIRED;
+  }
+  detect_linearized();
+  return true;
+}
+
+size_t Document::object_count() const {
+  size_t n = 0;
+  for (auto& e : xref_) if (e.type != 0) ++n;
+  return n;
+}
+
+void Document::set_entry(uint32_t num, const XrefEntry& e, bool overwrite) {
+  if (num > 8388607) return;    // limite da especificação
+  if (num >= xref_.size()) xref_.resize((size_t)num + 1);
+  if (overwrite || (xref_[num].type == 0 && !(num < freed_.size() && freed_[num]))) xref_[num] = e;
+}
+
+void Document::mark_free(uint32_t num) {
+  if (num == 0 || num > 8388607) return;
+  if (num >= xref_.size()) xref_.resize((size_t)num + 1);
+  if (xref_[num].type != 0) return;               // já definido por uma seção mais nova
+  if (num >= freed_.size()) freed_.resize((size_t)num + 1);
+  freed_[num] = true;
+}
+
+bool Document::read_xref_chain(size_t startxref) {
+  std::unordered_set<size_t> seen;
+  size_t off = startxref;
+  bool first = true;
+  // as seções mais novas vêm primeiro: só preenchemos entradas ainda vazias (e não
+  // apagadas por uma seção mais nova, ver mark_free)
+  freed_.clear();
+  while (off > 0 && off < size_ && seen.insert(off).second && seen.size() < 512) {
+    Obj tr;
+    size_t prev = 0, xrefstm = 0;
+    Lexer lx(data_, size_, off);
+    lx.skip_ws();
+    size_t p0 = lx.pos();
+    bool table = (p0 + 4 <= size_ && memcmp(data_ + p0, "xref", 4) == 0);
+    std::vector<uint32_t> table_free;
+    bool ok = table ? read_xref_table(p0, tr, prev, xrefstm, table_free) : read_xref_stream(p0, tr, prev);
+    if (!ok) return !first && trailer_.is_dict();   // seção antiga ruim: fica com o que já temos
+    if (xrefstm > 0 && xrefstm < size_) {
+      Obj tr2; size_t prev2 = 0;
+      read_xref_stream(xrefstm, tr2, prev2);       // híbrido: complementa a tabela
+    }
+    // só depois do XRefStm da mesma seção: no híbrido, os objetos comprimidos aparecem
+    // livres na tabela e definidos no stream
+    for (uint32_t num : table_free) mark_free(num);
+    ++xref_sections_;
+    if (first) { trailer_ = tr; first = false; }
+    else if (tr.is_dict()) {
+      for (auto& kv : *tr.dict) if (!trailer_.get(kv.first.c_str())) trailer_.set(kv.first, kv.second);
+    }
+    off = prev;
+  }
+  return trailer_.is_dict() && trailer_.get("Root");
+}
+
+bool Document::read_xref_table(size_t off, Obj& trailer, size_t& prev, size_t& xrefstm,
+                               std::vector<uint32_t>& freed) {
+  Lexer lx(data_, size_, off);
+  if (lx.next() != Lexer::T_KEYWORD || lx.text() != "xref") return false;
+  for (;;) {
+    size_t save = lx.pos();
+    Lexer::Tok t = lx.next();
+    if (t == Lexer::T_KEYWORD && lx.text() == "trailer") break;
+    if (t != Lexer::T_INT) { lx.seek(save); return false; }
+    int64_t start = lx.ival();
+    if (lx.next() != Lexer::T_INT) return false;
+    int64_t count = lx.ival();
+    if (start < 0 || count < 0 || count > 8388608) return false;
+    for (int64_t k = 0; k < count; ++k) {
+      if (lx.next() != Lexer::T_INT) return false;
+      int64_t o = lx.ival();
+      if (lx.next() != Lexer::T_INT) return false;
+      int64_t g = lx.ival();
+      if (lx.next() != Lexer::T_KEYWORD) return false;
+      XrefEntry e;
+      if (lx.text() == "n" && o > 0) { e.type = 1; e.off = (uint64_t)o; e.gen = (uint32_t)g; }
+      // 'f' ou offset 0: livre nesta seção; read_xref_chain impede que as mais antigas
+      // o preencham (depois de ler o XRefStm da seção)
+      uint32_t num = (uint32_t)(start + k);
+      if (e.type) set_entry(num, e, false);
+      else freed.push_back(num);
+    }
+  }
+  if (!lx.parse(trailer) || !trailer.is_dict()) return false;
+  const Obj* p = trailer.get("Prev");
+  prev = p ? (size_t)p->as_int(0) : 0;
+  const Obj* x = trailer.get("XRefStm");
+  xrefstm = x ? (size_t)x->as_int(0) : 0;
+  return true;
+}
+
+bool Document::read_xref_stream(size_t off, Obj& trailer, size_t& prev) {
+  Indirect ind;
+  if (!load_at(off, 0, ind) || !ind.is_stream || !ind.value.is_dict()) return false;
+  const Obj& d = ind.value;
+  const Obj* type = d.get("Type");
+  if (!type || !type->is_name("XRef")) return false;
+  const Obj* w = d.get("W");
+  if (!w || !w->is_array() || w->arr->size() < 3) return false;
+  int W[3];
+  for (int k = 0; k < 3; ++k) {
+    W[k] = (int)(*w->arr)[k].as_int(-1);
+    if (W[k] < 0 || W[k] > 8) return false;
+  }
+  int rowlen = W[0] + W[1] + W[2];
+  if (rowlen == 0) return false;
+
+  std::string data;
+  if (!decode_stream(ind, data)) return false;
+
+  std::vector<std::pair<int64_t, int64_t>> index;
+  const Obj* idx = d.get("Index");
+  if (idx && idx->is_array()) {
+    for (size_t k = 0; k + 1 < idx->arr->size(); k += 2)
+      index.emplace_back((*idx->arr)[k].as_int(0), (*idx->arr)[k + 1].as_int(0));
+  } else {
+    const Obj* sz = d.get("Size");
+    index.emplace_back(0, sz ? sz->as_int(0) : 0);
+  }
+
+  size_t pos = 0;
+  const uint8_t* p = (const uint8_t*)data.data();
+  for (auto& sec : index) {
+    for (int64_t k = 0; k < sec.second; ++k) {
+      if (pos + (size_t)rowlen > data.size()) goto done;
+      uint64_t f[3] = {0, 0, 0};
+      for (int c = 0; c < 3; ++c) {
+        for (int b = 0; b < W[c]; ++b) f[c] = (f[c] << 8) | p[pos++];
+      }
+      if (W[0] == 0) f[0] = 1;
+      uint32_t num = (uint32_t)(sec.first + k);
+      XrefEntry e;
+      if (f[0] == 1 && f[1] > 0) { e.type = 1; e.off = f[1]; e.gen = (uint32_t)f[2]; }
+      else if (f[0] == 2)        { e.type = 2; e.off = f[1]; e.gen = (uint32_t)f[2]; }
+      if (e.type) set_entry(num, e, false);
+      else mark_free(num);
+    }
+  }
+done:
+  has_xref_stream_ = true;
+  trailer = d;
+  const Obj* pv = d.get("Prev");
+  prev = pv ? (size_t)pv->as_int(0) : 0;
+  return true;
+}
+
+// Determina início/comprimento dos dados do stream; valida com "endstream".
+bool Document::stream_extent(Indirect& ind, size_t data_start) {
+  size_t len = 0;
+  bool have_len = false;
+  const Obj* l = ind.value.get("Length");
+  if (l) {
+    if (l->is_int()) { len = (size_t)std::max<int64_t>(0, l->i); have_len = true; }
+    else if (l->is_ref() && l->ref_num() != ind.num) {
+      Obj lv = resolve(*l);
+      if (lv.is_int() && lv.i >= 0) { len = (size_t)lv.i; have_len = true; }
+    }
+  }
+  if (have_len && data_start + len <= size_) {
+    size_t q = data_start + len;
+    while (q < size_ && Lexer::is_ws(data_[q])) ++q;
+    if (q + 9 <= size_ && memcmp(data_ + q, "endstream", 9) == 0) {
+      ind.stream_off = data_start; ind.stream_len = len;
+      return true;
+    }
+  }
+  // /Length ausente ou errado: procura "endstream"
+  const uint8_t* e = find_bytes(data_ + data_start, size_ - data_start, "endstream");
+  if (!e) return false;
+  size_t end = (size_t)(e - data_);
+  if (end > data_start && data_[end - 1] == '\n') --end;
+  if (end > data_start && data_[end - 1] == '\r') --end;
+  ind.stream_off = data_start;
+  ind.stream_len = end - data_start;
+  return true;
+}
+
+bool Document::load_at(size_t off, uint32_t expect_num, Indirect& out) {
+  if (off >= size_) return false;
+  Lexer lx(data_, size_, off);
+  if (lx.next() != Lexer::T_INT) return false;
+  int64_t num = lx.ival();
+  if (lx.next() != Lexer::T_INT) return false;
+  int64_t gen = lx.ival();
+  if (lx.next() != Lexer::T_KEYWORD || lx.text() != "obj") return false;
+  if (expect_num && (uint32_t)num != expect_num) return false;
+  out = Indirect();
+  out.num = (uint32_t)num;
+  out.gen = (int)gen;
+  out.obj_off = off;
+  if (!lx.parse(out.value)) {
+    // "N G obj endobj" (vazio) é tolerado como null
+    if (lx.kw() == "endobj") { out.value = Obj(); return true; }
+    return false;
+  }
+  size_t save = lx.pos();
+  if (out.value.is_dict() && lx.next() == Lexer::T_KEYWORD && lx.text() == "stream") {
+    size_t p = lx.pos();
+    if (p < size_ && data_[p] == '\r') ++p;
+    if (p < size_ && data_[p] == '\n') ++p;
+    out.is_stream = true;
+    if (!stream_extent(out, p)) return false;
+  } else {
+    lx.seek(save);
+  }
+  return true;
+}
+
+Document::ObjStm* Document::objstm(uint32_t num) {
+  auto it = objstm_cache_.find(num);
+  if (it != objstm_cache_.end()) return it->second.get();
+  objstm_cache_[num] = nullptr;   // evita recursão em arquivos maliciosos
+  Indirect ind;
+  if (num >= xref_.size() || xref_[num].type != 1) return nullptr;
+  if (!load_at((size_t)xref_[num].off, num, ind) || !ind.is_stream) return nullptr;
+  std::unique_ptr<ObjStm> s(new ObjStm());
+  if (!decode_stream(ind, s->data)) return nullptr;
+  const Obj* n = ind.value.get("N");
+  const Obj* first = ind.value.get("First");
+  if (!n || !first) return nullptr;
+  int64_t count = n->as_int(0), fst = first->as_int(0);
+  if (count < 0 || fst < 0 || (size_t)fst > s->data.size()) return nullptr;
+  Lexer lx((const uint8_t*)s->data.data(), (size_t)fst);
+  for (int64_t k = 0; k < count; ++k) {
+    if (lx.next() != Lexer::T_INT) break;
+    int64_t onum = lx.ival();
+    if (lx.next() != Lexer::T_INT) break;
+    int64_t ooff = lx.ival();
+    if (onum < 0 || ooff < 0) break;
+    s->items.emplace_back((uint32_t)onum, (size_t)(fst + ooff));
+  }
+  ObjStm* raw = s.get();
+  objstm_cache_[num] = std::move(s);
+  return raw;
+}
+
+bool Document::load_from_objstm(uint32_t stm_num, uint32_t index, uint32_t expect_num, Indirect& out) {
+  ObjStm* s = objstm(stm_num);
+  if (!s) return false;
+  size_t off = 0;
+  bool found = false;
+  if (index < s->items.size() && s->items[index].first == expect_num) { off = s->items[index].second; found = true; }
+  else {
+    for (auto& it : s->items) if (it.first == expect_num) { off = it.second; found = true; break; }
+  }
+  if (!found || off >= s->data.size()) return false;
+  Lexer lx((const uint8_t*)s->data.data(), s->data.size(), off);
+  out = Indirect();
+  out.num = expect_num;
+  out.in_objstm = stm_num;
+  return lx.parse(out.value);
+}
+
+bool Document::load(uint32_t num, Indirect& out) {
+  if (num == 0 || num >= xref_.size()) return false;
+  const XrefEntry& e = xref_[num];
+  if (e.type == 1) return load_at((size_t)e.off, num, out);
+  if (e.type == 2) return load_from_objstm((uint32_t)e.off, e.gen, num, out);
+  return false;
+}
+
+Obj Document::resolve(const Obj& o) {
+  if (!o.is_ref()) return o;
+  if (resolve_depth_ > 32) return Obj();
+  ++resolve_depth_;
+  Indirect ind;
+  Obj r;
+  if (load(o.ref_num(), ind)) r = resolve(ind.value);
+  --resolve_depth_;
+  return r;
+}
+
+Obj Document::get(const Obj& dict, const char* key) {
+  const Obj* v = dict.get(key);
+  return v ? resolve(*v) : Obj();
+}
+
+Obj Document::root() {
+  const Obj* r = trailer_.get("Root");
+  return r ? resolve(*r) : Obj();
+}
+
+bool Document::stream_is_flate_only(const Obj& dict) {
+  const Obj* f = dict.get("Filter");
+  if (!f || f->is_null()) return true;
+  auto flate = [](const Obj& n){ return n.is_name("FlateDecode") || n.is_name("Fl"); };
+  if (f->is_name()) return flate(*f);
+  if (f->is_array()) {
+    for (auto& x : *f->arr) if (!flate(x)) return false;
+    return true;
+  }
+  return false;
+}
+
+bool Document::decode_stream(const Indirect& ind, std::string& out) {
+  out.clear();
+  if (!ind.is_stream || ind.stream_off + ind.stream_len > size_) return false;
+  const Obj& d = ind.value;
+  if (!stream_is_flate_only(d)) return false;
+  Obj filter = resolve(d.get("Filter") ? *d.get("Filter") : Obj());
+  Obj parms  = resolve(d.get("DecodeParms") ? *d.get("DecodeParms") : Obj());
+  int nfilters = filter.is_name() ? 1 : (filter.is_array() ? (int)filter.arr->size() : 0);
+  if (nfilters == 0) { out.assign((const char*)data_ + ind.stream_off, ind.stream_len); return true; }
+
+  std::string cur((const char*)data_ + ind.stream_off, ind.stream_len);
+  for (int k = 0; k < nfilters; ++k) {
+    std::string dec;
+    if (!flate_decode((const uint8_t*)cur.data(), cur.size(), dec)) return false;
+    Obj pk = parms.is_array() ? (k < (int)parms.arr->size() ? resolve((*parms.arr)[k]) : Obj()) : parms;
+    if (!apply_predictor(dec, pk)) return false;
+    cur.swap(dec);
+  }
+  out.swap(cur);
+  return true;
+}
+
+void Document::detect_linearized() {
+  linearized_ = false;
+  size_t scan = std::min<size_t>(size_, 1024);
+  const uint8_t* o = find_bytes(data_ + header_off_, scan > header_off_ ? scan - header_off_ : 0, " obj");
+  if (!o) return;
+  // volta até o início de "N G obj"
+  size_t p = (size_t)(o - data_);
+  int fields = 0;
+  while (p > header_off_ && fields < 2) {
+    while (p > header_off_ && Lexer::is_ws(data_[p - 1])) --p;
+    while (p > header_off_ && data_[p - 1] >= '0' && data_[p - 1] <= '9') --p;
+    ++fields;
+  }
+  Indirect ind;
+  if (!load_at(p, 0, ind) || !ind.value.is_dict()) return;
+  const Obj* lin = ind.value.get("Linearized");
+  const Obj* len = ind.value.get("L");
+  linearized_ = lin && len && (size_t)len->as_int(0) == size_;
+}
+
+// ----------------------- Varredura de reparo -----------------------
+bool Document::repair() {
+  xref_.clear();
+  freed_.clear();
+  objstm_cache_.clear();
+  has_xref_stream_ = false;
+  Obj last_trailer;
+
+  // 1) todas as ocorrências de "N G obj" (a última definição de cada número vence)
+  const uint8_t* p = data_;
+  const uint8_t* end = data_ + size_;
+  while (p + 3 <= end) {
+    p = (const uint8_t*)memchr(p, 'o', (size_t)(end - p));
+    if (!p || p + 3 > end) break;
+    if (p[1] != 'b' || p[2] != 'j' || (p + 3 < end && !Lexer::is_ws(p[3]) && !Lexer::is_delim(p[3]))) { ++p; continue; }
+    size_t q = (size_t)(p - data_);
+    size_t k = q;
+    auto back_ws = [&](){ size_t c = 0; while (k > 0 && Lexer::is_ws(data_[k - 1])) { --k; ++c; } return c; };
+    auto back_num = [&](uint64_t& v){
+      size_t e = k; while (k > 0 && data_[k - 1] >= '0' && data_[k - 1] <= '9' && e - k < 10) --k;
+      if (k == e) return false;
+      v = strtoull(std::string((const char*)data_ + k, e - k).c_str(), nullptr, 10);
+      return true;
+    };
+    uint64_t gen = 0, num = 0;
+    if (back_ws() > 0 && back_num(gen) && back_ws() > 0 && back_num(num) &&
+        (k == 0 || Lexer::is_ws(data_[k - 1]) || Lexer::is_delim(data_[k - 1])) && num > 0 && gen < 65536) {
+      XrefEntry e; e.type = 1; e.off = k; e.gen = (uint32_t)gen;
+      set_entry((uint32_t)num, e, true);
+    }
+    p += 3;
+  }
+
+  // 2) trailers clássicos (o último com /Root vence)
+  for (const uint8_t* t = data_; t < end; ) {
+    const uint8_t* f = find_bytes(t, (size_t)(end - t), "trailer");
+    if (!f) break;
+    Lexer lx(data_, size_, (size_t)(f - data_) + 7);
+    Obj d;
+    if (lx.parse(d) && d.is_dict() && d.get("Root")) last_trailer = d;
+    t = f + 7;
+  }
+
+  // 3) object streams, xref streams e catálogos
+  uint32_t catalog = 0;
+  std::vector<uint32_t> stms;
+  for (uint32_t n = 1; n < xref_.size(); ++n) {
+    if (xref_[n].type != 1) continue;
+    Indirect ind;
+    if (!load_at((size_t)xref_[n].off, n, ind) || !ind.value.is_dict()) continue;
+    const Obj* type = ind.value.get("Type");
+    if (!type || !type->is_name()) continue;
+    if (type->s == "ObjStm" && ind.is_stream) stms.push_back(n);
+    else if (type->s == "XRef" && ind.value.get("Root") && !last_trailer.is_dict()) last_trailer = ind.value;
+    else if (type->s == "Catalog") catalog = n;
+  }
+  for (uint32_t s : stms) {
+    ObjStm* os = objstm(s);
+    if (!os) continue;
+    for (size_t k = 0; k < os->items.size(); ++k) {
+      XrefEntry e; e.type = 2; e.off = s; e.gen = (uint32_t)k;
+      set_entry(os->items[k].first, e, false);    // definição direta tem prioridade
+    }
+  }
+
+  trailer_ = Obj::make_dict();
+  if (last_trailer.is_dict()) {
+    for (auto& kv : *last_trailer.dict) {
+      const std::string& key = kv.first;
+      if (key == "Root" || key == "Info" || key == "ID" || key == "Encrypt") trailer_.set(key, kv.second);
+    }
+  }
+  Obj r = root();
+  if ((!r.is_dict() || !get(r, "Pages").is_dict()) && catalog) {
+    trailer_.set("Root", Obj::make_ref(catalog, (int)xref_[catalog].gen));
+    r = root();
+  }
+  trailer_.set("Size", Obj::make_int((int64_t)xref_.size()));
+  return r.is_dict() && get(r, "Pages").is_dict();
+}
+
+// ----------------------- Árvore de páginas -----------------------
+bool Document::pages(std::vector<PageInfo>& out) {
+  out.clear();
+  Obj r = root();
+  const Obj* pref = r.get("Pages");
+  if (!pref || !pref->is_ref()) return false;
+
+  struct Node { uint32_t num; Obj res, mbox, cbox, rot; };
+  std::vector<Node> stack;
+  std::unordered_set<uint32_t> visited;
+  stack.push_back(Node{pref->ref_num(), Obj(), Obj(), Obj(), Obj()});
+
+  while (!stack.empty()) {
+    Node n = std::move(stack.back());
+    stack.pop_back();
+    if (!visited.insert(n.num).second) continue;
+    Indirect ind;
+    if (!load(n.num, ind) || !ind.value.is_dict()) continue;
+    const Obj& d = ind.value;
+
+    auto inherit = [&](const char* key, Obj& slot){ const Obj* v = d.get(key); if (v) slot = *v; };
+    inherit("Resources", n.res);
+    inherit("MediaBox", n.mbox);
+    inherit("CropBox", n.cbox);
+    inherit("Rotate", n.rot);
+
+    Obj kids = get(d, "Kids");
+    const Obj* type = d.get("Type");
+    bool is_pages = kids.is_array() && !(type && type->is_name("Page"));
+    if (!is_pages) {
+      PageInfo pi;
+      pi.num = n.num; pi.gen = ind.gen; pi.dict = d;
+      pi.resources = n.res; pi.media_box = n.mbox; pi.crop_box = n.cbox; pi.rotate = n.rot;
+      out.push_back(std::move(pi));
+      continue;
+    }
+    // empilha na ordem inversa para visitar da esquerda para a direita
+    for (size_t k = kids.arr->size(); k-- > 0; ) {
+      const Obj& kid = (*kids.arr)[k];
+      if (kid.is_ref()) stack.push_back(Node{kid.ref_num(), n.res, n.mbox, n.cbox, n.rot});
+    }
+  }
+  return true;
+}
+
+int Document::page_count_fast() {
+  Obj r = root();
+  Obj pages_node = get(r, "Pages");
+  if (!pages_node.is_dict()) return -1;
+  Obj count = get(pages_node, "Count");
+  Obj kids = get(pages_node, "Kids");
+  if (count.is_int() && count.i >= 0 && kids.is_array()) {
+    int64_t sum = 0;
+    bool ok = true;
+    for (auto& k : *kids.arr) {
+      Obj kid = resolve(k);
+      if (!kid.is_dict()) { ok = false; break; }
+      Obj kc = get(kid, "Kids");
+      if (kc.is_array()) {
+        Obj c = get(kid, "Count");
+        if (!c.is_int() || c.i < 0) { ok = false; break; }
+        sum += c.i;
+      } else {
+        sum += 1;
+      }
+    }
+    if (ok && sum == count.i) return (int)count.i;
+  }
+  std::vector<PageInfo> all;
+  if (!pages(all)) return -1;
+  return (int)all.size();
+}
+
+// ======================= Escrita =======================
+static bool is_regular(char c) {
+  return !Lexer::is_ws((uint8_t)c) && !Lexer::is_delim((uint8_t)c);
+}
+
+// Acrescenta um token "regular" (número/keyword), separando do anterior se preciso.
+static void put_token(std::string& out, const char* t, size_t n) {
+  if (!out.empty() && is_regular(out.back())) out.push_back(' ');
+  out.append(t, n);
+}
+
+static void put_int(std::string& out, int64_t v) {
+  char b[32];
+  int n = snprintf(b, sizeof(b), "%lld", (long long)v);
+  put_token(out, b, (size_t)n);
+}
+
+static void put_real(std::string& out, double v) {
+  char b[64];
+  if (!(v == v) || v > 1e15 || v < -1e15) v = 0;   // NaN/inf não existem em PDF
+  int n = snprintf(b, sizeof(b), "%.6f", v);
+  while (n > 0 && b[n - 1] == '0') --n;
+  if (n > 0 && b[n - 1] == '.') --n;
+  if (n == 0 || (n == 1 && b[0] == '-') || (n == 2 && b[0] == '-' && b[1] == '0')) { b[0] = '0'; n = 1; }
+  put_token(out, b, (size_t)n);
+}
+
+static void put_name(std::string& out, const std::string& n) {
+  static const char* hx = "0123456789ABCDEF";
+  out.push_back('/');
+  for (unsigned char c : n) {
+    if (c < 0x21 || c > 0x7E || c == '#' || Lexer::is_delim(c)) {
+      out.push_back('#'); out.push_back(hx[c >> 4]); out.push_back(hx[c & 15]);
+    } else {
+      out.push_back((char)c);
+    }
+  }
+}
+
+static void put_string(std::string& out, const std::string& v, bool hex) {
+  if (hex) {
+    static const char* hx = "0123456789abcdef";
+    out.push_back('<');
+    for (unsigned char c : v) { out.push_back(hx[c >> 4]); out.push_back(hx[c & 15]); }
+    out.push_back('>');
+    return;
+  }
+  out.push_back('(');
+  for (char c : v) {
+    if (c == '(' || c == ')' || c == '\\') { out.push_back('\\'); out.push_back(c); }
+    else if (c == '\r') out += "\\r";      // EOL cru seria normalizado pelo leitor
+    else out.push_back(c);
+  }
+  out.push_back(')');
+}
+
+void serialize(const Obj& o, std::string& out) {
+  switch (o.type) {
+    case Type::Null:   put_token(out, "null", 4); break;
+    case Type::Bool:   o.b ? put_token(out, "true", 4) : put_token(out, "false", 5); break;
+    case Type::Int:    put_int(out, o.i); break;
+    case Type::Real:   put_real(out, o.r); break;
+    case Type::Name:   put_name(out, o.s); break;
+    case Type::String: put_string(out, o.s, o.hex); break;
+    case Type::Ref:
+      put_int(out, o.i); put_int(out, o.gen); put_token(out, "R", 1);
+      break;
+    case Type::Array:
+      out.push_back('[');
+      if (o.arr) for (auto& v : *o.arr) serialize(v, out);
+      out.push_back(']');
+      break;
+    case Type::Dict:
+      out += "<<";
+      if (o.dict) for (auto& kv : *o.dict) { put_name(out, kv.first); serialize(kv.second, out); }
+      out += ">>";
+      break;
+  }
+}
+
+bool Writer::open(const char* path, int version) {
+  close();
+  err_ = 0;
+#ifdef _WIN32
+  f_ = _wfopen(utf8_to_wide(path).c_str(), L"wb");
+#else
+  f_ = std::fopen(path, "wb");
+#endif
+  if (!f_) { err_ = errno; return false; }
+  pos_ = 0;
+  buf_.clear();
+  buf_.reserve(1 << 20);
+  offsets_.assign(1, 0);
+  gens_.assign(1, 0);
+  in_stm_.assign(1, 0);
+  pend_.clear();
+  pend_items_.clear();
+  objstms_ = 0;
+  packed_ = 0;
+  if (version < 10 || version > 20) version = 17;
+  if (compact_ && version < 15) version = 15;   // object/xref streams exigem PDF 1.5
+  char hdr[32];
+  int n = snprintf(hdr, sizeof(hdr), "%%PDF-%d.%d\n%%\xE2\xE3\xCF\xD3\n", version / 10, version % 10);
+  return put(hdr, (size_t)n);
+}
+
+uint32_t Writer::reserve() {
+  offsets_.push_back(0);
+  gens_.push_back(0);
+  in_stm_.push_back(0);
+  return (uint32_t)(offsets_.size() - 1);
+}
+
+bool Writer::flush() {
+  if (!f_) return false;
+  if (!buf_.empty()) {
+    if (std::fwrite(buf_.data(), 1, buf_.size(), f_) != buf_.size()) { err_ = errno ? errno : EIO; return false; }
+    pos_ += buf_.size();
+    buf_.clear();
+  }
+  return true;
+}
+
+bool Writer::put(const void* p, size_t n) {
+  if (!f_) return false;
+  if (buf_.size() + n <= buf_.capacity()) { buf_.append((const char*)p, n); return true; }
+  if (!flush()) return false;
+  if (n >= buf_.capacity()) {
+    // blocos grandes (dados de stream) vão direto, sem passar pelo buffer
+    if (std::fwrite(p, 1, n, f_) != n) { err_ = errno ? errno : EIO; return false; }
+    pos_ += n;
+    return true;
+  }
+  buf_.append((const char*)p, n);
+  return true;
+}
+
+bool Writer::write_object(uint32_t num, const Obj& value) {
+  if (num == 0 || num >= offsets_.size()) return false;
+  if (compact_) {
+    // vai para o object stream em montagem; a xref aponta para (stream, índice)
+    pend_items_.push_back(std::make_pair(num, pend_.size()));
+    serialize(value, pend_);
+    pend_.push_back('\n');
+    ++packed_;
+    if (pend_items_.size() >= kObjStmMaxObjects || pend_.size() >= kObjStmMaxBytes) return flush_objstm();
+    return true;
+  }
+  offsets_[num] = bytes_written();
+  tmp_.clear();
+  put_int(tmp_, num);
+  tmp_ += " 0 obj\n";
+  serialize(value, tmp_);
+  tmp_ += "\nendobj\n";
+  return put(tmp_.data(), tmp_.size());
+}
+
+bool Writer::write_stream(uint32_t num, const Obj& dict, const uint8_t* data, size_t len) {
+  if (num == 0 || num >= offsets_.size()) return false;
+  offsets_[num] = bytes_written();
+  Obj d = dict;
+  if (d.dict) d.dict = std::make_shared<Dict>(*d.dict);   // não altera o dicionário do chamador
+  else d = Obj::make_dict();
+  d.set("Length", Obj::make_int((int64_t)len));
+  tmp_.clear();
+  put_int(tmp_, num);
+  tmp_ += " 0 obj\n";
+  serialize(d, tmp_);
+  tmp_ += "\nstream\n";
+  if (!put(tmp_.data(), tmp_.size())) return false;
+  if (len && !put(data, len)) return false;
+  static const char tail[] = "\nendstream\nendobj\n";
+  return put(tail, sizeof(tail) - 1);
+}
+
+bool Writer::write_raw(uint32_t num, int gen, const uint8_t* data, size_t len) {
+  if (num == 0 || num >= offsets_.size() || gen < 0 || gen > 65535) return false;
+  offsets_[num] = bytes_written();
+  gens_[num] = (uint16_t)gen;
+  static const char nl = '\n';
+  return put(data, len) && put(&nl, 1);
+}
+
+bool Writer::flush_objstm() {
+  if (pend_items_.empty()) return true;
+  const uint32_t num = reserve();
+  std::string head;
+  for (auto& it : pend_items_) {
+    put_int(head, it.first);
+    put_int(head, (int64_t)it.second);
+  }
+  head.push_back('\n');
+  std::string raw = head + pend_;
+  std::string z;
+  if (!flate_encode((const uint8_t*)raw.data(), raw.size(), 9, 0, z)) return false;
+  Obj d = Obj::make_dict();
+  d.set("Type", Obj::make_name("ObjStm"));
+  d.set("N", Obj::make_int((int64_t)pend_items_.size()));
+  d.set("First", Obj::make_int((int64_t)head.size()));
+  d.set("Filter", Obj::make_name("FlateDecode"));
+  for (size_t k = 0; k < pend_items_.size(); ++k) {
+    in_stm_[pend_items_[k].first] = num;
+    gens_[pend_items_[k].first] = (uint16_t)k;       // tipo 2: índice dentro do stream
+  }
+  pend_.clear();
+  pend_items_.clear();
+  ++objstms_;
+  return write_stream(num, d, (const uint8_t*)z.data(), z.size());
+}
+
+// Xref stream (PDF 1.5): /W [1 n 2], linhas com preditor PNG Up e Flate.
+bool Writer::finish_xref_stream(const Obj& trailer) {
+  if (!flush_objstm()) return false;
+  const uint32_t num = reserve();
+  const uint64_t xref_off = bytes_written();
+  offsets_[num] = xref_off;
+  int w1 = 1;
+  while (w1 < 8 && (xref_off >> (8 * w1)) != 0) ++w1;
+  for (size_t k = 1; k < offsets_.size(); ++k)
+    if (in_stm_[k] > 0 && w1 < 4 && (in_stm_[k] >> (8 * w1)) != 0) ++w1;
+  const int cols = 1 + w1 + 2;
+  std::string rows;
+  rows.reserve(offsets_.size() * (size_t)(cols + 1));
+  std::vector<uint8_t> prev((size_t)cols, 0), cur((size_t)cols);
+  for (size_t k = 0; k < offsets_.size(); ++k) {
+    uint64_t f2;
+    unsigned f3;
+    if (in_stm_[k]) { cur[0] = 2; f2 = in_stm_[k]; f3 = gens_[k]; }
+    else if (k && offsets_[k]) { cur[0] = 1; f2 = offsets_[k]; f3 = gens_[k]; }
+    else { cur[0] = 0; f2 = 0; f3 = k ? 1 : 65535; }   // livre (reservado e nunca gravado)
+    for (int b = 0; b < w1; ++b) cur[(size_t)(1 + b)] = (uint8_t)(f2 >> (8 * (w1 - 1 - b)));
+    cur[(size_t)(1 + w1)] = (uint8_t)(f3 >> 8);
+    cur[(size_t)(2 + w1)] = (uint8_t)f3;
+    rows.push_back(2);                                  // PNG Up
+    for (int c = 0; c < cols; ++c) rows.push_back((char)(uint8_t)(cur[(size_t)c] - prev[(size_t)c]));
+    prev = cur;
+  }
+  std::string z;
+  if (!flate_encode((const uint8_t*)rows.data(), rows.size(), 9, 0, z)) return false;
+
+  Obj d = trailer.is_dict() ? trailer : Obj::make_dict();
+  if (d.dict) d.dict = std::make_shared<Dict>(*d.dict);
+  d.erase("Prev");
+  d.erase("XRefStm");
+  d.set("Type", Obj::make_name("XRef"));
+  d.set("Size", Obj::make_int((int64_t)offsets_.size()));
+  Obj w = Obj::make_array();
+  w.arr->push_back(Obj::make_int(1));
+  w.arr->push_back(Obj::make_int(w1));
+  w.arr->push_back(Obj::make_int(2));
+  d.set("W", w);
+  d.set("Filter", Obj::make_name("FlateDecode"));
+  Obj parms = Obj::make_dict();
+  parms.set("Predictor", Obj::make_int(12));
+  parms.set("Columns", Obj::make_int(cols));
+  d.set("DecodeParms", parms);
+  d.set("Length", Obj::make_int((int64_t)z.size()));
+  tmp_.clear();
+  put_int(tmp_, num);
+  tmp_ += " 0 obj\n";
+  serialize(d, tmp_);
+  tmp_ += "\nstream\n";
+  if (!put(tmp_.data(), tmp_.size()) || !put(z.data(), z.size())) return false;
+  tmp_.clear();
+  tmp_ += "\nendstream\nendobj\nstartxref\n";
+  tmp_ += std::to_string(xref_off);
+  tmp_ += "\n%%EOF\n";
+  return put(tmp_.data(), tmp_.size()) && finish_raw();
+}
+
+bool Writer::finish(const Obj& trailer) {
+  if (!f_) return false;
+  if (compact_) return finish_xref_stream(trailer);
+  uint64_t xref_off = bytes_written();
+  tmp_.clear();
+  tmp_ += "xref\n0 ";
+  tmp_ += std::to_string(offsets_.size());
+  tmp_ += "\n0000000000 65535 f\r\n";
+  if (!put(tmp_.data(), tmp_.size())) return false;
+  char line[32];
+  for (size_t k = 1; k < offsets_.size(); ++k) {
+    // objetos reservados e nunca gravados viram entradas livres
+    if (offsets_[k]) snprintf(line, sizeof(line), "%010llu %05u n\r\n", (unsigned long long)offsets_[k], (unsigned)gens_[k]);
+    else snprintf(line, sizeof(line), "0000000000 00001 f\r\n");
+    if (!put(line, 20)) return false;
+  }
+  Obj t = trailer.is_dict() ? trailer : Obj::make_dict();
+  if (t.dict) t.dict = std::make_shared<Dict>(*t.dict);
+  t.set("Size", Obj::make_int((int64_t)offsets_.size()));
+  tmp_.clear();
+  tmp_ += "trailer\n";
+  serialize(t, tmp_);
+  tmp_ += "\nstartxref\n";
+  tmp_ += std::to_string(xref_off);
+  tmp_ += "\n%%EOF\n";
+  return put(tmp_.data(), tmp_.size()) && finish_raw();
+}
+
+bool Writer::finish_raw() {
+  if (!flush()) return false;
+  int rc = std::fclose(f_);
+  f_ = nullptr;
+  if (rc != 0) { err_ = errno ? errno : EIO; return false; }
+  return true;
+}
+
+void Writer::close() {
+  if (f_) { std::fclose(f_); f_ = nullptr; }
+  buf_.clear();
+  pend_.clear();
+  pend_items_.clear();
+}
+
+}  // namespace gsx_pdf
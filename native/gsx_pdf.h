@@ -0,0 +1,359 @@
+// gsx_pdf.h — leitor/escritor PDF mínimo (xref, objetos, object streams, árvore de
+// páginas) usado pelas rotinas nativas do gsx_bridge que NÃO precisam do Ghostscript.
+//
+// Escopo: apenas o necessário para inspecionar/planejar/copiar estrutura.
+//  - arquivo mapeado em memória (mmap / MapViewOfFile), sem cópia
+//  - xref clássica, xref stream, híbrida e cadeia /Prev
+//  - object streams (/Type /ObjStm)
+//  - FlateDecode (+ preditores PNG/TIFF); demais filtros ficam "crus"
+//  - varredura de reparo quando a xref está danificada
+//
+// Não é thread-safe: use um Document por thread.
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace gsx_pdf {
+
+// ======================= Arquivo mapeado =======================
+class MappedFile {
+public:
+  MappedFile() = default;
+  ~MappedFile() { close(); }
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  bool open(const char* path);   // false => os_errno() tem o motivo
+  void close();
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  int os_errno() const { return err_; }
+
+private:
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  int err_ = 0;
+#ifdef _WIN32
+  void* file_ = nullptr;
+  void* map_ = nullptr;
+#else
+  int fd_ = -1;
+#endif
+};
+
+// ======================= Objetos =======================
+enum class Type : uint8_t { Null, Bool, Int, Real, Name, String, Array, Dict, Ref };
+
+struct Obj;
+using Array = std::vector<Obj>;
+using Dict  = std::vector<std::pair<std::string, Obj>>;
+
+struct Obj {
+  Type type = Type::Null;
+  bool hex = false;        // String originalmente escrita como <...>
+  bool b = false;          // Bool
+  int gen = 0;             // Ref: geração
+  int64_t i = 0;           // Int; Ref: número do objeto
+  double r = 0;            // Real
+  std::string s;           // Name (sem '/', #xx já decodificado) ou String (bytes crus)
+  std::shared_ptr<Array> arr;
+  std::shared_ptr<Dict> dict;
+
+  bool is_null()   const { return type == Type::Null; }
+  bool is_int()    const { return type == Type::Int; }
+  bool is_num()    const { return type == Type::Int || type == Type::Real; }
+  bool is_name()   const { return type == Type::Name; }
+  bool is_string() const { return type == Type::String; }
+  bool is_array()  const { return type == Type::Array && arr; }
+  bool is_dict()   const { return type == Type::Dict && dict; }
+  bool is_ref()    const { return type == Type::Ref; }
+  bool is_name(const char* n) const { return type == Type::Name && s == n; }
+
+  int64_t as_int(int64_t def = 0) const {
+    return type == Type::Int ? i : (type == Type::Real ? (int64_t)r : def);
+  }
+  double as_num(double def = 0) const {
+    return type == Type::Int ? (double)i : (type == Type::Real ? r : def);
+  }
+  uint32_t ref_num() const { return type == Type::Ref ? (uint32_t)i : 0; }
+
+  // Dict: valor direto (sem resolver referências); nullptr se ausente
+  const Obj* get(const char* key) const;
+  Obj* get(const char* key);
+  void set(const std::string& key, Obj v);   // substitui ou acrescenta
+  void erase(const char* key);
+
+  static Obj make_bool(bool v);
+  static Obj make_int(int64_t v);
+  static Obj make_real(double v);
+  static Obj make_name(const std::string& n);
+  static Obj make_string(const std::string& bytes, bool hex = false);
+  static Obj make_ref(uint32_t num, int gen = 0);
+  static Obj make_array();
+  static Obj make_dict();
+};
+
+// Objeto indireto carregado ("N G obj ... endobj")
+struct Indirect {
+  uint32_t num = 0;
+  int gen = 0;
+  Obj value;
+  bool is_stream = false;
+  size_t stream_off = 0;   // 1º byte dos dados do stream (no buffer do documento)
+  size_t stream_len = 0;   // bytes codificados (como estão no arquivo)
+  size_t obj_off = 0;      // início de "N G obj" (0 se veio de object stream)
+  uint32_t in_objstm = 0;  // != 0 => número do object stream de origem
+};
+
+// ======================= Léxico / parser =======================
+class Lexer {
+public:
+  enum Tok { T_EOF, T_ERR, T_INT, T_REAL, T_NAME, T_STR, T_HEXSTR,
+             T_ARR_OPEN, T_ARR_CLOSE, T_DICT_OPEN, T_DICT_CLOSE, T_KEYWORD };
+
+  Lexer(const uint8_t* base, size_t len, size_t pos = 0)
+    : p_(base), n_(len), pos_(pos) {}
+
+  size_t pos() const { return pos_; }
+  void seek(size_t pos) { pos_ = pos; }
+  const uint8_t* base() const { return p_; }
+  size_t size() const { return n_; }
+
+  void skip_ws();                       // espaços + comentários
+  Tok next();                           // texto em text(), números em ival()/rval()
+  const std::string& text() const { return text_; }
+  int64_t ival() const { return ival_; }
+  double rval() const { return rval_; }
+
+  // Objeto completo (resolve "N G R" para Ref). false em erro/keyword inesperada;
+  // nesse caso kw() contém a keyword encontrada (p.ex. "endobj", "stream").
+  bool parse(Obj& out, int depth = 0);
+  const std::string& kw() const { return text_; }
+
+  static bool is_ws(uint8_t c) {
+    return c == 0 || c == 9 || c == 10 || c == 12 || c == 13 || c == 32;
+  }
+  static bool is_delim(uint8_t c) {
+    return c == '(' || c == ')' || c == '<' || c == '>' || c == '[' || c == ']' ||
+           c == '{' || c == '}' || c == '/' || c == '%';
+  }
+
+private:
+  const uint8_t* p_;
+  size_t n_;
+  size_t pos_;
+  std::string text_;
+  int64_t ival_ = 0;
+  double rval_ = 0;
+};
+
+// ======================= Documento =======================
+struct XrefEntry {
+  uint8_t type = 0;    // 0=livre/ausente, 1=offset no arquivo, 2=dentro de object stream
+  uint64_t off = 0;    // type 1: offset; type 2: número do object stream
+  uint32_t gen = 0;    // type 1: geração; type 2: índice dentro do object stream
+};
+
+enum XrefHealth {
+  XREF_OK       = 0,   // xref lida e consistente
+  XREF_REPAIRED = 1,   // xref ausente/danificada; reconstruída por varredura
+  XREF_BROKEN   = 2    // nem a varredura encontrou /Root
+};
+
+// Página com atributos herdáveis já resolvidos (Resources/MediaBox/CropBox/Rotate)
+struct PageInfo {
+  uint32_t num = 0;
+  int gen = 0;
+  Obj dict;            // dicionário da página (como está no arquivo)
+  Obj resources;       // herdado se ausente na página
+  Obj media_box;
+  Obj crop_box;
+  Obj rotate;
+};
+
+class Document {
+public:
+  Document() = default;
+  Document(const Document&) = delete;
+  Document& operator=(const Document&) = delete;
+
+  bool open(const char* path);                         // mapeia o arquivo
+  bool open_memory(const uint8_t* data, size_t len);   // não copia: 'data' deve sobreviver ao Document
+
+  const uint8_t* data() const { return data_; }
+  size_t size() const { return size_; }
+  int os_errno() const { return os_errno_; }
+
+  int version() const { return version_; }             // 17 == "%PDF-1.7"; 0 se sem header
+  size_t header_offset() const { return header_off_; }
+  const Obj& trailer() const { return trailer_; }
+  const std::vector<XrefEntry>& xref() const { return xref_; }
+  XrefHealth health() const { return health_; }
+  bool has_xref_stream() const { return has_xref_stream_; }
+  int xref_sections() const { return xref_sections_; }
+  bool encrypted() const { return trailer_.get("Encrypt") != nullptr; }
+  bool linearized() const { return linearized_; }
+  size_t object_count() const;                         // entradas em uso na xref
+
+  bool load(uint32_t num, Indirect& out);
+  Obj resolve(const Obj& o);                           // segue Refs (com limite de profundidade)
+  Obj get(const Obj& dict, const char* key);           // dict[key] já resolvido
+  Obj root();                                          // /Root resolvido
+
+  // Decodifica um stream (sem filtro ou FlateDecode com preditores).
+  // false se o filtro não é suportado ou os dados estão corrompidos.
+  bool decode_stream(const Indirect& ind, std::string& out);
+  static bool stream_is_flate_only(const Obj& dict);
+
+  // Percorre a árvore de páginas em ordem. false se /Root//Pages inexistente.
+  bool pages(std::vector<PageInfo>& out);
+  // Contagem rápida: /Count da raiz, conferida com os filhos diretos.
+  int page_count_fast();
+
+  // Reconstrói a xref varrendo o arquivo inteiro ("N G obj").
+  bool repair();
+
+private:
+  bool init();
+  bool read_xref_chain(size_t startxref);
+  bool read_xref_table(size_t off, Obj& trailer, size_t& prev, size_t& xrefstm, std::vector<uint32_t>& freed);
+  bool read_xref_stream(size_t off, Obj& trailer, size_t& prev);
+  void set_entry(uint32_t num, const XrefEntry& e, bool overwrite);
+  void mark_free(uint32_t num);
+  bool load_at(size_t off, uint32_t expect_num, Indirect& out);
+  bool load_from_objstm(uint32_t stm_num, uint32_t index, uint32_t expect_num, Indirect& out);
+  bool stream_extent(Indirect& ind, size_t data_start);
+  void detect_linearized();
+
+  struct ObjStm {
+    std::string data;
+    std::vector<std::pair<uint32_t, size_t>> items;   // (num, offset absoluto em data)
+  };
+  ObjStm* objstm(uint32_t num);
+
+  std::unique_ptr<MappedFile> file_;
+  const uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  int os_errno_ = 0;
+
+  int version_ = 0;
+  size_t header_off_ = 0;
+  Obj trailer_;
+  std::vector<XrefEntry> xref_;
+  // livre numa seção mais nova (objeto apagado por salvamento incremental): as seções
+  // antigas não podem trazê-lo de volta
+  std::vector<bool> freed_;
+  XrefHealth health_ = XREF_OK;
+  bool has_xref_stream_ = false;
+  int xref_sections_ = 0;
+  bool linearized_ = false;
+  int resolve_depth_ = 0;
+  std::unordered_map<uint32_t, std::unique_ptr<ObjStm>> objstm_cache_;
+};
+
+// ======================= Escrita =======================
+// Serializa um objeto direto (Refs como "N G R"); reais sem notação exponencial.
+void serialize(const Obj& o, std::string& out);
+
+// Escritor sequencial: o chamador numera os objetos (reserve) e os grava em qualquer
+// ordem; finish() escreve a xref clássica e o trailer. Dados de stream são copiados
+// como estão (sem recodificar).
+// Modo compacto (set_compact antes de open): objetos sem stream vão para object
+// streams Flate de até 100 objetos e finish() escreve uma xref stream; o cabeçalho
+// sobe para 1.5 se preciso. O chamador não deve gravar o dicionário /Encrypt assim.
+class Writer {
+public:
+  Writer() = default;
+  ~Writer() { close(); }
+  Writer(const Writer&) = delete;
+  Writer& operator=(const Writer&) = delete;
+
+  void set_compact(bool on) { compact_ = on; }
+  bool open(const char* path, int version);    // version 17 == "%PDF-1.7"
+  uint32_t reserve();                          // próximo número de objeto livre
+  bool write_object(uint32_t num, const Obj& value);
+  // /Length do dicionário é substituído pelo tamanho real de 'data'
+  bool write_stream(uint32_t num, const Obj& dict, const uint8_t* data, size_t len);
+  // Objeto já serializado ("num gen obj ... endobj"), copiado byte a byte
+  bool write_raw(uint32_t num, int gen, const uint8_t* data, size_t len);
+  // /Size é preenchido aqui; 'trailer' traz /Root, /Info, /ID...
+  bool finish(const Obj& trailer);
+  // Layout montado pelo chamador (p.ex. linearização): bytes crus na posição atual e
+  // fechamento sem xref própria. false em erro de E/S (os_errno()).
+  bool write_bytes(const void* p, size_t n) { return put(p, n); }
+  bool finish_raw();
+  void close();                                // fecha sem finalizar (arquivo incompleto)
+
+  uint64_t bytes_written() const { return pos_ + buf_.size(); }
+  int os_errno() const { return err_; }
+  size_t objects_packed() const { return packed_; }    // modo compacto
+  size_t object_streams() const { return objstms_; }
+
+private:
+  bool put(const void* p, size_t n);
+  bool flush();
+  bool flush_objstm();
+  bool finish_xref_stream(const Obj& trailer);
+
+  static const size_t kObjStmMaxObjects = 100;
+  static const size_t kObjStmMaxBytes = 1 << 20;
+
+  std::FILE* f_ = nullptr;
+  uint64_t pos_ = 0;                   // bytes já entregues ao FILE*
+  std::string buf_;
+  std::vector<uint64_t> offsets_;      // índice = número do objeto; 0 = não gravado
+  std::vector<uint16_t> gens_;         // geração na xref (write_raw); tipo 2: índice no stream
+  std::vector<uint32_t> in_stm_;       // != 0 => object stream que contém o objeto
+  std::string tmp_;
+  int err_ = 0;
+
+  bool compact_ = false;
+  std::string pend_;                   // corpo do object stream em montagem
+  std::vector<std::pair<uint32_t, size_t>> pend_items_;   // (num, offset em pend_)
+  size_t packed_ = 0, objstms_ = 0;
+};
+
+// ======================= Linearização =======================
+// Objeto de entrada de write_linearized: Refs em 'value' são índices em objs (o 0 não
+// é usado); dados de stream copiados como estão, /Length regravado.
+struct LinObject {
+  Obj value;
+  bool is_stream = false;
+  const uint8_t* data = nullptr;
+  size_t len = 0;
+};
+
+struct LinStats {
+  size_t objects = 0;              // gravados (sem o dicionário de linearização e hints)
+  size_t first_page_objects = 0;   // seção da 1ª página
+  size_t shared_objects = 0;       // usados por mais de uma página (fora da 1ª)
+  uint64_t first_page_end = 0;     // /E
+  uint64_t hint_bytes = 0;         // hint stream (comprimido)
+  uint64_t bytes_out = 0;          // /L
+};
+
+// Grava objs como PDF linearizado ("fast web view", ISO 32000-1 anexo F) em uma só
+// passada: o layout é calculado antes (só os dicionários são serializados; os dados de
+// stream ficam onde estão) e as hint tables saem dele. Ordem: dicionário de
+// linearização, xref da 1ª página, catálogo e afins, hint stream, 1ª página, demais
+// páginas com seus objetos exclusivos, compartilhados, resto, xref principal.
+// Xref clássica, sem object streams. pages: objetos /Page em ordem; trailer traz
+// /Info (índice) e /ID. false em entrada inválida ou erro de E/S (*os_errno != 0).
+bool write_linearized(const char* path, int version, const std::vector<LinObject>& objs,
+                      uint32_t catalog, const std::vector<uint32_t>& pages, const Obj& trailer,
+                      LinStats* stats, int* os_errno);
+
+// Decodificador Flate (zlib). Aceita dados truncados (devolve o que conseguiu).
+bool flate_decode(const uint8_t* p, size_t n, std::string& out);
+// Codificador Flate (zlib, memLevel 9). strategy: 0 = padrão, 1 = Z_FILTERED.
+bool flate_encode(const uint8_t* p, size_t n, int level, int strategy, std::string& out);
+// Desfaz preditores PNG (10..15) e TIFF (2) conforme /DecodeParms.
+bool apply_predictor(std::string& data, const Obj& parms);
+
+}  // namespace gsx_pdf
@@ -0,0 +1,295 @@
+// gsx_pipeline.cpp — pipeline nativo de uma requisição (gsx_pipeline_run)
+//
+// probe → normalize → chunk → compress → merge → dedup → linearize numa chamada só. Entre as
+// etapas nada passa pelo disco:
+//  - probe/chunk leem a entrada mapeada (gsx_pdf::Document, gsx_page_weights);
+//  - xref danificada é reparada uma vez (gsx_normalize.cpp) e a cópia normalizada
+//    vai para a memória como as partes, em vez de cada lote repetir o reparo;
+//  - cada lote do pdfwrite grava num memfd (Linux), aberto pelo Ghostscript como
+//    /proc/self/fd/N e mapeado de volta pela mesclagem, que deduplica e já grava a
+//    saída final (linearizada, se pedido) numa escrita; com uma parte só não há
+//    mesclagem: ela é movida/copiada para a saída ou linearizada a partir do próprio catálogo;
+//  - a memória é limitada: a reserva de cada parte é estimada pela fração do peso
+//    das páginas sobre o tamanho da entrada; o que passaria de mem_budget_mb vai para
+//    arquivos temporários em work_dir (e sem memfd, tudo vai).
+// O relatório traz o tempo de cada etapa.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#ifdef __linux__
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+static const uint64_t kDefaultBudgetMb = 512;
+
+// Partes em memfd enquanto couberem na reserva; o resto em arquivos temporários
+struct MemPartStore : GsxPartStore {
+  std::string dir;
+  uint64_t budget = 0;
+  std::mutex m;
+  uint64_t reserved = 0;
+  std::unordered_map<std::string, std::pair<int, uint64_t>> mem;   // caminho → (fd, reserva)
+
+  ~MemPartStore() {
+#ifdef __linux__
+    for (auto& kv : mem) close(kv.second.first);
+#endif
+  }
+
+  std::string create(uint64_t expect_bytes) override {
+#ifdef __linux__
+    std::lock_guard<std::mutex> lk(m);
+    if (budget && reserved + expect_bytes <= budget) {
+      int fd = memfd_create("gsx_part", MFD_CLOEXEC);
+      if (fd >= 0) {
+        std::string path = "/proc/self/fd/" + std::to_string(fd);
+        mem[path] = std::make_pair(fd, expect_bytes);
+        reserved += expect_bytes;
+        return path;
+      }
+    }
+#else
+    (void)expect_bytes;
+#endif
+    return gsx_make_temp_path(dir.empty() ? nullptr : dir.c_str(), "GSXP", ".pdf");
+  }
+
+  void drop(const std::string& path) override {
+    {
+      std::lock_guard<std::mutex> lk(m);
+      auto it = mem.find(path);
+      if (it != mem.end()) {
+#ifdef __linux__
+        close(it->second.first);
+#endif
+        reserved -= it->second.second;
+        mem.erase(it);
+        return;
+      }
+    }
+    std::error_code ec;
+    fs::remove(path, ec);
+  }
+
+  bool in_memory(const std::string& path) {
+    std::lock_guard<std::mutex> lk(m);
+    return mem.count(path) != 0;
+  }
+};
+
+struct Stage {
+  const char* name;
+  uint64_t us;
+};
+
+}  // namespace
+
+GSX_API int gsx_pipeline_run(const char* in_path, const char* out_path,
+                             const gsx_pipeline_opts_t* opts, char** report_json,
+                             gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  const Clock::time_point start = Clock::now();
+  GsxJobScope scope("gsx_pipeline_run", in_path, out_path);
+  if (report_json) *report_json = nullptr;
+  gsx_pipeline_opts_t o{};
+  if (opts) o = *opts;
+  scope.capture({"pipeline", in_path, o.dpi, o.jpeg_quality, o.preset, (int)o.mode, o.first_page, o.last_page,
+                 o.workers, (o.linearize ? 1 : 0) | (o.skip_dedup ? 2 : 0)});
+  std::error_code ec;
+  if (!in_path || !out_path || fs::equivalent(in_path, out_path, ec)) {
+    set_last_error_json(GSX_E_ARGS, "pipeline", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  const int dpi = o.dpi > 0 ? o.dpi : 150;
+  const int quality = o.jpeg_quality > 0 ? o.jpeg_quality : 65;
+  std::vector<Stage> stages;
+  Clock::time_point t0 = Clock::now();
+  uint64_t tr_t0 = gsx_trace_on() ? gsx_trace_clock_ns() : 0;
+  auto lap = [&](const char* name, const char* trace_name) {
+    const Clock::time_point now = Clock::now();
+    stages.push_back({name, (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(now - t0).count()});
+    t0 = now;
+    if (tr_t0) {
+      const uint64_t tr_now = gsx_trace_clock_ns();
+      gsx_trace_emit(trace_name, tr_t0, tr_now);
+      tr_t0 = tr_now;
+    }
+  };
+  auto stage_msg = [&](const char* name) {
+    if (!on_progress) return;
+    std::string line = std::string("pipeline: ") + name;
+    on_progress(0, 0, line.c_str(), user);
+  };
+
+  // probe: a entrada precisa ser legível pelo leitor nativo (a mesclagem depende dele)
+  uint64_t in_bytes = 0;
+  {
+    gsx_pdf::Document doc;
+    if (!doc.open(in_path)) {
+      int rc = doc.os_errno() ? GSX_E_INPUT_NOT_FOUND : GSX_E_PDF_PARSE;
+      set_last_error_json(rc, "pipeline.probe", doc.os_errno(), 0, nullptr);
+      return rc;
+    }
+    if (doc.encrypted()) {
+      set_last_error_json(GSX_E_PDF_ENCRYPTED, "pipeline.probe", 0, 0, nullptr);
+      return GSX_E_PDF_ENCRYPTED;
+    }
+    in_bytes = doc.size();
+  }
+  lap("probe", "pipeline.probe");
+
+  MemPartStore store;
+  if (o.work_dir) store.dir = o.work_dir;
+  store.budget = o.mem_budget_mb < 0 ? 0 : (uint64_t)(o.mem_budget_mb ? o.mem_budget_mb : kDefaultBudgetMb) << 20;
+
+  // normalize: só quando a xref está danificada; daqui em diante a cópia é a entrada
+  std::string normalized;
+  if (gsx_normalize_lazy(in_path, 0, [&] { return store.create(in_bytes); }, &normalized, nullptr) == 1) {
+    in_path = normalized.c_str();
+    if (on_progress) on_progress(0, 0, "normalize: xref table was repaired (uma vez, antes dos lotes)", user);
+  }
+  auto drop_normalized = [&] { if (!normalized.empty()) store.drop(normalized); };
+  lap("normalize", "pipeline.normalize");
+
+  // chunk: pesos por página (a partição em lotes é feita pelo compressor)
+  int first = o.first_page, last = o.last_page;
+  std::vector<uint64_t> weights;
+  int rc = gsx_page_weights(in_path, first, last, weights);
+  if (rc < 0) { drop_normalized(); return rc; }
+  const int pages = last - first + 1;
+  lap("chunk", "pipeline.chunk");
+  if (cancel_flag && *cancel_flag) {
+    drop_normalized();
+    set_last_error_json(GSX_E_CANCELED, "pipeline", 0, 0, nullptr);
+    return GSX_E_CANCELED;
+  }
+
+  // compress
+  std::vector<std::string> parts;
+  stage_msg("compress");
+  if (gsx_images_engine_applies(o.preset, in_path, o.first_page, o.last_page)) {
+    // o motor de imagens trabalha no documento inteiro com todas as threads: uma parte
+    parts.push_back(store.create(in_bytes));
+    rc = gsx_compress_file_sync(in_path, parts[0].c_str(), dpi, quality, o.preset, o.mode,
+                                o.first_page, o.last_page, on_progress, user, cancel_flag);
+    if (rc < 0) store.drop(parts[0]);
+  } else {
+    gsx_parallel_opts_t po{};
+    po.workers = o.workers;
+    rc = gsx_parallel_compress(in_path, dpi, quality, o.preset, o.mode, first, std::move(weights), &po,
+                               store, parts, on_progress, user, cancel_flag);
+  }
+  drop_normalized();
+  if (rc < 0) return rc;
+  lap("compress", "pipeline.compress");
+
+  size_t parts_mem = 0;
+  uint64_t part_bytes = 0;
+  for (auto& p : parts) {
+    if (store.in_memory(p)) ++parts_mem;
+    part_bytes += (uint64_t)fs::file_size(p, ec);
+  }
+
+  gsx_merge_stats_t ms{};
+  if (cancel_flag && *cancel_flag) {
+    for (auto& p : parts) store.drop(p);
+    set_last_error_json(GSX_E_CANCELED, "pipeline", 0, 0, nullptr);
+    return GSX_E_CANCELED;
+  }
+  if (parts.size() == 1) {
+    // parte única (motor de imagens ou um lote só): não há o que mesclar nem deduplicar
+    // entre partes; a mesclagem reconstruiria catálogo e trailer à toa
+    const std::string& part = parts[0];
+    stage_msg(o.linearize ? "linearize" : "write");
+    if (o.linearize) {
+      gsx_linearize_stats_t ls{};
+      rc = gsx_linearize_pdf(part.c_str(), out_path, &ls);
+      ms.objects_out = ls.objects;
+      ms.bytes_out = ls.bytes_out;
+    } else {
+      // arquivo temporário: tenta mover; memfd ou outro sistema de arquivos: copia
+      ec.clear();
+      if (store.in_memory(part)) ec = std::make_error_code(std::errc::cross_device_link);
+      else fs::rename(part, out_path, ec);
+      if (ec) {
+        ec.clear();
+        fs::copy_file(part, out_path, fs::copy_options::overwrite_existing, ec);
+      }
+      if (ec) {
+        fs::remove(out_path, ec);
+        rc = GSX_E_WRITE_IO;
+        set_last_error_json(rc, "pipeline.write", ec.value(), 0, nullptr);
+      } else {
+        rc = 0;
+        ms.bytes_out = (uint64_t)fs::file_size(out_path, ec);
+        gsx_pdf::Document out;
+        if (out.open(out_path)) ms.objects_out = (int)out.object_count();
+      }
+    }
+    store.drop(part);
+    if (rc < 0) return rc;
+    lap(o.linearize ? "linearize" : "write", o.linearize ? "pipeline.linearize" : "pipeline.write");
+  } else {
+    // merge → dedup → write/linearize, direto na saída
+    int flags = (o.skip_dedup ? 0 : GSX_MERGE_DEDUP) | (o.linearize ? GSX_MERGE_LINEARIZE : 0);
+    std::vector<const char*> in;
+    for (auto& p : parts) in.push_back(p.c_str());
+    GsxMergeTimes mt;
+    stage_msg(o.linearize ? "merge+linearize" : "merge");
+    rc = gsx_merge_timed(in.data(), (int)in.size(), out_path, flags, &ms, &mt);
+    for (auto& p : parts) store.drop(p);
+    if (rc < 0) return rc;
+    stages.push_back({"merge", mt.collect_us});
+    stages.push_back({"dedup", mt.dedup_us});
+    stages.push_back({o.linearize ? "linearize" : "write", mt.write_us});
+  }
+
+  const uint64_t total_us =
+      (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(Clock::now() - start).count();
+  char buf[256];
+  std::string js = "{";
+  snprintf(buf, sizeof buf,
+           "\"pages\":%d,\"parts\":%zu,\"parts_in_memory\":%zu,\"handoff\":\"%s\",\"part_bytes\":%llu,"
+           "\"bytes_in\":%llu,\"bytes_out\":%llu,\"objects\":%d,\"normalized\":%s,\"linearized\":%s,\"total_ms\":%.1f,",
+           pages, parts.size(), parts_mem,
+           parts_mem == parts.size() ? "memfd" : (parts_mem ? "mixed" : "file"),
+           (unsigned long long)part_bytes, (unsigned long long)in_bytes, (unsigned long long)ms.bytes_out,
+           ms.objects_out, normalized.empty() ? "false" : "true", o.linearize ? "true" : "false",
+           total_us / 1000.0);
+  js += buf;
+  js += "\"stages\":[";
+  for (size_t i = 0; i < stages.size(); ++i) {
+    snprintf(buf, sizeof buf, "%s{\"stage\":\"%s\",\"ms\":%.1f}", i ? "," : "", stages[i].name,
+             stages[i].us / 1000.0);
+    js += buf;
+  }
+  js += "]}";
+  gsx_log_msg(GSX_LOG_DEBUG, ("pipeline: " + js).c_str());
+  if (report_json) {
+    *report_json = gsx_dup_string(js);
+    if (!*report_json) {
+      set_last_error_json(GSX_E_UNKNOWN, "pipeline.alloc", 0, 0, nullptr);
+      return GSX_E_UNKNOWN;
+    }
+  }
+  set_last_error_json(GSX_OK, "pipeline", 0, 0, nullptr);
+  return pages;
+}
@@ -0,0 +1,294 @@
+// gsx_plan.cpp — planejamento de chunks por custo estimado (gsx_plan_chunks)
+//
+// Em vez de dividir o intervalo em contagens iguais de páginas, mede o "peso" de cada
+// página direto da estrutura do PDF (sem Ghostscript) e faz uma partição contígua que
+// minimiza o chunk mais pesado. Assim um apêndice escaneado no fim do arquivo não deixa
+// um único worker rodando sozinho depois que os outros terminaram.
+
+#include <algorithm>
+#include <cerrno>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+using namespace gsx_pdf;
+
+// Custo fixo por página (interpretação, fontes, overhead do pdfwrite) em "bytes equivalentes".
+static const uint64_t kPageBaseCost = 32 * 1024;
+// Profundidade máxima de Forms aninhados considerada na medição.
+static const int kMaxFormDepth = 8;
+
+struct WeightCtx {
+  Document& doc;
+  std::unordered_map<uint32_t, uint64_t> memo;   // peso de cada XObject já medido
+  std::unordered_set<uint32_t> on_path;          // proteção contra ciclos de Forms
+};
+
+static uint64_t xobjects_weight(WeightCtx& c, const Obj& resources, int depth);
+
+// Componentes de cor para estimar o tamanho decodificado (desconhecido = 3)
+static int image_comps(Document& doc, const Obj& cs_in) {
+  Obj cs = doc.resolve(cs_in);
+  if (cs.is_array() && !cs.arr->empty()) {
+    Obj head = doc.resolve((*cs.arr)[0]);
+    if (head.is_name("Indexed") || head.is_name("I") || head.is_name("Separation")) return 1;
+    if (head.is_name("ICCBased") && cs.arr->size() >= 2) {
+      Indirect icc;
+      const Obj& ref = (*cs.arr)[1];
+      const int64_t n = ref.is_ref() && doc.load(ref.ref_num(), icc) ? doc.get(icc.value, "N").as_int(0) : 0;
+      return n >= 1 && n <= 4 ? (int)n : 3;
+    }
+    if (head.is_name("DeviceN") && cs.arr->size() >= 2) {
+      Obj names = doc.resolve((*cs.arr)[1]);
+      return names.is_array() && !names.arr->empty() ? (int)names.arr->size() : 1;
+    }
+    cs = head;
+  }
+  if (cs.is_name("DeviceGray") || cs.is_name("G") || cs.is_name("CalGray")) return 1;
+  if (cs.is_name("DeviceCMYK") || cs.is_name("CMYK")) return 4;
+  return 3;
+}
+
+// Imagem sem filtro ou só com Flate: o custo acompanha os pixels decodificados, não o
+// stream comprimido (um escaneado liso comprime muito e ainda assim pesa no Ghostscript).
+// DCT e os demais codecs ficam pelo tamanho do stream.
+static uint64_t image_weight(Document& doc, const Indirect& ind) {
+  const Obj& d = ind.value;
+  Obj filter = doc.get(d, "Filter");
+  std::vector<Obj> names;
+  if (filter.is_name()) names.push_back(filter);
+  else if (filter.is_array()) for (auto& f : *filter.arr) names.push_back(doc.resolve(f));
+  for (const Obj& n : names)
+    if (!n.is_name("FlateDecode") && !n.is_name("Fl")) return ind.stream_len;
+  const int64_t w = doc.get(d, "Width").as_int(0), h = doc.get(d, "Height").as_int(0);
+  if (w <= 0 || h <= 0) return ind.stream_len;
+  Obj im = doc.get(d, "ImageMask");
+  const bool mask = im.type == Type::Bool && im.b;
+  const int64_t bpc = mask ? 1 : std::max<int64_t>(1, doc.get(d, "BitsPerComponent").as_int(8));
+  const Obj* cs = d.get("ColorSpace");
+  const int comps = mask ? 1 : cs ? image_comps(doc, *cs) : 1;
+  const uint64_t decoded = ((uint64_t)w * comps * (uint64_t)bpc + 7) / 8 * (uint64_t)h;
+  return std::max((uint64_t)ind.stream_len, decoded);
+}
+
+static uint64_t xobject_weight(WeightCtx& c, uint32_t num, int depth) {
+  auto it = c.memo.find(num);
+  if (it != c.memo.end()) return it->second;
+  if (!c.on_path.insert(num).second) return 0;
+
+  uint64_t w = 0;
+  Indirect ind;
+  if (c.doc.load(num, ind) && ind.is_stream) {
+    w = ind.stream_len;
+    const Obj* st = ind.value.get("Subtype");
+    if (st && st->is_name("Image")) {
+      w = image_weight(c.doc, ind);
+      // a máscara suave também é decodificada/reamostrada
+      const Obj* sm = ind.value.get("SMask");
+      Indirect si;
+      if (sm && sm->is_ref() && c.doc.load(sm->ref_num(), si) && si.is_stream) w += image_weight(c.doc, si);
+    } else if (st && st->is_name("Form") && depth < kMaxFormDepth) {
+      const Obj* res = ind.value.get("Resources");
+      if (res) w += xobjects_weight(c, *res, depth + 1);
+    }
+  }
+  c.on_path.erase(num);
+  c.memo[num] = w;
+  return w;
+}
+
+static uint64_t xobjects_weight(WeightCtx& c, const Obj& resources, int depth) {
+  Obj res = c.doc.resolve(resources);
+  if (!res.is_dict()) return 0;
+  Obj xo = c.doc.get(res, "XObject");
+  if (!xo.is_dict()) return 0;
+  uint64_t w = 0;
+  for (auto& kv : *xo.dict)
+    if (kv.second.is_ref()) w += xobject_weight(c, kv.second.ref_num(), depth);
+  return w;
+}
+
+static uint64_t contents_weight(WeightCtx& c, const Obj& contents) {
+  uint64_t w = 0;
+  auto stream_len = [&](const Obj& ref) -> uint64_t {
+    Indirect ind;
+    return (ref.is_ref() && c.doc.load(ref.ref_num(), ind) && ind.is_stream) ? ind.stream_len : 0;
+  };
+  if (contents.is_ref()) {
+    Indirect ind;
+    if (!c.doc.load(contents.ref_num(), ind)) return 0;
+    if (ind.is_stream) return ind.stream_len;
+    if (ind.value.is_array())
+      for (auto& r : *ind.value.arr) w += stream_len(r);
+  } else if (contents.is_array()) {
+    for (auto& r : *contents.arr) w += stream_len(r);
+  }
+  return w;
+}
+
+static uint64_t page_weight(WeightCtx& c, const PageInfo& pg) {
+  uint64_t w = kPageBaseCost;
+  const Obj* contents = pg.dict.get("Contents");
+  if (contents) w += contents_weight(c, *contents);
+  w += xobjects_weight(c, pg.resources, 0);
+  return w;
+}
+
+// Quantos chunks contíguos são necessários para que nenhum passe de 'cap'.
+static int chunks_needed(const std::vector<uint64_t>& w, uint64_t cap) {
+  int n = 1;
+  uint64_t acc = 0;
+  for (uint64_t x : w) {
+    if (acc + x > cap) { ++n; acc = x; }
+    else acc += x;
+  }
+  return n;
+}
+
+// Partição contígua de 'w' em até k faixas [ini,fim] minimizando a faixa mais pesada:
+// busca binária no limite + preenchimento guloso; depois usa os workers que sobraram
+// dividindo as faixas mais pesadas (nunca piora o máximo).
+std::vector<std::pair<size_t, size_t>> gsx_partition_weights(const std::vector<uint64_t>& w, int k) {
+  std::vector<std::pair<size_t, size_t>> out;
+  if (w.empty() || k <= 0) return out;
+
+  uint64_t lo = 0, hi = 0;
+  for (uint64_t x : w) { lo = std::max(lo, x); hi += x; }
+  while (lo < hi) {
+    uint64_t mid = lo + (hi - lo) / 2;
+    if (chunks_needed(w, mid) <= k) hi = mid;
+    else lo = mid + 1;
+  }
+
+  size_t start = 0;
+  uint64_t acc = 0;
+  for (size_t i = 0; i < w.size(); ++i) {
+    if (acc + w[i] > lo && i > start) {
+      out.emplace_back(start, i - 1);
+      start = i;
+      acc = 0;
+    }
+    acc += w[i];
+  }
+  out.emplace_back(start, w.size() - 1);
+
+  std::vector<uint64_t> prefix(w.size() + 1, 0);
+  for (size_t i = 0; i < w.size(); ++i) prefix[i + 1] = prefix[i] + w[i];
+  auto sum = [&](size_t a, size_t b){ return prefix[b + 1] - prefix[a]; };
+
+  while ((int)out.size() < k) {
+    size_t best = out.size();
+    uint64_t best_w = 0;
+    for (size_t i = 0; i < out.size(); ++i) {
+      if (out[i].second == out[i].first) continue;
+      uint64_t s = sum(out[i].first, out[i].second);
+      if (s > best_w) { best_w = s; best = i; }
+    }
+    if (best == out.size()) break;   // só restam chunks de 1 página
+    size_t a = out[best].first, b = out[best].second;
+    size_t cut = a;
+    uint64_t cut_max = UINT64_MAX;
+    for (size_t m = a; m < b; ++m) {
+      uint64_t mx = std::max(sum(a, m), sum(m + 1, b));
+      if (mx < cut_max) { cut_max = mx; cut = m; }
+    }
+    out[best].second = cut;
+    out.insert(out.begin() + (long)best + 1, std::make_pair(cut + 1, b));
+  }
+  return out;
+}
+
+int gsx_page_weights(const char* in_path, int& first, int& last, std::vector<uint64_t>& weights) {
+  GsxSpan span("plan.page_weights");
+  weights.clear();
+  Document doc;
+  if (!doc.open(in_path)) {
+    int rc = doc.os_errno() ? GSX_E_INPUT_NOT_FOUND : GSX_E_PDF_PARSE;
+    set_last_error_json(rc, "page_weights.open", doc.os_errno(), 0, nullptr);
+    return rc;
+  }
+  std::vector<PageInfo> pages;
+  if (!doc.pages(pages) || pages.empty()) {
+    set_last_error_json(GSX_E_PDF_PARSE, "page_weights.pages", 0, 0, nullptr);
+    return GSX_E_PDF_PARSE;
+  }
+  int total = (int)pages.size();
+  first = first > 0 ? first : 1;
+  last  = last > 0 ? std::min(last, total) : total;
+  if (first > last) {
+    set_last_error_json(GSX_E_ARGS, "page_weights.range", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  WeightCtx c{doc, {}, {}};
+  weights.reserve((size_t)(last - first + 1));
+  for (int pg = first; pg <= last; ++pg) weights.push_back(page_weight(c, pages[(size_t)pg - 1]));
+  if (doc.health() == XREF_REPAIRED) gsx_log_msg(GSX_LOG_DEBUG, "page_weights: xref reparada");
+  return GSX_OK;
+}
+
+int gsx_run_weighted(const std::vector<uint64_t>& weights, int first, int workers,
+                     const std::function<int(int, int)>& fn, volatile int* cancel_flag, int* used) {
+  const int total = (int)weights.size();
+  if (workers <= 0) workers = (int)std::thread::hardware_concurrency();
+  workers = std::max(1, std::min(workers, total));
+  auto ranges = gsx_partition_weights(weights, workers);
+  if (used) *used = (int)ranges.size();
+  std::vector<int> rcs(ranges.size(), 0);
+  if (ranges.size() == 1) {
+    rcs[0] = fn(first, first + total - 1);
+  } else {
+    std::vector<std::thread> pool;
+    const GsxJobToken job = gsx_job_token();
+    for (size_t k = 0; k < ranges.size(); ++k)
+      pool.emplace_back([&, k, job] {
+        GsxJobAdopt adopt(job);
+        rcs[k] = fn(first + (int)ranges[k].first, first + (int)ranges[k].second);
+      });
+    for (auto& t : pool) t.join();
+  }
+  if (cancel_flag && *cancel_flag) return GSX_E_CANCELED;
+  for (int r : rcs) if (r < 0) return r;
+  return GSX_OK;
+}
+
+GSX_API int gsx_plan_chunks(
+  const char* in_path, int first_page, int last_page, int max_chunks,
+  gsx_chunk_t* chunks_out)
+{
+  if (!in_path || max_chunks <= 0 || !chunks_out) {
+    set_last_error_json(GSX_E_ARGS, "plan_chunks", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  int first = first_page, last = last_page;
+  std::vector<uint64_t> w;
+  int rc = gsx_page_weights(in_path, first, last, w);
+  if (rc < 0) return rc;
+
+  auto parts = gsx_partition_weights(w, max_chunks);
+  uint64_t heaviest = 0, sum = 0;
+  int n = 0;
+  for (auto& pr : parts) {
+    uint64_t s = 0;
+    for (size_t i = pr.first; i <= pr.second; ++i) s += w[i];
+    chunks_out[n].first_page = first + (int)pr.first;
+    chunks_out[n].last_page  = first + (int)pr.second;
+    chunks_out[n].weight     = s;
+    heaviest = std::max(heaviest, s);
+    sum += s;
+    ++n;
+  }
+
+  std::string msg = "plan_chunks: " + std::to_string(last - first + 1) + " páginas em " +
+                    std::to_string(n) + " chunks; peso total=" + std::to_string(sum) +
+                    " maior=" + std::to_string(heaviest);
+  gsx_log_msg(GSX_LOG_DEBUG, msg.c_str());
+  set_last_error_json(GSX_OK, "plan_chunks", 0, 0, nullptr);
+  return n;
+}
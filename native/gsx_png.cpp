@@ -0,0 +1,96 @@
+// gsx_png.cpp — PNG em memória só com a zlib (miniaturas, gsx_thumbs.cpp).
+// Filtro escolhido por linha (None/Sub/Up/Paeth) pela menor soma dos resíduos em
+// módulo, a heurística da libpng; IDAT único comprimido com deflate.
+
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include <zlib.h>
+
+#include "gsx_internal.h"
+
+namespace {
+
+static void put_u32(std::string& out, uint32_t v) {
+  const char b[4] = {(char)(v >> 24), (char)(v >> 16), (char)(v >> 8), (char)v};
+  out.append(b, 4);
+}
+
+static void put_chunk(std::string& out, const char type[4], const uint8_t* data, size_t len) {
+  put_u32(out, (uint32_t)len);
+  const size_t at = out.size();
+  out.append(type, 4);
+  if (len) out.append((const char*)data, len);
+  uLong crc = crc32(0L, Z_NULL, 0);
+  crc = crc32(crc, (const Bytef*)out.data() + at, (uInt)(len + 4));
+  put_u32(out, (uint32_t)crc);
+}
+
+static inline uint8_t paeth(int a, int b, int c) {
+  const int p = a + b - c;
+  const int pa = abs(p - a), pb = abs(p - b), pc = abs(p - c);
+  if (pa <= pb && pa <= pc) return (uint8_t)a;
+  return (uint8_t)(pb <= pc ? b : c);
+}
+
+static inline uint32_t cost(const uint8_t* f, size_t n) {
+  uint32_t s = 0;
+  for (size_t i = 0; i < n; ++i) s += f[i] < 128 ? f[i] : 256 - f[i];
+  return s;
+}
+
+}  // namespace
+
+bool gsx_png_encode(const uint8_t* px, int w, int h, int comps, size_t stride, std::string& out) {
+  if (!px || w <= 0 || h <= 0 || (comps != 1 && comps != 3)) return false;
+  const size_t row = (size_t)w * comps;
+  if (stride == 0) stride = row;
+  if (stride < row) return false;
+
+  // linhas filtradas: 1 byte de tipo + row
+  std::vector<uint8_t> filt((row + 1) * (size_t)h);
+  std::vector<uint8_t> cand[4];
+  for (auto& c : cand) c.resize(row);
+  for (int y = 0; y < h; ++y) {
+    const uint8_t* cur = px + (size_t)y * stride;
+    const uint8_t* up = y ? cur - stride : nullptr;
+    for (size_t i = 0; i < row; ++i) {
+      const int a = i >= (size_t)comps ? cur[i - comps] : 0;
+      const int b = up ? up[i] : 0;
+      const int c = (up && i >= (size_t)comps) ? up[i - comps] : 0;
+      cand[0][i] = cur[i];
+      cand[1][i] = (uint8_t)(cur[i] - a);
+      cand[2][i] = (uint8_t)(cur[i] - b);
+      cand[3][i] = (uint8_t)(cur[i] - paeth(a, b, c));
+    }
+    int best = 0;
+    uint32_t best_cost = cost(cand[0].data(), row);
+    for (int k = 1; k < 4; ++k) {
+      const uint32_t cst = cost(cand[k].data(), row);
+      if (cst < best_cost) { best_cost = cst; best = k; }
+    }
+    uint8_t* dst = filt.data() + (size_t)y * (row + 1);
+    dst[0] = (uint8_t)(best == 3 ? 4 : best);   // tipos PNG: 0 None, 1 Sub, 2 Up, 4 Paeth
+    memcpy(dst + 1, cand[best].data(), row);
+  }
+
+  uLongf zlen = compressBound((uLong)filt.size());
+  std::vector<uint8_t> z(zlen);
+  if (compress2(z.data(), &zlen, filt.data(), (uLong)filt.size(), 6) != Z_OK) return false;
+
+  static const char sig[8] = {'\x89', 'P', 'N', 'G', '\r', '\n', '\x1a', '\n'};
+  out.append(sig, 8);
+  uint8_t ihdr[13];
+  const uint32_t W = (uint32_t)w, H = (uint32_t)h;
+  ihdr[0] = (uint8_t)(W >> 24); ihdr[1] = (uint8_t)(W >> 16); ihdr[2] = (uint8_t)(W >> 8); ihdr[3] = (uint8_t)W;
+  ihdr[4] = (uint8_t)(H >> 24); ihdr[5] = (uint8_t)(H >> 16); ihdr[6] = (uint8_t)(H >> 8); ihdr[7] = (uint8_t)H;
+  ihdr[8] = 8;                          // bits por amostra
+  ihdr[9] = comps == 3 ? 2 : 0;         // RGB / cinza
+  ihdr[10] = 0; ihdr[11] = 0; ihdr[12] = 0;
+  put_chunk(out, "IHDR", ihdr, sizeof ihdr);
+  put_chunk(out, "IDAT", z.data(), zlen);
+  put_chunk(out, "IEND", nullptr, 0);
+  return true;
+}
@@ -0,0 +1,71 @@
+// gsx_pnm.cpp — leitura incremental de PNM binário (P5/P6) vindo do stdout do Ghostscript.
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "gsx_internal.h"
+
+bool GsxPnmReader::parse_header() {
+  // tokens separados por espaço; '#' comenta até o fim da linha
+  std::vector<std::string> tok;
+  size_t i = 0;
+  while (i < hdr_.size() && tok.size() < 4) {
+    char c = hdr_[i];
+    if (c == '#') { while (i < hdr_.size() && hdr_[i] != '\n') ++i; continue; }
+    if (c == ' ' || c == '\t' || c == '\r' || c == '\n') { ++i; continue; }
+    size_t j = i;
+    while (j < hdr_.size() && !strchr(" \t\r\n#", hdr_[j])) ++j;
+    if (j == hdr_.size()) return false;          // token ainda incompleto
+    tok.emplace_back(hdr_, i, j - i);
+    i = j;
+  }
+  if (tok.size() < 4) return false;
+  int ch = tok[0] == "P5" ? 1 : (tok[0] == "P6" ? 3 : 0);
+  int w = atoi(tok[1].c_str()), h = atoi(tok[2].c_str());
+  if (!ch || w <= 0 || h <= 0 || atoi(tok[3].c_str()) != 255) {
+    hdr_.clear();                                 // não é P5/P6 de 8 bits: descarta
+    return false;
+  }
+  w_ = w; h_ = h; ch_ = ch; y_ = 0;
+  row_.resize((size_t)w * (size_t)ch);
+  row_fill_ = 0;
+  on_page(w, h, ch);
+  return true;
+}
+
+void GsxPnmReader::feed(const uint8_t* d, size_t len) {
+  while (len) {
+    if (!in_pixels_) {
+      hdr_.push_back((char)*d++); --len;
+      char c = hdr_.back();
+      if ((c == ' ' || c == '\t' || c == '\r' || c == '\n') && parse_header()) in_pixels_ = true;
+      else if (hdr_.size() > 4096) hdr_.clear();
+      continue;
+    }
+    const size_t stride = row_.size();
+    if (row_fill_ == 0 && len >= stride) {       // linha inteira no buffer de entrada
+      on_row(y_++, d);
+      d += stride; len -= stride;
+    } else {
+      size_t take = std::min(stride - row_fill_, len);
+      memcpy(row_.data() + row_fill_, d, take);
+      row_fill_ += take; d += take; len -= take;
+      if (row_fill_ < stride) continue;
+      row_fill_ = 0;
+      on_row(y_++, row_.data());
+    }
+    if (y_ == h_) {
+      on_page_end();
+      in_pixels_ = false;
+      hdr_.clear();
+    }
+  }
+}
+
+int GsxPnmReader::sink(void* user, const char* d, int len) {
+  if (len > 0) static_cast<GsxPnmReader*>(user)->feed((const uint8_t*)d, (size_t)len);
+  return len;
+}
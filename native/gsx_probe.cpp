@@ -0,0 +1,56 @@
+// gsx_probe.cpp — inspeção rápida de um PDF (gsx_probe): contagem de páginas e saúde da
+// estrutura sem Ghostscript/MuPDF. Só header, trailer, xref (ou xref stream) e a raiz
+// da árvore de páginas são lidos; a varredura de reparo só roda se a xref não serve.
+
+#include <chrono>
+#include <cstring>
+#include <string>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+using namespace gsx_pdf;
+
+GSX_API int gsx_probe(const char* in_path, gsx_probe_t* out)
+{
+  if (!in_path || !out) {
+    set_last_error_json(GSX_E_ARGS, "probe", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  memset(out, 0, sizeof(*out));
+  out->page_count = -1;
+  out->xref_health = XREF_BROKEN;
+
+  auto t0 = std::chrono::steady_clock::now();
+  Document doc;
+  bool opened = doc.open(in_path);
+  if (!opened && doc.os_errno()) {
+    set_last_error_json(GSX_E_INPUT_NOT_FOUND, "probe.open", doc.os_errno(), 0, nullptr);
+    return GSX_E_INPUT_NOT_FOUND;
+  }
+  // header e tamanho valem mesmo quando a estrutura não é legível
+  out->version = doc.version();
+  out->header_offset = doc.header_offset();
+  out->file_size = doc.size();
+  if (!opened) {
+    set_last_error_json(GSX_E_PDF_PARSE, "probe.xref", 0, 0, nullptr);
+    return GSX_E_PDF_PARSE;
+  }
+
+  out->xref_health = doc.health();
+  out->has_xref_stream = doc.has_xref_stream() ? 1 : 0;
+  out->xref_sections = doc.xref_sections();
+  out->object_count = (int)doc.object_count();
+  out->encrypted = doc.encrypted() ? 1 : 0;
+  out->linearized = doc.linearized() ? 1 : 0;
+  out->page_count = doc.page_count_fast();
+  out->elapsed_us = (uint64_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                      std::chrono::steady_clock::now() - t0).count();
+  if (out->page_count < 0) {
+    set_last_error_json(GSX_E_PDF_PARSE, "probe.pages", 0, 0, nullptr);
+    return GSX_E_PDF_PARSE;
+  }
+  set_last_error_json(GSX_OK, "probe", 0, 0, nullptr);
+  return GSX_OK;
+}
@@ -0,0 +1,493 @@
+// gsx_recompress.cpp — recompressão só das imagens (gsx_recompress_images), sem pdfwrite.
+//
+// O pdfwrite reinterpreta o documento inteiro para reduzir as imagens: fontes são
+// reembutidas, o conteúdo é regerado e tudo custa tempo. Aqui o PDF é lido pelo
+// gsx_pdf, só os streams de imagem são decodificados e o resto é copiado como está:
+//   1) as páginas são percorridas (gsx_scan_page_images) para achar a maior área em
+//      que cada imagem é desenhada e, dela, o dpi efetivo;
+//   2) as candidatas (8 bits, cinza/RGB, sem filtro/Flate/DCT, fora de máscaras) são
+//      decodificadas, reduzidas por média de área quando passam de 1.5× a dpi alvo
+//      (o mesmo limiar padrão do pdfwrite) e recodificadas em JPEG por várias threads;
+//      as de 1 bit (/ImageMask ou DeviceGray) viram JBIG2 sem perdas, sem redução;
+//   3) a saída é uma regravação completa com os números de objeto originais: os objetos
+//      soltos vão byte a byte, os de object streams são reserializados, as imagens
+//      trocadas ganham o JPEG e a xref clássica é reescrita.
+// A atualização incremental foi descartada de propósito: os streams antigos continuariam
+// no arquivo e ele só cresceria.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+#include "gsx_pdf.h"
+
+namespace fs = std::filesystem;
+using namespace gsx_pdf;
+
+static const int    kDefaultDpi = 150;
+static const int    kDefaultQuality = 75;
+static const double kDownsampleThreshold = 1.5;   // como ColorImageDownsampleThreshold
+static const int    kMinGainPct = 75;             // sem redução, o JPEG precisa ficar <= 75% do original
+
+namespace {
+
+// ======================= Seleção =======================
+enum Codec { C_RAW, C_FLATE, C_DCT };
+
+struct Cand {
+  uint32_t num = 0;
+  Obj dict;
+  const uint8_t* data = nullptr;
+  size_t len = 0;
+  int codec = C_RAW;
+  std::vector<Obj> parms;        // C_FLATE: DecodeParms de cada filtro (resolvidos)
+  int w = 0, h = 0, comps = 0;
+  int nw = 0, nh = 0;            // dimensões de saída
+  bool to_gray = false;
+  bool bilevel = false;          // 1 bit → JBIG2 (amostras preservadas, /Decode fica)
+  int dpi = 0;                   // bilevel: resolução efetiva, vai no cabeçalho do JBIG2
+
+  std::string out;               // JPEG/JBIG2 (vazio = mantém o original)
+};
+
+// componentes de cor de espaços que o JPEG representa sem perda de semântica; 0 = não serve
+static int color_comps(Document& doc, const Obj& cs_in) {
+  Obj cs = doc.resolve(cs_in);
+  if (cs.is_name("DeviceGray") || cs.is_name("G") || cs.is_name("CalGray")) return 1;
+  if (cs.is_name("DeviceRGB") || cs.is_name("RGB") || cs.is_name("CalRGB")) return 3;
+  if (!cs.is_array() || cs.arr->empty()) return 0;
+  Obj head = doc.resolve((*cs.arr)[0]);
+  if (head.is_name("CalGray")) return 1;
+  if (head.is_name("CalRGB")) return 3;
+  if (head.is_name("ICCBased") && cs.arr->size() >= 2) {
+    Indirect icc;
+    const Obj& ref = (*cs.arr)[1];
+    if (!ref.is_ref() || !doc.load(ref.ref_num(), icc)) return 0;
+    const int64_t n = doc.get(icc.value, "N").as_int(0);
+    return n == 1 || n == 3 ? (int)n : 0;
+  }
+  return 0;
+}
+
+static bool plan_image(Document& doc, const Indirect& ind, const GsxImageScan& scan,
+                       int dpi, bool gray, Cand& c) {
+  const Obj& d = ind.value;
+  if (ind.gen != 0 || ind.in_objstm || ind.stream_off + ind.stream_len > doc.size()) return false;
+  Obj im = doc.get(d, "ImageMask");
+  const bool mask = im.type == Type::Bool && im.b;
+  const int64_t bpc = doc.get(d, "BitsPerComponent").as_int(0);
+  c.w = (int)doc.get(d, "Width").as_int(0);
+  c.h = (int)doc.get(d, "Height").as_int(0);
+  if (c.w <= 0 || c.h <= 0 || (int64_t)c.w * c.h > (int64_t)1 << 28) return false;
+  const Obj* cs = d.get("ColorSpace");
+  if (mask || bpc == 1) {
+    // JBIG2 é sem perdas: /Decode e /Mask continuam valendo sobre as mesmas amostras
+    if (!mask && (!cs || color_comps(doc, *cs) != 1)) return false;
+    c.bilevel = true;
+    c.comps = 1;
+  } else {
+    if (bpc != 8) return false;
+    if (d.get("Decode") || doc.get(d, "Mask").is_array()) return false;   // cor-chave não sobrevive ao JPEG
+    c.comps = cs ? color_comps(doc, *cs) : 0;
+    if (!c.comps) return false;
+  }
+
+  Obj filter = doc.get(d, "Filter");
+  Obj parms = doc.get(d, "DecodeParms");
+  std::vector<Obj> names;
+  if (filter.is_name()) names.push_back(filter);
+  else if (filter.is_array()) for (auto& f : *filter.arr) names.push_back(doc.resolve(f));
+  if (names.empty()) c.codec = C_RAW;
+  else if (names.size() == 1 && (names[0].is_name("DCTDecode") || names[0].is_name("DCT"))) {
+    if (!parms.is_null() || c.bilevel) return false;                 // /ColorTransform explícito: deixa como está
+    c.codec = C_DCT;
+  } else {
+    for (size_t k = 0; k < names.size(); ++k) {
+      if (!names[k].is_name("FlateDecode") && !names[k].is_name("Fl")) return false;
+      c.parms.push_back(parms.is_array() ? (k < parms.arr->size() ? doc.resolve((*parms.arr)[k]) : Obj())
+                                         : parms);
+    }
+    c.codec = C_FLATE;
+  }
+
+  // /Matte de uma SMask é dado nos componentes da imagem: não pode virar cinza
+  Obj smask = doc.get(d, "SMask");
+  c.to_gray = gray && c.comps == 3 && !(smask.is_dict() && smask.get("Matte"));
+
+  c.nw = c.w;
+  c.nh = c.h;
+  auto it = scan.images.find(ind.num);
+  if (it != scan.images.end() && it->second.w_pt > 0 && it->second.h_pt > 0) {
+    const double dx = c.w * 72.0 / it->second.w_pt, dy = c.h * 72.0 / it->second.h_pt;
+    if (c.bilevel) c.dpi = (int)std::lround(std::min(dx, dy));
+    else if (std::min(dx, dy) > dpi * kDownsampleThreshold) {
+      c.nw = std::max(1, std::min(c.w, (int)std::lround(c.w * dpi / dx)));
+      c.nh = std::max(1, std::min(c.h, (int)std::lround(c.h * dpi / dy)));
+    }
+  }
+  c.num = ind.num;
+  c.dict = d;
+  c.data = doc.data() + ind.stream_off;
+  c.len = ind.stream_len;
+  return true;
+}
+
+// Amostras de uma candidata sem filtro ou Flate (os primeiros 'need' bytes)
+static bool raw_samples(const Cand& c, size_t need, std::vector<uint8_t>& px) {
+  if (c.codec == C_FLATE) {
+    std::string cur((const char*)c.data, c.len);
+    for (const Obj& pk : c.parms) {
+      std::string dec;
+      if (!flate_decode((const uint8_t*)cur.data(), cur.size(), dec) || !apply_predictor(dec, pk)) return false;
+      cur.swap(dec);
+    }
+    if (cur.size() < need) return false;
+    px.assign(cur.begin(), cur.begin() + (std::ptrdiff_t)need);
+    return true;
+  }
+  if (c.len < need) return false;
+  px.assign(c.data, c.data + need);
+  return true;
+}
+
+// 1 bit → JBIG2 genérico sem perdas. O /JBIG2Decode entrega o preto do JBIG2 como
+// amostra 0, então amostra 0 vira pixel 1 e o resultado decodifica bit a bit igual.
+static void process_bilevel(Cand& c) {
+  const size_t stride = ((size_t)c.w + 7) / 8;
+  std::vector<uint8_t> packed;
+  if (!raw_samples(c, stride * (size_t)c.h, packed)) return;
+  std::vector<uint8_t> bw((size_t)c.w * (size_t)c.h);
+  for (int y = 0; y < c.h; ++y) {
+    const uint8_t* row = packed.data() + (size_t)y * stride;
+    uint8_t* dst = bw.data() + (size_t)y * (size_t)c.w;
+    for (int x = 0; x < c.w; ++x) dst[x] = ((row[x >> 3] >> (7 - (x & 7))) & 1) ? 0 : 1;
+  }
+  std::string enc;
+  gsx_jbig2_encode(bw.data(), c.w, c.h, c.dpi, enc);
+  if (enc.size() < c.len) c.out.swap(enc);
+}
+
+// decodifica, reduz e recodifica; c.out fica vazio se não compensar
+static void process(Cand& c, int quality) {
+  if (c.bilevel) {
+    process_bilevel(c);
+    return;
+  }
+  std::vector<uint8_t> px;
+  const size_t need = (size_t)c.w * (size_t)c.h * (size_t)c.comps;
+  if (c.codec == C_DCT) {
+    int w = 0, h = 0, comps = 0;
+    if (!gsx_jpeg_decode(c.data, c.len, px, w, h, comps) || w != c.w || h != c.h || comps != c.comps) return;
+  } else if (!raw_samples(c, need, px)) {
+    return;
+  }
+
+  int comps = c.comps;
+  if (c.to_gray) {
+    const size_t n = (size_t)c.w * (size_t)c.h;
+    gsx_rgb_to_gray(px.data(), px.data(), n);     // no lugar: a saída i nunca passa da entrada 3i
+    px.resize(n);
+    comps = 1;
+  }
+  if (c.nw != c.w || c.nh != c.h) {
+    std::vector<uint8_t> small((size_t)c.nw * (size_t)c.nh * (size_t)comps);
+    gsx_resample(px.data(), c.w, c.h, comps, small.data(), c.nw, c.nh, GSX_FILTER_BOX);
+    px.swap(small);
+  }
+
+  std::string enc;
+  if (!gsx_jpeg_encode(px.data(), c.nw, c.nh, comps, quality, enc)) return;
+  const bool reduced = c.nw != c.w || c.nh != c.h || c.to_gray;
+  if (enc.size() < c.len && (reduced || enc.size() * 100 <= c.len * (size_t)kMinGainPct)) c.out.swap(enc);
+}
+
+// Fim de "N G obj ... endobj" no arquivo (0 se não encontrado)
+static size_t object_end(const Document& doc, const Indirect& ind) {
+  const uint8_t* p = doc.data();
+  const size_t n = doc.size();
+  if (ind.is_stream) {
+    const size_t from = ind.stream_off + ind.stream_len;
+    const size_t to = std::min(n, from + 256);
+    for (size_t i = from; i + 6 <= to; ++i)
+      if (memcmp(p + i, "endobj", 6) == 0) return i + 6;
+    return 0;
+  }
+  Lexer lx(p, n, ind.obj_off);
+  lx.next(); lx.next(); lx.next();              // N G obj
+  Obj v;
+  if (lx.parse(v)) {
+    if (lx.next() != Lexer::T_KEYWORD || lx.text() != "endobj") return 0;
+  } else if (lx.kw() != "endobj") {
+    return 0;
+  }
+  return lx.pos();
+}
+
+// Reserializa um objeto (de object stream ou de extensão não encontrada) com a geração original
+static std::string serialize_indirect(const Document& doc, const Indirect& ind) {
+  std::string s = std::to_string(ind.num) + " " + std::to_string(ind.gen) + " obj\n";
+  if (!ind.is_stream) {
+    serialize(ind.value, s);
+    s += "\nendobj";
+    return s;
+  }
+  Obj d = ind.value;
+  if (d.dict) d.dict = std::make_shared<Dict>(*d.dict);
+  d.set("Length", Obj::make_int((int64_t)ind.stream_len));
+  serialize(d, s);
+  s += "\nstream\n";
+  s.append((const char*)doc.data() + ind.stream_off, ind.stream_len);
+  s += "\nendstream\nendobj";
+  return s;
+}
+
+// Saída = cópia exata da entrada (nenhuma imagem compensou)
+static int copy_input(const Document& doc, const char* in_path, const char* out_path,
+                      gsx_recompress_stats_t& st, gsx_recompress_stats_t* stats_out) {
+  std::error_code ec;
+  fs::copy_file(in_path, out_path, fs::copy_options::overwrite_existing, ec);
+  if (ec) {
+    set_last_error_json(GSX_E_WRITE_IO, "recompress.copy", ec.value(), 0, nullptr);
+    fs::remove(out_path, ec);
+    return GSX_E_WRITE_IO;
+  }
+  st.bytes_out = doc.size();
+  if (stats_out) *stats_out = st;
+  gsx_log_msg(GSX_LOG_INFO, ("recompress_images: nenhuma das " + std::to_string(st.images) +
+                             " imagens compensou; arquivo copiado sem alterações").c_str());
+  set_last_error_json(GSX_OK, "recompress", 0, 0, nullptr);
+  return 0;
+}
+
+}  // namespace
+
+GSX_API int gsx_recompress_images(
+  const char* in_path,
+  const char* out_path,
+  const gsx_recompress_opts_t* opts,
+  gsx_recompress_stats_t* stats_out,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  GsxJobScope scope("gsx_recompress_images", in_path, out_path);
+  GsxSpan span("recompress_images");
+  if (stats_out) memset(stats_out, 0, sizeof(*stats_out));
+  if (!in_path || !out_path ||
+      (opts && (opts->dpi < 0 || opts->dpi > 1200 || opts->jpeg_quality < 0 || opts->jpeg_quality > 100))) {
+    set_last_error_json(GSX_E_ARGS, "recompress", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  std::error_code ec;
+  if (fs::equivalent(in_path, out_path, ec)) {
+    set_last_error_json(GSX_E_ARGS, "recompress.same_path", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  const int dpi = opts && opts->dpi > 0 ? opts->dpi : kDefaultDpi;
+  const int quality = opts && opts->jpeg_quality > 0 ? opts->jpeg_quality : kDefaultQuality;
+  const bool gray = opts && opts->gray;
+  auto t0 = std::chrono::steady_clock::now();
+
+  Document doc;
+  if (!doc.open(in_path)) {
+    int rc = doc.os_errno() ? GSX_E_INPUT_NOT_FOUND : GSX_E_PDF_PARSE;
+    set_last_error_json(rc, "recompress.open", doc.os_errno(), 0, nullptr);
+    return rc;
+  }
+  if (doc.encrypted()) {
+    set_last_error_json(GSX_E_PDF_ENCRYPTED, "recompress.open", 0, 0, nullptr);
+    return GSX_E_PDF_ENCRYPTED;
+  }
+  std::vector<PageInfo> pages;
+  if (!doc.pages(pages)) {
+    set_last_error_json(GSX_E_PDF_PARSE, "recompress.pages", 0, 0, nullptr);
+    return GSX_E_PDF_PARSE;
+  }
+
+  // 1) onde cada imagem aparece
+  GsxImageScan scan;
+  for (size_t k = 0; k < pages.size(); ++k) gsx_scan_page_images(doc, pages[k], (int)k + 1, scan);
+
+  // 2) objetos + candidatas; máscaras (SMask/Mask de outra imagem) ficam de fora
+  const auto& xr = doc.xref();
+  std::vector<Indirect> objs(xr.size());
+  std::vector<char> present(xr.size(), 0);
+  std::unordered_set<uint32_t> masks;
+  int images = 0;
+  for (uint32_t n = 1; n < xr.size(); ++n) {
+    if (!xr[n].type || !doc.load(n, objs[n])) continue;
+    present[n] = 1;
+    const Obj& v = objs[n].value;
+    const Obj* sub = v.get("Subtype");
+    if (!objs[n].is_stream || !sub || !sub->is_name("Image")) continue;
+    ++images;
+    for (const char* key : {"SMask", "Mask"}) {
+      const Obj* m = v.get(key);
+      if (m && m->is_ref()) masks.insert(m->ref_num());
+    }
+  }
+  std::vector<Cand> cands;
+  for (uint32_t n = 1; n < xr.size(); ++n) {
+    if (!present[n] || !objs[n].is_stream || masks.count(n)) continue;
+    const Obj* sub = objs[n].value.get("Subtype");
+    if (!sub || !sub->is_name("Image")) continue;
+    Cand c;
+    if (plan_image(doc, objs[n], scan, dpi, gray, c)) cands.push_back(std::move(c));
+  }
+
+  // 3) decodifica/reduz/codifica em paralelo, maiores primeiro
+  std::vector<size_t> order(cands.size());
+  for (size_t i = 0; i < order.size(); ++i) order[i] = i;
+  std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return (uint64_t)cands[a].w * cands[a].h > (uint64_t)cands[b].w * cands[b].h;
+  });
+  int workers = opts && opts->workers > 0 ? opts->workers : (int)std::thread::hardware_concurrency();
+  workers = std::max(1, std::min(workers, (int)cands.size()));
+  std::atomic<size_t> next{0};
+  std::atomic<int> done{0};
+  std::mutex cb_m;
+  auto work = [&]() {
+    for (;;) {
+      if (cancel_flag && *cancel_flag) return;
+      const size_t i = next++;
+      if (i >= order.size()) return;
+      process(cands[order[i]], quality);
+      const int d = ++done;
+      if (on_progress) {
+        const std::string line = "Image " + std::to_string(d);
+        std::lock_guard<std::mutex> lk(cb_m);
+        on_progress(d, (int)cands.size(), line.c_str(), user);
+      }
+    }
+  };
+  if (!cands.empty()) {
+    std::vector<std::thread> pool;
+    for (int i = 1; i < workers; ++i) pool.emplace_back(work);
+    work();
+    for (auto& t : pool) t.join();
+  }
+  if (cancel_flag && *cancel_flag) {
+    set_last_error_json(GSX_E_CANCELED, "recompress", 0, 0, nullptr);
+    return GSX_E_CANCELED;
+  }
+
+  // 4) regravação com os números originais
+  std::vector<int> repl(xr.size(), -1);
+  gsx_recompress_stats_t st{};
+  st.images = images;
+  st.bytes_in = doc.size();
+  int jbig2 = 0;
+  for (size_t i = 0; i < cands.size(); ++i) {
+    if (cands[i].out.empty()) continue;
+    repl[cands[i].num] = (int)i;
+    ++st.recompressed;
+    if (cands[i].bilevel) ++jbig2;
+    if (cands[i].nw != cands[i].w || cands[i].nh != cands[i].h) ++st.downsampled;
+    st.image_bytes_in += cands[i].len;
+    st.image_bytes_out += cands[i].out.size();
+  }
+
+  // nada a trocar: a regravação só perderia a compactação dos object streams
+  fs::create_directories(fs::path(out_path).parent_path(), ec);
+  if (!st.recompressed) return copy_input(doc, in_path, out_path, st, stats_out);
+
+  // dicionário e stream de dicas da linearização ficariam inválidos: saem
+  uint32_t lin_num = 0;
+  uint64_t hint_off = 0;
+  for (uint32_t n = 1; n < xr.size() && doc.linearized(); ++n) {
+    if (!present[n] || !objs[n].value.get("Linearized")) continue;
+    lin_num = n;
+    Obj hs = doc.get(objs[n].value, "H");
+    if (hs.is_array() && !hs.arr->empty()) hint_off = (uint64_t)(*hs.arr)[0].as_int(0);
+    break;
+  }
+
+  // JBIG2Decode é do PDF 1.4: entrada mais antiga com imagem 1 bit recodificada sobe o cabeçalho
+  Writer w;
+  if (!w.open(out_path, jbig2 ? std::max(doc.version(), 14) : doc.version())) {
+    set_last_error_json(GSX_E_WRITE_OPEN, "recompress.out", w.os_errno(), 0, nullptr);
+    return GSX_E_WRITE_OPEN;
+  }
+  for (uint32_t n = 1; n < xr.size(); ++n) w.reserve();
+
+  bool ok = true;
+  for (uint32_t n = 1; n < xr.size() && ok; ++n) {
+    if (!present[n] || n == lin_num) continue;
+    const Indirect& ind = objs[n];
+    if (ind.is_stream) {
+      const Obj* t = ind.value.get("Type");
+      if (t && (t->is_name("ObjStm") || t->is_name("XRef"))) continue;   // refeitos pela xref clássica
+      if (hint_off && ind.obj_off == hint_off) continue;
+    }
+    if (repl[n] >= 0) {
+      const Cand& c = cands[(size_t)repl[n]];
+      Obj d = c.dict;
+      d.dict = std::make_shared<Dict>(*d.dict);
+      d.set("Filter", Obj::make_name(c.bilevel ? "JBIG2Decode" : "DCTDecode"));
+      d.erase("DecodeParms");
+      d.erase("DL");
+      d.set("Width", Obj::make_int(c.nw));
+      d.set("Height", Obj::make_int(c.nh));
+      if (c.to_gray) d.set("ColorSpace", Obj::make_name("DeviceGray"));
+      ok = w.write_stream(n, d, (const uint8_t*)c.out.data(), c.out.size());
+      continue;
+    }
+    const size_t end = ind.in_objstm ? 0 : object_end(doc, ind);
+    if (end > ind.obj_off) {
+      ok = w.write_raw(n, ind.gen, doc.data() + ind.obj_off, end - ind.obj_off);
+    } else {
+      const std::string s = serialize_indirect(doc, ind);
+      ok = w.write_raw(n, ind.gen, (const uint8_t*)s.data(), s.size());
+    }
+  }
+  if (ok) {
+    Obj trailer = Obj::make_dict();
+    for (const char* key : {"Root", "Info", "ID"}) {
+      const Obj* v = doc.trailer().get(key);
+      if (v) trailer.set(key, *v);
+    }
+    ok = w.finish(trailer);
+  }
+  if (!ok) {
+    set_last_error_json(GSX_E_WRITE_IO, "recompress.write", w.os_errno(), 0, nullptr);
+    w.close();
+    fs::remove(out_path, ec);
+    return GSX_E_WRITE_IO;
+  }
+  st.bytes_out = w.bytes_written();
+  if (st.bytes_out >= st.bytes_in) {
+    // o ganho nas imagens não pagou a xref clássica e os objetos desempacotados
+    st = gsx_recompress_stats_t{};
+    st.images = images;
+    st.bytes_in = doc.size();
+    return copy_input(doc, in_path, out_path, st, stats_out);
+  }
+  if (stats_out) *stats_out = st;
+
+  const auto ms = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - t0).count();
+  std::string msg = "recompress_images: " + std::to_string(st.recompressed) + " de " + std::to_string(images) +
+                    " imagens (" + std::to_string(st.downsampled) + " reduzidas a " + std::to_string(dpi) +
+                    " dpi, " + std::to_string(jbig2) + " de 1 bit em JBIG2), " + std::to_string(st.image_bytes_in) + " -> " + std::to_string(st.image_bytes_out) +
+                    " bytes; arquivo " + std::to_string(st.bytes_in) + " -> " + std::to_string(st.bytes_out) +
+                    " em " + std::to_string((long long)ms) + " ms, " + std::to_string(workers) + " threads";
+  gsx_log_msg(GSX_LOG_INFO, msg.c_str());
+  set_last_error_json(GSX_OK, "recompress", 0, 0, nullptr);
+  return st.recompressed;
+}
+
+bool gsx_images_engine_applies(const char* preset, const char* in_path, int first_page, int last_page) {
+  if (!preset || strcmp(preset, GSX_PRESET_IMAGES) != 0 || first_page > 1) return false;
+  if (last_page <= 0) return true;
+  Document doc;
+  if (!doc.open(in_path)) return false;
+  const int count = doc.page_count_fast();
+  return count > 0 && last_page >= count;
+}
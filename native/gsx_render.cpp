@@ -0,0 +1,448 @@
+// gsx_render.cpp — renderização para a memória pelo device display (gsx_render_pages)
+//
+// O Ghostscript desenha direto num bitmap nosso (display_memalloc) e avisa no fim de
+// cada página (display_page); nada passa por arquivo nem pelo stdout. Com band_height
+// o device fica no modo de faixas do display v3: a alocação da página inteira é
+// recusada e ele pede retângulos (display_rectangle_request) — cada pedido seguinte
+// significa que o anterior está pronto, então a faixa é entregue e a próxima é cedida.
+//
+// Os bitmaps vêm do chamador (opts.alloc) ou de um pool global reaproveitado entre
+// páginas e chamadas (miniaturas em sequência não realocam). As faixas de páginas são
+// equilibradas pelo peso do gsx_plan_chunks, uma instância do Ghostscript por faixa.
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+extern "C" {
+  #include "iapi.h"
+  #include "gdevdsp.h"
+}
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+static const int kDefaultDpi = 72;
+static const int kPoolMaxBlocks = 8;       // bitmaps guardados no pool (o resto é liberado)
+
+// ======================= Pool de bitmaps =======================
+namespace {
+
+struct Block { void* p; size_t size; };
+
+std::mutex g_pool_mtx;
+std::vector<Block> g_pool;
+
+// o menor bloco livre que caiba sem desperdiçar mais que o dobro
+static void* pool_get(size_t size) {
+  {
+    std::lock_guard<std::mutex> lk(g_pool_mtx);
+    size_t best = g_pool.size();
+    for (size_t i = 0; i < g_pool.size(); ++i)
+      if (g_pool[i].size >= size && g_pool[i].size <= size * 2 &&
+          (best == g_pool.size() || g_pool[i].size < g_pool[best].size))
+        best = i;
+    if (best < g_pool.size()) {
+      void* p = g_pool[best].p;
+      g_pool.erase(g_pool.begin() + (std::ptrdiff_t)best);
+      return p;
+    }
+  }
+  return malloc(size);
+}
+
+static void pool_put(void* p, size_t size) {
+  if (!p) return;
+  void* drop = nullptr;
+  {
+    std::lock_guard<std::mutex> lk(g_pool_mtx);
+    g_pool.push_back(Block{p, size});
+    if ((int)g_pool.size() > kPoolMaxBlocks) {
+      drop = g_pool.front().p;
+      g_pool.erase(g_pool.begin());
+    }
+  }
+  free(drop);
+}
+
+// ======================= Job / worker =======================
+struct Job {
+  gsx_render_opts_t o;
+  unsigned format = 0;
+  int bpp = 24;
+  gsx_raster_cb on_raster = nullptr;
+  void* raster_user = nullptr;
+  gsx_progress_cb on_progress = nullptr;
+  void* user = nullptr;
+  volatile int* user_cancel = nullptr;
+  volatile int stop = 0;                     // cancelamento (chamador ou callback) → poll do GS
+  std::mutex progress_mtx;
+  int delivered = 0, total = 0;
+};
+
+struct Worker {
+  Job* job = nullptr;
+  int index = 0;
+  int page = 0;                              // próxima página a ser entregue
+  int pages = 0;
+  int w = 0, h = 0, raster = 0;
+  unsigned char* image = nullptr;            // bitmap da página (modo página)
+  std::vector<Block> live;                   // alocações feitas via display_memalloc
+  // modo faixa
+  uint8_t* band = nullptr;
+  size_t band_size = 0;
+  int band_stride = 0;
+  int band_y = -1, band_rows = 0;
+  display_callback cb;
+
+  void* mem_get(size_t size) {
+    void* p = job->o.alloc ? job->o.alloc(size, job->o.alloc_user) : pool_get(size);
+    if (p) live.push_back(Block{p, size});
+    return p;
+  }
+  void mem_put(void* p) {
+    if (!p) return;
+    size_t size = 0;
+    for (size_t i = 0; i < live.size(); ++i)
+      if (live[i].p == p) { size = live[i].size; live.erase(live.begin() + (std::ptrdiff_t)i); break; }
+    if (job->o.alloc) { if (job->o.free_mem) job->o.free_mem(p, job->o.alloc_user); }
+    else pool_put(p, size);
+  }
+  void release_all() {
+    while (!live.empty()) mem_put(live.back().p);
+    band = nullptr;
+    band_size = 0;
+  }
+
+  bool canceled() {
+    if (job->user_cancel && *job->user_cancel) job->stop = 1;
+    return job->stop != 0;
+  }
+
+  int deliver(const uint8_t* data, int y, int rows, int stride) {
+    if (canceled()) return -1;
+    gsx_raster_t r;
+    r.page = page;
+    r.width = w;
+    r.height = h;
+    r.y = y;
+    r.rows = rows;
+    r.stride = stride;
+    r.color = job->o.color;
+    r.bits_per_pixel = job->bpp;
+    r.worker = index;
+    r.data = data;
+    if (job->on_raster && job->on_raster(&r, job->raster_user) != 0) {
+      job->stop = 1;
+      return -1;
+    }
+    return 0;
+  }
+
+  void page_done() {
+    ++pages;
+    Job& j = *job;
+    if (j.on_progress) {
+      std::lock_guard<std::mutex> lk(j.progress_mtx);
+      ++j.delivered;
+      char line[32];
+      snprintf(line, sizeof(line), "Page %d", page);
+      j.on_progress(j.delivered, j.total, line, j.user);
+    }
+    ++page;
+  }
+};
+
+static Worker* W(void* handle) { return static_cast<Worker*>(gsx_display_user(handle)); }
+
+// ----------------------- callbacks do display -----------------------
+static int dsp_open(void*, void*) { return 0; }
+static int dsp_preclose(void*, void*) { return 0; }
+static int dsp_close(void*, void*) { return 0; }
+static int dsp_sync(void*, void*) { return 0; }
+
+static int dsp_presize(void* handle, void*, int width, int height, int raster, unsigned int format) {
+  Worker* wk = W(handle);
+  if (!wk || format != wk->job->format) return -1;
+  wk->w = width;
+  wk->h = height;
+  wk->raster = raster;
+  return 0;
+}
+
+static int dsp_size(void* handle, void*, int width, int height, int raster, unsigned int, unsigned char* pimage) {
+  Worker* wk = W(handle);
+  if (!wk) return -1;
+  wk->w = width;
+  wk->h = height;
+  wk->raster = raster;
+  wk->image = pimage;
+  return 0;
+}
+
+static int dsp_update(void* handle, void*, int, int, int, int) {
+  Worker* wk = W(handle);
+  return wk && wk->canceled() ? -1 : 0;
+}
+
+static int dsp_page(void* handle, void*, int, int) {
+  Worker* wk = W(handle);
+  if (!wk) return -1;
+  if (wk->job->o.band_height > 0) return wk->canceled() ? -1 : 0;   // faixas já entregues
+  if (!wk->image) return -1;
+  if (wk->deliver(wk->image, 0, wk->h, wk->raster) < 0) return -1;
+  wk->page_done();
+  return 0;
+}
+
+static void* dsp_memalloc(void* handle, void*, size_t size) {
+  Worker* wk = W(handle);
+  if (!wk || wk->job->o.band_height > 0) return nullptr;     // força o modo de faixas
+  return wk->mem_get(size);
+}
+
+static int dsp_memfree(void* handle, void*, void* mem) {
+  Worker* wk = W(handle);
+  if (!wk) return -1;
+  if (mem == wk->image) wk->image = nullptr;
+  wk->mem_put(mem);
+  return 0;
+}
+
+static int dsp_adjust_band_height(void* handle, void*, int) {
+  Worker* wk = W(handle);
+  return wk ? wk->job->o.band_height : 0;
+}
+
+static int dsp_rectangle_request(void* handle, void*, void** memory, int* ox, int* oy,
+                                 int* raster, int* plane_raster, int* x, int* y, int* w, int* h) {
+  Worker* wk = W(handle);
+  if (!wk) return -1;
+  if (wk->band_y >= 0) {                               // o retângulo anterior está pronto
+    if (wk->deliver(wk->band, wk->band_y, wk->band_rows, wk->band_stride) < 0) return -1;
+    wk->band_y += wk->band_rows;
+  } else {
+    wk->band_y = 0;
+  }
+  if (wk->band_y >= wk->h) {                           // página completa
+    *memory = nullptr;
+    *ox = *oy = *x = *y = *w = *h = 0;
+    *raster = *plane_raster = 0;
+    wk->band_y = -1;
+    wk->page_done();
+    return 0;
+  }
+  const int bits = wk->w * wk->job->bpp;
+  wk->band_stride = ((bits + 7) / 8 + 3) & ~3;
+  const size_t need = (size_t)wk->band_stride * (size_t)wk->job->o.band_height;
+  if (need > wk->band_size) {
+    if (wk->band) wk->mem_put(wk->band);
+    wk->band = (uint8_t*)wk->mem_get(need);
+    wk->band_size = wk->band ? need : 0;
+    if (!wk->band) return -1;
+  }
+  wk->band_rows = std::min(wk->job->o.band_height, wk->h - wk->band_y);
+  *memory = wk->band;
+  *ox = 0;
+  *oy = wk->band_y;
+  *raster = wk->band_stride;
+  *plane_raster = wk->band_stride * wk->band_rows;
+  *x = 0;
+  *y = wk->band_y;
+  *w = wk->w;
+  *h = wk->band_rows;
+  return 0;
+}
+
+static void init_callbacks(display_callback& cb, bool bands) {
+  memset(&cb, 0, sizeof(cb));
+  cb.size = sizeof(cb);
+  cb.version_major = DISPLAY_VERSION_MAJOR;
+  cb.version_minor = DISPLAY_VERSION_MINOR;
+  cb.display_open = dsp_open;
+  cb.display_preclose = dsp_preclose;
+  cb.display_close = dsp_close;
+  cb.display_presize = dsp_presize;
+  cb.display_size = dsp_size;
+  cb.display_sync = dsp_sync;
+  cb.display_page = dsp_page;
+  cb.display_update = dsp_update;
+  cb.display_memalloc = dsp_memalloc;
+  cb.display_memfree = dsp_memfree;
+  if (bands) {
+    cb.display_adjust_band_height = dsp_adjust_band_height;
+    cb.display_rectangle_request = dsp_rectangle_request;
+  }
+}
+
+static int render_range(Job& job, int index, const char* in_path, int first, int last, Worker& wk) {
+  const gsx_render_opts_t& o = job.o;
+  std::vector<std::string> A = {
+    "gs", "-dSAFER", "-dBATCH", "-dNOPAUSE", "-dQUIET",
+    "-sDEVICE=display", "-dDisplayFormat=" + std::to_string(job.format),
+    "-r" + std::to_string(o.dpi),
+    "-dTextAlphaBits=" + std::to_string(o.alpha_bits),
+    "-dGraphicsAlphaBits=" + std::to_string(o.alpha_bits),
+  };
+  if (o.render_threads > 0) A.push_back("-dNumRenderingThreads=" + std::to_string(o.render_threads));
+  if (o.band_height > 0) A.push_back("-dBandHeight=" + std::to_string(o.band_height));
+  A.push_back("-dFirstPage=" + std::to_string(first));
+  A.push_back("-dLastPage=" + std::to_string(last));
+  A.push_back(in_path);
+
+  wk.job = &job;
+  wk.index = index;
+  wk.page = first;
+  init_callbacks(wk.cb, o.band_height > 0);
+  int rc = gsx_run_gs_display(A, &wk.cb, &wk, nullptr, nullptr, &job.stop);
+  wk.release_all();
+  if (rc < 0) return rc;
+  if (wk.pages < last - first + 1) {
+    char msg[96];
+    snprintf(msg, sizeof(msg), "render: %d de %d páginas entregues (%d-%d)",
+             wk.pages, last - first + 1, first, last);
+    gsx_log_msg(GSX_LOG_WARN, msg);
+  }
+  return wk.pages;
+}
+
+}  // namespace
+
+GSX_API int gsx_render_pages(
+  const char* in_path,
+  int first_page,
+  int last_page,
+  const gsx_render_opts_t* opts,
+  gsx_raster_cb on_raster, void* raster_user,
+  gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  gsx_render_opts_t o{};
+  if (opts) o = *opts;
+  if (!in_path || !on_raster || first_page < 0 || last_page < 0 || (last_page && first_page > last_page) ||
+      o.dpi < 0 || o.dpi > 2400 || o.color < GSX_RENDER_RGB || o.color > GSX_RENDER_MONO ||
+      o.band_height < 0 || (o.alloc && !o.free_mem)) {
+    set_last_error_json(GSX_E_ARGS, "render_pages", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  if (o.dpi == 0) o.dpi = kDefaultDpi;
+  if (o.color == GSX_RENDER_MONO) o.alpha_bits = 1;     // anti-aliasing não existe em 1 bit
+  else if (o.alpha_bits != 1 && o.alpha_bits != 2) o.alpha_bits = 4;
+
+  Job job;
+  job.o = o;
+  job.on_raster = on_raster;
+  job.raster_user = raster_user;
+  job.on_progress = on_progress;
+  job.user = user;
+  job.user_cancel = cancel_flag;
+  const unsigned common = DISPLAY_ALPHA_NONE | DISPLAY_BIGENDIAN | DISPLAY_TOPFIRST | DISPLAY_CHUNKY;
+  switch (o.color) {
+    case GSX_RENDER_GRAY: job.format = common | DISPLAY_COLORS_GRAY | DISPLAY_DEPTH_8; job.bpp = 8; break;
+    case GSX_RENDER_MONO: job.format = common | DISPLAY_COLORS_NATIVE | DISPLAY_DEPTH_1; job.bpp = 1; break;
+    default:              job.format = common | DISPLAY_COLORS_RGB | DISPLAY_DEPTH_8; job.bpp = 24; break;
+  }
+
+  int first = first_page, last = last_page;
+  std::vector<uint64_t> weights;
+  int rc = gsx_page_weights(in_path, first, last, weights);
+  if (rc < 0) return rc;
+  job.total = last - first + 1;
+
+  int workers = o.workers > 0 ? o.workers : (int)std::thread::hardware_concurrency();
+  workers = std::max(1, std::min(workers, job.total));
+  auto ranges = gsx_partition_weights(weights, workers);
+
+  std::vector<Worker> wks(ranges.size());
+  std::vector<int> rcs(ranges.size(), 0);
+  std::vector<std::thread> pool;
+  for (size_t k = 0; k < ranges.size(); ++k) {
+    pool.emplace_back([&, k] {
+      int a = first + (int)ranges[k].first, b = first + (int)ranges[k].second;
+      rcs[k] = render_range(job, (int)k, in_path, a, b, wks[k]);
+    });
+  }
+  for (auto& t : pool) t.join();
+
+  if (job.stop || (cancel_flag && *cancel_flag)) {
+    set_last_error_json(GSX_E_CANCELED, "render_pages", 0, 0, nullptr);
+    return GSX_E_CANCELED;
+  }
+  int pages = 0;
+  for (int r : rcs) {
+    if (r < 0) {
+      set_last_error_json(r, "render_pages", 0, r, nullptr);
+      return r;
+    }
+    pages += r;
+  }
+  set_last_error_json(GSX_OK, "render_pages", 0, 0, nullptr);
+  return pages;
+}
+
+GSX_API void gsx_render_pool_trim(void) {
+  std::vector<Block> drop;
+  {
+    std::lock_guard<std::mutex> lk(g_pool_mtx);
+    drop.swap(g_pool);
+  }
+  for (auto& b : drop) free(b.p);
+}
+
+// ======================= Coletor em memória =======================
+struct gsx_raster_list_s {
+  std::mutex mtx;
+  std::map<int, std::pair<gsx_raster_t, std::vector<uint8_t>>> pages;   // por página
+  std::vector<const gsx_raster_t*> order;
+};
+
+GSX_API gsx_raster_list_t* gsx_raster_list_new(void) { return new gsx_raster_list_t(); }
+
+GSX_API int GSX_CALL gsx_raster_list_collect(const gsx_raster_t* r, void* list) {
+  auto* L = static_cast<gsx_raster_list_t*>(list);
+  if (!L || !r || !r->data || r->y < 0 || r->y + r->rows > r->height) return 1;
+  const size_t tight = ((size_t)r->width * (size_t)r->bits_per_pixel + 7) / 8;
+  std::lock_guard<std::mutex> lk(L->mtx);
+  auto it = L->pages.find(r->page);
+  if (it == L->pages.end()) {
+    gsx_raster_t head = *r;
+    head.y = 0;
+    head.rows = r->height;
+    head.stride = (int)tight;
+    head.data = nullptr;
+    it = L->pages.emplace(r->page, std::make_pair(head, std::vector<uint8_t>(tight * (size_t)r->height))).first;
+  }
+  uint8_t* dst = it->second.second.data();
+  for (int y = 0; y < r->rows; ++y)
+    memcpy(dst + (size_t)(r->y + y) * tight, r->data + (size_t)y * (size_t)r->stride, tight);
+  L->order.clear();
+  return 0;
+}
+
+GSX_API int gsx_raster_list_count(gsx_raster_list_t* L) {
+  if (!L) return 0;
+  std::lock_guard<std::mutex> lk(L->mtx);
+  return (int)L->pages.size();
+}
+
+GSX_API const gsx_raster_t* gsx_raster_list_get(gsx_raster_list_t* L, int index) {
+  if (!L) return nullptr;
+  std::lock_guard<std::mutex> lk(L->mtx);
+  if (L->order.size() != L->pages.size()) {
+    L->order.clear();
+    for (auto& kv : L->pages) {
+      kv.second.first.data = kv.second.second.data();
+      L->order.push_back(&kv.second.first);
+    }
+  }
+  if (index < 0 || index >= (int)L->order.size()) return nullptr;
+  return L->order[(size_t)index];
+}
+
+GSX_API void gsx_raster_list_free(gsx_raster_list_t* L) { delete L; }
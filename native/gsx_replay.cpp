@@ -0,0 +1,509 @@
+// gsx_replay.cpp — captura da carga real e replay contra outra build (gsx_capture_*, gsx_replay_run)
+//
+// Captura: cada chamada de topo de compressão guarda, ao começar, os parâmetros, o
+// tamanho e o hash da entrada (que no caminho por fd pode ser um temporário apagado no
+// fim) e, ao terminar, grava uma linha JSON com a chegada relativa ao início da captura,
+// o resultado, a duração e os bytes gravados. As linhas saem na ordem de término; o
+// replay reordena pela chegada.
+//
+// Replay: uma thread despacha cada registro na chegada gravada dividida por 'speed' para
+// uma fila atendida por 'concurrency' workers — laço aberto, como a carga original: se
+// a build nova for mais lenta a fila cresce e a latência mostra isso. Latência conta da
+// chegada prevista; serviço só a chamada. As entradas são achadas pelo caminho gravado
+// (se tamanho e hash conferem) ou, em inputs_dir, pelo tamanho e depois pelo hash.
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+std::atomic<bool> g_gsx_capture_on{false};
+
+namespace {
+
+std::mutex g_cap_m;
+FILE* g_cap_f = nullptr;
+Clock::time_point g_cap_t0;
+
+// Tamanho e hash do arquivo inteiro (blocos de 1 MiB encadeados pela semente)
+static bool hash_file(const std::string& path, uint64_t& size, uint64_t& hash) {
+  size = 0;
+  hash = 0;
+  FILE* f = fopen(path.c_str(), "rb");
+  if (!f) return false;
+  std::vector<uint8_t> buf(1 << 20);
+  size_t n;
+  while ((n = fread(buf.data(), 1, buf.size(), f)) > 0) {
+    hash = gsx_hash_bytes(buf.data(), n, hash);
+    size += n;
+  }
+  const bool ok = !ferror(f);
+  fclose(f);
+  return ok;
+}
+
+static std::string hex64(uint64_t v) {
+  char b[20];
+  snprintf(b, sizeof b, "%016llx", (unsigned long long)v);
+  return b;
+}
+
+// ---- leitura dos registros (só o que gsx_capture_write produz) ----
+
+// Lê a string JSON que começa em p (no '"'); avança p até depois do fecho
+static bool read_string(const char*& p, std::string& out) {
+  out.clear();
+  if (*p != '"') return false;
+  for (++p; *p && *p != '"'; ++p) {
+    if (*p != '\\') { out.push_back(*p); continue; }
+    switch (*++p) {
+      case 'n': out.push_back('\n'); break;
+      case 't': out.push_back('\t'); break;
+      case 'r': out.push_back('\r'); break;
+      case 'b': out.push_back('\b'); break;
+      case 'f': out.push_back('\f'); break;
+      case 'u': {
+        // gsx_json_escape só gera \u00XX (controles)
+        if (!p[1] || !p[2] || !p[3] || !p[4]) return false;
+        char hex[5] = {p[1], p[2], p[3], p[4], 0};
+        out.push_back((char)strtol(hex, nullptr, 16));
+        p += 4;
+        break;
+      }
+      case 0: return false;
+      default: out.push_back(*p);
+    }
+  }
+  if (*p != '"') return false;
+  ++p;
+  return true;
+}
+
+static const char* find_key(const std::string& js, const char* key) {
+  const std::string k = std::string("\"") + key + "\":";
+  size_t p = js.find(k);
+  return p == std::string::npos ? nullptr : js.c_str() + p + k.size();
+}
+
+static bool json_number(const std::string& js, const char* key, double& v) {
+  const char* b = find_key(js, key);
+  if (!b) return false;
+  char* e = nullptr;
+  v = strtod(b, &e);
+  return e != b;
+}
+
+static int json_int(const std::string& js, const char* key, int def = 0) {
+  double v;
+  return json_number(js, key, v) ? (int)v : def;
+}
+
+static bool json_string(const std::string& js, const char* key, std::string& v) {
+  const char* b = find_key(js, key);
+  return b && read_string(b, v);
+}
+
+struct Record {
+  double t = 0;                 // chegada gravada (ms desde o início da captura)
+  std::string call, in, preset;
+  uint64_t size = 0, hash = 0;
+  int dpi = 0, quality = 0, mode = 0, first = 0, last = 0, workers = 0, flags = 0;
+  int rc = 0;
+  double ms = 0;
+  // replay
+  bool readable = true;         // a entrada existia na captura (hash gravado)
+  std::string path;             // entrada resolvida (vazia = não encontrada)
+  int new_rc = 0;
+  double latency_ms = 0, service_ms = 0;
+  bool done = false;
+};
+
+static bool parse_record(const std::string& js, Record& r) {
+  std::string hash;
+  if (!json_number(js, "t", r.t) || !json_string(js, "call", r.call) || !json_string(js, "in", r.in) ||
+      !json_string(js, "hash", hash))
+    return false;
+  double size = 0;
+  json_number(js, "size", size);
+  r.size = (uint64_t)size;
+  r.readable = !hash.empty();
+  r.hash = strtoull(hash.c_str(), nullptr, 16);
+  json_string(js, "preset", r.preset);
+  r.dpi = json_int(js, "dpi");
+  r.quality = json_int(js, "q");
+  r.mode = json_int(js, "mode");
+  r.first = json_int(js, "first");
+  r.last = json_int(js, "last");
+  r.workers = json_int(js, "workers");
+  r.flags = json_int(js, "flags");
+  r.rc = json_int(js, "rc");
+  json_number(js, "ms", r.ms);
+  return true;
+}
+
+// ---- entradas ----
+
+class InputIndex {
+ public:
+  explicit InputIndex(const char* dir) {
+    if (!dir || !*dir) return;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+      std::error_code fe;
+      if (!it->is_regular_file(fe)) continue;
+      const uintmax_t n = it->file_size(fe);
+      if (!fe) by_size_.emplace((uint64_t)n, it->path().string());
+    }
+  }
+
+  // Caminho com o mesmo conteúdo gravado, ou vazio
+  std::string resolve(const Record& r) {
+    if (!r.readable) return r.in;   // a falha gravada é parte da carga
+    const auto key = std::make_pair(r.size, r.hash);
+    auto hit = resolved_.find(key);
+    if (hit != resolved_.end()) return hit->second;
+    std::string found;
+    if (matches(r.in, r)) found = r.in;
+    auto range = by_size_.equal_range(r.size);
+    for (auto it = range.first; found.empty() && it != range.second; ++it)
+      if (matches(it->second, r)) found = it->second;
+    resolved_[key] = found;
+    return found;
+  }
+
+ private:
+  bool matches(const std::string& path, const Record& r) {
+    std::error_code ec;
+    const uintmax_t n = fs::file_size(path, ec);
+    if (ec || (uint64_t)n != r.size) return false;
+    auto h = hashes_.find(path);
+    if (h == hashes_.end()) {
+      uint64_t size = 0, hash = 0;
+      if (!hash_file(path, size, hash)) return false;
+      h = hashes_.emplace(path, hash).first;
+    }
+    return h->second == r.hash;
+  }
+
+  std::multimap<uint64_t, std::string> by_size_;
+  std::map<std::string, uint64_t> hashes_;
+  std::map<std::pair<uint64_t, uint64_t>, std::string> resolved_;
+};
+
+// ---- execução ----
+
+static void remove_parts(const char* parts_json) {
+  if (!parts_json) return;
+  std::error_code ec;
+  std::string part;
+  for (const char* p = parts_json; (p = strchr(p, '"')) != nullptr;)
+    if (read_string(p, part)) fs::remove(part, ec);
+    else break;
+}
+
+static int run_record(const Record& r, const std::string& out, const char* work_dir, volatile int* cancel_flag) {
+  const char* preset = r.preset.empty() ? nullptr : r.preset.c_str();
+  const gsx_color_mode_t mode = (gsx_color_mode_t)r.mode;
+  int rc;
+  if (r.call == "compress_parallel") {
+    gsx_parallel_opts_t po{};
+    po.workers = r.workers;
+    po.work_dir = work_dir;
+    char* parts = nullptr;
+    rc = gsx_compress_parallel_sync(r.path.c_str(), r.dpi, r.quality, preset, mode, r.first, r.last, &po, &parts,
+                                    nullptr, nullptr, cancel_flag);
+    remove_parts(parts);
+    gsx_free(parts);
+  } else if (r.call == "pipeline") {
+    gsx_pipeline_opts_t po{};
+    po.dpi = r.dpi;
+    po.jpeg_quality = r.quality;
+    po.preset = preset;
+    po.mode = mode;
+    po.first_page = r.first;
+    po.last_page = r.last;
+    po.workers = r.workers;
+    po.linearize = (r.flags & 1) ? 1 : 0;
+    po.skip_dedup = (r.flags & 2) ? 1 : 0;
+    po.work_dir = work_dir;
+    rc = gsx_pipeline_run(r.path.c_str(), out.c_str(), &po, nullptr, nullptr, nullptr, cancel_flag);
+  } else {
+    // compress_file e compress_fd: o caminho por fd só acrescenta cópias em volta
+    rc = gsx_compress_file_sync(r.path.c_str(), out.c_str(), r.dpi, r.quality, preset, mode, r.first, r.last,
+                                nullptr, nullptr, cancel_flag);
+  }
+  std::error_code ec;
+  fs::remove(out, ec);
+  return rc;
+}
+
+struct Dist { double p50 = 0, p90 = 0, p99 = 0, max = 0, mean = 0; };
+
+// Percentis por posto mais próximo
+static Dist dist(std::vector<double> v) {
+  Dist d;
+  if (v.empty()) return d;
+  std::sort(v.begin(), v.end());
+  auto at = [&](double q) {
+    size_t i = (size_t)std::ceil(q * (double)v.size());
+    return v[std::min(v.size(), std::max<size_t>(i, 1)) - 1];
+  };
+  d.p50 = at(0.50);
+  d.p90 = at(0.90);
+  d.p99 = at(0.99);
+  d.max = v.back();
+  double sum = 0;
+  for (double x : v) sum += x;
+  d.mean = sum / (double)v.size();
+  return d;
+}
+
+static std::string dist_json(const Dist& d) {
+  char b[192];
+  snprintf(b, sizeof b, "{\"p50\":%.1f,\"p90\":%.1f,\"p99\":%.1f,\"max\":%.1f,\"mean\":%.1f}", d.p50, d.p90, d.p99,
+           d.max, d.mean);
+  return b;
+}
+
+static bool canceled(volatile int* flag) { return flag && *flag; }
+
+}  // namespace
+
+std::string gsx_capture_params(const GsxCaptureParams& p) {
+  uint64_t size = 0, hash = 0;
+  // entrada ilegível: hash vazio, o replay repete a chamada com o mesmo caminho
+  const bool readable = p.in_path && hash_file(p.in_path, size, hash);
+  char nums[192];
+  snprintf(nums, sizeof nums,
+           ",\"size\":%llu,\"hash\":\"%s\",\"dpi\":%d,\"q\":%d,\"mode\":%d,\"first\":%d,\"last\":%d,\"workers\":%d,"
+           "\"flags\":%d", (unsigned long long)size, readable ? hex64(hash).c_str() : "", p.dpi, p.jpeg_quality, p.mode, p.first_page,
+           p.last_page, p.workers, p.flags);
+  return std::string("\"call\":\"") + p.call + "\",\"in\":\"" + gsx_json_escape(p.in_path ? p.in_path : "") +
+         "\",\"preset\":\"" + gsx_json_escape(p.preset ? p.preset : "") + "\"" + nums;
+}
+
+void gsx_capture_write(const std::string& params, Clock::time_point arrival, int rc, double ms, uint64_t bytes_out) {
+  std::lock_guard<std::mutex> lk(g_cap_m);
+  if (!g_cap_f) return;   // parada durante a chamada
+  const double t = std::max(0.0, std::chrono::duration<double, std::milli>(arrival - g_cap_t0).count());
+  fprintf(g_cap_f, "{\"t\":%.1f,%s,\"rc\":%d,\"ms\":%.1f,\"out\":%llu}\n", t, params.c_str(), rc, ms,
+          (unsigned long long)bytes_out);
+  fflush(g_cap_f);
+}
+
+GSX_API int gsx_capture_start(const char* path) {
+  if (!path || !*path) {
+    set_last_error_json(GSX_E_ARGS, "capture_start", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  std::lock_guard<std::mutex> lk(g_cap_m);
+  if (g_cap_f) fclose(g_cap_f);
+  g_cap_f = fopen(path, "wb");
+  if (!g_cap_f) {
+    g_gsx_capture_on.store(false);
+    set_last_error_json(GSX_E_WRITE_OPEN, "capture_start", errno, 0, nullptr);
+    return GSX_E_WRITE_OPEN;
+  }
+  g_cap_t0 = Clock::now();
+  char stamp[32] = "";
+  const time_t now = time(nullptr);
+  struct tm tmv;
+#ifdef _WIN32
+  gmtime_s(&tmv, &now);
+#else
+  gmtime_r(&now, &tmv);
+#endif
+  strftime(stamp, sizeof stamp, "%Y-%m-%dT%H:%M:%SZ", &tmv);
+  fprintf(g_cap_f, "{\"gsx_capture\":1,\"started\":\"%s\"}\n", stamp);
+  fflush(g_cap_f);
+  g_gsx_capture_on.store(true);
+  set_last_error_json(GSX_OK, "capture_start", 0, 0, nullptr);
+  return GSX_OK;
+}
+
+GSX_API void gsx_capture_stop(void) {
+  std::lock_guard<std::mutex> lk(g_cap_m);
+  g_gsx_capture_on.store(false);
+  if (g_cap_f) fclose(g_cap_f);
+  g_cap_f = nullptr;
+}
+
+GSX_API int gsx_capture_active(void) {
+  return gsx_capture_on() ? 1 : 0;
+}
+
+GSX_API int gsx_replay_run(const char* capture_path, const gsx_replay_opts_t* opts, char** report_json,
+                           gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  // Sem GsxJobScope: cada job reemitido é chamada de topo, com métricas e trace próprios
+  if (report_json) *report_json = nullptr;
+  gsx_replay_opts_t o{};
+  if (opts) o = *opts;
+  if (!capture_path || o.speed < 0) {
+    set_last_error_json(GSX_E_ARGS, "replay", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  const int concurrency = o.concurrency > 0 ? o.concurrency : 8;
+  const char* work_dir = o.work_dir && *o.work_dir ? o.work_dir : nullptr;
+
+  FILE* f = fopen(capture_path, "rb");
+  if (!f) {
+    set_last_error_json(GSX_E_INPUT_NOT_FOUND, "replay", errno, 0, nullptr);
+    return GSX_E_INPUT_NOT_FOUND;
+  }
+  std::vector<Record> recs;
+  {
+    std::string ln;
+    int c;
+    do {
+      c = fgetc(f);
+      if (c != EOF && c != '\n') { ln.push_back((char)c); continue; }
+      Record r;
+      if (!ln.empty() && parse_record(ln, r)) recs.push_back(std::move(r));
+      ln.clear();
+    } while (c != EOF);
+    fclose(f);
+  }
+  std::stable_sort(recs.begin(), recs.end(), [](const Record& a, const Record& b) { return a.t < b.t; });
+  if (o.limit > 0 && (size_t)o.limit < recs.size()) recs.resize((size_t)o.limit);
+  if (recs.empty()) {
+    set_last_error_json(GSX_E_ARGS, "replay.capture", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+
+  int missing = 0;
+  {
+    GsxSpan span("replay.resolve");
+    InputIndex index(o.inputs_dir);
+    for (Record& r : recs) {
+      r.path = index.resolve(r);
+      if (r.path.empty()) ++missing;
+    }
+  }
+
+  std::mutex m;
+  std::condition_variable cv;
+  std::deque<std::pair<size_t, Clock::time_point>> queue;
+  bool closed = false;
+  int finished = 0;
+  const int total = (int)recs.size() - missing;
+
+  auto worker = [&] {
+    const std::string out = gsx_make_temp_path(work_dir, "GSXR", ".pdf");
+    for (;;) {
+      std::pair<size_t, Clock::time_point> job;
+      {
+        std::unique_lock<std::mutex> lk(m);
+        cv.wait(lk, [&] { return closed || !queue.empty(); });
+        if (queue.empty()) return;
+        job = queue.front();
+        queue.pop_front();
+      }
+      Record& r = recs[job.first];
+      const Clock::time_point s0 = Clock::now();
+      const int rc = run_record(r, out, work_dir, cancel_flag);
+      const Clock::time_point s1 = Clock::now();
+      r.new_rc = rc;
+      r.service_ms = std::chrono::duration<double, std::milli>(s1 - s0).count();
+      r.latency_ms = std::chrono::duration<double, std::milli>(s1 - job.second).count();
+      std::lock_guard<std::mutex> lk(m);
+      r.done = true;
+      ++finished;
+      if (on_progress) {
+        char line[256];
+        snprintf(line, sizeof line, "replay: %s %.0f ms (gravado %.0f ms) rc=%d", r.call.c_str(), r.latency_ms, r.ms,
+                 rc);
+        on_progress(finished, total, line, user);
+      }
+    }
+  };
+
+  const Clock::time_point start = Clock::now();
+  std::vector<std::thread> pool;
+  for (int i = 0; i < concurrency; ++i) pool.emplace_back(worker);
+  const double t0 = recs.front().t;
+  for (size_t i = 0; i < recs.size() && !canceled(cancel_flag); ++i) {
+    if (recs[i].path.empty()) continue;
+    Clock::time_point due = Clock::now();
+    if (o.speed > 0) {
+      due = start + std::chrono::duration_cast<Clock::duration>(
+                        std::chrono::duration<double, std::milli>((recs[i].t - t0) / o.speed));
+      // espera em fatias curtas para atender o cancelamento
+      while (!canceled(cancel_flag) && Clock::now() < due)
+        std::this_thread::sleep_until(std::min(due, Clock::now() + std::chrono::milliseconds(100)));
+      if (canceled(cancel_flag)) break;
+    }
+    {
+      std::lock_guard<std::mutex> lk(m);
+      queue.emplace_back(i, due);
+    }
+    cv.notify_one();
+  }
+  {
+    std::lock_guard<std::mutex> lk(m);
+    closed = true;
+    if (canceled(cancel_flag)) queue.clear();
+  }
+  cv.notify_all();
+  for (std::thread& t : pool) t.join();
+  const double wall_ms = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  if (canceled(cancel_flag)) {
+    set_last_error_json(GSX_E_CANCELED, "replay", 0, 0, nullptr);
+    return GSX_E_CANCELED;
+  }
+
+  // Desfecho muda quando sucesso vira falha ou o contrário (códigos de erro podem variar)
+  int replayed = 0, failed = 0, mismatch = 0;
+  std::vector<double> lat, svc, cap;
+  for (const Record& r : recs) {
+    if (!r.done) continue;
+    ++replayed;
+    if (r.new_rc < 0) ++failed;
+    if ((r.new_rc < 0) != (r.rc < 0)) ++mismatch;
+    lat.push_back(r.latency_ms);
+    svc.push_back(r.service_ms);
+    cap.push_back(r.ms);
+  }
+  const Dist dl = dist(lat), ds = dist(svc), dc = dist(cap);
+  const double jobs_per_s = wall_ms > 0 ? replayed * 1000.0 / wall_ms : 0;
+
+  char head[384];
+  snprintf(head, sizeof head,
+           "{\"records\":%zu,\"replayed\":%d,\"missing\":%d,\"failed\":%d,\"outcome_mismatch\":%d,\"speed\":%g,"
+           "\"concurrency\":%d,\"wall_ms\":%.0f,\"jobs_per_s\":%.3f", recs.size(), replayed, missing, failed, mismatch,
+           o.speed, concurrency, wall_ms, jobs_per_s);
+  std::string js = head;
+  js += ",\"latency_ms\":" + dist_json(dl) + ",\"service_ms\":" + dist_json(ds) + ",\"captured_ms\":" +
+        dist_json(dc) + "}";
+
+  char msg[256];
+  snprintf(msg, sizeof msg, "replay: %d job(s) em %.1f s (%.2f/s), p99 %.0f ms (gravado %.0f ms), %d falha(s), "
+           "%d sem entrada, %d desfecho(s) diferente(s)", replayed, wall_ms / 1000.0, jobs_per_s, dl.p99, dc.p99,
+           failed, missing, mismatch);
+  gsx_log_msg(mismatch || missing ? GSX_LOG_WARN : GSX_LOG_INFO, msg);
+  if (on_progress) on_progress(total, total, msg, user);
+
+  if (report_json) *report_json = gsx_dup_string(js);
+  set_last_error_json(GSX_OK, "replay", 0, 0, nullptr);
+  return replayed;
+}
@@ -0,0 +1,384 @@
+// gsx_soak.cpp — teste de resistência: vazamentos que só aparecem depois de horas (gsx_soak_run)
+//
+// 'workers' laços rodam, ao mesmo tempo e até o prazo, uma mistura sorteada de jobs:
+// compressão síncrona, assíncrona (submit/join/free), assíncrona cancelada no meio,
+// chamadas que falham (arquivo inexistente, lixo com cabeçalho PDF, PDF truncado),
+// pipeline completo e rajadas de gsx_build_pdfwrite_args. Enquanto isso a thread
+// chamadora amostra o processo a cada sample_ms: RSS, descritores abertos, threads e
+// os temporários da biblioteca (arquivos GSX* na pasta temporária e em work_dir).
+//
+// Crescimento: descartado o aquecimento, as amostras são divididas em quatro quartos e
+// de cada um fica o mínimo — o piso, que ignora os jobs em andamento no instante da
+// amostra. Um recurso cresce quando os pisos nunca descem e o último passa do primeiro
+// por mais que a tolerância. RSS, descritores e threads vêm de /proc (só no Linux).
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+enum Kind { K_SYNC, K_ASYNC, K_CANCEL, K_FAIL, K_PIPELINE, K_ARGS, K_COUNT };
+static const char* const kKindNames[K_COUNT] = {"sync", "async", "canceled", "failing", "pipeline", "args"};
+static const int kKindWeights[K_COUNT] = {35, 20, 15, 15, 10, 5};
+
+struct Doc { std::string path; int pages; };
+
+struct Sample {
+  double t_ms;
+  int64_t rss_kb, fds, threads, tmp_files, tmp_bytes;
+  uint64_t jobs;
+};
+
+struct Soak {
+  gsx_soak_opts_t o{};
+  int dpi = 150, quality = 65, max_pages = 4;
+  std::string dir;                  // work_dir efetivo (vazio = pasta temporária do sistema)
+  std::vector<Doc> docs;
+  std::string garbage, truncated, missing;
+  Clock::time_point deadline;
+  volatile int* cancel_flag = nullptr;
+  std::atomic<uint64_t> done[K_COUNT] = {};
+  std::atomic<uint64_t> unexpected{0};
+  std::mutex msg_m;
+  std::vector<std::string> msgs;    // primeiras ocorrências inesperadas
+
+  bool stop() const { return Clock::now() >= deadline || (cancel_flag && *cancel_flag); }
+
+  void expect(bool ok, const char* kind, int rc, const std::string& what) {
+    if (ok || stop()) return;       // no fim, o cancelamento global derruba qualquer job
+    unexpected++;
+    std::lock_guard<std::mutex> lk(msg_m);
+    if (msgs.size() < 8) msgs.push_back(std::string(kind) + " rc=" + std::to_string(rc) + " " + what);
+  }
+};
+
+static double ms_since(Clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// Campo "Chave:   valor" de /proc/self/status (-1 fora do Linux ou se faltar)
+static int64_t proc_status(const char* key) {
+#ifdef __linux__
+  std::ifstream f("/proc/self/status");
+  std::string line;
+  const size_t n = strlen(key);
+  while (std::getline(f, line))
+    if (line.compare(0, n, key) == 0 && line.size() > n && line[n] == ':') return atoll(line.c_str() + n + 1);
+#else
+  (void)key;
+#endif
+  return -1;
+}
+
+static int64_t open_fds() {
+#ifdef __linux__
+  std::error_code ec;
+  int64_t n = 0;
+  for (fs::directory_iterator it("/proc/self/fd", ec), end; !ec && it != end; it.increment(ec)) ++n;
+  return ec ? -1 : n;
+#else
+  return -1;
+#endif
+}
+
+// Temporários da biblioteca (prefixo GSX) numa pasta; os do próprio teste (GSXS: lixo,
+// truncado e a saída de cada laço) não contam
+static void temp_usage(const fs::path& dir, int64_t& files, int64_t& bytes) {
+  std::error_code ec;
+  for (fs::directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+    const std::string name = it->path().filename().string();
+    if (name.compare(0, 3, "GSX") != 0 || name.compare(0, 4, "GSXS") == 0) continue;
+    std::error_code ec2;
+    const uintmax_t sz = it->file_size(ec2);
+    ++files;
+    if (!ec2) bytes += (int64_t)sz;
+  }
+}
+
+static Sample take_sample(const Soak& s, Clock::time_point start) {
+  Sample x{};
+  x.t_ms = ms_since(start);
+  x.rss_kb = proc_status("VmRSS");
+  x.threads = proc_status("Threads");
+  x.fds = open_fds();
+  std::error_code ec;
+  const fs::path sys = fs::temp_directory_path(ec);
+  if (!ec) temp_usage(sys, x.tmp_files, x.tmp_bytes);
+  if (!s.dir.empty() && !fs::equivalent(s.dir, sys, ec)) temp_usage(s.dir, x.tmp_files, x.tmp_bytes);
+  for (const auto& d : s.done) x.jobs += d.load();
+  return x;
+}
+
+static void run_one(Soak& s, Kind k, std::mt19937& rng, const std::string& out) {
+  const Doc& d = s.docs[rng() % s.docs.size()];
+  const int first = 1 + (int)(rng() % (unsigned)d.pages);
+  const int last = std::min(d.pages, first + (int)(rng() % (unsigned)s.max_pages));
+  const std::string what = d.path + " [" + std::to_string(first) + "-" + std::to_string(last) + "]";
+  const char* preset = s.o.preset;
+  int rc = 0;
+  switch (k) {
+    case K_SYNC:
+      rc = gsx_compress_file_sync(d.path.c_str(), out.c_str(), s.dpi, s.quality, preset, s.o.mode, first, last,
+                                  nullptr, nullptr, s.cancel_flag);
+      s.expect(rc >= 0, "sync", rc, what);
+      break;
+    case K_ASYNC:
+    case K_CANCEL: {
+      volatile int flag = 0;
+      gsx_job_t* job = gsx_compress_file_async(d.path.c_str(), out.c_str(), s.dpi, s.quality, preset, s.o.mode,
+                                               first, last, nullptr, nullptr, &flag);
+      if (!job) {
+        s.expect(false, kKindNames[k], gsx_last_rc(), what);
+        break;
+      }
+      if (k == K_CANCEL) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(rng() % 200));
+        gsx_job_cancel(job);
+      }
+      rc = gsx_job_join(job);
+      gsx_job_free(job);
+      s.expect(rc >= 0 || (k == K_CANCEL && rc == GSX_E_CANCELED), kKindNames[k], rc, what);
+      break;
+    }
+    case K_FAIL: {
+      // só o arquivo inexistente tem resultado certo; lixo e truncado exercitam os
+      // caminhos de erro e de reparo do Ghostscript, que às vezes ainda produz algo
+      const std::string* in[3] = {&s.missing, &s.garbage, &s.truncated};
+      const unsigned which = rng() % 3;
+      rc = gsx_compress_file_sync(in[which]->c_str(), out.c_str(), s.dpi, s.quality, preset, s.o.mode, 0, 0,
+                                  nullptr, nullptr, s.cancel_flag);
+      if (which == 0) s.expect(rc < 0, "failing", rc, s.missing + " terminou sem erro");
+      break;
+    }
+    case K_PIPELINE: {
+      gsx_pipeline_opts_t po{};
+      po.dpi = s.dpi;
+      po.jpeg_quality = s.quality;
+      po.preset = preset;
+      po.mode = s.o.mode;
+      po.first_page = first;
+      po.last_page = last;
+      po.workers = 2;
+      po.linearize = (int)(rng() % 2);
+      po.work_dir = s.dir.empty() ? nullptr : s.dir.c_str();
+      char* report = nullptr;
+      rc = gsx_pipeline_run(d.path.c_str(), out.c_str(), &po, &report, nullptr, nullptr, s.cancel_flag);
+      gsx_free(report);
+      // o pipeline exige o leitor nativo: PDFs que ele não entende falham sem vazar nada
+      s.expect(rc >= 0 || rc == GSX_E_PDF_PARSE, "pipeline", rc, what);
+      break;
+    }
+    case K_ARGS: {
+      const char* argv[96];
+      for (int i = 0; i < 50; ++i) {
+        rc = gsx_build_pdfwrite_args(argv, 96, d.path.c_str(), out.c_str(), s.dpi, s.quality, preset, s.o.mode,
+                                     first, last);
+        if (rc < 0) break;
+      }
+      s.expect(rc > 0, "args", rc, what);
+      break;
+    }
+    default:
+      break;
+  }
+  s.done[k]++;
+}
+
+static void worker_main(Soak* sp, unsigned seed) {
+  Soak& s = *sp;
+  std::mt19937 rng(seed);
+  int total = 0;
+  for (int w : kKindWeights) total += w;
+  const std::string out = gsx_make_temp_path(s.dir.empty() ? nullptr : s.dir.c_str(), "GSXS", ".pdf");
+  while (!s.stop()) {
+    int r = (int)(rng() % (unsigned)total), k = 0;
+    while (r >= kKindWeights[k]) r -= kKindWeights[k++];
+    run_one(s, (Kind)k, rng, out);
+  }
+  std::error_code ec;
+  fs::remove(out, ec);
+}
+
+struct Series {
+  const char* name;
+  int64_t Sample::*field;
+  int64_t first = 0, last = 0, tolerance = 0;
+  bool measured = false, growing = false;
+};
+
+// Pisos (mínimos) dos quatro quartos de v: cresce se nunca descem e sobem mais que tol
+static void analyze(Series& se, const std::vector<Sample>& v, int64_t min_tol, int64_t pct_tol) {
+  const size_t n = v.size();
+  for (const Sample& x : v) if (x.*se.field < 0) return;
+  if (n < 8) return;
+  int64_t q[4];
+  for (size_t i = 0; i < 4; ++i) {
+    q[i] = INT64_MAX;
+    for (size_t j = n * i / 4; j < n * (i + 1) / 4; ++j) q[i] = std::min(q[i], v[j].*se.field);
+  }
+  se.measured = true;
+  se.first = q[0];
+  se.last = q[3];
+  se.tolerance = std::max(min_tol, q[0] * pct_tol / 100);
+  se.growing = q[0] <= q[1] && q[1] <= q[2] && q[2] <= q[3] && q[3] - q[0] > se.tolerance;
+}
+
+}  // namespace
+
+GSX_API int gsx_soak_run(const char* const* corpus, int count, const gsx_soak_opts_t* opts,
+                         char** report_json, gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  GsxJobScope scope("gsx_soak_run");
+  if (report_json) *report_json = nullptr;
+  if (!corpus || count <= 0) {
+    set_last_error_json(GSX_E_ARGS, "soak", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  Soak s;
+  if (opts) s.o = *opts;
+  s.o.seconds = s.o.seconds > 0 ? s.o.seconds : 300;
+  s.o.workers = s.o.workers > 0 ? s.o.workers : 4;
+  s.o.sample_ms = s.o.sample_ms > 0 ? s.o.sample_ms : 2000;
+  s.o.warmup_pct = s.o.warmup_pct > 0 ? std::min(s.o.warmup_pct, 80) : 20;
+  s.dpi = s.o.dpi > 0 ? s.o.dpi : 150;
+  s.quality = s.o.jpeg_quality > 0 ? s.o.jpeg_quality : 65;
+  s.max_pages = s.o.max_pages > 0 ? s.o.max_pages : 4;
+  s.dir = s.o.work_dir && *s.o.work_dir ? s.o.work_dir : "";
+  s.cancel_flag = cancel_flag;
+
+  for (int i = 0; i < count; ++i) {
+    if (!corpus[i]) continue;
+    int first = 0, last = 0;
+    std::vector<uint64_t> w;
+    if (gsx_page_weights(corpus[i], first, last, w) < 0 || w.empty()) continue;
+    s.docs.push_back({corpus[i], (int)w.size()});
+  }
+  if (s.docs.empty()) {
+    set_last_error_json(GSX_E_ARGS, "soak.corpus", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+
+  // entradas que falham: lixo com cabeçalho PDF e a primeira metade do primeiro documento
+  const char* dir = s.dir.empty() ? nullptr : s.dir.c_str();
+  s.garbage = gsx_make_temp_path(dir, "GSXS", ".pdf");
+  s.truncated = gsx_make_temp_path(dir, "GSXS", ".pdf");
+  s.missing = s.garbage + ".inexistente.pdf";
+  {
+    std::mt19937 rng(7);
+    std::ofstream g(s.garbage, std::ios::binary);
+    g << "%PDF-1.7\n";
+    for (int i = 0; i < 64 * 1024; ++i) g.put((char)(rng() & 0xff));
+    std::error_code ec;
+    const uintmax_t size = fs::file_size(s.docs[0].path, ec);
+    std::ifstream src(s.docs[0].path, std::ios::binary);
+    std::vector<char> head(ec ? 1 : (size_t)std::max<uintmax_t>(1, size / 2));
+    src.read(head.data(), (std::streamsize)head.size());
+    std::ofstream t(s.truncated, std::ios::binary);
+    t.write(head.data(), src.gcount());
+  }
+
+  const unsigned seed = s.o.seed ? s.o.seed : (unsigned)Clock::now().time_since_epoch().count();
+  const Clock::time_point start = Clock::now();
+  s.deadline = start + std::chrono::seconds(s.o.seconds);
+  std::vector<Sample> samples;
+  samples.push_back(take_sample(s, start));
+
+  std::vector<std::thread> pool;
+  for (int i = 0; i < s.o.workers; ++i) pool.emplace_back(worker_main, &s, seed + (unsigned)i * 7919u);
+  Clock::time_point next = start + std::chrono::milliseconds(s.o.sample_ms);
+  while (!s.stop()) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(std::min(100, s.o.sample_ms)));
+    if (Clock::now() < next) continue;
+    next += std::chrono::milliseconds(s.o.sample_ms);
+    const Sample x = take_sample(s, start);
+    samples.push_back(x);
+    char line[200];
+    snprintf(line, sizeof line, "soak: %.0f s, rss %lld KB, fds %lld, threads %lld, temp %lld arq./%lld KB, %llu jobs",
+             x.t_ms / 1000.0, (long long)x.rss_kb, (long long)x.fds, (long long)x.threads,
+             (long long)x.tmp_files, (long long)(x.tmp_bytes / 1024), (unsigned long long)x.jobs);
+    if (on_progress) on_progress((int)(x.t_ms / 1000.0), s.o.seconds, line, user);
+  }
+  for (auto& t : pool) t.join();
+  samples.push_back(take_sample(s, start));   // em repouso: todos os laços terminados
+
+  std::error_code ec;
+  fs::remove(s.garbage, ec);
+  fs::remove(s.truncated, ec);
+
+  const size_t skip = samples.size() * (size_t)s.o.warmup_pct / 100;
+  const std::vector<Sample> steady(samples.begin() + (long)std::min(skip, samples.size()), samples.end());
+  Series series[] = {
+    {"rss_kb", &Sample::rss_kb}, {"fds", &Sample::fds}, {"threads", &Sample::threads},
+    {"tmp_files", &Sample::tmp_files}, {"tmp_bytes", &Sample::tmp_bytes},
+  };
+  analyze(series[0], steady, 4096, 5);          // 4 MiB ou 5%
+  analyze(series[1], steady, 2, 0);
+  analyze(series[2], steady, 2, 0);
+  analyze(series[3], steady, 2, 0);
+  analyze(series[4], steady, 1 << 20, 0);
+
+  int growing = 0;
+  bool conclusive = false;
+  std::string js = "{\"seconds\":" + std::to_string(s.o.seconds) + ",\"workers\":" + std::to_string(s.o.workers) +
+                   ",\"seed\":" + std::to_string(seed) + ",\"jobs\":{";
+  for (int k = 0; k < K_COUNT; ++k)
+    js += std::string(k ? "," : "") + "\"" + kKindNames[k] + "\":" + std::to_string(s.done[k].load());
+  js += "},\"unexpected\":" + std::to_string(s.unexpected.load()) + ",\"unexpected_msgs\":[";
+  for (size_t i = 0; i < s.msgs.size(); ++i) js += (i ? ",\"" : "\"") + gsx_json_escape(s.msgs[i]) + "\"";
+  js += "],\"series\":[";
+  std::string grown;
+  for (size_t i = 0; i < sizeof series / sizeof series[0]; ++i) {
+    const Series& se = series[i];
+    if (i) js += ",";
+    js += std::string("{\"name\":\"") + se.name + "\",\"measured\":" + (se.measured ? "true" : "false");
+    if (se.measured) {
+      conclusive = true;
+      js += ",\"first\":" + std::to_string(se.first) + ",\"last\":" + std::to_string(se.last) +
+            ",\"tolerance\":" + std::to_string(se.tolerance) + ",\"growing\":" + (se.growing ? "true" : "false");
+    }
+    js += "}";
+    if (se.growing) {
+      grown += std::string(growing ? "," : "") + "\"" + se.name + "\"";
+      ++growing;
+    }
+  }
+  js += "],\"growing\":[" + grown + "],\"conclusive\":" + (conclusive ? "true" : "false") + ",\"samples\":[";
+  for (size_t i = 0; i < samples.size(); ++i) {
+    const Sample& x = samples[i];
+    char buf[256];
+    snprintf(buf, sizeof buf,
+             "%s{\"t_ms\":%.0f,\"rss_kb\":%lld,\"fds\":%lld,\"threads\":%lld,\"tmp_files\":%lld,\"tmp_bytes\":%lld,"
+             "\"jobs\":%llu}", i ? "," : "", x.t_ms, (long long)x.rss_kb, (long long)x.fds, (long long)x.threads,
+             (long long)x.tmp_files, (long long)x.tmp_bytes, (unsigned long long)x.jobs);
+    js += buf;
+  }
+  js += "]}";
+
+  std::string msg = "soak: " + std::to_string(samples.size()) + " amostras, " +
+                    std::to_string(s.unexpected.load()) + " resultados inesperados, " +
+                    (growing ? std::to_string(growing) + " recurso(s) crescendo: " + grown
+                             : std::string(conclusive ? "sem crescimento" : "inconclusivo (poucas amostras)"));
+  gsx_log_msg(growing || s.unexpected.load() ? GSX_LOG_WARN : GSX_LOG_INFO, msg.c_str());
+  if (on_progress) on_progress(s.o.seconds, s.o.seconds, msg.c_str(), user);
+
+  if (report_json) *report_json = gsx_dup_string(js);
+  set_last_error_json(GSX_OK, "soak", 0, 0, nullptr);
+  return growing;
+}
@@ -0,0 +1,470 @@
+// gsx_thumbs.cpp — serviço de miniaturas: fila com prioridade, workers que renderizam
+// lotes de páginas consecutivas com gsx_render_pages (uma instância do Ghostscript por
+// lote, não por página) e cache PNG em disco indexado pelo hash do conteúdo do PDF.
+//
+// Prioridades: 0 = visível (entre elas, o pedido mais recente primeiro, em ordem de
+// página), 1 = vizinhas das visíveis, 2 = prefetch explícito. O worker pega a entrada
+// do topo e estende o lote com as páginas seguintes já enfileiradas do mesmo documento
+// e nível. Um lote de prioridade > 0 para assim que entra uma página visível na fila:
+// as páginas que faltavam voltam para a fila e o worker atende a visível.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+namespace fs = std::filesystem;
+
+static const int kLevelDpi[GSX_THUMB_LEVELS] = {24, 48, 96, 192};
+static const int kDefaultPrefetch = 4;
+static const int kDefaultBatch = 8;
+
+enum { PRIO_VISIBLE = 0, PRIO_NEIGHBOR = 1, PRIO_BACKGROUND = 2 };
+enum { ST_QUEUED = 0, ST_RUNNING, ST_DONE, ST_FAILED };
+
+namespace {
+
+struct Key {
+  std::string doc;   // id do conteúdo (hash + tamanho)
+  int level;
+  int page;
+  bool operator<(const Key& o) const {
+    return std::tie(doc, level, page) < std::tie(o.doc, o.level, o.page);
+  }
+};
+
+struct Entry {
+  int state = ST_QUEUED;
+  int prio = PRIO_BACKGROUND;
+  uint64_t gen = 0;          // pedido que deu a prioridade atual (mais recente = maior)
+  int rc = GSX_OK;
+  std::string in_path;       // caminho usado para renderizar (o último que pediu)
+};
+
+// (prio, -gen, página): visíveis do pedido mais recente primeiro, em ordem de página
+typedef std::tuple<int, uint64_t, Key> QItem;
+static QItem qitem(const Key& k, const Entry& e) { return QItem(e.prio, ~e.gen, k); }
+
+struct Doc {
+  uintmax_t size = 0;
+  int64_t mtime = 0;
+  std::string id;
+  int pages = 0;
+};
+
+}  // namespace
+
+struct gsx_thumbs_s {
+  std::string dir;
+  gsx_thumbs_opts_t o{};
+  int prefetch = kDefaultPrefetch;
+
+  std::mutex mtx;
+  std::condition_variable cv_work;     // workers: fila nova ou fechamento
+  std::condition_variable cv_done;     // gsx_thumbs_get: página pronta
+  std::map<Key, Entry> entries;
+  std::set<QItem> queue;
+  std::map<std::string, Doc> docs;     // por caminho
+  uint64_t gen = 0;
+  bool closing = false;
+  int waiters = 0;
+  int idle = 0;                        // workers esperando trabalho
+  volatile int cancel = 0;
+  std::vector<std::thread> workers;
+
+  // contadores (sob mtx)
+  uint64_t hits_mem = 0, hits_disk = 0, rendered = 0, failed = 0, yielded = 0, batches = 0;
+  uint64_t render_us = 0, png_bytes = 0;
+};
+
+namespace {
+
+static std::string png_path(const gsx_thumbs_s* s, const Key& k) {
+  char tail[64];
+  snprintf(tail, sizeof tail, "%d/%d.png", kLevelDpi[k.level], k.page);
+  return (fs::path(s->dir) / k.doc / tail).string();
+}
+
+// id do conteúdo, memorizado por caminho enquanto tamanho e data não mudarem
+static int resolve_doc(gsx_thumbs_s* s, const char* in_path, Doc& out) {
+  std::error_code ec;
+  const uintmax_t size = fs::file_size(in_path, ec);
+  if (ec) return GSX_E_INPUT_NOT_FOUND;
+  const int64_t mtime = (int64_t)fs::last_write_time(in_path, ec).time_since_epoch().count();
+  if (ec) return GSX_E_INPUT_NOT_FOUND;
+  {
+    std::lock_guard<std::mutex> lk(s->mtx);
+    auto it = s->docs.find(in_path);
+    if (it != s->docs.end() && it->second.size == size && it->second.mtime == mtime) {
+      out = it->second;
+      return GSX_OK;
+    }
+  }
+
+  gsx_probe_t pr{};
+  int rc = gsx_probe(in_path, &pr);
+  if (rc < 0) return rc;
+  if (pr.page_count <= 0) return GSX_E_PDF_PARSE;
+
+  FILE* f = fopen(in_path, "rb");
+  if (!f) return GSX_E_INPUT_NOT_FOUND;
+  std::vector<uint8_t> buf(1 << 20);
+  uint64_t h = 0;
+  size_t n;
+  while ((n = fread(buf.data(), 1, buf.size(), f)) > 0) h = gsx_hash_bytes(buf.data(), n, h);
+  fclose(f);
+
+  char id[48];
+  snprintf(id, sizeof id, "%016llx-%llx", (unsigned long long)h, (unsigned long long)size);
+  Doc d;
+  d.size = size;
+  d.mtime = mtime;
+  d.id = id;
+  d.pages = pr.page_count;
+  std::lock_guard<std::mutex> lk(s->mtx);
+  s->docs[in_path] = d;
+  out = d;
+  return GSX_OK;
+}
+
+// Sob mtx. Retorna true se a página ainda não está pronta.
+static bool enqueue(gsx_thumbs_s* s, const Key& k, const char* in_path, int prio, uint64_t gen) {
+  auto it = s->entries.find(k);
+  if (it != s->entries.end()) {
+    Entry& e = it->second;
+    if (e.state == ST_DONE) {
+      if (prio != PRIO_NEIGHBOR) {
+        ++s->hits_mem;
+        gsx_metric_add(GSX_C_THUMB_HIT_MEM);
+      }
+      return false;
+    }
+    if (e.state == ST_RUNNING) return true;
+    if (e.state == ST_QUEUED) {
+      if (prio < e.prio || (prio == e.prio && gen > e.gen)) {
+        s->queue.erase(qitem(k, e));
+        e.prio = prio;
+        e.gen = gen;
+        e.in_path = in_path;
+        s->queue.insert(qitem(k, e));
+      }
+      return true;
+    }
+    // ST_FAILED: tenta de novo
+  }
+  std::error_code ec;
+  if (fs::exists(png_path(s, k), ec)) {
+    Entry& e = s->entries[k];
+    e.state = ST_DONE;
+    e.rc = GSX_OK;
+    if (prio != PRIO_NEIGHBOR) {
+      ++s->hits_disk;
+      gsx_metric_add(GSX_C_THUMB_HIT_DISK);
+    }
+    return false;
+  }
+  Entry& e = s->entries[k];
+  e.state = ST_QUEUED;
+  e.prio = prio;
+  e.gen = gen;
+  e.rc = GSX_OK;
+  e.in_path = in_path;
+  s->queue.insert(qitem(k, e));
+  return true;
+}
+
+struct Batch {
+  gsx_thumbs_s* s;
+  std::string doc;
+  int level;
+  int prio;
+  int first, last;
+  std::vector<char> got;
+  bool yielded = false;
+  int gray;
+};
+
+static bool write_atomic(const std::string& path, const std::string& data) {
+  std::error_code ec;
+  fs::create_directories(fs::path(path).parent_path(), ec);
+  // sal aleatório por processo: outro processo com o mesmo cache pode ter a mesma
+  // thread id; a sequência separa gravações da mesma thread
+  static const uint64_t salt = ((uint64_t)std::random_device{}() << 32) ^ std::random_device{}();
+  static std::atomic<uint64_t> seq{0};
+  char suffix[64];
+  snprintf(suffix, sizeof suffix, ".tmp%llx_%zx_%llx", (unsigned long long)salt,
+           std::hash<std::thread::id>()(std::this_thread::get_id()), (unsigned long long)seq.fetch_add(1));
+  const std::string tmp = path + suffix;
+  {
+    std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+    if (!f) return false;
+    f.write(data.data(), (std::streamsize)data.size());
+    if (!f) { f.close(); fs::remove(tmp, ec); return false; }
+  }
+  fs::rename(tmp, path, ec);
+  if (ec) {                                   // outro processo já gravou a mesma página
+    fs::remove(tmp, ec);
+    return fs::exists(path, ec);
+  }
+  return true;
+}
+
+static int GSX_CALL on_raster(const gsx_raster_t* r, void* user) {
+  Batch& b = *(Batch*)user;
+  gsx_thumbs_s* s = b.s;
+  const Key k{b.doc, b.level, r->page};
+  std::string png;
+  bool ok = gsx_png_encode(r->data, r->width, r->height, b.gray ? 1 : 3, (size_t)r->stride, png) &&
+            write_atomic(png_path(s, k), png);
+
+  std::lock_guard<std::mutex> lk(s->mtx);
+  if (r->page >= b.first && r->page <= b.last) b.got[r->page - b.first] = 1;
+  auto it = s->entries.find(k);
+  if (it != s->entries.end()) {
+    it->second.state = ok ? ST_DONE : ST_FAILED;
+    it->second.rc = ok ? GSX_OK : GSX_E_WRITE_IO;
+  }
+  if (ok) {
+    ++s->rendered;
+    s->png_bytes += png.size();
+    gsx_metric_add(GSX_C_THUMB_MISS);
+  } else {
+    ++s->failed;
+  }
+  s->cv_done.notify_all();
+
+  // lote em segundo plano cede a vez a uma página visível que chegou depois, se
+  // nenhum outro worker está livre para ela
+  if (b.prio > PRIO_VISIBLE && r->page < b.last && s->idle == 0 && !s->queue.empty() &&
+      std::get<0>(*s->queue.begin()) == PRIO_VISIBLE) {
+    b.yielded = true;
+    ++s->yielded;
+    return 1;
+  }
+  return 0;
+}
+
+static void worker_main(gsx_thumbs_s* s) {
+  std::unique_lock<std::mutex> lk(s->mtx);
+  for (;;) {
+    ++s->idle;
+    s->cv_work.wait(lk, [s] { return s->closing || !s->queue.empty(); });
+    --s->idle;
+    if (s->closing) return;
+
+    // topo da fila + páginas seguintes já enfileiradas do mesmo documento e nível
+    const QItem top = *s->queue.begin();
+    const Key k0 = std::get<2>(top);
+    Entry& e0 = s->entries[k0];
+    Batch b;
+    b.s = s;
+    b.doc = k0.doc;
+    b.level = k0.level;
+    b.prio = e0.prio;
+    b.first = b.last = k0.page;
+    b.gray = s->o.gray;
+    const std::string in_path = e0.in_path;
+    s->queue.erase(top);
+    e0.state = ST_RUNNING;
+    while (b.last - b.first + 1 < s->o.batch_pages) {
+      auto it = s->entries.find(Key{b.doc, b.level, b.last + 1});
+      if (it == s->entries.end() || it->second.state != ST_QUEUED) break;
+      s->queue.erase(qitem(it->first, it->second));
+      it->second.state = ST_RUNNING;
+      ++b.last;
+    }
+    b.got.assign((size_t)(b.last - b.first + 1), 0);
+    ++s->batches;
+    lk.unlock();
+
+    gsx_render_opts_t ro{};
+    ro.dpi = kLevelDpi[b.level];
+    ro.color = s->o.gray ? GSX_RENDER_GRAY : GSX_RENDER_RGB;
+    ro.workers = 1;
+    const auto t0 = std::chrono::steady_clock::now();
+    int rc = gsx_render_pages(in_path.c_str(), b.first, b.last, &ro, on_raster, &b,
+                              nullptr, nullptr, &s->cancel);
+    const auto us = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - t0).count();
+
+    lk.lock();
+    s->render_us += (uint64_t)us;
+    // páginas do lote que não saíram: de volta à fila (cedeu a vez) ou falha
+    for (int p = b.first; p <= b.last; ++p) {
+      if (b.got[p - b.first]) continue;
+      auto it = s->entries.find(Key{b.doc, b.level, p});
+      if (it == s->entries.end() || it->second.state != ST_RUNNING) continue;
+      Entry& e = it->second;
+      if (b.yielded && !s->closing) {
+        e.state = ST_QUEUED;
+        s->queue.insert(qitem(it->first, e));
+      } else {
+        e.state = ST_FAILED;
+        e.rc = s->closing ? GSX_E_CANCELED : (rc < 0 ? rc : GSX_E_UNKNOWN);
+        ++s->failed;
+      }
+    }
+    s->cv_done.notify_all();
+  }
+}
+
+}  // namespace
+
+GSX_API gsx_thumbs_t* gsx_thumbs_open(const char* cache_dir, const gsx_thumbs_opts_t* opts) {
+  if (!cache_dir || !*cache_dir) {
+    set_last_error_json(GSX_E_ARGS, "thumbs_open", 0, 0, nullptr);
+    return nullptr;
+  }
+  std::error_code ec;
+  fs::create_directories(cache_dir, ec);
+  if (!fs::is_directory(cache_dir, ec)) {
+    set_last_error_json(GSX_E_OUTDIR_CREATE, "thumbs_open", 0, 0, nullptr);
+    return nullptr;
+  }
+  gsx_thumbs_t* s = new gsx_thumbs_t;
+  s->dir = cache_dir;
+  if (opts) s->o = *opts;
+  s->prefetch = s->o.prefetch == 0 ? kDefaultPrefetch : std::max(0, s->o.prefetch);
+  if (s->o.batch_pages <= 0) s->o.batch_pages = kDefaultBatch;
+  int n = s->o.workers > 0 ? s->o.workers : (int)std::thread::hardware_concurrency();
+  n = std::max(1, n);
+  for (int i = 0; i < n; ++i) s->workers.emplace_back(worker_main, s);
+  return s;
+}
+
+GSX_API void gsx_thumbs_close(gsx_thumbs_t* s) {
+  if (!s) return;
+  {
+    std::lock_guard<std::mutex> lk(s->mtx);
+    s->closing = true;
+    s->cancel = 1;
+  }
+  s->cv_work.notify_all();
+  for (auto& t : s->workers) t.join();
+  {
+    // gsx_thumbs_get ainda esperando: acorda e espera sair antes de liberar
+    std::unique_lock<std::mutex> lk(s->mtx);
+    for (auto& kv : s->entries)
+      if (kv.second.state == ST_QUEUED || kv.second.state == ST_RUNNING) {
+        kv.second.state = ST_FAILED;
+        kv.second.rc = GSX_E_CANCELED;
+      }
+    s->cv_done.notify_all();
+    s->cv_done.wait(lk, [s] { return s->waiters == 0; });
+  }
+  delete s;
+  gsx_render_pool_trim();
+}
+
+GSX_API int gsx_thumbs_request(gsx_thumbs_t* s, const char* in_path, int first_page,
+                               int last_page, int level, int visible) {
+  if (!s || !in_path || level < 0 || level >= GSX_THUMB_LEVELS || first_page < 1 ||
+      last_page < first_page) {
+    set_last_error_json(GSX_E_ARGS, "thumbs_request", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  Doc d;
+  int rc = resolve_doc(s, in_path, d);
+  if (rc < 0) {
+    set_last_error_json(rc, "thumbs_request", 0, 0, nullptr);
+    return rc;
+  }
+  if (first_page > d.pages) {
+    set_last_error_json(GSX_E_ARGS, "thumbs_request", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  last_page = std::min(last_page, d.pages);
+
+  int pending = 0;
+  {
+    std::lock_guard<std::mutex> lk(s->mtx);
+    if (s->closing) return GSX_E_CANCELED;
+    const uint64_t gen = ++s->gen;
+    const int prio = visible ? PRIO_VISIBLE : PRIO_BACKGROUND;
+    for (int p = first_page; p <= last_page; ++p)
+      pending += enqueue(s, Key{d.id, level, p}, in_path, prio, gen) ? 1 : 0;
+    if (visible && s->prefetch > 0) {
+      for (int p = std::max(1, first_page - s->prefetch); p < first_page; ++p)
+        enqueue(s, Key{d.id, level, p}, in_path, PRIO_NEIGHBOR, gen);
+      for (int p = last_page + 1; p <= std::min(d.pages, last_page + s->prefetch); ++p)
+        enqueue(s, Key{d.id, level, p}, in_path, PRIO_NEIGHBOR, gen);
+    }
+  }
+  s->cv_work.notify_all();
+  return pending;
+}
+
+GSX_API int gsx_thumbs_get(gsx_thumbs_t* s, const char* in_path, int page, int level,
+                           char** png_path_out) {
+  if (!s || !png_path_out) {
+    set_last_error_json(GSX_E_ARGS, "thumbs_get", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  *png_path_out = nullptr;
+  int rc = gsx_thumbs_request(s, in_path, page, page, level, 1);
+  if (rc < 0) return rc;
+
+  Doc d;
+  rc = resolve_doc(s, in_path, d);      // já memorizado pelo request
+  if (rc < 0) return rc;
+  const Key k{d.id, level, page};
+  std::unique_lock<std::mutex> lk(s->mtx);
+  ++s->waiters;
+  s->cv_done.wait(lk, [&] {
+    auto it = s->entries.find(k);
+    return s->closing || it == s->entries.end() ||
+           it->second.state == ST_DONE || it->second.state == ST_FAILED;
+  });
+  auto it = s->entries.find(k);
+  rc = it == s->entries.end() ? GSX_E_CANCELED
+     : it->second.state == ST_DONE ? GSX_OK
+     : it->second.state == ST_FAILED ? it->second.rc : GSX_E_CANCELED;
+  // caminho montado antes de liberar: com waiters em 0, gsx_thumbs_close pode apagar 's'
+  const std::string path = rc < 0 ? std::string() : png_path(s, k);
+  if (--s->waiters == 0 && s->closing) s->cv_done.notify_all();
+  lk.unlock();
+
+  if (rc < 0) {
+    set_last_error_json(rc, "thumbs_get", 0, 0, nullptr);
+    return rc;
+  }
+  *png_path_out = gsx_dup_string(path);
+  if (!*png_path_out) return GSX_E_UNKNOWN;
+  return GSX_OK;
+}
+
+GSX_API int gsx_thumbs_stats(gsx_thumbs_t* s, char** json_out) {
+  if (!s || !json_out) return GSX_E_ARGS;
+  std::string j;
+  {
+    std::lock_guard<std::mutex> lk(s->mtx);
+    char buf[512];
+    snprintf(buf, sizeof buf,
+             "{\"workers\":%zu,\"hits_memory\":%llu,\"hits_disk\":%llu,\"rendered\":%llu,"
+             "\"failed\":%llu,\"queued\":%zu,\"batches\":%llu,\"yielded\":%llu,"
+             "\"render_ms\":%.1f,\"png_bytes\":%llu}",
+             s->workers.size(), (unsigned long long)s->hits_mem, (unsigned long long)s->hits_disk,
+             (unsigned long long)s->rendered, (unsigned long long)s->failed, s->queue.size(),
+             (unsigned long long)s->batches, (unsigned long long)s->yielded,
+             s->render_us / 1000.0, (unsigned long long)s->png_bytes);
+    j = buf;
+  }
+  *json_out = gsx_dup_string(j);
+  return *json_out ? GSX_OK : GSX_E_UNKNOWN;
+}
@@ -0,0 +1,281 @@
+// gsx_trace.cpp — spans das etapas em formato Chrome trace (gsx_trace_*)
+//
+// Cada thread grava num buffer circular próprio (kCap eventos): o escritor é o único
+// dono do índice 'head' e publica cada evento com release; quem despeja lê com acquire
+// e descarta o que foi sobrescrito durante a cópia. A trava do registro só é tomada
+// quando uma thread grava o primeiro span (pega um buffer livre ou cria um) e quando
+// termina (devolve o buffer, com os eventos, para a próxima thread) — nunca por span.
+// Desligado, GsxSpan não lê o relógio nem toca no buffer.
+//
+// O despejo segue o formato "Trace Event" (chrome://tracing, ui.perfetto.dev): spans
+// completos ("ph":"X"), pid = job, tid = thread, e metadados com o nome de cada job.
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+std::atomic<bool> g_gsx_trace_on{false};
+
+namespace {
+
+constexpr uint64_t kCap = 1u << 13;   // eventos por buffer (~600 KiB)
+constexpr size_t kNamesPrune = 1024;  // nomes de job guardados antes da primeira poda
+
+struct Ev {
+  uint64_t t0, t1, job;
+  const char* name;
+  const char* k1;
+  const char* k2;
+  int64_t v1, v2;
+  uint32_t tid;
+};
+
+struct Buf {
+  std::atomic<uint64_t> head{0};   // eventos já gravados (só o dono escreve)
+  std::atomic<uint64_t> tail{0};   // gsx_trace_clear: tudo antes disso foi descartado
+  Ev ev[kCap];
+};
+
+struct Registry {
+  std::mutex m;
+  std::vector<Buf*> all, spare;
+  std::unordered_map<uint64_t, std::pair<const char*, bool>> job_names;   // job → (nome, em andamento)
+  size_t prune_at = kNamesPrune;
+  std::string dump_dir;
+};
+
+// Nunca destruído: threads podem terminar depois dos destrutores estáticos
+static Registry& reg() {
+  static Registry* r = new Registry;
+  return *r;
+}
+
+static std::atomic<uint64_t> g_next_job{0};
+static std::atomic<uint32_t> g_next_tid{0};
+
+struct Tls {
+  Buf* buf = nullptr;
+  uint32_t tid = 0;
+  uint64_t job = 0;
+  ~Tls() {
+    if (!buf) return;
+    std::lock_guard<std::mutex> lk(reg().m);
+    reg().spare.push_back(buf);
+  }
+};
+static thread_local Tls t_trace;
+
+static std::chrono::steady_clock::time_point epoch() {
+  static const std::chrono::steady_clock::time_point e = std::chrono::steady_clock::now();
+  return e;
+}
+
+// Com r.m preso: tira os nomes de jobs terminados que não têm mais eventos em nenhum
+// buffer (os anéis já os sobrescreveram). Sem isso, um servidor rastreando por dias
+// acumula um nome por requisição. A próxima poda espera o mapa dobrar.
+static void prune_job_names(Registry& r) {
+  std::unordered_set<uint64_t> live;
+  std::vector<uint64_t> jobs;
+  for (Buf* b : r.all) {
+    // mesma cópia de collect(): só até o head publicado, e o que o dono sobrescreveu
+    // durante a cópia é descartado antes de contar
+    const uint64_t h = b->head.load(std::memory_order_acquire);
+    const uint64_t from = std::max(b->tail.load(std::memory_order_relaxed), h > kCap ? h - kCap : 0);
+    jobs.clear();
+    for (uint64_t i = from; i < h; ++i) jobs.push_back(b->ev[i & (kCap - 1)].job);
+    const uint64_t h2 = b->head.load(std::memory_order_acquire);
+    size_t lost = 0;
+    if (h2 > kCap && h2 - kCap > from) lost = (size_t)std::min(h2 - kCap - from, h - from);
+    live.insert(jobs.begin() + (ptrdiff_t)lost, jobs.end());
+  }
+  for (auto it = r.job_names.begin(); it != r.job_names.end();)
+    it = it->second.second || live.count(it->first) ? std::next(it) : r.job_names.erase(it);
+  r.prune_at = std::max(kNamesPrune, r.job_names.size() * 2);
+}
+
+static std::vector<Ev> collect(uint64_t job, uint64_t since_ns) {
+  std::vector<Ev> out;
+  Registry& r = reg();
+  std::lock_guard<std::mutex> lk(r.m);
+  for (Buf* b : r.all) {
+    const uint64_t h = b->head.load(std::memory_order_acquire);
+    const uint64_t from = std::max(b->tail.load(std::memory_order_relaxed), h > kCap ? h - kCap : 0);
+    const size_t base = out.size();
+    for (uint64_t i = from; i < h; ++i) out.push_back(b->ev[i & (kCap - 1)]);
+    // o dono continuou gravando: o início da cópia pode ter sido sobrescrito
+    const uint64_t h2 = b->head.load(std::memory_order_acquire);
+    if (h2 > kCap && h2 - kCap > from) {
+      const size_t lost = (size_t)std::min(h2 - kCap - from, h - from);
+      out.erase(out.begin() + (ptrdiff_t)base, out.begin() + (ptrdiff_t)(base + lost));
+    }
+  }
+  out.erase(std::remove_if(out.begin(), out.end(), [&](const Ev& e) {
+              return (job && e.job != job) || e.t1 < since_ns;
+            }), out.end());
+  std::sort(out.begin(), out.end(), [](const Ev& a, const Ev& b) { return a.t0 < b.t0; });
+  return out;
+}
+
+static std::string to_json(const std::vector<Ev>& evs) {
+  std::unordered_map<uint64_t, std::pair<const char*, bool>> names;
+  {
+    std::lock_guard<std::mutex> lk(reg().m);
+    names = reg().job_names;
+  }
+  std::string js = "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+  char buf[512];
+  bool first = true;
+  std::vector<uint64_t> jobs;
+  for (const Ev& e : evs)
+    if (std::find(jobs.begin(), jobs.end(), e.job) == jobs.end()) jobs.push_back(e.job);
+  for (uint64_t j : jobs) {
+    auto it = names.find(j);
+    snprintf(buf, sizeof buf,
+             "%s{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":%llu,\"tid\":0,\"args\":{\"name\":\"job %llu: %s\"}}",
+             first ? "" : ",\n", (unsigned long long)j, (unsigned long long)j,
+             j == 0 ? "fora de job" : (it != names.end() ? it->second.first : "?"));
+    js += buf;
+    first = false;
+  }
+  for (const Ev& e : evs) {
+    int n = snprintf(buf, sizeof buf,
+                     "%s{\"name\":\"%s\",\"cat\":\"gsx\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":%llu,\"tid\":%u",
+                     first ? "" : ",\n", e.name, e.t0 / 1000.0, (e.t1 - e.t0) / 1000.0,
+                     (unsigned long long)e.job, e.tid);
+    if (e.k1 && n > 0 && n < (int)sizeof buf) {
+      if (e.k2)
+        n += snprintf(buf + n, sizeof buf - n, ",\"args\":{\"%s\":%lld,\"%s\":%lld}", e.k1, (long long)e.v1,
+                      e.k2, (long long)e.v2);
+      else
+        n += snprintf(buf + n, sizeof buf - n, ",\"args\":{\"%s\":%lld}", e.k1, (long long)e.v1);
+    }
+    js += buf;
+    js += "}";
+    first = false;
+  }
+  js += "]}\n";
+  return js;
+}
+
+static bool write_file(const char* path, const std::string& js, int* err) {
+  FILE* f = std::fopen(path, "wb");
+  if (!f) { *err = errno; return false; }
+  const bool ok = std::fwrite(js.data(), 1, js.size(), f) == js.size();
+  *err = errno;
+  return std::fclose(f) == 0 && ok;
+}
+
+}  // namespace
+
+uint64_t gsx_trace_clock_ns() {
+  return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now() - epoch()).count();
+}
+
+void gsx_trace_emit(const char* name, uint64_t t0_ns, uint64_t t1_ns,
+                    const char* k1, int64_t v1, const char* k2, int64_t v2) {
+  Tls& tl = t_trace;
+  if (!tl.buf) {
+    Registry& r = reg();
+    std::lock_guard<std::mutex> lk(r.m);
+    if (!r.spare.empty()) {
+      tl.buf = r.spare.back();
+      r.spare.pop_back();
+    } else {
+      tl.buf = new Buf;
+      r.all.push_back(tl.buf);
+    }
+    tl.tid = ++g_next_tid;
+  }
+  Buf* b = tl.buf;
+  const uint64_t h = b->head.load(std::memory_order_relaxed);
+  Ev& e = b->ev[h & (kCap - 1)];
+  e.t0 = t0_ns; e.t1 = t1_ns; e.job = tl.job;
+  e.name = name; e.k1 = k1; e.k2 = k2; e.v1 = v1; e.v2 = v2;
+  e.tid = tl.tid;
+  b->head.store(h + 1, std::memory_order_release);
+}
+
+uint64_t gsx_trace_job() { return t_trace.job; }
+void gsx_trace_set_job(uint64_t job) { t_trace.job = job; }
+
+uint64_t gsx_trace_job_open(const char* name) {
+  if (!gsx_trace_on() || t_trace.job) return 0;
+  const uint64_t job = ++g_next_job;
+  t_trace.job = job;
+  Registry& r = reg();
+  std::lock_guard<std::mutex> lk(r.m);
+  if (r.job_names.size() >= r.prune_at) prune_job_names(r);
+  r.job_names[job] = std::make_pair(name, true);
+  return job;
+}
+
+void gsx_trace_job_close(uint64_t job, const char* name, uint64_t t0_ns) {
+  if (!job) return;
+  gsx_trace_emit(name, t0_ns, gsx_trace_clock_ns());
+  t_trace.job = 0;
+  std::string dir;
+  {
+    std::lock_guard<std::mutex> lk(reg().m);
+    reg().job_names[job].second = false;
+    dir = reg().dump_dir;
+  }
+  if (dir.empty()) return;
+  // despejo automático: sem mexer no último erro da chamada que acabou
+  const std::string path = dir + "/gsx_trace_" + std::to_string(job) + ".json";
+  int err = 0;
+  if (!write_file(path.c_str(), to_json(collect(job, 0)), &err))
+    gsx_log_msg(GSX_LOG_WARN, ("trace: falha ao gravar " + path).c_str());
+}
+
+GSX_API void gsx_trace_enable(int on) {
+  epoch();
+  g_gsx_trace_on.store(on != 0, std::memory_order_relaxed);
+}
+
+GSX_API int gsx_trace_enabled(void) { return gsx_trace_on() ? 1 : 0; }
+
+GSX_API void gsx_trace_set_dump_dir(const char* dir) {
+  std::lock_guard<std::mutex> lk(reg().m);
+  reg().dump_dir = dir ? dir : "";
+}
+
+GSX_API uint64_t gsx_trace_now_us(void) { return gsx_trace_clock_ns() / 1000; }
+
+GSX_API int gsx_trace_dump(const char* path, uint64_t job, uint64_t since_us) {
+  if (!path || !*path) {
+    set_last_error_json(GSX_E_ARGS, "trace_dump", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  const std::vector<Ev> evs = collect(job, since_us * 1000);
+  int err = 0;
+  if (!write_file(path, to_json(evs), &err)) {
+    set_last_error_json(GSX_E_WRITE_IO, "trace_dump", err, 0, nullptr);
+    return GSX_E_WRITE_IO;
+  }
+  set_last_error_json(GSX_OK, "trace_dump", 0, 0, nullptr);
+  return (int)evs.size();
+}
+
+GSX_API char* gsx_trace_json(uint64_t job, uint64_t since_us) {
+  return gsx_dup_string(to_json(collect(job, since_us * 1000)));
+}
+
+GSX_API void gsx_trace_clear(void) {
+  Registry& r = reg();
+  std::lock_guard<std::mutex> lk(r.m);
+  for (Buf* b : r.all) b->tail.store(b->head.load(std::memory_order_acquire), std::memory_order_relaxed);
+  // nomes dos jobs em andamento continuam (o span do job ainda vai ser gravado)
+  for (auto it = r.job_names.begin(); it != r.job_names.end();)
+    it = it->second.second ? std::next(it) : r.job_names.erase(it);
+}
@@ -0,0 +1,390 @@
+// gsx_tune.cpp — calibração do modelo de custo da compressão em lotes (gsx_tune_*)
+//
+// Dividir compensa quando o ganho de rodar páginas em paralelo supera o custo fixo de
+// cada instância do Ghostscript mais a mesclagem — e isso muda com a CPU, o disco e o
+// tipo de documento. gsx_tune_calibrate mede essas parcelas nesta máquina:
+//  1) lotes de 1, 2, 4... páginas de cada documento do corpus (do início e do meio),
+//     um de cada vez: tempo × (páginas, peso) → custo fixo por lote e custo variável;
+//  2) as saídas mescladas em grupos crescentes → custo da mesclagem por parte e por MB;
+//  3) o maior lote rodado em k cópias simultâneas → eficiência paralela.
+// Os coeficientes saem de mínimos quadrados sem termos negativos (o termo que ficaria
+// negativo é zerado e o ajuste refeito). gsx_tune_plan escolhe o número de lotes que
+// minimiza o tempo estimado; gsx_compress_parallel_sync o consulta com o perfil ativo.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "gsx_bridge.h"
+#include "gsx_internal.h"
+
+namespace fs = std::filesystem;
+using Clock = std::chrono::steady_clock;
+
+namespace {
+
+struct Sample { double x1, x2, y; };   // lote: (páginas, MB); mesclagem: (partes, MB)
+
+static std::mutex g_profile_m;
+static bool g_profile_on = false;
+static gsx_tune_profile_t g_profile;
+
+static double ms_since(Clock::time_point t0) {
+  return std::chrono::duration<double, std::milli>(Clock::now() - t0).count();
+}
+
+// y ≈ c0 + c1·x1 + c2·x2 com c ≥ 0: normais 3×3 por eliminação; termo negativo (ou
+// sistema singular) sai do ajuste. c0 fica por último — sem custo fixo negativo.
+static void fit(const std::vector<Sample>& s, double c[3]) {
+  c[0] = c[1] = c[2] = 0;
+  if (s.empty()) return;
+  bool use[3] = {true, true, true};
+  for (int round = 0; round < 3; ++round) {
+    int idx[3], n = 0;
+    for (int k = 0; k < 3; ++k) if (use[k]) idx[n++] = k;
+    if (n == 0) return;
+    double a[3][4] = {};
+    for (const Sample& p : s) {
+      const double x[3] = {1.0, p.x1, p.x2};
+      for (int i = 0; i < n; ++i) {
+        for (int j = 0; j < n; ++j) a[i][j] += x[idx[i]] * x[idx[j]];
+        a[i][3] += x[idx[i]] * p.y;
+      }
+    }
+    bool singular = false;
+    for (int i = 0; i < n && !singular; ++i) {
+      int piv = i;
+      for (int r = i + 1; r < n; ++r) if (std::fabs(a[r][i]) > std::fabs(a[piv][i])) piv = r;
+      if (std::fabs(a[piv][i]) < 1e-9) { singular = true; break; }
+      for (int k = 0; k < 4; ++k) std::swap(a[i][k], a[piv][k]);
+      for (int r = 0; r < n; ++r) {
+        if (r == i) continue;
+        const double f = a[r][i] / a[i][i];
+        for (int k = i; k < 4; ++k) a[r][k] -= f * a[i][k];
+      }
+    }
+    double sol[3] = {0, 0, 0};
+    int worst = -1;
+    if (!singular) {
+      for (int i = 0; i < n; ++i) {
+        sol[idx[i]] = a[i][3] / a[i][i];
+        if (sol[idx[i]] < 0 && (worst < 0 || sol[idx[i]] < sol[worst])) worst = idx[i];
+      }
+    } else {
+      // colunas dependentes (p.ex. páginas e peso proporcionais): tira o último termo
+      worst = idx[n - 1];
+    }
+    if (worst < 0) { for (int k = 0; k < 3; ++k) c[k] = sol[k]; return; }
+    use[worst] = false;
+  }
+  // só a média
+  double m = 0;
+  for (const Sample& p : s) m += p.y;
+  c[0] = m / (double)s.size();
+}
+
+static void progress_line(gsx_progress_cb cb, void* user, int done, int total, const std::string& line) {
+  if (cb) cb(done, total, line.c_str(), user);
+}
+
+// Busca "key": número no JSON gravado por gsx_tune_save
+static bool json_number(const std::string& js, const char* key, double& v) {
+  const std::string k = std::string("\"") + key + "\":";
+  size_t p = js.find(k);
+  if (p == std::string::npos) return false;
+  const char* b = js.c_str() + p + k.size();
+  char* e = nullptr;
+  v = strtod(b, &e);
+  return e != b;
+}
+
+}  // namespace
+
+GSX_API int gsx_tune_calibrate(const char* const* corpus, int count, const gsx_tune_opts_t* opts,
+                               gsx_tune_profile_t* out,
+                               gsx_progress_cb on_progress, void* user, volatile int* cancel_flag)
+{
+  GsxJobScope scope("gsx_tune_calibrate");
+  if (!corpus || count <= 0 || !out) {
+    set_last_error_json(GSX_E_ARGS, "tune_calibrate", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  gsx_tune_opts_t o{};
+  if (opts) o = *opts;
+  const int dpi = o.dpi > 0 ? o.dpi : 150;
+  const int quality = o.jpeg_quality > 0 ? o.jpeg_quality : 65;
+  const int max_pages = o.max_pages > 0 ? o.max_pages : 16;
+  const double budget_ms = (o.max_seconds > 0 ? o.max_seconds : 60) * 1000.0;
+  const char* dir = o.work_dir && *o.work_dir ? o.work_dir : nullptr;
+  const Clock::time_point start = Clock::now();
+  auto over = [&] { return ms_since(start) > budget_ms || (cancel_flag && *cancel_flag); };
+
+  std::vector<Sample> chunk, merge;
+  double part_bytes = 0, part_weight = 0;
+  std::string big_doc;        // maior lote medido: base da medição paralela
+  int big_first = 0, big_last = 0;
+  double big_ms = 0;
+  int runs = 0;
+
+  for (int d = 0; d < count && !over(); ++d) {
+    if (!corpus[d]) continue;
+    int first = 0, last = 0;
+    std::vector<uint64_t> w;
+    if (gsx_page_weights(corpus[d], first, last, w) < 0) {
+      progress_line(on_progress, user, 0, 0, std::string("tune: ignorado (ilegível) ") + corpus[d]);
+      continue;
+    }
+    const int pages = (int)w.size();
+    std::vector<std::string> outs;
+    for (int size = 1; size <= std::min(pages, max_pages) && !over(); size *= 2) {
+      const int starts[2] = {1, std::max(1, (pages - size) / 2 + 1)};
+      for (int si = 0; si < (starts[1] != 1 ? 2 : 1) && !over(); ++si) {
+        const int f = starts[si], l = f + size - 1;
+        double mb = 0;
+        for (int pg = f; pg <= l; ++pg) mb += (double)w[(size_t)pg - 1] / 1048576.0;
+        std::string part = gsx_make_temp_path(dir, "GSXT", ".pdf");
+        const Clock::time_point t0 = Clock::now();
+        int rc = gsx_compress_file_sync(corpus[d], part.c_str(), dpi, quality, o.preset, o.mode,
+                                        f, l, nullptr, nullptr, cancel_flag);
+        const double ms = ms_since(t0);
+        if (rc < 0) {
+          std::error_code ec;
+          fs::remove(part, ec);
+          if (rc == GSX_E_CANCELED) break;
+          progress_line(on_progress, user, 0, 0, "tune: falha rc=" + std::to_string(rc) + " em " + corpus[d]);
+          continue;
+        }
+        chunk.push_back({(double)size, mb, ms});
+        std::error_code ec;
+        part_bytes += (double)fs::file_size(part, ec);
+        part_weight += mb * 1048576.0;
+        outs.push_back(part);
+        ++runs;
+        if (ms > big_ms) { big_ms = ms; big_doc = corpus[d]; big_first = f; big_last = l; }
+        char line[160];
+        snprintf(line, sizeof line, "tune: %d página(s) [%d-%d] %.1f MB em %.0f ms", size, f, l, mb, ms);
+        progress_line(on_progress, user, runs, 0, line);
+      }
+    }
+
+    // mesclagem: prefixos crescentes das saídas deste documento
+    for (size_t k = 2; k <= outs.size() && !over(); k = k < outs.size() && k * 2 > outs.size() ? outs.size() : k * 2) {
+      std::vector<const char*> in;
+      double mb = 0;
+      std::error_code ec;
+      for (size_t i = 0; i < k; ++i) {
+        in.push_back(outs[i].c_str());
+        mb += (double)fs::file_size(outs[i], ec) / 1048576.0;
+      }
+      std::string merged = gsx_make_temp_path(dir, "GSXT", ".pdf");
+      gsx_merge_stats_t ms{};
+      GsxMergeTimes mt;
+      const Clock::time_point t0 = Clock::now();
+      int rc = gsx_merge_timed(in.data(), (int)in.size(), merged.c_str(), GSX_MERGE_DEDUP, &ms, &mt);
+      const double t = ms_since(t0);
+      fs::remove(merged, ec);
+      if (rc >= 0) merge.push_back({(double)k, mb, t});
+      if (k == outs.size()) break;
+    }
+    std::error_code ec;
+    for (auto& p : outs) fs::remove(p, ec);
+  }
+
+  if (chunk.empty()) {
+    if (cancel_flag && *cancel_flag) {
+      set_last_error_json(GSX_E_CANCELED, "tune_calibrate", 0, 0, nullptr);
+      return GSX_E_CANCELED;
+    }
+    set_last_error_json(GSX_E_ARGS, "tune_calibrate.empty", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+
+  gsx_tune_profile_t p{};
+  double c[3];
+  fit(chunk, c);
+  p.chunk_fixed_ms = c[0]; p.page_ms = c[1]; p.ms_per_mb = c[2];
+  fit(merge, c);
+  p.merge_fixed_ms = c[0]; p.merge_part_ms = c[1]; p.merge_ms_per_mb = c[2];
+  p.out_ratio = part_weight > 0 ? part_bytes / part_weight : 1.0;
+  p.cpus = std::max(1, (int)std::thread::hardware_concurrency());
+  p.parallel_eff = 1.0;
+  p.eff_workers = 1;
+
+  // eficiência paralela: o maior lote em k cópias ao mesmo tempo
+  const int k = std::min(p.cpus, 8);
+  if (k > 1 && !big_doc.empty() && !(cancel_flag && *cancel_flag) && ms_since(start) + big_ms * 2 < budget_ms) {
+    std::vector<std::thread> th;
+    std::vector<double> t(k, 0.0);
+    std::atomic<int> failed{0};
+    const GsxJobToken job = gsx_job_token();
+    for (int i = 0; i < k; ++i) {
+      th.emplace_back([&, i, job] {
+        GsxJobAdopt adopt(job);
+        std::string part = gsx_make_temp_path(dir, "GSXT", ".pdf");
+        const Clock::time_point t0 = Clock::now();
+        if (gsx_compress_file_sync(big_doc.c_str(), part.c_str(), dpi, quality, o.preset, o.mode,
+                                   big_first, big_last, nullptr, nullptr, cancel_flag) < 0)
+          failed++;
+        t[i] = ms_since(t0);
+        std::error_code ec;
+        fs::remove(part, ec);
+      });
+    }
+    for (auto& x : th) x.join();
+    if (!failed) {
+      double mean = 0;
+      for (double x : t) mean += x / k;
+      if (mean > 0) {
+        p.parallel_eff = std::max(0.05, std::min(1.0, big_ms / mean));
+        p.eff_workers = k;
+      }
+      runs += k;
+    }
+  }
+  p.samples = runs;
+  *out = p;
+
+  char line[256];
+  snprintf(line, sizeof line,
+           "tune: lote %.0f ms + %.1f ms/pág + %.1f ms/MB; mescla %.0f + %.1f ms/parte + %.1f ms/MB; "
+           "eficiência %.2f com %d", p.chunk_fixed_ms, p.page_ms, p.ms_per_mb, p.merge_fixed_ms,
+           p.merge_part_ms, p.merge_ms_per_mb, p.parallel_eff, p.eff_workers);
+  gsx_log_msg(GSX_LOG_INFO, line);
+  progress_line(on_progress, user, runs, runs, line);
+  set_last_error_json(GSX_OK, "tune_calibrate", 0, 0, nullptr);
+  return runs;
+}
+
+GSX_API int gsx_tune_save(const char* path, const gsx_tune_profile_t* p) {
+  if (!path || !p) {
+    set_last_error_json(GSX_E_ARGS, "tune_save", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  char buf[640];
+  snprintf(buf, sizeof buf,
+           "{\"version\":1,\"chunk_fixed_ms\":%.4f,\"page_ms\":%.4f,\"ms_per_mb\":%.4f,"
+           "\"merge_fixed_ms\":%.4f,\"merge_part_ms\":%.4f,\"merge_ms_per_mb\":%.4f,"
+           "\"out_ratio\":%.6f,\"parallel_eff\":%.4f,\"eff_workers\":%d,\"cpus\":%d,\"samples\":%d}\n",
+           p->chunk_fixed_ms, p->page_ms, p->ms_per_mb, p->merge_fixed_ms, p->merge_part_ms,
+           p->merge_ms_per_mb, p->out_ratio, p->parallel_eff, p->eff_workers, p->cpus, p->samples);
+  std::ofstream f(path, std::ios::binary | std::ios::trunc);
+  if (!f) {
+    set_last_error_json(GSX_E_WRITE_OPEN, "tune_save", errno, 0, nullptr);
+    return GSX_E_WRITE_OPEN;
+  }
+  f << buf;
+  if (!f.flush()) {
+    set_last_error_json(GSX_E_WRITE_IO, "tune_save", errno, 0, nullptr);
+    return GSX_E_WRITE_IO;
+  }
+  set_last_error_json(GSX_OK, "tune_save", 0, 0, nullptr);
+  return GSX_OK;
+}
+
+GSX_API int gsx_tune_load(const char* path, gsx_tune_profile_t* p) {
+  if (!path || !p) {
+    set_last_error_json(GSX_E_ARGS, "tune_load", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  std::ifstream f(path, std::ios::binary);
+  if (!f) {
+    set_last_error_json(GSX_E_INPUT_NOT_FOUND, "tune_load", errno, 0, nullptr);
+    return GSX_E_INPUT_NOT_FOUND;
+  }
+  std::stringstream ss;
+  ss << f.rdbuf();
+  const std::string js = ss.str();
+  double v[11];
+  static const char* keys[11] = {"version", "chunk_fixed_ms", "page_ms", "ms_per_mb", "merge_fixed_ms",
+                                 "merge_part_ms", "merge_ms_per_mb", "out_ratio", "parallel_eff",
+                                 "eff_workers", "cpus"};
+  for (int i = 0; i < 11; ++i) {
+    if (!json_number(js, keys[i], v[i]) || (i == 0 && v[0] != 1)) {
+      set_last_error_json(GSX_E_ARGS, "tune_load.format", 0, 0, nullptr);
+      return GSX_E_ARGS;
+    }
+  }
+  double samples = 0;
+  json_number(js, "samples", samples);
+  gsx_tune_profile_t q{};
+  q.chunk_fixed_ms = v[1]; q.page_ms = v[2]; q.ms_per_mb = v[3];
+  q.merge_fixed_ms = v[4]; q.merge_part_ms = v[5]; q.merge_ms_per_mb = v[6];
+  q.out_ratio = v[7]; q.parallel_eff = v[8]; q.eff_workers = (int)v[9]; q.cpus = (int)v[10];
+  q.samples = (int)samples;
+  *p = q;
+  set_last_error_json(GSX_OK, "tune_load", 0, 0, nullptr);
+  return GSX_OK;
+}
+
+GSX_API void gsx_tune_set_profile(const gsx_tune_profile_t* profile) {
+  std::lock_guard<std::mutex> lk(g_profile_m);
+  g_profile_on = profile != nullptr;
+  if (profile) g_profile = *profile;
+}
+
+GSX_API int gsx_tune_get_profile(gsx_tune_profile_t* out) {
+  std::lock_guard<std::mutex> lk(g_profile_m);
+  if (!g_profile_on) return 0;
+  if (out) *out = g_profile;
+  return 1;
+}
+
+GSX_API void gsx_tune_plan(const gsx_tune_profile_t* p, int pages, uint64_t weight_bytes,
+                           int max_workers, gsx_tune_plan_t* out)
+{
+  if (!out) return;
+  *out = gsx_tune_plan_t{1, 1, 0, 0};
+  if (!p || pages <= 0) return;
+  if (max_workers <= 0) max_workers = std::max(1, (int)std::thread::hardware_concurrency());
+  // além dos núcleos medidos o perfil não sabe nada: não promete ganho
+  if (p->cpus > 0) max_workers = std::min(max_workers, p->cpus);
+  const double mb = (double)weight_bytes / 1048576.0;
+  const double work = p->page_ms * pages + p->ms_per_mb * mb;
+  auto eff = [&](int k) {
+    if (k <= 1 || p->eff_workers <= 1) return 1.0;
+    const double t = std::min(1.0, (double)(k - 1) / (double)(p->eff_workers - 1));
+    return std::max(0.05, 1.0 - (1.0 - p->parallel_eff) * t);
+  };
+  out->est_single_ms = p->chunk_fixed_ms + work;
+  out->est_ms = out->est_single_ms;
+  const int max_chunks = std::min(pages, max_workers * 4);
+  for (int n = 2; n <= max_chunks; ++n) {
+    const int k = std::min(n, max_workers);
+    const int rounds = (n + k - 1) / k;
+    const double t = (rounds * p->chunk_fixed_ms + work / k) / eff(k) +
+                     p->merge_fixed_ms + p->merge_part_ms * n + p->merge_ms_per_mb * mb * p->out_ratio;
+    if (t < out->est_ms) { out->est_ms = t; out->chunks = n; out->workers = k; }
+  }
+}
+
+GSX_API int gsx_tune_plan_file(const char* in_path, int first_page, int last_page, int max_workers,
+                               gsx_tune_plan_t* out)
+{
+  if (!in_path || !out) {
+    set_last_error_json(GSX_E_ARGS, "tune_plan", 0, 0, nullptr);
+    return GSX_E_ARGS;
+  }
+  *out = gsx_tune_plan_t{1, 1, 0, 0};
+  gsx_tune_profile_t p;
+  if (!gsx_tune_get_profile(&p)) return 0;
+  int first = first_page, last = last_page;
+  std::vector<uint64_t> w;
+  int rc = gsx_page_weights(in_path, first, last, w);
+  if (rc < 0) return rc;
+  uint64_t total = 0;
+  for (uint64_t x : w) total += x;
+  gsx_tune_plan(&p, (int)w.size(), total, max_workers, out);
+  set_last_error_json(GSX_OK, "tune_plan", 0, 0, nullptr);
+  return 1;
+}